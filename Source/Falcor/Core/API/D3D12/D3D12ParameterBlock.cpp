@@ -1542,6 +1542,7 @@ namespace Falcor
         //
 
         auto pSlangSession = mpProgramVersion->getSlangSession();
+        auto sessionLock = mpProgramVersion->lockSlangSession();
 
         ComPtr<ISlangBlob> pDiagnostics;
         auto pSpecializedSlangType = pSlangSession->specializeType(
@@ -26,11 +26,60 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "Core/API/Shader.h"
+#include "Core/Program/Program.h"
+#include "Utils/Timing/CpuTimer.h"
 
 #include <slang.h>
 
+#include <atomic>
+
 namespace Falcor
 {
+    namespace
+    {
+        /** Blob holding kernel code loaded from the shader cache.
+            Slang blobs are binary compatible with D3D blobs, so this can be used wherever compiled code is expected.
+        */
+        class CachedKernelBlob : public ISlangBlob
+        {
+        public:
+            CachedKernelBlob(std::vector<uint8_t> data) : mData(std::move(data)) {}
+            virtual ~CachedKernelBlob() = default;
+
+            virtual SLANG_NO_THROW SlangResult SLANG_MCALL queryInterface(SlangUUID const& uuid, void** outObject) override
+            {
+                const SlangUUID kUnknownUUID = SLANG_UUID_ISlangUnknown;
+                const SlangUUID kBlobUUID = SLANG_UUID_ISlangBlob;
+                if (uuid == kUnknownUUID || uuid == kBlobUUID)
+                {
+                    addRef();
+                    *outObject = static_cast<ISlangBlob*>(this);
+                    return SLANG_OK;
+                }
+                return SLANG_E_NO_INTERFACE;
+            }
+
+            virtual SLANG_NO_THROW uint32_t SLANG_MCALL addRef() override
+            {
+                return ++mRefCount;
+            }
+
+            virtual SLANG_NO_THROW uint32_t SLANG_MCALL release() override
+            {
+                uint32_t refCount = --mRefCount;
+                if (refCount == 0) delete this;
+                return refCount;
+            }
+
+            virtual SLANG_NO_THROW void const* SLANG_MCALL getBufferPointer() override { return mData.data(); }
+            virtual SLANG_NO_THROW size_t SLANG_MCALL getBufferSize() override { return mData.size(); }
+
+        private:
+            std::vector<uint8_t> mData;
+            std::atomic<uint32_t> mRefCount{ 0 };
+        };
+    }
+
     struct ShaderData
     {
         ID3DBlobPtr pBlob;
@@ -45,12 +94,26 @@ namespace Falcor
     {
     }
 
-    bool Shader::init(ComPtr<slang::IComponentType> slangEntryPoint, const std::string& entryPointName, CompilerFlags flags, std::string& log)
+    bool Shader::init(ComPtr<slang::IComponentType> slangEntryPoint, const std::string& entryPointName, CompilerFlags flags, std::string& log, const std::optional<ShaderCache::Key>& cacheKey)
     {
+        // Look up the kernel in the shader cache.
+        ShaderCache::SharedPtr pCache = cacheKey ? Program::getShaderCache() : nullptr;
+        if (pCache)
+        {
+            if (auto data = pCache->get(*cacheKey))
+            {
+                ComPtr<ISlangBlob> pCachedBlob(new CachedKernelBlob(std::move(*data)));
+                mpPrivateData->pBlob = pCachedBlob.get();
+                return true;
+            }
+        }
+
         // Compile the shader kernel.
         ComPtr<slang::IBlob> pSlangDiagnostics;
         ComPtr<slang::IBlob> pShaderBlob;
 
+        CpuTimer timer;
+        timer.update();
         bool succeeded = SLANG_SUCCEEDED(slangEntryPoint->getEntryPointCode(
             /* entryPointIndex: */ 0,
             /* targetIndex: */ 0,
@@ -63,6 +126,12 @@ namespace Falcor
         if (succeeded)
         {
             mpPrivateData->pBlob = pShaderBlob.get();
+
+            if (pCache)
+            {
+                timer.update();
+                pCache->put(*cacheKey, pShaderBlob->getBufferPointer(), pShaderBlob->getBufferSize(), timer.delta());
+            }
         }
         return succeeded;
     }
@@ -28,6 +28,7 @@
 #include "Device.h"
 #include "Core/Assert.h"
 #include "Core/Errors.h"
+#include "Utils/Logger.h"
 #include "Utils/Scripting/ScriptBindings.h"
 
 namespace Falcor
@@ -86,6 +87,11 @@ namespace Falcor
             return false;
         }
 
+#ifndef FALCOR_D3D12
+        // The shader cache stores the kernels generated by Falcor, with GFX they are generated internally. See Program::getShaderCache().
+        logInfo("The shader kernel cache is not available with the GFX backend, kernels are compiled on every start. Build with FALCOR_RENDER_BACKEND=D3D12 to use it.");
+#endif
+
         return true;
     }
 
@@ -60,7 +60,7 @@ namespace Falcor
     {
     }
 
-    bool Shader::init(ComPtr<slang::IComponentType> slangEntryPoint, const std::string& entryPointName, CompilerFlags flags, std::string& log)
+    bool Shader::init(ComPtr<slang::IComponentType> slangEntryPoint, const std::string& entryPointName, CompilerFlags flags, std::string& log, const std::optional<ShaderCache::Key>& cacheKey)
     {
         // In GFX, we do not generate actual shader code at program creation.
         // The actual shader code will only be generated and cached when all specialization arguments
@@ -71,6 +71,7 @@ namespace Falcor
         // Since most users/render-passes do not need to get shader kernel code, we defer
         // the call to slang's `getEntryPointCode` function until it is actually needed.
         // to avoid redundant shader compiler invocation.
+        // The shader cache is not used here, as GFX generates the kernel code for draw/dispatch internally.
         mpPrivateData->pBlob = nullptr;
         mpPrivateData->pLinkedSlangEntryPoint = slangEntryPoint;
         return slangEntryPoint != nullptr;
@@ -29,6 +29,7 @@
 #include "Core/Macros.h"
 #include "Core/Assert.h"
 #include "Core/API/Shared/D3D12Handles.h"
+#include "Core/Program/ShaderCache.h"
 
 #include <slang.h>
 #if FALCOR_HAS_D3D12
@@ -38,6 +39,7 @@
 #include <initializer_list>
 #include <memory>
 #include <map>
+#include <optional>
 #include <string>
 #include <cstddef> // std::nullptr_t
 
@@ -328,13 +330,14 @@ namespace Falcor
             \param[in] linkedSlangEntryPoint The Slang IComponentType that defines the shader entry point.
             \param[in] type The Type of the shader
             \param[out] log This string will contain the error log message in case shader compilation failed
+            \param[in] cacheKey Optional key used to look up and store the kernel code in the program shader cache.
             \return If success, a new shader object, otherwise nullptr
         */
-        static SharedPtr create(ComPtr<slang::IComponentType> linkedSlangEntryPoint, ShaderType type, std::string const&  entryPointName, CompilerFlags flags, std::string& log)
+        static SharedPtr create(ComPtr<slang::IComponentType> linkedSlangEntryPoint, ShaderType type, std::string const&  entryPointName, CompilerFlags flags, std::string& log, const std::optional<ShaderCache::Key>& cacheKey = {})
         {
             SharedPtr pShader = SharedPtr(new Shader(type));
             pShader->mEntryPointName = entryPointName;
-            return pShader->init(linkedSlangEntryPoint, entryPointName, flags, log) ? pShader : nullptr;
+            return pShader->init(linkedSlangEntryPoint, entryPointName, flags, log, cacheKey) ? pShader : nullptr;
         }
 
         virtual ~Shader();
@@ -358,7 +361,7 @@ namespace Falcor
 
     protected:
         // API handle depends on the shader Type, so it stored be stored as part of the private data
-        bool init(ComPtr<slang::IComponentType> linkedSlangEntryPoint, const std::string& entryPointName, CompilerFlags flags, std::string& log);
+        bool init(ComPtr<slang::IComponentType> linkedSlangEntryPoint, const std::string& entryPointName, CompilerFlags flags, std::string& log, const std::optional<ShaderCache::Key>& cacheKey);
         Shader(ShaderType Type);
         ShaderType mType;
         std::string mEntryPointName;
@@ -177,6 +177,15 @@ namespace Falcor
         */
         static SharedPtr createFromFile(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSrgb, BindFlags bindFlags = BindFlags::ShaderResource);
 
+        /** Create a new 2D texture object from a bitmap.
+            \param[in] bitmap The bitmap.
+            \param[in] generateMipLevels Whether the mip-chain should be generated.
+            \param[in] loadAsSrgb Create the texture using sRGB format. Only valid for 3 or 4 component textures.
+            \param[in] bindFlags The bind flags to create the texture with.
+            \return A new texture, or throws an exception if creation failed.
+        */
+        static SharedPtr createFromBitmap(const Bitmap& bitmap, bool generateMipLevels, bool loadAsSrgb, BindFlags bindFlags = BindFlags::ShaderResource);
+
         /** Get a shader-resource view for the entire resource
         */
         virtual ShaderResourceView::SharedPtr getSRV() override;
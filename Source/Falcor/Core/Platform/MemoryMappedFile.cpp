@@ -0,0 +1,151 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MemoryMappedFile.h"
+#include "Utils/Logger.h"
+
+#if FALCOR_WINDOWS
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif FALCOR_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace Falcor
+{
+    MemoryMappedFile::MemoryMappedFile(const std::filesystem::path& path, AccessHint accessHint)
+    {
+        open(path, accessHint);
+    }
+
+    MemoryMappedFile::~MemoryMappedFile()
+    {
+        close();
+    }
+
+#if FALCOR_WINDOWS
+
+    bool MemoryMappedFile::open(const std::filesystem::path& path, AccessHint accessHint)
+    {
+        close();
+
+        DWORD flags = FILE_ATTRIBUTE_NORMAL;
+        if (accessHint == AccessHint::SequentialScan) flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+        else if (accessHint == AccessHint::RandomAccess) flags |= FILE_FLAG_RANDOM_ACCESS;
+
+        HANDLE file = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        mFile = file;
+
+        LARGE_INTEGER size;
+        if (!::GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        {
+            close();
+            return false;
+        }
+        mSize = (size_t)size.QuadPart;
+
+        HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+        {
+            close();
+            return false;
+        }
+        mMapping = mapping;
+
+        mpData = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (mpData == nullptr)
+        {
+            logWarning("Failed to map file '{}'.", path);
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void MemoryMappedFile::close()
+    {
+        if (mpData) ::UnmapViewOfFile(mpData);
+        if (mMapping) ::CloseHandle(mMapping);
+        if (mFile) ::CloseHandle(mFile);
+        mpData = nullptr;
+        mMapping = nullptr;
+        mFile = nullptr;
+        mSize = 0;
+    }
+
+#elif FALCOR_LINUX
+
+    bool MemoryMappedFile::open(const std::filesystem::path& path, AccessHint accessHint)
+    {
+        close();
+
+        mFile = ::open(path.c_str(), O_RDONLY);
+        if (mFile == -1) return false;
+
+        struct stat st;
+        if (::fstat(mFile, &st) != 0 || st.st_size == 0)
+        {
+            close();
+            return false;
+        }
+        mSize = (size_t)st.st_size;
+
+        void* pData = ::mmap(nullptr, mSize, PROT_READ, MAP_SHARED, mFile, 0);
+        if (pData == MAP_FAILED)
+        {
+            logWarning("Failed to map file '{}'.", path);
+            close();
+            return false;
+        }
+        mpData = pData;
+
+        int advice = MADV_NORMAL;
+        if (accessHint == AccessHint::SequentialScan) advice = MADV_SEQUENTIAL;
+        else if (accessHint == AccessHint::RandomAccess) advice = MADV_RANDOM;
+        ::madvise(mpData, mSize, advice);
+
+        return true;
+    }
+
+    void MemoryMappedFile::close()
+    {
+        if (mpData) ::munmap(mpData, mSize);
+        if (mFile != -1) ::close(mFile);
+        mpData = nullptr;
+        mFile = -1;
+        mSize = 0;
+    }
+
+#endif
+}
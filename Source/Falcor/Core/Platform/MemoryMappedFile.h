@@ -0,0 +1,100 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <filesystem>
+#include <cstddef>
+#include <cstdint>
+
+namespace Falcor
+{
+    /** Read-only memory mapped file.
+        The whole file is mapped into the address space of the process. Pages are loaded lazily by the OS on first access.
+    */
+    class FALCOR_API MemoryMappedFile
+    {
+    public:
+        /** Hint about the expected access pattern, used to optimize read-ahead.
+        */
+        enum class AccessHint
+        {
+            Normal,             ///< No particular access pattern.
+            SequentialScan,     ///< Data is accessed sequentially from beginning to end.
+            RandomAccess,       ///< Data is accessed at random offsets.
+        };
+
+        MemoryMappedFile() = default;
+
+        /** Constructor that opens and maps a file.
+            Use isOpen() to check if the file was successfully mapped.
+            \param[in] path Path of the file to map.
+            \param[in] accessHint Expected access pattern.
+        */
+        MemoryMappedFile(const std::filesystem::path& path, AccessHint accessHint = AccessHint::Normal);
+
+        /** Destructor. Unmaps and closes the file.
+        */
+        ~MemoryMappedFile();
+
+        MemoryMappedFile(const MemoryMappedFile&) = delete;
+        MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+        /** Open and map a file. Closes a previously opened file.
+            \param[in] path Path of the file to map.
+            \param[in] accessHint Expected access pattern.
+            \return Returns true if the file was successfully mapped.
+        */
+        bool open(const std::filesystem::path& path, AccessHint accessHint = AccessHint::Normal);
+
+        /** Unmap and close the file.
+        */
+        void close();
+
+        /** Returns true if a file is mapped.
+        */
+        bool isOpen() const { return mpData != nullptr; }
+
+        /** Returns the size of the mapped file in bytes.
+        */
+        size_t getSize() const { return mSize; }
+
+        /** Returns a pointer to the mapped file data, or nullptr if no file is mapped.
+        */
+        const void* getData() const { return mpData; }
+
+    private:
+        void* mpData = nullptr;
+        size_t mSize = 0;
+#if FALCOR_WINDOWS
+        void* mFile = nullptr;
+        void* mMapping = nullptr;
+#elif FALCOR_LINUX
+        int mFile = -1;
+#endif
+    };
+}
@@ -32,11 +32,14 @@
 #include "Core/API/ParameterBlock.h"
 #include "Utils/StringUtils.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/CpuTimer.h"
 #include "Utils/Scripting/ScriptBindings.h"
 
 #include <slang.h>
 
+#include <algorithm>
+#include <mutex>
 #include <set>
 
 namespace Falcor
@@ -50,6 +53,39 @@ namespace Falcor
     static Program::DefineList sGlobalDefineList; // TODO: REMOVEGLOBAL
     static bool sGenerateDebugInfo; // TODO: REMOVEGLOBAL
     static Program::ForcedCompilerFlags sForcedCompilerFlags; // TODO: REMOVEGLOBAL
+#ifdef FALCOR_D3D12
+    static ShaderCache::SharedPtr sShaderCache; // TODO: REMOVEGLOBAL
+    static bool sShaderCacheInitialized = false; // TODO: REMOVEGLOBAL
+    static std::mutex sShaderCacheMutex;
+#endif
+    static std::mutex sCompilationStatsMutex;
+
+    static void hashString(SHA1& sha1, const std::string& str)
+    {
+        sha1.update((uint64_t)str.size());
+        sha1.update(str.data(), str.size());
+    }
+
+    static void hashDefines(SHA1& sha1, const Program::DefineList& defines)
+    {
+        sha1.update((uint64_t)defines.size());
+        for (const auto& [name, value] : defines)
+        {
+            hashString(sha1, name);
+            hashString(sha1, value);
+        }
+    }
+
+    static void hashTypeConformances(SHA1& sha1, const Program::TypeConformanceList& typeConformances)
+    {
+        sha1.update((uint64_t)typeConformances.size());
+        for (const auto& [typeConformance, id] : typeConformances)
+        {
+            hashString(sha1, typeConformance.mTypeName);
+            hashString(sha1, typeConformance.mInterfaceName);
+            sha1.update(id);
+        }
+    }
 
     Program::Desc applyForcedCompilerFlags(Program::Desc desc)
     {
@@ -225,38 +261,43 @@ namespace Falcor
 
     std::string Program::getProgramDescString() const
     {
-        std::string desc;
+        return getProgramDescString(mDesc);
+    }
+
+    std::string Program::getProgramDescString(const Desc& desc)
+    {
+        std::string str;
 
-        int32_t groupCount = (int32_t)mDesc.mGroups.size();
+        int32_t groupCount = (int32_t)desc.mGroups.size();
 
-        for (size_t i = 0; i < mDesc.mSources.size(); i++)
+        for (size_t i = 0; i < desc.mSources.size(); i++)
         {
-            const auto& src = mDesc.mSources[i];
-            if (i != 0) desc += " ";
+            const auto& src = desc.mSources[i];
+            if (i != 0) str += " ";
             switch (src.getType())
             {
             case ShaderModule::Type::File:
-                desc += src.source.filePath.string();
+                str += src.source.filePath.string();
                 break;
             case ShaderModule::Type::String:
-                desc += "Created from string";
+                str += "Created from string";
                 break;
             default:
                 FALCOR_UNREACHABLE();
             }
 
-            desc += "(";
+            str += "(";
             for (size_t ee = 0; ee < src.entryPoints.size(); ++ee)
             {
-                auto& entryPoint = mDesc.mEntryPoints[src.entryPoints[ee]];
+                auto& entryPoint = desc.mEntryPoints[src.entryPoints[ee]];
 
-                if (ee != 0) desc += ", ";
-                desc += entryPoint.exportName;
+                if (ee != 0) str += ", ";
+                str += entryPoint.exportName;
             }
-            desc += ")";
+            str += ")";
         }
 
-        return desc;
+        return str;
     }
 
     bool Program::addDefine(const std::string& name, const std::string& value)
@@ -348,6 +389,7 @@ namespace Falcor
         if (mTypeConformanceList.find(conformance) == mTypeConformanceList.end())
         {
             markDirty();
+            std::lock_guard<std::mutex> lock(mMutex);
             mTypeConformanceList.add(typeName, interfaceType, id);
             return true;
         }
@@ -360,6 +402,7 @@ namespace Falcor
         if (mTypeConformanceList.find(conformance) != mTypeConformanceList.end())
         {
             markDirty();
+            std::lock_guard<std::mutex> lock(mMutex);
             mTypeConformanceList.remove(typeName, interfaceType);
             return true;
         }
@@ -371,6 +414,7 @@ namespace Falcor
         if (conformances != mTypeConformanceList)
         {
             markDirty();
+            std::lock_guard<std::mutex> lock(mMutex);
             mTypeConformanceList = conformances;
             return true;
         }
@@ -386,6 +430,7 @@ namespace Falcor
         }
 
         // Have any of the files we depend on changed?
+        std::lock_guard<std::mutex> lock(mMutex);
         for (auto& entry : mFileTimeMap)
         {
             auto& path = entry.first;
@@ -403,8 +448,23 @@ namespace Falcor
     {
         if (mLinkRequired)
         {
-            const auto& it = mProgramVersions.find(mDefineList);
-            if (it == mProgramVersions.end())
+            // If the version is being compiled in the background, wait for it instead of compiling it again.
+            std::shared_future<ProgramVersion::SharedConstPtr> pendingVersion;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                const auto& it = mPendingVersions.find(mDefineList);
+                if (it != mPendingVersions.end()) pendingVersion = it->second;
+            }
+            if (pendingVersion.valid()) pendingVersion.wait();
+
+            ProgramVersion::SharedConstPtr pVersion;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                const auto& it = mProgramVersions.find(mDefineList);
+                if (it != mProgramVersions.end()) pVersion = it->second;
+            }
+
+            if (pVersion == nullptr)
             {
                 // Note that link() updates mActiveProgram only if the operation was successful.
                 // On error we get false, and mActiveProgram points to the last successfully compiled version.
@@ -414,12 +474,13 @@ namespace Falcor
                 }
                 else
                 {
+                    std::lock_guard<std::mutex> lock(mMutex);
                     mProgramVersions[mDefineList] = mpActiveVersion;
                 }
             }
             else
             {
-                mpActiveVersion = it->second;
+                mpActiveVersion = pVersion;
             }
             mLinkRequired = false;
         }
@@ -440,6 +501,58 @@ namespace Falcor
         return pSlangGlobalSession;
     }
 
+    namespace
+    {
+        /** Pool of Slang global sessions used for background compilation.
+            The Slang API is not thread-safe. Each background compilation takes exclusive ownership of a global session,
+            and program versions keep the session's mutex so that later calls into the session can be serialized with
+            other background compilations. The main global session is only used on the calling thread.
+        */
+        class SlangSessionPool
+        {
+        public:
+            struct Entry
+            {
+                slang::IGlobalSession* pSession = nullptr;
+                std::shared_ptr<std::recursive_mutex> pMutex;
+                bool inUse = false;
+            };
+
+            Entry* acquire()
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                for (auto& pEntry : mEntries)
+                {
+                    if (!pEntry->inUse)
+                    {
+                        pEntry->inUse = true;
+                        return pEntry.get();
+                    }
+                }
+
+                auto pEntry = std::make_unique<Entry>();
+                pEntry->pSession = createSlangGlobalSession();
+                if (!pEntry->pSession) throw RuntimeError("Failed to create Slang global session");
+                pEntry->pMutex = std::make_shared<std::recursive_mutex>();
+                pEntry->inUse = true;
+                mEntries.push_back(std::move(pEntry));
+                return mEntries.back().get();
+            }
+
+            void release(Entry* pEntry)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                pEntry->inUse = false;
+            }
+
+        private:
+            std::mutex mMutex;
+            std::vector<std::unique_ptr<Entry>> mEntries;
+        };
+
+        SlangSessionPool sSlangSessionPool; // TODO: REMOVEGLOBAL
+    }
+
     // Translation a Falcor `ShaderType` to the corresponding `SlangStage`
     SlangStage getSlangStage(ShaderType type)
     {
@@ -488,9 +601,10 @@ namespace Falcor
     }
 
     SlangCompileRequest* Program::createSlangCompileRequest(
-        const DefineList& defineList) const
+        const Desc& desc,
+        const DefineList& defineList,
+        slang::IGlobalSession* pSlangGlobalSession) const
     {
-        slang::IGlobalSession* pSlangGlobalSession = getSlangGlobalSession();
         FALCOR_ASSERT(pSlangGlobalSession);
 
         slang::SessionDesc sessionDesc;
@@ -513,17 +627,17 @@ namespace Falcor
 
         slang::TargetDesc targetDesc;
         targetDesc.format = SLANG_TARGET_UNKNOWN;
-        targetDesc.profile = pSlangGlobalSession->findProfile(getSlangProfileString(mDesc.mShaderModel).c_str());
+        targetDesc.profile = pSlangGlobalSession->findProfile(getSlangProfileString(desc.mShaderModel).c_str());
 
         if (targetDesc.profile == SLANG_PROFILE_UNKNOWN)
         {
-            reportError("Can't find Slang profile for shader model " + mDesc.mShaderModel);
+            reportError("Can't find Slang profile for shader model " + desc.mShaderModel);
             return nullptr;
         }
 
         // Set floating point mode. If no shader compiler flags for this were set, we use Slang's default mode.
-        bool flagFast = is_set(mDesc.getCompilerFlags(), Shader::CompilerFlags::FloatingPointModeFast);
-        bool flagPrecise = is_set(mDesc.getCompilerFlags(), Shader::CompilerFlags::FloatingPointModePrecise);
+        bool flagFast = is_set(desc.getCompilerFlags(), Shader::CompilerFlags::FloatingPointModeFast);
+        bool flagPrecise = is_set(desc.getCompilerFlags(), Shader::CompilerFlags::FloatingPointModePrecise);
         if (flagFast && flagPrecise)
         {
             logWarning("Shader compiler flags 'FloatingPointModeFast' and 'FloatingPointModePrecise' can't be used simultaneously. Ignoring 'FloatingPointModeFast'.");
@@ -559,7 +673,7 @@ namespace Falcor
         }
 
         // Add program specific defines.
-        for (const auto& shaderDefine : getDefineList())
+        for (const auto& shaderDefine : defineList)
         {
             addSlangDefine(shaderDefine.first.c_str(), shaderDefine.second.c_str());
         }
@@ -567,7 +681,7 @@ namespace Falcor
         // Add a `#define`s based on the target and shader model.
         addSlangDefine(targetMacroName, "1");
 
-        std::string sm = "__SM_" + mDesc.mShaderModel + "__";
+        std::string sm = "__SM_" + desc.mShaderModel + "__";
         addSlangDefine(sm.c_str(), "1");
 
         sessionDesc.preprocessorMacros = slangDefines.data();
@@ -580,7 +694,7 @@ namespace Falcor
         // to allow it to compute correct reflection information. Slang then invokes the downstream compiler.
         // Column major option can be useful when compiling external shader sources that don't depend
         // on anything Falcor.
-        bool useColumnMajor = is_set(mDesc.getCompilerFlags(), Shader::CompilerFlags::MatrixLayoutColumnMajor);
+        bool useColumnMajor = is_set(desc.getCompilerFlags(), Shader::CompilerFlags::MatrixLayoutColumnMajor);
         sessionDesc.defaultMatrixLayoutMode = useColumnMajor ? SLANG_MATRIX_LAYOUT_COLUMN_MAJOR : SLANG_MATRIX_LAYOUT_ROW_MAJOR;
 
         ComPtr<slang::ISession> pSlangSession;
@@ -589,8 +703,6 @@ namespace Falcor
             pSlangSession.writeRef());
         FALCOR_ASSERT(pSlangSession);
 
-        mFileTimeMap.clear();
-
         SlangCompileRequest* pSlangRequest = nullptr;
         pSlangSession->createCompileRequest(
             &pSlangRequest);
@@ -601,10 +713,10 @@ namespace Falcor
         spOverrideDiagnosticSeverity(pSlangRequest, 30081, SLANG_SEVERITY_DISABLED);
 
         // Enable/disable intermediates dump
-        bool dumpIR = is_set(mDesc.getCompilerFlags(), Shader::CompilerFlags::DumpIntermediates);
+        bool dumpIR = is_set(desc.getCompilerFlags(), Shader::CompilerFlags::DumpIntermediates);
         spSetDumpIntermediates(pSlangRequest, dumpIR);
 
-        if (sGenerateDebugInfo || is_set(mDesc.getCompilerFlags(), Shader::CompilerFlags::GenerateDebugInfo))
+        if (sGenerateDebugInfo || is_set(desc.getCompilerFlags(), Shader::CompilerFlags::GenerateDebugInfo))
         {
             spSetDebugInfoLevel(pSlangRequest, SLANG_DEBUG_INFO_LEVEL_STANDARD);
         }
@@ -621,10 +733,10 @@ namespace Falcor
         spSetCompileFlags(pSlangRequest, slangFlags);
 
         // Set additional command line arguments.
-        if (!mDesc.mCompilerArguments.empty())
+        if (!desc.mCompilerArguments.empty())
         {
             std::vector<const char*> args;
-            for (const auto& arg : mDesc.mCompilerArguments) args.push_back(arg.c_str());
+            for (const auto& arg : desc.mCompilerArguments) args.push_back(arg.c_str());
             spProcessCommandLineArguments(pSlangRequest, args.data(), (int)args.size());
         }
 
@@ -632,7 +744,7 @@ namespace Falcor
         int translationUnitsAdded = 0;
         int translationUnitIndex = -1;
 
-        for (auto src : mDesc.mSources)
+        for (auto src : desc.mSources)
         {
             // Register new translation unit with Slang if needed.
             if (translationUnitIndex < 0 || src.source.createTranslationUnit)
@@ -674,7 +786,7 @@ namespace Falcor
         // Each entry point references the index of the source
         // it uses, and luckily, the Slang API can use these
         // indices directly.
-        for (auto& entryPoint : mDesc.mEntryPoints)
+        for (auto& entryPoint : desc.mEntryPoints)
         {
             spAddEntryPoint(
                 pSlangRequest,
@@ -743,7 +855,14 @@ namespace Falcor
         CpuTimer timer;
         timer.update();
 
+        auto sessionLock = pVersion->lockSlangSession();
         auto pSlangGlobalScope = pVersion->getSlangGlobalScope();
+
+        TypeConformanceList programTypeConformances;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            programTypeConformances = mTypeConformanceList;
+        }
         auto pSlangSession = pSlangGlobalScope->getSession();
 
 #ifdef FALCOR_D3D12
@@ -840,7 +959,7 @@ namespace Falcor
         typeConformancesCompositeComponents.reserve(getEntryPointGroupCount());
         for (const auto& group : mDesc.mGroups)
         {
-            TypeConformanceList typeConformances = mTypeConformanceList;
+            TypeConformanceList typeConformances = programTypeConformances;
             typeConformances.add(group.typeConformances);
             if (auto typeConformanceComponentList = createTypeConformanceComponentList(typeConformances))
                 typeConformancesCompositeComponents.emplace_back(*typeConformanceComponentList);
@@ -983,6 +1102,29 @@ namespace Falcor
         ProgramReflection::SharedPtr pReflector;
         doSlangReflection(pVersion, pSpecializedSlangProgram, pLinkedEntryPoints, pReflector, log);
 
+        // Compute the shader cache key of the kernels. The key of the version covers the source closure and the
+        // compilation options, here we add everything that is linked in or specialized afterwards.
+        std::optional<ShaderCache::Key> kernelsCacheKey;
+        if (pVersion->mShaderCacheKey)
+        {
+            SHA1 sha1;
+            sha1.update(pVersion->mShaderCacheKey->data(), pVersion->mShaderCacheKey->size());
+            hashTypeConformances(sha1, programTypeConformances);
+            for (const auto& group : mDesc.mGroups)
+            {
+                hashTypeConformances(sha1, group.typeConformances);
+                hashString(sha1, group.nameSuffix);
+            }
+#ifdef FALCOR_D3D12
+            sha1.update((uint64_t)specializationArgs.size());
+            for (const auto& specializationArg : specializationArgs)
+            {
+                hashString(sha1, specializationArg.type->getName());
+            }
+#endif
+            kernelsCacheKey = sha1.finalize();
+        }
+
         // Create Shader objects for each entry point and cache them here.
         std::vector<Shader::SharedPtr> allShaders;
         for (uint32_t i = 0; i < allEntryPointCount; i++)
@@ -990,7 +1132,16 @@ namespace Falcor
             auto pLinkedEntryPoint = pLinkedEntryPoints[i];
             auto entryPointDesc = mDesc.mEntryPoints[i];
 
-            Shader::SharedPtr shader = Shader::create(pLinkedEntryPoint, entryPointDesc.stage, entryPointDesc.exportName, mDesc.getCompilerFlags(), log);
+            std::optional<ShaderCache::Key> shaderCacheKey;
+            if (kernelsCacheKey)
+            {
+                SHA1 sha1;
+                sha1.update(kernelsCacheKey->data(), kernelsCacheKey->size());
+                sha1.update(i);
+                shaderCacheKey = sha1.finalize();
+            }
+
+            Shader::SharedPtr shader = Shader::create(pLinkedEntryPoint, entryPointDesc.stage, entryPointDesc.exportName, mDesc.getCompilerFlags(), log, shaderCacheKey);
             if (!shader) return nullptr;
 
             allShaders.push_back(std::move(shader));
@@ -1036,6 +1187,7 @@ namespace Falcor
 
         timer.update();
         double time = timer.delta();
+        std::lock_guard<std::mutex> statsLock(sCompilationStatsMutex);
         sCompilationStats.programKernelsCount++;
         sCompilationStats.programKernelsTotalTime += time;
         sCompilationStats.programKernelsMaxTime = std::max(sCompilationStats.programKernelsMaxTime, time);
@@ -1064,12 +1216,15 @@ namespace Falcor
     }
 
     ProgramVersion::SharedPtr Program::preprocessAndCreateProgramVersion(
+        const Desc& desc,
+        const DefineList& defineList,
+        slang::IGlobalSession* pSlangGlobalSession,
         std::string& log) const
     {
         CpuTimer timer;
         timer.update();
 
-        auto pSlangRequest = createSlangCompileRequest(mDefineList);
+        auto pSlangRequest = createSlangCompileRequest(desc, defineList, pSlangGlobalSession);
         if (pSlangRequest == nullptr) return nullptr;
 
         SlangResult slangResult = spCompile(pSlangRequest);
@@ -1089,7 +1244,7 @@ namespace Falcor
 
         // Prepare entry points.
         std::vector<ComPtr<slang::IComponentType>> pSlangEntryPoints;
-        uint32_t entryPointCount = (uint32_t)mDesc.mEntryPoints.size();
+        uint32_t entryPointCount = (uint32_t)desc.mEntryPoints.size();
         for (uint32_t ee = 0; ee < entryPointCount; ++ee)
         {
             ComPtr<slang::IComponentType> pSlangEntryPoint;
@@ -1101,7 +1256,7 @@ namespace Falcor
             // Rename entry point in the generated code if the exported name differs from the source name.
             // This makes it possible to generate different specializations of the same source entry point,
             // for example by setting different type conformances.
-            const auto& entryPointDesc = mDesc.mEntryPoints[ee];
+            const auto& entryPointDesc = desc.mEntryPoints[ee];
             if (entryPointDesc.exportName != entryPointDesc.name)
             {
                 ComPtr<slang::IComponentType> pRenamedEntryPoint;
@@ -1115,11 +1270,15 @@ namespace Falcor
         }
 
         // Extract list of files referenced, for dependency-tracking purposes.
-        int depFileCount = spGetDependencyFileCount(pSlangRequest);
-        for (int ii = 0; ii < depFileCount; ++ii)
+        // The map accumulates the dependencies of all compiled versions, so that editing any of them triggers a reload.
         {
-            std::string depFilePath = spGetDependencyFilePath(pSlangRequest, ii);
-            mFileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
+            std::lock_guard<std::mutex> lock(mMutex);
+            int depFileCount = spGetDependencyFileCount(pSlangRequest);
+            for (int ii = 0; ii < depFileCount; ++ii)
+            {
+                std::string depFilePath = spGetDependencyFilePath(pSlangRequest, ii);
+                mFileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
+            }
         }
 
         // Note: the `ProgramReflection` needs to be able to refer back to the
@@ -1155,15 +1314,21 @@ namespace Falcor
             return nullptr;
         }
 
-        auto descStr = getProgramDescString();
+        // There is no shader cache with the GFX backend, see getShaderCache().
+        std::optional<ShaderCache::Key> shaderCacheKey;
+        if (getShaderCache()) shaderCacheKey = computeShaderCacheKey(desc, defineList, pSlangRequest);
+
+        auto descStr = getProgramDescString(desc);
         pVersion->init(
-            mDefineList,
+            defineList,
             pReflector,
             descStr,
-            pSlangEntryPoints);
+            pSlangEntryPoints,
+            shaderCacheKey);
 
         timer.update();
         double time = timer.delta();
+        std::lock_guard<std::mutex> statsLock(sCompilationStatsMutex);
         sCompilationStats.programVersionCount++;
         sCompilationStats.programVersionTotalTime += time;
         sCompilationStats.programVersionMaxTime = std::max(sCompilationStats.programVersionMaxTime, time);
@@ -1172,6 +1337,80 @@ namespace Falcor
         return pVersion;
     }
 
+    std::optional<ShaderCache::Key> Program::computeShaderCacheKey(const Desc& desc, const DefineList& defineList, SlangCompileRequest* pSlangRequest) const
+    {
+        SHA1 sha1;
+
+        // Compiler and compilation options.
+        hashString(sha1, spGetBuildTagString());
+        sha1.update((uint32_t)gpDevice->getType());
+        hashString(sha1, desc.mShaderModel);
+        sha1.update((uint32_t)desc.getCompilerFlags());
+        sha1.update(sGenerateDebugInfo);
+        sha1.update((uint64_t)desc.mCompilerArguments.size());
+        for (const auto& arg : desc.mCompilerArguments) hashString(sha1, arg);
+
+        // Defines.
+        hashDefines(sha1, sGlobalDefineList);
+        hashDefines(sha1, defineList);
+
+        // Sources and entry points. Source strings are hashed here, files are part of the dependencies below.
+        std::set<std::string> stringModulePaths;
+        sha1.update((uint64_t)desc.mSources.size());
+        for (const auto& src : desc.mSources)
+        {
+            sha1.update((uint32_t)src.getType());
+            sha1.update(src.source.createTranslationUnit);
+            hashString(sha1, src.source.moduleName);
+            if (src.getType() == ShaderModule::Type::File)
+            {
+                hashString(sha1, src.source.filePath.string());
+            }
+            else
+            {
+                hashString(sha1, src.source.modulePath);
+                hashString(sha1, src.source.str);
+                stringModulePaths.insert(src.source.modulePath);
+            }
+        }
+
+        sha1.update((uint64_t)desc.mEntryPoints.size());
+        for (const auto& entryPoint : desc.mEntryPoints)
+        {
+            hashString(sha1, entryPoint.name);
+            hashString(sha1, entryPoint.exportName);
+            sha1.update((uint32_t)entryPoint.stage);
+            sha1.update(entryPoint.sourceIndex);
+            sha1.update(entryPoint.groupIndex);
+        }
+
+        // Contents of all files in the source closure.
+        std::vector<std::string> dependencies;
+        int depFileCount = spGetDependencyFileCount(pSlangRequest);
+        for (int ii = 0; ii < depFileCount; ++ii)
+        {
+            dependencies.push_back(spGetDependencyFilePath(pSlangRequest, ii));
+        }
+        std::sort(dependencies.begin(), dependencies.end());
+
+        sha1.update((uint64_t)dependencies.size());
+        for (const auto& path : dependencies)
+        {
+            hashString(sha1, path);
+            if (auto hash = ShaderCache::getFileHash(path))
+            {
+                sha1.update(hash->data(), hash->size());
+            }
+            else if (stringModulePaths.count(path) == 0)
+            {
+                logWarning("Can't read shader source '{}', kernels of program '{}' are not cached.", path, getProgramDescString(desc));
+                return {};
+            }
+        }
+
+        return sha1.finalize();
+    }
+
     EntryPointGroupKernels::SharedPtr Program::createEntryPointGroupKernels(
         const std::vector<Shader::SharedPtr>& shaders,
         EntryPointBaseReflection::SharedPtr const& pReflector) const
@@ -1185,7 +1424,7 @@ namespace Falcor
         {
             // Create the program
             std::string log;
-            auto pVersion = preprocessAndCreateProgramVersion(log);
+            auto pVersion = preprocessAndCreateProgramVersion(mDesc, mDefineList, getSlangGlobalSession(), log);
 
             if (pVersion == nullptr)
             {
@@ -1211,11 +1450,122 @@ namespace Falcor
     void Program::reset()
     {
         mpActiveVersion = nullptr;
-        mProgramVersions.clear();
-        mFileTimeMap.clear();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mProgramVersions.clear();
+            mPendingVersions.clear();
+            mFileTimeMap.clear();
+            mVersionGeneration++;
+        }
         mLinkRequired = true;
     }
 
+    bool Program::isBackgroundCompilationSupported()
+    {
+#ifdef FALCOR_D3D12
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    std::shared_future<ProgramVersion::SharedConstPtr> Program::compileVersionAsync(const DefineList& defines) const
+    {
+        auto pPromise = std::make_shared<std::promise<ProgramVersion::SharedConstPtr>>();
+        std::shared_future<ProgramVersion::SharedConstPtr> future = pPromise->get_future().share();
+        uint32_t generation = 0;
+
+        // The task works on a copy of the program description, so that it never reads program state
+        // that is owned by the calling thread.
+        std::shared_ptr<const Desc> pDesc;
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (auto it = mProgramVersions.find(defines); it != mProgramVersions.end())
+            {
+                pPromise->set_value(it->second);
+                return future;
+            }
+            if (auto it = mPendingVersions.find(defines); it != mPendingVersions.end()) return it->second;
+            mPendingVersions[defines] = future;
+            generation = mVersionGeneration;
+            pDesc = std::make_shared<const Desc>(mDesc);
+        }
+
+        auto compile = [pProgram = shared_from_this(), pDesc, pPromise, defines, generation]()
+        {
+            ProgramVersion::SharedPtr pVersion;
+            std::string log;
+            try
+            {
+#ifdef FALCOR_D3D12
+                auto pEntry = sSlangSessionPool.acquire();
+                try
+                {
+                    std::lock_guard<std::recursive_mutex> sessionLock(*pEntry->pMutex);
+                    pVersion = pProgram->preprocessAndCreateProgramVersion(*pDesc, defines, pEntry->pSession, log);
+                }
+                catch (...)
+                {
+                    sSlangSessionPool.release(pEntry);
+                    throw;
+                }
+                sSlangSessionPool.release(pEntry);
+                if (pVersion) pVersion->mpSlangSessionMutex = pEntry->pMutex;
+#else
+                pVersion = pProgram->preprocessAndCreateProgramVersion(*pDesc, defines, getSlangGlobalSession(), log);
+#endif
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(pProgram->mMutex);
+                if (pProgram->mVersionGeneration == generation) pProgram->mPendingVersions.erase(defines);
+                pPromise->set_exception(std::current_exception());
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(pProgram->mMutex);
+                if (pProgram->mVersionGeneration == generation)
+                {
+                    if (pVersion) pProgram->mProgramVersions[defines] = pVersion;
+                    pProgram->mPendingVersions.erase(defines);
+                }
+            }
+
+            if (pVersion)
+            {
+                if (!log.empty()) logWarning("Warnings in program:\n" + getProgramDescString(*pDesc) + "\n" + log);
+                pPromise->set_value(pVersion);
+            }
+            else
+            {
+                pPromise->set_exception(std::make_exception_ptr(RuntimeError("Failed to link program:\n{}\n\n{}", getProgramDescString(*pDesc), log)));
+            }
+        };
+
+#ifdef FALCOR_D3D12
+        Threading::dispatchTask(compile);
+#else
+        // Background compilation is D3D12 only, see isBackgroundCompilationSupported().
+        // Compiling the front-end on a pooled session isn't possible, as the resulting Slang types can't be moved to the device's session.
+        compile();
+#endif
+        return future;
+    }
+
+    std::vector<std::shared_future<ProgramVersion::SharedConstPtr>> Program::compileVersionsAsync(const std::vector<SharedPtr>& programs)
+    {
+        std::vector<std::shared_future<ProgramVersion::SharedConstPtr>> futures;
+        futures.reserve(programs.size());
+        for (const auto& pProgram : programs)
+        {
+            checkArgument(pProgram != nullptr, "'programs' must not contain null programs.");
+            futures.push_back(pProgram->compileVersionAsync(pProgram->getDefineList()));
+        }
+        return futures;
+    }
+
     bool Program::reloadAllPrograms(bool forceReload)
     {
         bool hasReloaded = false;
@@ -1305,6 +1655,42 @@ namespace Falcor
 
     Program::ForcedCompilerFlags Program::getForcedCompilerFlags() { return sForcedCompilerFlags; }
 
+    void Program::setShaderCache(const ShaderCache::SharedPtr& pCache)
+    {
+#ifdef FALCOR_D3D12
+        std::lock_guard<std::mutex> lock(sShaderCacheMutex);
+        sShaderCache = pCache;
+        sShaderCacheInitialized = true;
+#else
+        if (pCache) logWarning("Kernels are not cached with the GFX backend. Ignoring shader cache.");
+#endif
+    }
+
+    ShaderCache::SharedPtr Program::getShaderCache()
+    {
+#ifdef FALCOR_D3D12
+        std::lock_guard<std::mutex> lock(sShaderCacheMutex);
+        if (!sShaderCacheInitialized)
+        {
+            sShaderCacheInitialized = true;
+            try
+            {
+                sShaderCache = ShaderCache::create(ShaderCache::getDefaultDirectory());
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Failed to create shader cache, kernels are not cached. {}", e.what());
+            }
+        }
+        return sShaderCache;
+#else
+        // GFX generates the kernel code for draws/dispatches internally from the Slang component types,
+        // and has no way to create programs from previously generated code, so there are no kernels to cache.
+        // The cache (and its directory) is never created. This is reported when the device is created.
+        return nullptr;
+#endif
+    }
+
     FALCOR_SCRIPT_BINDING(Program)
     {
         pybind11::class_<Program, Program::SharedPtr>(m, "Program");
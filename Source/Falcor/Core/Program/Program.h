@@ -27,10 +27,13 @@
  **************************************************************************/
 #pragma once
 #include "ProgramVersion.h"
+#include "ShaderCache.h"
 #include "Core/Macros.h"
 #include "Core/API/Shader.h"
 #include <filesystem>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string_view>
 #include <string>
 #include <map>
@@ -303,6 +306,31 @@ namespace Falcor
         */
         const DefineList& getDefineList() const { return mDefineList; }
 
+        /** Check if program versions can be compiled in the background, see compileVersionAsync().
+            \return True with the D3D12 backend. False with GFX, where compileVersionAsync() is synchronous.
+        */
+        static bool isBackgroundCompilationSupported();
+
+        /** Compile a program version in the background using the global thread pool.
+            Once compiled, the version is added to the program's version cache, so selecting the same defines
+            later (e.g. using setDefines()) switches to it without compiling on the calling thread.
+            The compile task works on a snapshot of the program description taken when this function is called.
+            Note: This function is synchronous with the GFX backend (see isBackgroundCompilationSupported()). The version is compiled
+            on the calling thread and the returned future is ready. GFX creates kernels and shader objects from the device's Slang
+            session, so versions must be compiled with that session, which can't be used concurrently.
+            \param[in] defines Macro definitions of the program version.
+            \return Future holding the program version. On compilation failure, the future holds a RuntimeError.
+        */
+        std::shared_future<ProgramVersion::SharedConstPtr> compileVersionAsync(const DefineList& defines) const;
+
+        /** Compile the current program version of multiple programs in parallel.
+            This is a convenience function calling compileVersionAsync() on each program with its current defines.
+            Note: With GFX the programs are compiled one after another on the calling thread, see isBackgroundCompilationSupported().
+            \param[in] programs List of programs.
+            \return List of futures holding the program versions, in the same order as the programs.
+        */
+        static std::vector<std::shared_future<ProgramVersion::SharedConstPtr>> compileVersionsAsync(const std::vector<SharedPtr>& programs);
+
         /** Reload and relink all programs.
             \param[in] forceReload Force reloading all programs.
             \return True if any program was reloaded, false otherwise.
@@ -341,6 +369,18 @@ namespace Falcor
         */
         static ForcedCompilerFlags getForcedCompilerFlags();
 
+        /** Set the persistent kernel cache used by all programs.
+            Kernels are only cached with the D3D12 backend. With GFX, the call is ignored.
+            \param[in] pCache Shader cache, or nullptr to disable caching.
+        */
+        static void setShaderCache(const ShaderCache::SharedPtr& pCache);
+
+        /** Get the persistent kernel cache used by all programs.
+            Unless set explicitly, a cache in the default directory is created on first use.
+            \return The shader cache, or nullptr if caching is disabled or the backend is GFX.
+        */
+        static ShaderCache::SharedPtr getShaderCache();
+
         /** Get the program reflection for the active program.
             \return Program reflection object, or an exception is thrown on failure.
         */
@@ -367,7 +407,9 @@ namespace Falcor
         bool link() const;
 
         SlangCompileRequest* createSlangCompileRequest(
-            DefineList  const& defineList) const;
+            Desc        const& desc,
+            DefineList  const& defineList,
+            slang::IGlobalSession* pSlangGlobalSession) const;
 
         virtual void setUpSlangCompilationTarget(
             slang::TargetDesc&  ioTargetDesc,
@@ -380,7 +422,26 @@ namespace Falcor
             ProgramReflection::SharedPtr&               pReflector,
             std::string&                                log) const;
 
-        ProgramVersion::SharedPtr preprocessAndCreateProgramVersion(std::string& log) const;
+        /** Create a program version. All inputs are passed explicitly, so that versions can be created on a background thread.
+            \param[in] desc Program description, a copy of mDesc when called from a background task.
+            \param[in] defineList Macro definitions of the version.
+            \param[in] pSlangGlobalSession Slang global session used for compilation.
+            \param[out] log Compilation diagnostics.
+            \return The program version, or nullptr on failure.
+        */
+        ProgramVersion::SharedPtr preprocessAndCreateProgramVersion(
+            Desc        const& desc,
+            DefineList  const& defineList,
+            slang::IGlobalSession* pSlangGlobalSession,
+            std::string& log) const;
+
+        /** Compute the shader cache key of a program version from everything that affects code generation.
+            \param[in] desc Program description.
+            \param[in] defineList Macro definitions of the version.
+            \param[in] pSlangRequest Compile request of the version, used to get the source closure.
+            \return The cache key, or an empty optional if a source file couldn't be read.
+        */
+        std::optional<ShaderCache::Key> computeShaderCacheKey(const Desc& desc, const DefineList& defineList, SlangCompileRequest* pSlangRequest) const;
 
         ProgramKernels::SharedPtr preprocessAndCreateProgramKernels(
             ProgramVersion const* pVersion,
@@ -404,7 +465,7 @@ namespace Falcor
         const Desc mDesc;
 
         DefineList mDefineList;
-        TypeConformanceList mTypeConformanceList;
+        TypeConformanceList mTypeConformanceList; ///< Modified under mMutex, kernel creation works on a copy.
 
         // We are doing lazy compilation, so these are mutable
         mutable bool mLinkRequired = true;
@@ -412,7 +473,14 @@ namespace Falcor
         mutable ProgramVersion::SharedConstPtr mpActiveVersion;
         void markDirty() { mLinkRequired = true; }
 
+        // State shared with background compilation tasks, guarded by mMutex.
+        // The version cache mProgramVersions and mFileTimeMap are also accessed under this lock.
+        mutable std::mutex mMutex;
+        mutable std::map<DefineList, std::shared_future<ProgramVersion::SharedConstPtr>> mPendingVersions;
+        mutable uint32_t mVersionGeneration = 0; ///< Incremented on reset, versions compiled for an older generation are discarded.
+
         std::string getProgramDescString() const;
+        static std::string getProgramDescString(const Desc& desc);
         static std::vector<std::weak_ptr<Program>> sProgramsForReload; // TODO: REMOVEGLOBAL
         static CompilationStats sCompilationStats; // TODO: REMOVEGLOBAL
 
@@ -203,13 +203,15 @@ namespace Falcor
         const DefineList&                                   defineList,
         const ProgramReflection::SharedPtr&                 pReflector,
         const std::string&                                  name,
-        std::vector<ComPtr<slang::IComponentType>> const&   pSlangEntryPoints)
+        std::vector<ComPtr<slang::IComponentType>> const&   pSlangEntryPoints,
+        const std::optional<ShaderCache::Key>&              shaderCacheKey)
     {
         FALCOR_ASSERT(pReflector);
         mDefines = defineList;
         mpReflector = pReflector;
         mName = name;
         mpSlangEntryPoints = pSlangEntryPoints;
+        mShaderCacheKey = shaderCacheKey;
     }
 
     ProgramVersion::SharedPtr ProgramVersion::createEmpty(Program* pProgram, slang::IComponentType* pSlangGlobalScope)
@@ -292,4 +294,10 @@ namespace Falcor
     {
         return mpSlangEntryPoints[index];
     }
+
+    std::unique_lock<std::recursive_mutex> ProgramVersion::lockSlangSession() const
+    {
+        if (!mpSlangSessionMutex) return {};
+        return std::unique_lock<std::recursive_mutex>(*mpSlangSessionMutex);
+    }
 }
@@ -27,10 +27,13 @@
  **************************************************************************/
 #pragma once
 #include "ProgramReflection.h"
+#include "ShaderCache.h"
 #include "Core/Macros.h"
 #include "Core/API/Shader.h"
 #include "Core/API/Handles.h"
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -248,6 +251,13 @@ namespace Falcor
         slang::IComponentType* getSlangGlobalScope() const;
         slang::IComponentType* getSlangEntryPoint(uint32_t index) const;
 
+        /** Lock the Slang global session this version was compiled with.
+            Versions compiled in the background use a global session that is shared with other background compilations.
+            All calls into the version's Slang session need to hold this lock.
+            \return Lock on the session, or an empty lock if the version was compiled using the main global session.
+        */
+        std::unique_lock<std::recursive_mutex> lockSlangSession() const;
+
     protected:
         friend class Program;
         friend class RtProgram;
@@ -260,7 +270,8 @@ namespace Falcor
             const DefineList&                                   defineList,
             const ProgramReflection::SharedPtr&                 pReflector,
             const std::string&                                  name,
-            std::vector<ComPtr<slang::IComponentType>> const&   pSlangEntryPoints);
+            std::vector<ComPtr<slang::IComponentType>> const&   pSlangEntryPoints,
+            const std::optional<ShaderCache::Key>&              shaderCacheKey);
 
         std::shared_ptr<Program>        mpProgram;
         DefineList                      mDefines;
@@ -268,6 +279,8 @@ namespace Falcor
         std::string                     mName;
         ComPtr<slang::IComponentType>   mpSlangGlobalScope;
         std::vector<ComPtr<slang::IComponentType>> mpSlangEntryPoints;
+        std::optional<ShaderCache::Key> mShaderCacheKey; ///< Shader cache key of the version, or empty if the kernels can't be cached.
+        std::shared_ptr<std::recursive_mutex> mpSlangSessionMutex; ///< Mutex of the Slang global session used for background compilation, or nullptr.
 
         // Cached version of compiled kernels for this program version
         mutable std::unordered_map<std::string, ProgramKernels::SharedPtr> mpKernels;
@@ -0,0 +1,377 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ShaderCache.h"
+#include "Core/Errors.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Specifies the current cache entry version.
+            This needs to be incremented every time the file format changes!
+        */
+        const uint32_t kVersion = 1;
+
+        /** Shader cache directory (subdirectory in the application data directory).
+        */
+        const std::string kDirectory = "NVIDIA/Falcor/ShaderCache";
+
+        const size_t kBlockSize = 1 * 1024 * 1024;
+
+        const char* kMagic = "FalcorK$";
+        struct Header
+        {
+            uint8_t magic[8]{};
+            uint32_t version{};
+            uint32_t reserved{};
+            ShaderCache::Key key{};
+            double compileTime{};
+            uint64_t dataSize{};
+
+            bool isValid(const ShaderCache::Key& expectedKey, uint64_t fileSize) const
+            {
+                return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion &&
+                    key == expectedKey && sizeof(Header) + dataSize == fileSize;
+            }
+        };
+
+        int64_t getCurrentFileTime()
+        {
+            return std::filesystem::file_time_type::clock::now().time_since_epoch().count();
+        }
+
+        /** Convert a key to the entry file name (40 hex digits).
+        */
+        std::string toKeyString(const ShaderCache::Key& key)
+        {
+            std::string str;
+            str.reserve(2 * key.size());
+            for (uint8_t c : key) str += fmt::format("{:02x}", c);
+            return str;
+        }
+
+        /** Check if a file name is a key string (40 hex digits).
+        */
+        bool isKeyString(const std::string& name)
+        {
+            return name.size() == 2 * sizeof(ShaderCache::Key) && std::all_of(name.begin(), name.end(), [](char c) { return std::isxdigit((unsigned char)c) != 0; });
+        }
+
+        struct FileHashEntry
+        {
+            uint64_t size;
+            int64_t lastWriteTime;
+            SHA1::MD hash;
+        };
+
+        std::mutex sFileHashMutex;
+        std::unordered_map<std::string, FileHashEntry> sFileHashes; // TODO: REMOVEGLOBAL
+    }
+
+    ShaderCache::SharedPtr ShaderCache::create(const std::filesystem::path& directory, uint64_t maxSize)
+    {
+        return SharedPtr(new ShaderCache(directory, maxSize));
+    }
+
+    std::filesystem::path ShaderCache::getDefaultDirectory()
+    {
+        return getAppDataDirectory() / kDirectory;
+    }
+
+    ShaderCache::ShaderCache(const std::filesystem::path& directory, uint64_t maxSize)
+        : mDirectory(directory)
+        , mMaxSize(maxSize)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(mDirectory, ec);
+        if (ec) throw RuntimeError("Failed to create shader cache directory '{}'.", mDirectory);
+
+        // Index existing entries. The modification time of the files reflects their last use.
+        for (const auto& it : std::filesystem::directory_iterator(mDirectory, ec))
+        {
+            if (!it.is_regular_file(ec)) continue;
+            auto name = it.path().filename().string();
+            if (!isKeyString(name)) continue;
+
+            Entry entry;
+            entry.size = it.file_size(ec);
+            if (ec) continue;
+            entry.lastUse = it.last_write_time(ec).time_since_epoch().count();
+            if (ec) continue;
+
+            mEntries[name] = entry;
+            mSize += entry.size;
+            mLastUseTime = std::max(mLastUseTime, entry.lastUse);
+        }
+
+        evict();
+
+        logInfo("Shader cache '{}' has {} entries ({:.1f} MB).", mDirectory, mEntries.size(), mSize / (1024.0 * 1024.0));
+    }
+
+    std::optional<std::vector<uint8_t>> ShaderCache::get(const Key& key)
+    {
+        const std::string name = toKeyString(key);
+
+        // Always look for the entry file, even if it is not in the index.
+        // Other processes sharing the cache directory may have added it after the index was built.
+        auto path = getEntryPath(name);
+        std::optional<std::vector<uint8_t>> data;
+        uint64_t fileSize = 0;
+        Header header;
+        {
+            std::ifstream fs(path, std::ios_base::binary | std::ios_base::ate);
+            if (fs.good())
+            {
+                fileSize = (uint64_t)fs.tellg();
+                fs.seekg(0);
+                fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+                if (fs.good() && header.isValid(key, fileSize))
+                {
+                    data = std::vector<uint8_t>(header.dataSize);
+                    fs.read(reinterpret_cast<char*>(data->data()), data->size());
+                    if (!fs.good()) data.reset();
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mEntries.find(name);
+        if (!data)
+        {
+            // The entry doesn't exist, is corrupt or was removed by another process.
+            if (it != mEntries.end())
+            {
+                mSize -= it->second.size;
+                mEntries.erase(it);
+            }
+            if (fileSize > 0)
+            {
+                std::error_code ec;
+                std::filesystem::remove(path, ec);
+            }
+            mStats.missCount++;
+            return {};
+        }
+
+        // Mark the entry as used, also on disk for other processes.
+        int64_t now = nextUseTime();
+        if (it == mEntries.end())
+        {
+            // Entry written by another process, add it to the index.
+            auto& entry = mEntries[name];
+            entry.size = fileSize;
+            entry.lastUse = now;
+            mSize += entry.size;
+        }
+        else
+        {
+            it->second.lastUse = now;
+        }
+        std::error_code ec;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type(std::filesystem::file_time_type::duration(now)), ec);
+
+        mStats.hitCount++;
+        mStats.timeSaved += header.compileTime;
+        evict();
+        return data;
+    }
+
+    void ShaderCache::put(const Key& key, const void* pData, size_t size, double compileTime)
+    {
+        FALCOR_ASSERT(pData || size == 0);
+        const std::string name = toKeyString(key);
+        const auto path = getEntryPath(name);
+
+        // Write to a uniquely named temporary file first and rename it, so that readers never see partial entries.
+        static std::atomic<uint64_t> sTempCounter{ std::random_device()() };
+        const auto tempPath = getEntryPath(fmt::format("{}.{:x}.tmp", name, sTempCounter++));
+
+        Header header;
+        std::memcpy(header.magic, kMagic, sizeof(Header::magic));
+        header.version = kVersion;
+        header.key = key;
+        header.compileTime = compileTime;
+        header.dataSize = size;
+
+        {
+            std::ofstream fs(tempPath, std::ios_base::binary);
+            fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            fs.write(reinterpret_cast<const char*>(pData), size);
+            if (!fs.good())
+            {
+                logWarning("Failed to write shader cache entry '{}'.", tempPath);
+                fs.close();
+                std::error_code ec;
+                std::filesystem::remove(tempPath, ec);
+                return;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec)
+        {
+            logWarning("Failed to write shader cache entry '{}': {}", path, ec.message());
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto& entry = mEntries[name];
+        mSize -= entry.size;
+        entry.size = sizeof(Header) + size;
+        entry.lastUse = nextUseTime();
+        mSize += entry.size;
+
+        evict();
+    }
+
+    void ShaderCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (const auto& [name, entry] : mEntries)
+        {
+            std::error_code ec;
+            std::filesystem::remove(getEntryPath(name), ec);
+        }
+        mEntries.clear();
+        mSize = 0;
+    }
+
+    void ShaderCache::setMaxSize(uint64_t maxSize)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mMaxSize = maxSize;
+        evict();
+    }
+
+    uint64_t ShaderCache::getMaxSize() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mMaxSize;
+    }
+
+    uint64_t ShaderCache::getSize() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mSize;
+    }
+
+    size_t ShaderCache::getEntryCount() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mEntries.size();
+    }
+
+    ShaderCache::Stats ShaderCache::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mStats;
+    }
+
+    void ShaderCache::resetStats()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStats = {};
+    }
+
+    std::optional<SHA1::MD> ShaderCache::getFileHash(const std::filesystem::path& path)
+    {
+        std::error_code ec;
+        uint64_t size = std::filesystem::file_size(path, ec);
+        if (ec) return {};
+        int64_t lastWriteTime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        if (ec) return {};
+
+        const std::string key = path.string();
+        {
+            std::lock_guard<std::mutex> lock(sFileHashMutex);
+            auto it = sFileHashes.find(key);
+            if (it != sFileHashes.end() && it->second.size == size && it->second.lastWriteTime == lastWriteTime) return it->second.hash;
+        }
+
+        std::ifstream fs(path, std::ios_base::binary);
+        if (!fs.good()) return {};
+
+        SHA1 sha1;
+        std::vector<char> buffer(kBlockSize);
+        while (fs)
+        {
+            fs.read(buffer.data(), buffer.size());
+            sha1.update(buffer.data(), (size_t)fs.gcount());
+        }
+        SHA1::MD hash = sha1.finalize();
+
+        std::lock_guard<std::mutex> lock(sFileHashMutex);
+        sFileHashes[key] = { size, lastWriteTime, hash };
+        return hash;
+    }
+
+    int64_t ShaderCache::nextUseTime()
+    {
+        // Keep use times strictly increasing so that the LRU order is well defined within a process.
+        mLastUseTime = std::max(getCurrentFileTime(), mLastUseTime + 1);
+        return mLastUseTime;
+    }
+
+    std::filesystem::path ShaderCache::getEntryPath(const std::string& name) const
+    {
+        return mDirectory / name;
+    }
+
+    void ShaderCache::evict()
+    {
+        if (mSize <= mMaxSize) return;
+
+        // Remove the least recently used entries until the cache fits.
+        std::vector<std::pair<int64_t, std::string>> order;
+        order.reserve(mEntries.size());
+        for (const auto& [name, entry] : mEntries) order.emplace_back(entry.lastUse, name);
+        std::sort(order.begin(), order.end());
+
+        for (const auto& [lastUse, name] : order)
+        {
+            if (mSize <= mMaxSize) break;
+            auto it = mEntries.find(name);
+            std::error_code ec;
+            std::filesystem::remove(getEntryPath(name), ec);
+            mSize -= it->second.size;
+            mEntries.erase(it);
+            mStats.evictionCount++;
+        }
+    }
+}
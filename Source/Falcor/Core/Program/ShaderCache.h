@@ -0,0 +1,151 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/CryptoUtils.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Falcor
+{
+    /** Persistent on-disk cache of compiled shader kernels.
+
+        Each kernel is stored in a separate file named by its key. The key is computed by the caller from everything
+        that affects code generation (source closure, defines, type conformances, specialization arguments, compiler
+        flags, shader model and compiler version), so entries never need to be invalidated, only evicted.
+
+        The total size of the cache is bounded. When it is exceeded, the least recently used entries are evicted.
+        Cache hits update the modification time of the entry file so that the usage order persists across processes.
+        Entries are written to a temporary file first and then renamed, so that multiple processes can share the same
+        cache directory. All functions are thread-safe.
+        The cache is only used with the D3D12 backend, see Program::getShaderCache().
+    */
+    class FALCOR_API ShaderCache
+    {
+    public:
+        using SharedPtr = std::shared_ptr<ShaderCache>;
+        using Key = SHA1::MD;
+
+        static constexpr uint64_t kDefaultMaxSize = 1ull << 30;
+
+        /** Cache statistics.
+        */
+        struct Stats
+        {
+            uint64_t hitCount = 0;          ///< Number of lookups that found a kernel.
+            uint64_t missCount = 0;         ///< Number of lookups that did not find a kernel.
+            uint64_t evictionCount = 0;     ///< Number of evicted entries.
+            double timeSaved = 0.0;         ///< Total compile time of the kernels found in the cache in seconds.
+        };
+
+        /** Create a shader cache.
+            Existing entries in the directory are indexed. If they exceed the size limit, the least recently used ones are evicted.
+            \param[in] directory Cache directory. Created if it does not exist.
+            \param[in] maxSize Maximum total size of the cached kernels in bytes.
+            \return A new object.
+        */
+        static SharedPtr create(const std::filesystem::path& directory, uint64_t maxSize = kDefaultMaxSize);
+
+        /** Get the default cache directory (subdirectory in the application data directory).
+        */
+        static std::filesystem::path getDefaultDirectory();
+
+        /** Look up a kernel.
+            The entry file is looked up on disk, so entries written by other processes after this cache was created are found too.
+            \param[in] key Cache key.
+            \return Returns the kernel code, or an empty optional if not cached.
+        */
+        std::optional<std::vector<uint8_t>> get(const Key& key);
+
+        /** Store a kernel.
+            \param[in] key Cache key.
+            \param[in] pData Kernel code.
+            \param[in] size Size of the kernel code in bytes.
+            \param[in] compileTime Time it took to compile the kernel in seconds. This is reported as time saved on cache hits.
+        */
+        void put(const Key& key, const void* pData, size_t size, double compileTime);
+
+        /** Remove all entries.
+        */
+        void clear();
+
+        /** Set the maximum total size of the cached kernels. Evicts entries if the new limit is exceeded.
+        */
+        void setMaxSize(uint64_t maxSize);
+
+        uint64_t getMaxSize() const;
+
+        /** Get the total size of the cached kernels in bytes.
+        */
+        uint64_t getSize() const;
+
+        /** Get the number of cached kernels.
+        */
+        size_t getEntryCount() const;
+
+        const std::filesystem::path& getDirectory() const { return mDirectory; }
+
+        Stats getStats() const;
+        void resetStats();
+
+        /** Compute the SHA-1 hash of a file's contents.
+            Hashes are memoized by path, size and modification time, as the same shader headers are part of the source
+            closure of almost every program.
+            \param[in] path File path.
+            \return Returns the hash, or an empty optional if the file can't be read.
+        */
+        static std::optional<SHA1::MD> getFileHash(const std::filesystem::path& path);
+
+    private:
+        ShaderCache(const std::filesystem::path& directory, uint64_t maxSize);
+
+        struct Entry
+        {
+            uint64_t size = 0;          ///< Size of the entry file in bytes.
+            int64_t lastUse = 0;        ///< Last use time (in file clock ticks).
+        };
+
+        int64_t nextUseTime();
+        std::filesystem::path getEntryPath(const std::string& name) const;
+        void evict();
+
+        std::filesystem::path mDirectory;
+        uint64_t mMaxSize;
+        uint64_t mSize = 0;
+        int64_t mLastUseTime = 0;
+        std::unordered_map<std::string, Entry> mEntries; ///< Entries indexed by key string.
+        Stats mStats;
+        mutable std::mutex mMutex;
+    };
+}
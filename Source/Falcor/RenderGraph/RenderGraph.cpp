@@ -31,6 +31,7 @@
 #include "RenderPassLibrary.h"
 #include "RenderGraphCompiler.h"
 #include "Core/API/Device.h"
+#include "Utils/StringUtils.h"
 #include "Utils/Algorithm/DirectedGraphTraversal.h"
 #include "Utils/Scripting/Scripting.h"
 #include "Utils/Scripting/ScriptBindings.h"
@@ -728,7 +729,13 @@ namespace Falcor
 
     void RenderGraph::renderUI(Gui::Widgets& widget)
     {
-        if (mpExe) mpExe->renderUI(widget);
+        if (mpExe)
+        {
+            const auto& stats = mpExe->getResourceStats();
+            widget.text(fmt::format("Resources: {} fields in {} resources, {} of {} saved by aliasing",
+                stats.fieldCount, stats.resourceCount, formatByteSize(stats.getBytesSaved()), formatByteSize(stats.naiveSize)));
+            mpExe->renderUI(widget);
+        }
     }
 
     void RenderGraph::onSceneUpdates(RenderContext* pRenderContext, Scene::UpdateFlags sceneUpdates)
@@ -89,6 +89,10 @@ namespace Falcor
         */
         void setInput(const std::string& name, const Resource::SharedPtr& pResource);
 
+        /** Get statistics of the resources allocated for the graph.
+        */
+        const ResourceCache::Stats& getResourceStats() const { return mpResourceCache->getStats(); }
+
     private:
         friend class RenderGraphCompiler;
         static SharedPtr create() { return SharedPtr(new RenderGraphExe); }
@@ -26,9 +26,12 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "ResourceCache.h"
+#include "TransientResourcePlanner.h"
 #include "Core/API/Texture.h"
 #include "Core/API/Buffer.h"
 #include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
+#include <algorithm>
 
 namespace Falcor
 {
@@ -41,6 +44,7 @@ namespace Falcor
     {
         mNameToIndex.clear();
         mResourceData.clear();
+        mStats = {};
     }
 
     const Resource::SharedPtr& ResourceCache::getResource(const std::string& name) const
@@ -103,7 +107,8 @@ namespace Falcor
             FALCOR_ASSERT(mNameToIndex.count(name) == 0);
             mNameToIndex[name] = (uint32_t)mResourceData.size();
             bool resolveBindFlags = (field.getBindFlags() == ResourceBindFlags::None);
-            mResourceData.push_back({ field, {timePoint, timePoint}, nullptr, resolveBindFlags, name });
+            bool persistent = is_set(field.getFlags(), RenderPassReflection::Field::Flags::Persistent);
+            mResourceData.push_back({ field, {timePoint, timePoint}, nullptr, resolveBindFlags, name, persistent });
         }
         else // Add alias
         {
@@ -113,81 +118,190 @@ namespace Falcor
             mergeTimePoint(mResourceData[index].lifetime, timePoint);
             mResourceData[index].pResource = nullptr;
             mResourceData[index].resolveBindFlags = mResourceData[index].resolveBindFlags || (field.getBindFlags() == ResourceBindFlags::None);
+            mResourceData[index].persistent = mResourceData[index].persistent || is_set(field.getFlags(), RenderPassReflection::Field::Flags::Persistent);
         }
     }
 
-    Resource::SharedPtr createResourceForPass(const ResourceCache::DefaultProperties& params, const RenderPassReflection::Field& field, bool resolveBindFlags, const std::string& resourceName)
+    namespace
     {
-        uint32_t width = field.getWidth() ? field.getWidth() : params.dims.x;
-        uint32_t height = field.getHeight() ? field.getHeight() : params.dims.y;
-        uint32_t depth = field.getDepth() ? field.getDepth() : 1;
-        uint32_t sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
-        auto bindFlags = field.getBindFlags();
-        auto arraySize = field.getArraySize();
-        auto mipLevels = field.getMipCount();
+        /** Fully resolved properties of a resource to create for a field.
+        */
+        struct ResourceDesc
+        {
+            RenderPassReflection::Field::Type type;
+            uint32_t width;
+            uint32_t height;
+            uint32_t depth;
+            uint32_t sampleCount;
+            uint32_t arraySize;
+            uint32_t mipLevels;
+            ResourceFormat format;
+            ResourceBindFlags bindFlags;
 
-        ResourceFormat format = ResourceFormat::Unknown;
+            bool operator==(const ResourceDesc& other) const
+            {
+                return type == other.type && width == other.width && height == other.height && depth == other.depth &&
+                    sampleCount == other.sampleCount && arraySize == other.arraySize && mipLevels == other.mipLevels &&
+                    format == other.format && bindFlags == other.bindFlags;
+            }
+        };
 
-        if (field.getType() != RenderPassReflection::Field::Type::RawBuffer)
+        ResourceDesc resolveResourceDesc(const ResourceCache::DefaultProperties& params, const RenderPassReflection::Field& field, bool resolveBindFlags)
         {
-            format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
-            if (resolveBindFlags)
+            ResourceDesc desc;
+            desc.type = field.getType();
+            desc.width = field.getWidth() ? field.getWidth() : params.dims.x;
+            desc.height = field.getHeight() ? field.getHeight() : params.dims.y;
+            desc.depth = field.getDepth() ? field.getDepth() : 1;
+            desc.sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
+            desc.arraySize = field.getArraySize();
+            desc.mipLevels = field.getMipCount();
+            desc.format = ResourceFormat::Unknown;
+            desc.bindFlags = field.getBindFlags();
+
+            if (field.getType() != RenderPassReflection::Field::Type::RawBuffer)
             {
-                ResourceBindFlags mask = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
-                bool isOutput = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Output);
-                bool isInternal = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Internal);
-                if (isOutput || isInternal) mask |= Resource::BindFlags::DepthStencil | Resource::BindFlags::RenderTarget;
-                auto supported = getFormatBindFlags(format);
-                mask &= supported;
-                bindFlags |= mask;
+                desc.format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
+                if (resolveBindFlags)
+                {
+                    ResourceBindFlags mask = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
+                    bool isOutput = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Output);
+                    bool isInternal = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Internal);
+                    if (isOutput || isInternal) mask |= Resource::BindFlags::DepthStencil | Resource::BindFlags::RenderTarget;
+                    auto supported = getFormatBindFlags(desc.format);
+                    mask &= supported;
+                    desc.bindFlags |= mask;
+                }
             }
+            else // RawBuffer
+            {
+                if (resolveBindFlags) desc.bindFlags = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
+            }
+            return desc;
         }
-        else // RawBuffer
-        {
-            if (resolveBindFlags) bindFlags = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
-        }
-        Resource::SharedPtr pResource;
 
-        switch (field.getType())
+        /** Estimate the memory size of a resource, ignoring alignment and padding.
+        */
+        uint64_t estimateResourceSize(const ResourceDesc& desc)
         {
-        case RenderPassReflection::Field::Type::RawBuffer:
-            pResource = Buffer::create(width, bindFlags, Buffer::CpuAccess::None);
-            break;
-        case RenderPassReflection::Field::Type::Texture1D:
-            pResource = Texture::create1D(width, format, arraySize, mipLevels, nullptr, bindFlags);
-            break;
-        case RenderPassReflection::Field::Type::Texture2D:
-            if (sampleCount > 1)
+            if (desc.type == RenderPassReflection::Field::Type::RawBuffer) return desc.width;
+
+            uint32_t width = desc.width;
+            uint32_t height = desc.type == RenderPassReflection::Field::Type::Texture1D ? 1 : desc.height;
+            uint32_t depth = desc.type == RenderPassReflection::Field::Type::Texture3D ? desc.depth : 1;
+            uint32_t arraySize = desc.type == RenderPassReflection::Field::Type::Texture3D ? 1 : desc.arraySize;
+            if (desc.type == RenderPassReflection::Field::Type::TextureCube) arraySize *= 6;
+
+            uint32_t widthRatio = getFormatWidthCompressionRatio(desc.format);
+            uint32_t heightRatio = getFormatHeightCompressionRatio(desc.format);
+            uint64_t bytesPerBlock = getFormatBytesPerBlock(desc.format);
+
+            // Sum over the mip chain. A mip count of kMaxPossible means the full chain.
+            uint64_t size = 0;
+            for (uint32_t mip = 0; mip < desc.mipLevels; mip++)
             {
-                pResource = Texture::create2DMS(width, height, format, sampleCount, arraySize, bindFlags);
+                uint64_t blocksX = (width + widthRatio - 1) / widthRatio;
+                uint64_t blocksY = (height + heightRatio - 1) / heightRatio;
+                size += blocksX * blocksY * depth * bytesPerBlock;
+                if (width == 1 && height == 1 && depth == 1) break;
+                width = std::max(width / 2, 1u);
+                height = std::max(height / 2, 1u);
+                depth = std::max(depth / 2, 1u);
             }
-            else
+            return size * arraySize * desc.sampleCount;
+        }
+
+        Resource::SharedPtr createResource(const ResourceDesc& desc, const std::string& resourceName)
+        {
+            Resource::SharedPtr pResource;
+
+            switch (desc.type)
             {
-                pResource = Texture::create2D(width, height, format, arraySize, mipLevels, nullptr, bindFlags);
+            case RenderPassReflection::Field::Type::RawBuffer:
+                pResource = Buffer::create(desc.width, desc.bindFlags, Buffer::CpuAccess::None);
+                break;
+            case RenderPassReflection::Field::Type::Texture1D:
+                pResource = Texture::create1D(desc.width, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
+                break;
+            case RenderPassReflection::Field::Type::Texture2D:
+                if (desc.sampleCount > 1)
+                {
+                    pResource = Texture::create2DMS(desc.width, desc.height, desc.format, desc.sampleCount, desc.arraySize, desc.bindFlags);
+                }
+                else
+                {
+                    pResource = Texture::create2D(desc.width, desc.height, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
+                }
+                break;
+            case RenderPassReflection::Field::Type::Texture3D:
+                pResource = Texture::create3D(desc.width, desc.height, desc.depth, desc.format, desc.mipLevels, nullptr, desc.bindFlags);
+                break;
+            case RenderPassReflection::Field::Type::TextureCube:
+                pResource = Texture::createCube(desc.width, desc.height, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
+                break;
+            default:
+                FALCOR_UNREACHABLE();
+                return nullptr;
             }
-            break;
-        case RenderPassReflection::Field::Type::Texture3D:
-            pResource = Texture::create3D(width, height, depth, format, mipLevels, nullptr, bindFlags);
-            break;
-        case RenderPassReflection::Field::Type::TextureCube:
-            pResource = Texture::createCube(width, height, format, arraySize, mipLevels, nullptr, bindFlags);
-            break;
-        default:
-            FALCOR_UNREACHABLE();
-            return nullptr;
+            pResource->setName(resourceName);
+            return pResource;
         }
-        pResource->setName(resourceName);
-        return pResource;
     }
 
     void ResourceCache::allocateResources(const DefaultProperties& params)
     {
-        for (auto& data : mResourceData)
+        // Describe the fields that need a resource. Fields with identical resource properties get the same key.
+        std::vector<uint32_t> dataIndices;
+        std::vector<ResourceDesc> descs;
+        std::vector<ResourceDesc> uniqueDescs;
+        std::vector<TransientResourcePlanner::Request> requests;
+
+        for (uint32_t i = 0; i < (uint32_t)mResourceData.size(); i++)
         {
-            if ((data.pResource == nullptr) && (data.field.isValid()))
-            {
-                data.pResource = createResourceForPass(params, data.field, data.resolveBindFlags, data.name);
-            }
+            const auto& data = mResourceData[i];
+            if ((data.pResource != nullptr) || (data.field.isValid() == false)) continue;
+
+            ResourceDesc desc = resolveResourceDesc(params, data.field, data.resolveBindFlags);
+            auto it = std::find(uniqueDescs.begin(), uniqueDescs.end(), desc);
+            if (it == uniqueDescs.end()) it = uniqueDescs.insert(uniqueDescs.end(), desc);
+
+            // Graph outputs have their lifetime extended to the end of the graph.
+            bool graphOutput = data.lifetime.second == uint32_t(-1);
+            bool internal = is_set(data.field.getVisibility(), RenderPassReflection::Field::Visibility::Internal);
+
+            TransientResourcePlanner::Request request;
+            request.key = (uint64_t)(it - uniqueDescs.begin());
+            request.size = estimateResourceSize(desc);
+            request.firstUse = data.lifetime.first;
+            request.lastUse = data.lifetime.second;
+            request.transient = !(graphOutput || internal || data.persistent);
+
+            dataIndices.push_back(i);
+            descs.push_back(desc);
+            requests.push_back(request);
+        }
+
+        auto plan = TransientResourcePlanner::plan(requests);
+
+        // Create one resource per allocation and assign it to all fields using it.
+        std::vector<Resource::SharedPtr> resources(plan.getAllocationCount());
+        for (size_t r = 0; r < requests.size(); r++)
+        {
+            auto& data = mResourceData[dataIndices[r]];
+            auto& pResource = resources[plan.allocationIndex[r]];
+            if (pResource == nullptr) pResource = createResource(descs[r], data.name);
+            data.pResource = pResource;
+        }
+
+        mStats.fieldCount += (uint32_t)requests.size();
+        mStats.resourceCount += plan.getAllocationCount();
+        mStats.naiveSize += plan.naiveSize;
+        mStats.allocatedSize += plan.allocatedSize;
+
+        if (plan.getBytesSaved() > 0)
+        {
+            logInfo("ResourceCache: {} fields share {} resources, saving {} of {}.",
+                requests.size(), plan.getAllocationCount(), formatByteSize(plan.getBytesSaved()), formatByteSize(plan.naiveSize));
         }
     }
 }
@@ -55,6 +55,19 @@ namespace Falcor
             ResourceFormat format = ResourceFormat::Unknown;    ///< Format to use for texture creation
         };
 
+        /** Statistics of the resources allocated by the cache.
+            Sizes are estimated from the resource descriptions and don't include alignment and padding.
+        */
+        struct Stats
+        {
+            uint32_t fieldCount = 0;        ///< Number of distinct fields that required a resource.
+            uint32_t resourceCount = 0;     ///< Number of resources allocated for these fields.
+            uint64_t naiveSize = 0;         ///< Size in bytes if every field had its own resource.
+            uint64_t allocatedSize = 0;     ///< Size in bytes of the allocated resources.
+
+            uint64_t getBytesSaved() const { return naiveSize - allocatedSize; }
+        };
+
         /** Add/Remove reference to a graph input resource not owned by the cache
             \param[in] name The resource's name
             \param[in] pResource The resource to register. If this is null, will unregister the resource
@@ -80,9 +93,17 @@ namespace Falcor
 
         /** Allocate all resources that need to be created/updated.
             This includes new resources, resources whose properties have been updated since last allocation call.
+            Transient fields with identical resource properties and non-overlapping lifetimes share a resource.
+            Fields are transient unless they are graph outputs, internal to a pass or flagged as persistent.
         */
         void allocateResources(const DefaultProperties& params);
 
+        /** Get statistics of the resources allocated since the last reset().
+            allocateResources() only creates resources for fields that don't have one yet, so the statistics
+            of each call are accumulated to cover all resources held by the cache.
+        */
+        const Stats& getStats() const { return mStats; }
+
         /** Clears all registered field/resource properties and allocated resources.
         */
         void reset();
@@ -97,6 +118,7 @@ namespace Falcor
             Resource::SharedPtr pResource;          // The resource
             bool resolveBindFlags;                  // Whether or not we should resolve the field's bind-flags before creating the resource
             std::string name;                       // Full name of the resource, including the pass name
+            bool persistent;                        // Whether or not any of the aliased fields is flagged as persistent
         };
 
         // Resources and properties for fields within (and therefore owned by) a render graph
@@ -105,6 +127,8 @@ namespace Falcor
 
         // References to output resources not to be allocated by the render graph
         ResourcesMap mExternalResources;
+
+        Stats mStats;
     };
 
 }
@@ -0,0 +1,115 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TransientResourcePlanner.h"
+#include "Core/Errors.h"
+#include <algorithm>
+#include <numeric>
+
+namespace Falcor
+{
+    namespace
+    {
+        struct Allocation
+        {
+            uint64_t key;
+            uint64_t size;
+            uint32_t lastUse;
+            bool transient;
+        };
+    }
+
+    TransientResourcePlanner::Plan TransientResourcePlanner::plan(const std::vector<Request>& requests)
+    {
+        for (const auto& r : requests)
+        {
+            checkArgument(r.firstUse <= r.lastUse, "Request lifetime [{}, {}] is invalid.", r.firstUse, r.lastUse);
+        }
+
+        // Process requests in order of first use. Larger requests go first to make them the base of shared allocations.
+        std::vector<uint32_t> order(requests.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+        {
+            if (requests[a].firstUse != requests[b].firstUse) return requests[a].firstUse < requests[b].firstUse;
+            return requests[a].size > requests[b].size;
+        });
+
+        Plan plan;
+        plan.allocationIndex.resize(requests.size());
+        std::vector<Allocation> allocations;
+
+        for (uint32_t i : order)
+        {
+            const Request& r = requests[i];
+            plan.naiveSize += r.size;
+
+            // Find the best fitting free allocation. Prefer the smallest allocation that fits the request,
+            // otherwise the largest one, which needs to grow the least.
+            uint32_t best = uint32_t(-1);
+            if (r.transient)
+            {
+                for (uint32_t a = 0; a < (uint32_t)allocations.size(); a++)
+                {
+                    const Allocation& alloc = allocations[a];
+                    if (!alloc.transient || alloc.key != r.key || alloc.lastUse >= r.firstUse) continue;
+                    if (best == uint32_t(-1))
+                    {
+                        best = a;
+                        continue;
+                    }
+                    uint64_t bestSize = allocations[best].size;
+                    bool fits = alloc.size >= r.size;
+                    bool bestFits = bestSize >= r.size;
+                    if (fits ? (!bestFits || alloc.size < bestSize) : (!bestFits && alloc.size > bestSize)) best = a;
+                }
+            }
+
+            if (best == uint32_t(-1))
+            {
+                best = (uint32_t)allocations.size();
+                allocations.push_back({ r.key, r.size, r.lastUse, r.transient });
+            }
+            else
+            {
+                Allocation& alloc = allocations[best];
+                alloc.size = std::max(alloc.size, r.size);
+                alloc.lastUse = r.lastUse;
+            }
+            plan.allocationIndex[i] = best;
+        }
+
+        plan.allocationSize.reserve(allocations.size());
+        for (const auto& alloc : allocations)
+        {
+            plan.allocationSize.push_back(alloc.size);
+            plan.allocatedSize += alloc.size;
+        }
+
+        return plan;
+    }
+}
@@ -0,0 +1,74 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Plans memory sharing between transient render graph resources.
+
+        Each request describes a resource by its size and the range of execution order indices in which it is used.
+        Requests that are transient, have the same compatibility key and whose lifetimes don't overlap are assigned
+        to the same allocation. This is an interval colouring problem, which is solved greedily by processing the
+        requests in order of first use and reusing the best fitting allocation that has become free.
+        For requests of equal size and key, this results in the minimal number of allocations.
+
+        The planner is independent of the graphics API, so it can be tested on the CPU.
+    */
+    class FALCOR_API TransientResourcePlanner
+    {
+    public:
+        struct Request
+        {
+            uint64_t key = 0;           ///< Compatibility key. Only requests with the same key can share an allocation.
+            uint64_t size = 0;          ///< Size in bytes.
+            uint32_t firstUse = 0;      ///< First execution order index in which the resource is used.
+            uint32_t lastUse = 0;       ///< Last execution order index in which the resource is used (inclusive).
+            bool transient = true;      ///< If false, the request always gets an allocation of its own.
+        };
+
+        struct Plan
+        {
+            std::vector<uint32_t> allocationIndex;  ///< Index of the allocation used by each request.
+            std::vector<uint64_t> allocationSize;   ///< Size in bytes of each allocation.
+            uint64_t naiveSize = 0;                 ///< Total size in bytes if every request had its own allocation.
+            uint64_t allocatedSize = 0;             ///< Total size in bytes of all allocations.
+
+            uint32_t getAllocationCount() const { return (uint32_t)allocationSize.size(); }
+            uint64_t getBytesSaved() const { return naiveSize - allocatedSize; }
+        };
+
+        /** Assign allocations to a list of requests.
+            \param[in] requests List of requests.
+            \return The allocation plan. Throws an ArgumentError if a request has an invalid lifetime.
+        */
+        static Plan plan(const std::vector<Request>& requests);
+    };
+}
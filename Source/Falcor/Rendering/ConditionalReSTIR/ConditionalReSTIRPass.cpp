@@ -75,7 +75,6 @@ namespace Falcor
             pPass = ComputePass::create(desc, defines, false);
         }
         pPass->getProgram()->addDefines(defines);
-        pPass->setVars(nullptr);
     }
 
 
@@ -377,6 +376,7 @@ namespace Falcor
             baseDesc.addTypeConformances(typeConformances);
             baseDesc.setShaderModel(kShaderModel);
             createComputePass(mpReflectTypes, kReflectTypesFile, defines, baseDesc);
+            mpReflectTypes->setVars(nullptr);
         }
 
         createOrDestroyBuffer(mpReservoirs, "pathReservoirs", elementCount);
@@ -464,6 +464,22 @@ namespace Falcor
          createComputePass(mpSuffixRetraceTalbot, kSuffixRetraceTalbotFile, defines, baseDesc);
          createComputePass(mpSuffixProduceRetraceTalbotWorkload, kSuffixProduceRetraceTalbotWorkload, defines, baseDesc);
 
+         // Compile the programs of all passes in parallel before creating their vars, if supported by the backend.
+         // Creating the vars waits for the background compilation of the program. Otherwise they are compiled one by one.
+         const std::vector<ComputePass::SharedPtr> passes =
+         {
+             mpReflectTypes, mpPrefixResampling, mpTraceNewSuffixes, mpTraceNewPrefixes, mpPrefixNeighborSearch,
+             mpSuffixSpatialResampling, mpSuffixTemporalResampling, mpSuffixResampling, mpPrefixRetrace, mpPrefixProduceRetraceWorkload,
+             mpSuffixRetrace, mpSuffixProduceRetraceWorkload, mpSuffixRetraceTalbot, mpSuffixProduceRetraceTalbotWorkload
+         };
+         if (Program::isBackgroundCompilationSupported())
+         {
+             std::vector<Program::SharedPtr> programs;
+             for (const auto& pPass : passes) programs.push_back(pPass->getProgram());
+             Program::compileVersionsAsync(programs);
+         }
+         for (const auto& pPass : passes) pPass->setVars(nullptr);
+
          mRecompile = false;
          mResetTemporalReservoirs = true;
     }
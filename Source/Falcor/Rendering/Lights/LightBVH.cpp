@@ -132,6 +132,9 @@ namespace Falcor
         mNodes.clear();
         mNodeIndices.clear();
         mPerDepthRefitEntryInfo.clear();
+        mTriangleIndices.clear();
+        mTriangleBitmasks.clear();
+        mNodeSplitQuality.clear();
         mMaxTriangleCountPerLeaf = 0;
         mBVHStats = BVHStats();
         mIsValid = false;
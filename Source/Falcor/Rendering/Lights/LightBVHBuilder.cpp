@@ -29,9 +29,11 @@
 #include "Core/Assert.h"
 #include "Core/Errors.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/Profiler.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include <algorithm>
+#include <numeric>
 
 namespace
 {
@@ -45,6 +47,21 @@ namespace
     const uint32_t kMaxLeafTriangleCount = 1 << PackedNode::kTriangleCountBits;
     const uint32_t kMaxLeafTriangleOffset = 1 << PackedNode::kTriangleOffsetBits;
 
+    // Minimum number of triangles in a node for building its subtrees in parallel.
+    const uint32_t kMinParallelBuildTriangleCount = 4096;
+
+    // Minimum number of triangles in a node for evaluating the split along each axis in parallel.
+    const uint32_t kMinParallelSplitTriangleCount = 16384;
+
+    /** Calls func(i) for all i in [0, count), on the thread pool if 'parallel' is set and on the calling thread otherwise.
+    */
+    template<typename Func>
+    void parallelForIf(bool parallel, size_t count, Func&& func, size_t grainSize = 0)
+    {
+        if (parallel) Threading::parallelFor(0, count, std::forward<Func>(func), grainSize);
+        else for (size_t i = 0; i < count; ++i) func(i);
+    }
+
     inline float safeACos(float v)
     {
         return std::acos(glm::clamp(v, -1.0f, 1.0f));
@@ -241,37 +258,77 @@ namespace Falcor
         bvh.clear();
         FALCOR_ASSERT(!bvh.isValid() && bvh.mNodes.empty());
 
+        mUpdateStats = UpdateStats();
+        mUpdateStats.fullRebuild = true;
+
         // Get global list of emissive triangles.
         FALCOR_ASSERT(bvh.mpLightCollection);
         const auto& triangles = bvh.mpLightCollection->getMeshLightTriangles();
-        if (triangles.empty()) return;
+
+        BuildingData data(bvh.mNodes);
+        if (!buildNodes(triangles, data)) return;
+
+        // Compute the split quality of all nodes as reference for incremental updates.
+        if (mOptions.allowIncrementalUpdates) computeNodeSplitQuality(data, bvh.mNodeSplitQuality);
+
+        // The BVH is ready, mark it as valid and upload the data.
+        bvh.mIsValid = true;
+        bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
+        bvh.uploadCPUBuffers(data.triangleIndices, data.triangleBitmasks);
+        bvh.mTriangleIndices = std::move(data.triangleIndices);
+        bvh.mTriangleBitmasks = std::move(data.triangleBitmasks);
+
+        // Computate metadata.
+        bvh.finalize();
+
+        mUpdateStats.nodeCount = (uint32_t)bvh.mNodes.size();
+        mUpdateStats.rebuiltNodeCount = mUpdateStats.nodeCount;
+        mUpdateStats.rebuiltTriangleCount = (uint32_t)bvh.mTriangleIndices.size();
+    }
+
+    void LightBVHBuilder::buildCPU(const std::vector<LightCollection::MeshLightTriangle>& triangles, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices, std::vector<uint64_t>& triangleBitmasks, std::vector<float>* pNodeSplitQuality)
+    {
+        BuildingData data(nodes);
+        bool built = buildNodes(triangles, data);
+        if (pNodeSplitQuality)
+        {
+            pNodeSplitQuality->clear();
+            if (built) computeNodeSplitQuality(data, *pNodeSplitQuality);
+        }
+        triangleIndices = std::move(data.triangleIndices);
+        triangleBitmasks = std::move(data.triangleBitmasks);
+    }
+
+    void LightBVHBuilder::computeNodeSplitQuality(BuildingData& data, std::vector<float>& nodeSplitQuality) const
+    {
+        std::vector<RefitNodeData> refitData;
+        refitNodes(mOptions, data, refitData, false);
+        nodeSplitQuality.resize(data.nodes.size());
+        for (uint32_t nodeIndex = 0; nodeIndex < data.nodes.size(); ++nodeIndex)
+        {
+            nodeSplitQuality[nodeIndex] = computeSplitQuality(data, refitData, nodeIndex);
+        }
+    }
+
+    bool LightBVHBuilder::buildNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, BuildingData& data)
+    {
+        data.nodes.clear();
+        if (triangles.empty()) return false;
 
         // Create list of triangles that should be included in BVH.
         // For each triangle, precompute data we need for the build.
-        BuildingData data(bvh.mNodes);
         data.trianglesData.reserve(triangles.size());
 
         for (size_t i = 0; i < triangles.size(); i++)
         {
             if (!mOptions.usePreintegration || triangles[i].flux > 0.f)
             {
-                LightBVHBuilder::TriangleSortData tri;
-                for (uint32_t j = 0; j < 3; j++)
-                {
-                    tri.bounds |= triangles[i].vtx[j].pos;
-                }
-                tri.center = triangles[i].getCenter();
-                tri.coneDirection = triangles[i].normal;
-                tri.cosConeAngle = 1.f; // Single flat emitter => normal bounding cone angle is zero.
-                tri.flux = triangles[i].flux;
-                tri.triangleIndex = static_cast<uint32_t>(i);
-
-                data.trianglesData.push_back(tri);
+                data.trianglesData.append(triangles[i], static_cast<uint32_t>(i));
             }
         }
 
         // If there are no non-culled triangles, we're done.
-        if (data.trianglesData.empty()) return;
+        if (data.trianglesData.empty()) return false;
 
         // Validate options.
         if (mOptions.maxTriangleCountPerLeaf > kMaxLeafTriangleCount)
@@ -287,18 +344,19 @@ namespace Falcor
         // To be grossly conservative, assume each triangle requires two nodes.
         // This is only system RAM and shouldn't be that much, so it's not worth being more careful about it.
         // TODO: Better estimate of how many nodes we will need.
-        data.nodes.clear();
         data.nodes.reserve(2 * data.trianglesData.size());
-        data.triangleIndices.reserve(data.trianglesData.size());
 
         const uint64_t invalidBitmask = std::numeric_limits<uint64_t>::max();
-        data.triangleBitmasks.resize(triangles.size(), invalidBitmask); // This is sized based on input triangle count, as it's indexed by global triangle index.
+        data.triangleBitmasks.assign(triangles.size(), invalidBitmask); // This is sized based on input triangle count, as it's indexed by global triangle index.
 
         // Build the tree.
         SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
-        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data);
+        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data, data.nodes);
         FALCOR_ASSERT(!data.nodes.empty());
 
+        // Leaf nodes reference contiguous ranges of the sorted triangles in depth-first order, so the triangle indices are in sorted order.
+        data.triangleIndices = data.trianglesData.triangleIndex;
+
         size_t numValid = 0;
         for (auto mask : data.triangleBitmasks)
             if (mask != invalidBitmask) numValid++;
@@ -308,19 +366,289 @@ namespace Falcor
         float cosConeAngle;
         computeLightingConesInternal(0, data, cosConeAngle);
 
-        // The BVH is ready, mark it as valid and upload the data.
-        bvh.mIsValid = true;
-        bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
-        bvh.uploadCPUBuffers(data.triangleIndices, data.triangleBitmasks);
+        return true;
+    }
 
-        // Computate metadata.
+    void LightBVHBuilder::update(LightBVH& bvh)
+    {
+        FALCOR_PROFILE("LightBVHBuilder::update()");
+
+        FALCOR_ASSERT(bvh.mpLightCollection);
+        const auto& triangles = bvh.mpLightCollection->getMeshLightTriangles();
+
+        // Fall back to a full build if there is no BVH to update or it cannot be updated incrementally.
+        if (!bvh.isValid() || !updateCPU(triangles, bvh.mNodes, bvh.mTriangleIndices, bvh.mTriangleBitmasks, bvh.mNodeSplitQuality))
+        {
+            build(bvh);
+            return;
+        }
+
+        // Upload the updated BVH.
+        bvh.uploadCPUBuffers(bvh.mTriangleIndices, bvh.mTriangleBitmasks);
         bvh.finalize();
     }
 
+    bool LightBVHBuilder::updateCPU(const std::vector<LightCollection::MeshLightTriangle>& triangles, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices, std::vector<uint64_t>& triangleBitmasks, std::vector<float>& nodeSplitQuality)
+    {
+        if (nodes.empty() || triangleBitmasks.size() != triangles.size() || nodeSplitQuality.size() != nodes.size()) return false;
+
+        mUpdateStats = UpdateStats();
+
+        const uint64_t invalidBitmask = std::numeric_limits<uint64_t>::max();
+        const uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+        auto isIncluded = [&](uint32_t triangleIndex) { return !mOptions.usePreintegration || triangles[triangleIndex].flux > 0.f; };
+
+        // Prepare the triangles in their current order in the BVH and refit all nodes.
+        // The node attributes on the CPU may be stale if the BVH was refitted on the GPU, but the hierarchy is unchanged.
+        BuildingData oldData(nodes);
+        oldData.trianglesData.resize(triangleIndices.size());
+        parallelForIf(mOptions.parallelBuild, oldData.trianglesData.size(), [&](size_t i)
+        {
+            uint32_t triangleIndex = triangleIndices[i];
+            oldData.trianglesData.set(i, triangles[triangleIndex], triangleIndex);
+        });
+
+        std::vector<RefitNodeData> oldRefitData;
+        refitNodes(mOptions, oldData, oldRefitData, false);
+
+        const uint32_t nodeCount = (uint32_t)oldData.nodes.size();
+        std::vector<uint8_t> rebuild(nodeCount, 0);
+        auto markParent = [&](uint32_t nodeIndex)
+        {
+            uint32_t parent = oldRefitData[nodeIndex].parent;
+            rebuild[parent == invalidIndex ? nodeIndex : parent] = 1;
+        };
+
+        // Mark subtrees whose split quality degraded.
+        for (uint32_t nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+        {
+            float referenceQuality = nodeSplitQuality[nodeIndex];
+            if (referenceQuality > 0.f && computeSplitQuality(oldData, oldRefitData, nodeIndex) > referenceQuality * (1.f + mOptions.incrementalRebuildThreshold))
+            {
+                rebuild[nodeIndex] = 1;
+            }
+        }
+
+        // Mark the parents of leaves containing removed triangles.
+        std::vector<uint32_t> keptPrefixSum(oldData.trianglesData.size() + 1, 0);
+        for (size_t i = 0; i < oldData.trianglesData.size(); ++i)
+        {
+            bool kept = isIncluded(oldData.trianglesData.triangleIndex[i]);
+            keptPrefixSum[i + 1] = keptPrefixSum[i] + (kept ? 1 : 0);
+            if (!kept) mUpdateStats.removedTriangleCount++;
+        }
+        for (uint32_t nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+        {
+            const Range& range = oldRefitData[nodeIndex].triangleRange;
+            if (oldData.nodes[nodeIndex].isLeaf() && keptPrefixSum[range.end] - keptPrefixSum[range.begin] != range.length()) markParent(nodeIndex);
+        }
+
+        // Find a leaf for each added triangle by descending the tree along the child with the smallest growth in surface area.
+        // The parent of the leaf is rebuilt with the triangle inserted.
+        struct InsertedTriangle
+        {
+            uint32_t nodeIndex;
+            uint32_t triangleIndex;
+        };
+        std::vector<InsertedTriangle> insertedTriangles;
+        for (uint32_t triangleIndex = 0; triangleIndex < triangles.size(); ++triangleIndex)
+        {
+            if (triangleBitmasks[triangleIndex] != invalidBitmask || !isIncluded(triangleIndex)) continue;
+
+            AABB triangleBounds;
+            for (const auto& vtx : triangles[triangleIndex].vtx) triangleBounds |= vtx.pos;
+            uint32_t nodeIndex = 0;
+            while (!oldData.nodes[nodeIndex].isLeaf())
+            {
+                uint32_t leftIndex = nodeIndex + 1;
+                uint32_t rightIndex = oldData.nodes[nodeIndex].getInternalNode().rightChildIdx;
+                auto growth = [&](uint32_t childIndex)
+                {
+                    const AABB& bounds = oldRefitData[childIndex].bounds;
+                    return AABB(bounds).include(triangleBounds).area() - bounds.area();
+                };
+                nodeIndex = growth(leftIndex) <= growth(rightIndex) ? leftIndex : rightIndex;
+            }
+            markParent(nodeIndex);
+            insertedTriangles.push_back({ oldRefitData[nodeIndex].parent == invalidIndex ? nodeIndex : oldRefitData[nodeIndex].parent, triangleIndex });
+        }
+        std::sort(insertedTriangles.begin(), insertedTriangles.end(), [](const auto& a, const auto& b) { return a.nodeIndex < b.nodeIndex; });
+        mUpdateStats.insertedTriangleCount = (uint32_t)insertedTriangles.size();
+
+        // Returns the range of inserted triangles targeting the subtree of a node.
+        auto getInsertedRange = [&](uint32_t nodeIndex)
+        {
+            auto begin = std::lower_bound(insertedTriangles.begin(), insertedTriangles.end(), nodeIndex, [](const auto& a, uint32_t i) { return a.nodeIndex < i; });
+            auto end = std::lower_bound(begin, insertedTriangles.end(), oldRefitData[nodeIndex].subtreeEnd, [](const auto& a, uint32_t i) { return a.nodeIndex < i; });
+            return std::make_pair(begin, end);
+        };
+
+        // Subtrees that end up without triangles cannot be rebuilt, rebuild their parent instead.
+        // Parents are stored before their children, so iterating backwards propagates up the tree.
+        for (uint32_t nodeIndex = nodeCount; nodeIndex-- > 0;)
+        {
+            if (!rebuild[nodeIndex]) continue;
+            const Range& range = oldRefitData[nodeIndex].triangleRange;
+            auto [insertedBegin, insertedEnd] = getInsertedRange(nodeIndex);
+            if (keptPrefixSum[range.end] - keptPrefixSum[range.begin] + (insertedEnd - insertedBegin) > 0) continue;
+            if (nodeIndex == 0) return false; // No triangles left at all.
+            markParent(nodeIndex);
+        }
+
+        // Lay out the triangles in their new order. Triangles of rebuilt subtrees are gathered into contiguous ranges.
+        struct RebuildJob
+        {
+            Range triangleRange;
+            uint64_t bitmask;
+            uint32_t depth;
+            std::vector<PackedNode> nodes;
+        };
+        std::vector<RebuildJob> jobs;
+        std::vector<uint32_t> jobIndices(nodeCount, invalidIndex);
+        std::vector<uint32_t> leafOffsets(nodeCount, 0);
+
+        std::vector<PackedNode> newNodes;
+        BuildingData newData(newNodes);
+        newData.trianglesData.reserve(oldData.trianglesData.size() + insertedTriangles.size());
+        newData.triangleBitmasks = std::move(triangleBitmasks);
+
+        std::function<void(uint32_t, uint64_t, uint32_t)> layoutTriangles = [&](uint32_t nodeIndex, uint64_t bitmask, uint32_t depth)
+        {
+            const Range& range = oldRefitData[nodeIndex].triangleRange;
+            const uint32_t begin = (uint32_t)newData.trianglesData.size();
+            if (rebuild[nodeIndex])
+            {
+                for (uint32_t i = range.begin; i < range.end; ++i)
+                {
+                    const uint32_t triangleIndex = oldData.trianglesData.triangleIndex[i];
+                    if (isIncluded(triangleIndex)) newData.trianglesData.append(oldData.trianglesData, Range(i, i + 1));
+                    else newData.triangleBitmasks[triangleIndex] = invalidBitmask;
+                }
+                auto [insertedBegin, insertedEnd] = getInsertedRange(nodeIndex);
+                for (auto it = insertedBegin; it != insertedEnd; ++it) newData.trianglesData.append(triangles[it->triangleIndex], it->triangleIndex);
+
+                jobIndices[nodeIndex] = (uint32_t)jobs.size();
+                jobs.push_back({ Range(begin, (uint32_t)newData.trianglesData.size()), bitmask, depth, {} });
+            }
+            else if (oldData.nodes[nodeIndex].isLeaf())
+            {
+                leafOffsets[nodeIndex] = begin;
+                newData.trianglesData.append(oldData.trianglesData, range);
+            }
+            else
+            {
+                layoutTriangles(nodeIndex + 1, bitmask | (0ull << depth), depth + 1);
+                layoutTriangles(oldData.nodes[nodeIndex].getInternalNode().rightChildIdx, bitmask | (1ull << depth), depth + 1);
+            }
+        };
+        layoutTriangles(0, 0ull, 0);
+
+        if (newData.trianglesData.size() > kMaxLeafTriangleOffset + kMaxLeafTriangleCount)
+        {
+            throw RuntimeError("Emissive triangle count exceeds the maximum supported ({})", kMaxLeafTriangleOffset + kMaxLeafTriangleCount);
+        }
+
+        // Rebuild the marked subtrees in parallel. The jobs operate on disjoint triangle ranges.
+        SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
+        parallelForIf(mOptions.parallelBuild, jobs.size(), [&](size_t i)
+        {
+            auto& job = jobs[i];
+            buildInternal(mOptions, splitFunc, job.bitmask, job.depth, job.triangleRange, newData, job.nodes);
+        }, 1);
+
+        // Assemble the new node list in depth-first order, copying unchanged nodes and splicing in the rebuilt subtrees.
+        newNodes.reserve(nodeCount + insertedTriangles.size());
+        std::vector<float> newSplitQuality;
+        std::vector<uint8_t> isRebuilt;
+        std::function<uint32_t(uint32_t)> assembleNodes = [&](uint32_t oldIndex) -> uint32_t
+        {
+            const uint32_t newIndex = (uint32_t)newNodes.size();
+            if (jobIndices[oldIndex] != invalidIndex)
+            {
+                auto& job = jobs[jobIndices[oldIndex]];
+                for (auto& node : job.nodes)
+                {
+                    if (!node.isLeaf())
+                    {
+                        auto internalNode = node.getInternalNode();
+                        internalNode.rightChildIdx += newIndex;
+                        node.setInternalNode(internalNode);
+                    }
+                }
+                newNodes.insert(newNodes.end(), job.nodes.begin(), job.nodes.end());
+                newSplitQuality.resize(newNodes.size(), 0.f);
+                isRebuilt.resize(newNodes.size(), 1);
+                mUpdateStats.rebuiltSubtreeCount++;
+                mUpdateStats.rebuiltNodeCount += (uint32_t)job.nodes.size();
+                mUpdateStats.rebuiltTriangleCount += job.triangleRange.length();
+                return newIndex;
+            }
+
+            const PackedNode& oldNode = oldData.nodes[oldIndex];
+            newNodes.push_back(oldNode);
+            newSplitQuality.push_back(nodeSplitQuality[oldIndex]);
+            isRebuilt.push_back(0);
+            if (oldNode.isLeaf())
+            {
+                auto leafNode = oldNode.getLeafNode();
+                leafNode.triangleOffset = leafOffsets[oldIndex];
+                newNodes[newIndex].setLeafNode(leafNode);
+            }
+            else
+            {
+                auto internalNode = oldNode.getInternalNode();
+                assembleNodes(oldIndex + 1);
+                internalNode.rightChildIdx = assembleNodes(internalNode.rightChildIdx);
+                newNodes[newIndex].setInternalNode(internalNode);
+            }
+            return newIndex;
+        };
+        assembleNodes(0);
+
+        // Refit all nodes to the new hierarchy and update the reference split quality of the rebuilt nodes.
+        std::vector<RefitNodeData> newRefitData;
+        refitNodes(mOptions, newData, newRefitData, true);
+        for (uint32_t nodeIndex = 0; nodeIndex < newNodes.size(); ++nodeIndex)
+        {
+            if (isRebuilt[nodeIndex]) newSplitQuality[nodeIndex] = computeSplitQuality(newData, newRefitData, nodeIndex);
+        }
+
+        mUpdateStats.nodeCount = (uint32_t)newNodes.size();
+        mUpdateStats.refitNodeCount = mUpdateStats.nodeCount - mUpdateStats.rebuiltNodeCount;
+
+        nodes = std::move(newNodes);
+        nodeSplitQuality = std::move(newSplitQuality);
+        triangleIndices = std::move(newData.trianglesData.triangleIndex);
+        triangleBitmasks = std::move(newData.triangleBitmasks);
+        return true;
+    }
+
     bool LightBVHBuilder::renderUI(Gui::Widgets& widget)
     {
         // Render the build options.
-        return renderOptions(widget, mOptions);
+        bool optionsChanged = renderOptions(widget, mOptions);
+
+        // Render the statistics of the last update.
+        if (mOptions.allowIncrementalUpdates)
+        {
+            if (auto statsGroup = widget.group("Update statistics"))
+            {
+                const auto& stats = mUpdateStats;
+                const float touched = stats.nodeCount > 0 ? 100.f * stats.rebuiltNodeCount / stats.nodeCount : 0.f;
+                std::string statsStr =
+                    "  Full rebuild:           " + std::string(stats.fullRebuild ? "yes" : "no") + "\n" +
+                    "  Node count:             " + std::to_string(stats.nodeCount) + "\n" +
+                    "  Refitted nodes:         " + std::to_string(stats.refitNodeCount) + "\n" +
+                    "  Rebuilt subtrees:       " + std::to_string(stats.rebuiltSubtreeCount) + "\n" +
+                    "  Rebuilt nodes:          " + std::to_string(stats.rebuiltNodeCount) + " (" + std::to_string(touched) + "%)\n" +
+                    "  Rebuilt triangles:      " + std::to_string(stats.rebuiltTriangleCount) + "\n" +
+                    "  Inserted triangles:     " + std::to_string(stats.insertedTriangleCount) + "\n" +
+                    "  Removed triangles:      " + std::to_string(stats.removedTriangleCount);
+                statsGroup.text(statsStr);
+            }
+        }
+
+        return optionsChanged;
     }
 
     bool LightBVHBuilder::renderOptions(Gui::Widgets& widget, Options& options) const
@@ -328,6 +656,15 @@ namespace Falcor
         bool optionsChanged = false;
 
         optionsChanged |= widget.checkbox("Allow refitting", options.allowRefitting);
+        optionsChanged |= widget.checkbox("Allow incremental updates", options.allowIncrementalUpdates);
+        widget.tooltip("Refit the BVH on the CPU and only rebuild subtrees whose quality degraded or whose triangles changed.", true);
+        if (options.allowIncrementalUpdates)
+        {
+            optionsChanged |= widget.var("Rebuild threshold", options.incrementalRebuildThreshold, 0.f, 10.f, 0.05f);
+            widget.tooltip("Relative increase of a node's split cost since it was built above which its subtree is rebuilt.", true);
+        }
+        optionsChanged |= widget.checkbox("Parallel build", options.parallelBuild);
+        widget.tooltip("Build and update the BVH using the thread pool. The result is identical to a serial build.", true);
         optionsChanged |= widget.var("Max triangle count per leaf", options.maxTriangleCountPerLeaf, 1u, kMaxLeafTriangleCount);
         optionsChanged |= widget.dropdown("Split heuristic", kSplitHeuristicList, (uint32_t&)options.splitHeuristicSelection);
 
@@ -362,24 +699,17 @@ namespace Falcor
     {
     }
 
-    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data)
+    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data, std::vector<PackedNode>& nodes)
     {
         FALCOR_ASSERT(triangleRange.begin < triangleRange.end);
 
         // Compute the AABB and total flux of the node.
         float nodeFlux = 0.f;
-        AABB nodeBounds;
-        for (uint32_t dataIndex = triangleRange.begin; dataIndex < triangleRange.end; ++dataIndex)
-        {
-            nodeBounds |= data.trianglesData[dataIndex].bounds;
-            nodeFlux += data.trianglesData[dataIndex].flux;
-        }
+        AABB nodeBounds = data.trianglesData.computeBounds(triangleRange, nodeFlux);
         FALCOR_ASSERT(nodeBounds.valid());
 
-        data.currentNodeFlux = nodeFlux;
-
         bool trySplitting = triangleRange.length() > (options.createLeavesASAP ? options.maxTriangleCountPerLeaf : 1);
-        const SplitResult splitResult = trySplitting ? splitHeuristic(data, triangleRange, nodeBounds, options) : SplitResult();
+        const SplitResult splitResult = trySplitting ? splitHeuristic(data, triangleRange, nodeBounds, nodeFlux, options) : SplitResult();
 
         // If we should split, then create an internal node and split.
         if (splitResult.isValid())
@@ -387,13 +717,17 @@ namespace Falcor
             FALCOR_ASSERT(triangleRange.begin < splitResult.triangleIndex && splitResult.triangleIndex < triangleRange.end);
 
             // Sort the centroids and update the lists accordingly.
-            auto comp = [dim = splitResult.axis](const TriangleSortData& d1, const TriangleSortData& d2) { return d1.bounds.center()[dim] < d2.bounds.center()[dim]; };
-            std::nth_element(std::begin(data.trianglesData) + triangleRange.begin, std::begin(data.trianglesData) + splitResult.triangleIndex, std::begin(data.trianglesData) + triangleRange.end, comp);
+            // The partitioning is done on the element indices, which are then used to reorder all arrays in the range.
+            const auto& center = data.trianglesData.center[splitResult.axis];
+            std::vector<uint32_t> order(triangleRange.length());
+            std::iota(order.begin(), order.end(), triangleRange.begin);
+            std::nth_element(order.begin(), order.begin() + (splitResult.triangleIndex - triangleRange.begin), order.end(), [&center](uint32_t i1, uint32_t i2) { return center[i1] < center[i2]; });
+            data.trianglesData.permute(triangleRange, order);
 
             // Allocate internal node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)nodes.size();
+            nodes.push_back({});
 
             InternalNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -407,13 +741,43 @@ namespace Falcor
                 throw RuntimeError("BVH depth of {} reached. Maximum of {} allowed.", depth + 1, kMaxBVHDepth);
             }
 
-            uint32_t leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, Range(triangleRange.begin, splitResult.triangleIndex), data);
-            uint32_t rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, Range(splitResult.triangleIndex, triangleRange.end), data);
+            const Range leftRange(triangleRange.begin, splitResult.triangleIndex);
+            const Range rightRange(splitResult.triangleIndex, triangleRange.end);
+            uint32_t leftIndex;
+            uint32_t rightIndex;
+
+            if (options.parallelBuild && triangleRange.length() >= kMinParallelBuildTriangleCount)
+            {
+                // Build the right subtree concurrently into a separate node list.
+                std::vector<PackedNode> rightNodes;
+                Threading::TaskGroup group;
+                group.run([&]() { buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, rightRange, data, rightNodes); });
+                leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, leftRange, data, nodes);
+                group.wait();
+
+                // Append the right subtree after the left subtree to get the same depth-first order as a serial build.
+                rightIndex = (uint32_t)nodes.size();
+                for (auto& rightNode : rightNodes)
+                {
+                    if (!rightNode.isLeaf())
+                    {
+                        auto internalNode = rightNode.getInternalNode();
+                        internalNode.rightChildIdx += rightIndex;
+                        rightNode.setInternalNode(internalNode);
+                    }
+                }
+                nodes.insert(nodes.end(), rightNodes.begin(), rightNodes.end());
+            }
+            else
+            {
+                leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, leftRange, data, nodes);
+                rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, rightRange, data, nodes);
+            }
 
             FALCOR_ASSERT(leftIndex == nodeIndex + 1); // The left node should always be placed immediately after the current node.
             node.rightChildIdx = rightIndex;
 
-            data.nodes[nodeIndex].setInternalNode(node);
+            nodes[nodeIndex].setInternalNode(node);
             return nodeIndex;
         }
         else // No split => create leaf node
@@ -421,9 +785,9 @@ namespace Falcor
             FALCOR_ASSERT(triangleRange.length() <= options.maxTriangleCountPerLeaf);
 
             // Allocate leaf node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)nodes.size();
+            nodes.push_back({});
 
             LeafNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -432,24 +796,142 @@ namespace Falcor
             node.attribs.coneDirection = computeLightingCone(triangleRange, data, cosTheta);
             node.attribs.cosConeAngle = cosTheta;
 
+            // Leaf nodes are created in depth-first order, so the triangle offset is the start of the triangle range.
+            // The triangle indices are written in build() once all leaves are created.
             node.triangleCount = triangleRange.length();
-            node.triangleOffset = (uint32_t)data.triangleIndices.size();
+            node.triangleOffset = triangleRange.begin;
             FALCOR_ASSERT(node.triangleCount < kMaxLeafTriangleCount);
             FALCOR_ASSERT(node.triangleOffset < kMaxLeafTriangleOffset);
 
-            for (uint32_t triangleIdx = triangleRange.begin, index = 0; triangleIdx < triangleRange.end; ++triangleIdx, ++index)
+            for (uint32_t triangleIdx = triangleRange.begin; triangleIdx < triangleRange.end; ++triangleIdx)
             {
-                uint32_t globalTriangleIndex = data.trianglesData[triangleIdx].triangleIndex;
-                data.triangleIndices.push_back(globalTriangleIndex);
+                uint32_t globalTriangleIndex = data.trianglesData.triangleIndex[triangleIdx];
                 data.triangleBitmasks[globalTriangleIndex] = bitmask;
             }
-            FALCOR_ASSERT(data.triangleIndices.size() == node.triangleOffset + node.triangleCount);
 
-            data.nodes[nodeIndex].setLeafNode(node);
+            nodes[nodeIndex].setLeafNode(node);
             return nodeIndex;
         }
     }
 
+    void LightBVHBuilder::TriangleSortData::reserve(size_t count)
+    {
+        for (uint32_t axis = 0; axis < 3; ++axis)
+        {
+            boundsMin[axis].reserve(count);
+            boundsMax[axis].reserve(count);
+            center[axis].reserve(count);
+            coneDirection[axis].reserve(count);
+        }
+        cosConeAngle.reserve(count);
+        flux.reserve(count);
+        triangleIndex.reserve(count);
+    }
+
+    void LightBVHBuilder::TriangleSortData::resize(size_t count)
+    {
+        for (uint32_t axis = 0; axis < 3; ++axis)
+        {
+            boundsMin[axis].resize(count);
+            boundsMax[axis].resize(count);
+            center[axis].resize(count);
+            coneDirection[axis].resize(count);
+        }
+        cosConeAngle.resize(count);
+        flux.resize(count);
+        triangleIndex.resize(count, MeshLightData::kInvalidIndex);
+    }
+
+    void LightBVHBuilder::TriangleSortData::set(size_t i, const LightCollection::MeshLightTriangle& triangle, uint32_t globalTriangleIndex)
+    {
+        AABB bounds;
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            bounds |= triangle.vtx[j].pos;
+        }
+        const float3 boundsCenter = bounds.center();
+        for (uint32_t axis = 0; axis < 3; ++axis)
+        {
+            boundsMin[axis][i] = bounds.minPoint[axis];
+            boundsMax[axis][i] = bounds.maxPoint[axis];
+            center[axis][i] = boundsCenter[axis];
+            coneDirection[axis][i] = triangle.normal[axis];
+        }
+        cosConeAngle[i] = 1.f; // Single flat emitter => normal bounding cone angle is zero.
+        flux[i] = triangle.flux;
+        triangleIndex[i] = globalTriangleIndex;
+    }
+
+    void LightBVHBuilder::TriangleSortData::append(const LightCollection::MeshLightTriangle& triangle, uint32_t globalTriangleIndex)
+    {
+        const size_t i = size();
+        resize(i + 1);
+        set(i, triangle, globalTriangleIndex);
+    }
+
+    void LightBVHBuilder::TriangleSortData::append(const TriangleSortData& other, const Range& range)
+    {
+        auto appendRange = [&range](auto& dst, const auto& src) { dst.insert(dst.end(), src.begin() + range.begin, src.begin() + range.end); };
+        for (uint32_t axis = 0; axis < 3; ++axis)
+        {
+            appendRange(boundsMin[axis], other.boundsMin[axis]);
+            appendRange(boundsMax[axis], other.boundsMax[axis]);
+            appendRange(center[axis], other.center[axis]);
+            appendRange(coneDirection[axis], other.coneDirection[axis]);
+        }
+        appendRange(cosConeAngle, other.cosConeAngle);
+        appendRange(flux, other.flux);
+        appendRange(triangleIndex, other.triangleIndex);
+    }
+
+    void LightBVHBuilder::TriangleSortData::permute(const Range& range, const std::vector<uint32_t>& order)
+    {
+        FALCOR_ASSERT(order.size() == range.length());
+
+        // Gather each array into a scratch buffer and copy it back.
+        auto permuteArray = [&order, &range](auto& values, auto& scratch)
+        {
+            for (size_t i = 0; i < order.size(); ++i) scratch[i] = values[order[i]];
+            std::copy(scratch.begin(), scratch.end(), values.begin() + range.begin);
+        };
+        std::vector<float> scratch(range.length());
+        for (uint32_t axis = 0; axis < 3; ++axis)
+        {
+            permuteArray(boundsMin[axis], scratch);
+            permuteArray(boundsMax[axis], scratch);
+            permuteArray(center[axis], scratch);
+            permuteArray(coneDirection[axis], scratch);
+        }
+        permuteArray(cosConeAngle, scratch);
+        permuteArray(flux, scratch);
+        std::vector<uint32_t> indexScratch(range.length());
+        permuteArray(triangleIndex, indexScratch);
+    }
+
+    AABB LightBVHBuilder::TriangleSortData::computeBounds(const Range& range, float& totalFlux) const
+    {
+        AABB bounds;
+        for (uint32_t axis = 0; axis < 3; ++axis)
+        {
+            const float* pMin = boundsMin[axis].data();
+            const float* pMax = boundsMax[axis].data();
+            float minValue = bounds.minPoint[axis];
+            float maxValue = bounds.maxPoint[axis];
+            for (uint32_t i = range.begin; i < range.end; ++i)
+            {
+                minValue = std::min(minValue, pMin[i]);
+                maxValue = std::max(maxValue, pMax[i]);
+            }
+            bounds.minPoint[axis] = minValue;
+            bounds.maxPoint[axis] = maxValue;
+        }
+
+        totalFlux = 0.f;
+        for (uint32_t i = range.begin; i < range.end; ++i) totalFlux += flux[i];
+
+        return bounds;
+    }
+
     float3 LightBVHBuilder::computeLightingConesInternal(const uint32_t nodeIndex, BuildingData& data, float& cosConeAngle)
     {
         if (!data.nodes[nodeIndex].isLeaf())
@@ -495,7 +977,7 @@ namespace Falcor
         float3 coneDirectionSum = float3(0.0f);
         for (uint32_t triangleIdx = triangleRange.begin; triangleIdx < triangleRange.end; ++triangleIdx)
         {
-            coneDirectionSum += data.trianglesData[triangleIdx].coneDirection;
+            coneDirectionSum += data.trianglesData.getConeDirection(triangleIdx);
         }
         if (glm::length(coneDirectionSum) >= FLT_MIN)
         {
@@ -503,14 +985,14 @@ namespace Falcor
             cosTheta = 1.f;
             for (uint32_t triangleIdx = triangleRange.begin; triangleIdx < triangleRange.end; ++triangleIdx)
             {
-                const TriangleSortData& td = data.trianglesData[triangleIdx];
-                cosTheta = computeCosConeAngle(coneDirection, cosTheta, td.coneDirection, td.cosConeAngle);
+                const TriangleSortData& td = data.trianglesData;
+                cosTheta = computeCosConeAngle(coneDirection, cosTheta, td.getConeDirection(triangleIdx), td.cosConeAngle[triangleIdx]);
             }
         }
         return coneDirection;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, const Options& /*parameters*/)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& /*parameters*/)
     {
         // Find the largest dimension.
         float3 dimensions = nodeBounds.extent();
@@ -537,18 +1019,115 @@ namespace Falcor
         return cost;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)
+    /** Finds the best split given a function computing the cheapest split along a dimension.
+        Splits where all lights fall on either side are ignored. For large nodes the dimensions are evaluated
+        in parallel if 'parallelBuild' is enabled, the results are reduced in dimension order to get the same result as a serial evaluation.
+        \param[in] triangleRange Range of triangles to process.
+        \param[in] parameters The build options.
+        \param[in] largestDimension Largest dimension of the node bounds.
+        \param[in] binAlongDimension Function returning the cheapest (cost, split) pair along a given dimension.
+        \return The cheapest (cost, split) pair. The split is invalid if no valid split was found.
+    */
+    template<typename RangeType, typename BinFunc>
+    static auto findBestSplit(const RangeType& triangleRange, const LightBVHBuilder::Options& parameters, uint32_t largestDimension, const BinFunc& binAlongDimension)
     {
-        std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
+        using SplitPair = decltype(binAlongDimension(0u));
+        SplitPair overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), typename SplitPair::second_type());
         FALCOR_ASSERT(!overallBestSplit.second.isValid());
 
+        const auto updateBestSplit = [&](const SplitPair& axisBestSplit)
+        {
+            // Early out if all lights fall on either side of the split.
+            if (axisBestSplit.second.triangleIndex == triangleRange.begin ||
+                axisBestSplit.second.triangleIndex == triangleRange.end) return;
+
+            if (axisBestSplit.first < overallBestSplit.first)
+            {
+                overallBestSplit = axisBestSplit;
+                FALCOR_ASSERT(triangleRange.begin < overallBestSplit.second.triangleIndex && overallBestSplit.second.triangleIndex < triangleRange.end);
+            }
+        };
+
+        if (parameters.splitAlongLargest)
+        {
+            updateBestSplit(binAlongDimension(largestDimension));
+        }
+        else
+        {
+            SplitPair axisBestSplits[3];
+            if (parameters.parallelBuild && triangleRange.length() >= kMinParallelSplitTriangleCount)
+            {
+                Threading::parallelFor(0, 3, [&](size_t dimension) { axisBestSplits[dimension] = binAlongDimension((uint32_t)dimension); }, 1);
+            }
+            else
+            {
+                for (uint32_t dimension = 0; dimension < 3; ++dimension) axisBestSplits[dimension] = binAlongDimension(dimension);
+            }
+            for (const auto& axisBestSplit : axisBestSplits) updateBestSplit(axisBestSplit);
+        }
+
+        return overallBestSplit;
+    }
+
+    /** Computes the bin id of each triangle in a range along a dimension.
+        The centers along the dimension are stored contiguously, so the loop is vectorized by the compiler.
+        \param[in] center Bounds centers of all triangles along the dimension.
+        \param[in] triangleRange Range of triangles to process.
+        \param[in] bmin Min bound of the node along the dimension.
+        \param[in] bmax Max bound of the node along the dimension.
+        \param[in] binCount Number of bins.
+        \param[out] binIds Bin id for each triangle in the range.
+    */
+    template<typename RangeType>
+    static void computeBinIds(const std::vector<float>& center, const RangeType& triangleRange, float bmin, float bmax, uint32_t binCount, std::vector<uint32_t>& binIds)
+    {
+        const float w = bmax - bmin;
+        FALCOR_ASSERT(w >= 0.f); // The node bounds can be zero if all primitives are axis-aligned and coplanar
+        const float scale = w > FLT_MIN ? (float)binCount / w : 0.f;
+        const int32_t maxBinId = (int32_t)binCount - 1;
+
+        binIds.resize(triangleRange.length());
+        const float* pCenter = center.data() + triangleRange.begin;
+        uint32_t* pBinIds = binIds.data();
+        for (uint32_t i = 0; i < triangleRange.length(); ++i)
+        {
+            FALCOR_ASSERT(bmin <= pCenter[i] && pCenter[i] <= bmax);
+            pBinIds[i] = (uint32_t)std::min((int32_t)((pCenter[i] - bmin) * scale), maxBinId);
+        }
+    }
+
+    /** Accumulates the triangle count and bounds of the triangles in a range into their bins.
+        Each array is streamed separately to keep the working set small.
+        \param[in] trianglesData Prepared light data.
+        \param[in] triangleRange Range of triangles to process.
+        \param[in] binIds Bin id for each triangle in the range.
+        \param[in,out] bins Bins with 'bounds' and 'triangleCount' members.
+    */
+    template<typename SortData, typename RangeType, typename Bin>
+    static void accumulateBinBounds(const SortData& trianglesData, const RangeType& triangleRange, const std::vector<uint32_t>& binIds, std::vector<Bin>& bins)
+    {
+        for (uint32_t i = 0; i < triangleRange.length(); ++i) bins[binIds[i]].triangleCount++;
+
+        for (uint32_t axis = 0; axis < 3; ++axis)
+        {
+            const float* pMin = trianglesData.boundsMin[axis].data() + triangleRange.begin;
+            const float* pMax = trianglesData.boundsMax[axis].data() + triangleRange.begin;
+            for (uint32_t i = 0; i < triangleRange.length(); ++i)
+            {
+                AABB& bounds = bins[binIds[i]].bounds;
+                bounds.minPoint[axis] = std::min(bounds.minPoint[axis], pMin[i]);
+                bounds.maxPoint[axis] = std::max(bounds.maxPoint[axis], pMax[i]);
+            }
+        }
+    }
+
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters)
+    {
         struct Bin
         {
             AABB bounds;
             uint32_t triangleCount = 0;
 
-            Bin() = default;
-            Bin(const TriangleSortData& tri) : bounds(tri.bounds), triangleCount(1) {}
             Bin& operator|= (const Bin& rhs)
             {
                 bounds |= rhs.bounds;
@@ -558,35 +1137,20 @@ namespace Falcor
         };
 
         FALCOR_ASSERT(parameters.binCount > 1);
-        std::vector<Bin> bins(parameters.binCount);
-        std::vector<float> costs(parameters.binCount - 1);
 
         /** Helper function that computes the best split along the given dimension using the SAH metric.
             The triangles are binned to n bins, storing only the aggregate parameters (triangle count and bounds).
             Then the cost metric is evaluated for each of the n-1 potential splits.
         */
-        const auto binAlongDimension = [&bins, &costs, &triangleRange, &data, &parameters, &overallBestSplit, &nodeBounds](uint32_t dimension)
+        const auto binAlongDimension = [&triangleRange, &data, &parameters, &nodeBounds](uint32_t dimension)
         {
-            // Helper to compute the bin id for a given triangle.
-            auto getBinId = [&](const TriangleSortData& td)
-            {
-                float bmin = nodeBounds.minPoint[dimension], bmax = nodeBounds.maxPoint[dimension];
-                FALCOR_ASSERT(bmin < bmax);
-                float scale = (float)parameters.binCount / (bmax - bmin);
-                float p = td.bounds.center()[dimension];
-                FALCOR_ASSERT(bmin <= p && p <= bmax);
-                return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
-            };
-
-            // Reset the bins.
-            for (Bin& bin : bins) bin = Bin();
+            std::vector<Bin> bins(parameters.binCount);
+            std::vector<float> costs(parameters.binCount - 1);
 
             // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
-            }
+            std::vector<uint32_t> binIds;
+            computeBinIds(data.trianglesData.center[dimension], triangleRange, nodeBounds.minPoint[dimension], nodeBounds.maxPoint[dimension], parameters.binCount, binIds);
+            accumulateBinBounds(data.trianglesData, triangleRange, binIds, bins);
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
             // Note that the costs vector has n-1 elements when there are n bins; the i:th elements represents the split between bin i and i+1.
@@ -617,40 +1181,23 @@ namespace Falcor
             }
             FALCOR_ASSERT(triangleRange.begin <= axisBestSplit.second.triangleIndex && axisBestSplit.second.triangleIndex <= triangleRange.end);
 
-            // Early out if all lights fall on either side of the split.
-            if (axisBestSplit.second.triangleIndex == triangleRange.begin ||
-                axisBestSplit.second.triangleIndex == triangleRange.end) return;
-
-            if (axisBestSplit.first < overallBestSplit.first)
-            {
-                overallBestSplit = axisBestSplit;
-                FALCOR_ASSERT(triangleRange.begin < overallBestSplit.second.triangleIndex && overallBestSplit.second.triangleIndex < triangleRange.end);
-            }
+            return axisBestSplit;
         };
 
-        if (parameters.splitAlongLargest)
-        {
-            // Find the largest dimension.
-            float3 dimensions = nodeBounds.extent();
-            uint32_t largestDimension = dimensions[2] >= dimensions[0] && dimensions[2] >= dimensions[1] ?
-                2 : (dimensions[1] >= dimensions[0] && dimensions[1] >= dimensions[2] ? 1 : 0);
+        // Find the largest dimension.
+        float3 dimensions = nodeBounds.extent();
+        uint32_t largestDimension = dimensions[2] >= dimensions[0] && dimensions[2] >= dimensions[1] ?
+            2 : (dimensions[1] >= dimensions[0] && dimensions[1] >= dimensions[2] ? 1 : 0);
 
-            binAlongDimension(largestDimension);
-        }
-        else
-        {
-            for (uint32_t dimension = 0; dimension < 3; ++dimension)
-            {
-                binAlongDimension(dimension);
-            }
-        }
+        // Compute the best split.
+        const auto overallBestSplit = findBestSplit(triangleRange, parameters, largestDimension, binAlongDimension);
 
         // If we couldn't find a valid split, create leaf node immediately if possible or revert to equal splitting.
         if (!overallBestSplit.second.isValid())
         {
             if (triangleRange.length() <= parameters.maxTriangleCountPerLeaf) return SplitResult();
             logWarning("LightBVHBuilder::computeSplitWithBinnedSAH() was not able to compute a proper split: reverting to LightBVHBuilder::computeSplitWithEqual()");
-            return computeSplitWithEqual(data, triangleRange, nodeBounds, parameters);
+            return computeSplitWithEqual(data, triangleRange, nodeBounds, nodeFlux, parameters);
         }
 
         // If the best split we found is more expensive than the cost of a leaf node (and we can create one), then create a leaf node.
@@ -692,11 +1239,79 @@ namespace Falcor
         return cost;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)
+    /** Evaluates the cost metric of a node for the configured split heuristic.
+    */
+    static float evalNodeCost(const AABB& bounds, const float flux, const float cosTheta, const uint32_t triangleCount, const LightBVHBuilder::Options& parameters)
     {
-        std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
-        FALCOR_ASSERT(!overallBestSplit.second.isValid());
+        if (parameters.splitHeuristicSelection == LightBVHBuilder::SplitHeuristic::BinnedSAOH) return evalSAOH(bounds, flux, cosTheta, parameters);
+        return evalSAH(bounds, triangleCount, parameters);
+    }
+
+    void LightBVHBuilder::refitNodes(const Options& options, BuildingData& data, std::vector<RefitNodeData>& refitData, bool writeNodes)
+    {
+        refitData.assign(data.nodes.size(), RefitNodeData());
 
+        // Nodes are stored in depth-first order, so iterating backwards visits children before their parent.
+        for (uint32_t nodeIndex = (uint32_t)data.nodes.size(); nodeIndex-- > 0;)
+        {
+            RefitNodeData& refit = refitData[nodeIndex];
+            if (data.nodes[nodeIndex].isLeaf())
+            {
+                auto node = data.nodes[nodeIndex].getLeafNode();
+                refit.triangleRange = Range(node.triangleOffset, node.triangleOffset + node.triangleCount);
+                refit.subtreeEnd = nodeIndex + 1;
+                refit.bounds = data.trianglesData.computeBounds(refit.triangleRange, refit.flux);
+                refit.coneDirection = computeLightingCone(refit.triangleRange, data, refit.cosConeAngle);
+
+                if (writeNodes)
+                {
+                    node.attribs.setAABB(refit.bounds.minPoint, refit.bounds.maxPoint);
+                    node.attribs.flux = refit.flux;
+                    node.attribs.coneDirection = refit.coneDirection;
+                    node.attribs.cosConeAngle = refit.cosConeAngle;
+                    data.nodes[nodeIndex].setLeafNode(node);
+                }
+            }
+            else
+            {
+                auto node = data.nodes[nodeIndex].getInternalNode();
+                RefitNodeData& left = refitData[nodeIndex + 1];
+                RefitNodeData& right = refitData[node.rightChildIdx];
+                left.parent = nodeIndex;
+                right.parent = nodeIndex;
+
+                refit.triangleRange = Range(left.triangleRange.begin, right.triangleRange.end);
+                refit.subtreeEnd = right.subtreeEnd;
+                refit.bounds = left.bounds;
+                refit.bounds |= right.bounds;
+                refit.flux = left.flux + right.flux;
+                refit.coneDirection = coneUnionOld(left.coneDirection, left.cosConeAngle, right.coneDirection, right.cosConeAngle, refit.cosConeAngle);
+
+                if (writeNodes)
+                {
+                    node.attribs.setAABB(refit.bounds.minPoint, refit.bounds.maxPoint);
+                    node.attribs.flux = refit.flux;
+                    node.attribs.coneDirection = refit.coneDirection;
+                    node.attribs.cosConeAngle = refit.cosConeAngle;
+                    data.nodes[nodeIndex].setInternalNode(node);
+                }
+            }
+
+            refit.cost = evalNodeCost(refit.bounds, refit.flux, refit.cosConeAngle, refit.triangleRange.length(), options);
+        }
+    }
+
+    float LightBVHBuilder::computeSplitQuality(const BuildingData& data, const std::vector<RefitNodeData>& refitData, uint32_t nodeIndex)
+    {
+        if (data.nodes[nodeIndex].isLeaf()) return 0.f;
+        const float cost = refitData[nodeIndex].cost;
+        if (cost <= 0.f) return 0.f;
+        uint32_t rightIndex = data.nodes[nodeIndex].getInternalNode().rightChildIdx;
+        return (refitData[nodeIndex + 1].cost + refitData[rightIndex].cost) / cost;
+    }
+
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters)
+    {
         // Find the largest dimension.
         float3 dimensions = nodeBounds.extent();
         uint32_t largestDimension = dimensions[2] >= dimensions[0] && dimensions[2] >= dimensions[1] ?
@@ -710,8 +1325,6 @@ namespace Falcor
             float3 coneDirection = float3(0.0f);
             float cosConeAngle = 1.0f;
 
-            Bin() = default;
-            Bin(const TriangleSortData& tri) : bounds(tri.bounds), triangleCount(1), flux(tri.flux), coneDirection(tri.coneDirection), cosConeAngle(tri.cosConeAngle) {}
             Bin& operator|= (const Bin& rhs)
             {
                 bounds |= rhs.bounds;
@@ -724,8 +1337,6 @@ namespace Falcor
         };
 
         FALCOR_ASSERT(parameters.binCount > 1);
-        std::vector<Bin> bins(parameters.binCount);
-        std::vector<float> costs(parameters.binCount - 1);
 
         /** Helper function that computes the best split along the given dimension using the SAOH metric.
             The triangles are binned to n bins, storing only the aggregate parameters (triangle count, bounds, flux, and cone direction).
@@ -734,28 +1345,23 @@ namespace Falcor
             the bounding cones are approximates based on the bins' bounding cones. This is less expensive,
             but also less precise than computing them directly from the triangles.
         */
-        const auto binAlongDimension = [&bins, &costs, &triangleRange, &data, &parameters, &overallBestSplit, &nodeBounds, largestDimension, dimensions](uint32_t dimension)
+        const auto binAlongDimension = [&triangleRange, &data, &parameters, &nodeBounds, largestDimension, dimensions](uint32_t dimension)
         {
-            // Helper to compute the bin id for a given triangle.
-            auto getBinId = [&](const TriangleSortData& td)
-            {
-                float bmin = nodeBounds.minPoint[dimension], bmax = nodeBounds.maxPoint[dimension];
-                float w = bmax - bmin;
-                FALCOR_ASSERT(w >= 0.f); // The node bounds can be zero if all primitives are axis-aligned and coplanar
-                float scale = w > FLT_MIN ? (float)parameters.binCount / w : 0.f;
-                float p = td.bounds.center()[dimension];
-                FALCOR_ASSERT(bmin <= p && p <= bmax);
-                return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
-            };
-
-            // Reset the bins.
-            for (Bin& bin : bins) bin = Bin();
+            std::vector<Bin> bins(parameters.binCount);
+            std::vector<float> costs(parameters.binCount - 1);
 
             // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
+            const TriangleSortData& td = data.trianglesData;
+            std::vector<uint32_t> binIds;
+            computeBinIds(td.center[dimension], triangleRange, nodeBounds.minPoint[dimension], nodeBounds.maxPoint[dimension], parameters.binCount, binIds);
+            accumulateBinBounds(td, triangleRange, binIds, bins);
+
+            const float* pFlux = td.flux.data() + triangleRange.begin;
+            for (uint32_t i = 0; i < triangleRange.length(); ++i) bins[binIds[i]].flux += pFlux[i];
+            for (uint32_t axis = 0; axis < 3; ++axis)
             {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
+                const float* pConeDirection = td.coneDirection[axis].data() + triangleRange.begin;
+                for (uint32_t i = 0; i < triangleRange.length(); ++i) bins[binIds[i]].coneDirection[axis] += pConeDirection[i];
             }
 
             // Compute the lighting cones for each bin.
@@ -767,11 +1373,11 @@ namespace Falcor
                 bin.cosConeAngle = glm::length(bin.coneDirection) < FLT_MIN ? kInvalidCosConeAngle : 1.0f;
                 bin.coneDirection = glm::normalize(bin.coneDirection);
             }
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
+            for (uint32_t i = 0; i < triangleRange.length(); ++i)
             {
-                const auto& td = data.trianglesData[i];
-                Bin& bin = bins[getBinId(td)];
-                bin.cosConeAngle = computeCosConeAngle(bin.coneDirection, bin.cosConeAngle, td.coneDirection, td.cosConeAngle);
+                const uint32_t triangleIdx = triangleRange.begin + i;
+                Bin& bin = bins[binIds[i]];
+                bin.cosConeAngle = computeCosConeAngle(bin.coneDirection, bin.cosConeAngle, td.getConeDirection(triangleIdx), td.cosConeAngle[triangleIdx]);
             }
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
@@ -832,36 +1438,18 @@ namespace Falcor
             // Scale the cost by the ratio of the node's extent to discourage long skinny nodes.
             axisBestSplit.first *= static_cast<float>(dimensions[largestDimension]) / static_cast<float>(dimensions[dimension]);
 
-            // Early out if all lights fall on either side of the split.
-            if (axisBestSplit.second.triangleIndex == triangleRange.begin ||
-                axisBestSplit.second.triangleIndex == triangleRange.end) return;
-
-            if (axisBestSplit.first < overallBestSplit.first)
-            {
-                overallBestSplit = axisBestSplit;
-                FALCOR_ASSERT(triangleRange.begin < overallBestSplit.second.triangleIndex && overallBestSplit.second.triangleIndex < triangleRange.end);
-            }
+            return axisBestSplit;
         };
 
         // Compute the best split.
-        if (parameters.splitAlongLargest)
-        {
-            binAlongDimension(largestDimension);
-        }
-        else
-        {
-            for (uint32_t dimension = 0; dimension < 3; ++dimension)
-            {
-                binAlongDimension(dimension);
-            }
-        }
+        const auto overallBestSplit = findBestSplit(triangleRange, parameters, largestDimension, binAlongDimension);
 
         // If we couldn't find a valid split, create leaf node immediately if possible or revert to equal splitting.
         if (!overallBestSplit.second.isValid())
         {
             if (triangleRange.length() <= parameters.maxTriangleCountPerLeaf) return SplitResult();
             logWarning("LightBVHBuilder::computeSplitWithBinnedSAOH() was not able to compute a proper split: reverting to LightBVHBuilder::computeSplitWithEqual()");
-            return computeSplitWithEqual(data, triangleRange, nodeBounds, parameters);
+            return computeSplitWithEqual(data, triangleRange, nodeBounds, nodeFlux, parameters);
         }
 
         // If the best split we found is more expensive than the cost of a leaf node (and we can create one), then create a leaf node.
@@ -871,7 +1459,7 @@ namespace Falcor
             // Evaluate the cost metric for the node. This requires us to first compute the cone angle.
             float cosTheta = kInvalidCosConeAngle;
             computeLightingCone(triangleRange, data, cosTheta);
-            float leafCost = evalSAOH(nodeBounds, data.currentNodeFlux, cosTheta, parameters);
+            float leafCost = evalSAOH(nodeBounds, nodeFlux, cosTheta, parameters);
             if (leafCost <= overallBestSplit.first) return SplitResult();
         }
 
@@ -912,6 +1500,9 @@ namespace Falcor
         options.field(useLeafCreationCost);
         options.field(createLeavesASAP);
         options.field(allowRefitting);
+        options.field(allowIncrementalUpdates);
+        options.field(incrementalRebuildThreshold);
+        options.field(parallelBuild);
         options.field(usePreintegration);
         options.field(useLightingCones);
 #undef field
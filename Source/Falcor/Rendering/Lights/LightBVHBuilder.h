@@ -43,6 +43,11 @@ namespace Falcor
         The building process can be customized via the |Options|,
         which are also available in the GUI via the |renderUI()| function.
 
+        The build is task parallel: subtrees of large nodes are built concurrently and the split
+        evaluation for large nodes is done per axis in parallel. The resulting BVH is identical to
+        a serial build (same node order, triangle order and bitmasks), which can be selected with
+        the 'parallelBuild' option.
+
         TODO: Rename all things triangle* to light* as the BVH class can be used for other types.
     */
     class FALCOR_API LightBVHBuilder
@@ -72,6 +77,9 @@ namespace Falcor
             bool           useLeafCreationCost = true;                           ///< Set to true to avoid splitting when the cost is higher than the cost of creating a leaf node. Only used when 'createLeavesASAP' is disabled.
             bool           createLeavesASAP = true;                              ///< Rather than creating a leaf only once splitting stops, create it as soon as we can.
             bool           allowRefitting = true;                                ///< Rather than always rebuilding the BVH from scratch, keep the hierarchy but update the bounds and lighting cones.
+            bool           allowIncrementalUpdates = false;                      ///< Rather than refitting, update the BVH incrementally: refit all nodes on the CPU and only rebuild subtrees whose quality degraded or whose triangles changed. Takes precedence over 'allowRefitting'.
+            float          incrementalRebuildThreshold = 0.25f;                  ///< Relative increase of a node's split cost since it was built above which its subtree is rebuilt. Only used when 'allowIncrementalUpdates' is enabled.
+            bool           parallelBuild = true;                                 ///< Build and update the BVH using the thread pool. The result is identical to a serial build.
             bool           usePreintegration = true;                             ///< Use pre-integration for culling out emissive triangles and use their flux when computing the splits. Only valid when using the BinnedSAOH split heuristic.
             bool           useLightingCones = true;                              ///< Use lighting cones when computing the splits. Only valid when using the BinnedSAOH split heuristic.
         };
@@ -81,11 +89,59 @@ namespace Falcor
         */
         static SharedPtr create(const Options& options);
 
+        /** Statistics of the last BVH update.
+        */
+        struct UpdateStats
+        {
+            bool fullRebuild = false;                       ///< True if the BVH was built from scratch.
+            uint32_t nodeCount = 0;                         ///< Number of nodes in the BVH after the update.
+            uint32_t refitNodeCount = 0;                    ///< Number of nodes that were only refitted.
+            uint32_t rebuiltSubtreeCount = 0;               ///< Number of subtrees that were rebuilt.
+            uint32_t rebuiltNodeCount = 0;                  ///< Number of nodes in the rebuilt subtrees.
+            uint32_t rebuiltTriangleCount = 0;              ///< Number of triangles in the rebuilt subtrees.
+            uint32_t insertedTriangleCount = 0;             ///< Number of triangles inserted into the BVH.
+            uint32_t removedTriangleCount = 0;              ///< Number of triangles removed from the BVH.
+        };
+
         /** Build the BVH.
             \param[in,out] bvh The light BVH to build.
         */
         void build(LightBVH& bvh);
 
+        /** Build the BVH nodes on the CPU without uploading them to the GPU.
+            This is the CPU part of build(), which is useful for benchmarking the builder on synthetic data.
+            The lighting cones of all nodes are computed.
+            \param[in] triangles Global list of emissive triangles.
+            \param[out] nodes BVH nodes in depth-first order.
+            \param[out] triangleIndices Triangle indices sorted by leaf node.
+            \param[out] triangleBitmasks Per triangle bit pattern retracing the tree traversal to reach the triangle. Indexed by global triangle index.
+            \param[out] pNodeSplitQuality Optional split quality of each node, used as reference by updateCPU().
+        */
+        void buildCPU(const std::vector<LightCollection::MeshLightTriangle>& triangles, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices, std::vector<uint64_t>& triangleBitmasks, std::vector<float>* pNodeSplitQuality = nullptr);
+
+        /** Incrementally update the BVH to the current state of the light collection.
+            All nodes are refitted on the CPU. Subtrees whose split cost increased by more than the configured threshold since
+            they were built are rebuilt, as well as subtrees containing triangles that were added or removed (due to flux changes).
+            Falls back to a full build if the BVH has not been built with incremental updates enabled or the number of triangles changed.
+            \param[in,out] bvh The light BVH to update.
+        */
+        void update(LightBVH& bvh);
+
+        /** Incrementally update BVH nodes on the CPU without uploading them to the GPU.
+            This is the CPU part of update(). The BVH data is the output of a previous buildCPU() or updateCPU() call.
+            \param[in] triangles Global list of emissive triangles.
+            \param[in,out] nodes BVH nodes in depth-first order.
+            \param[in,out] triangleIndices Triangle indices sorted by leaf node.
+            \param[in,out] triangleBitmasks Per triangle bit pattern retracing the tree traversal to reach the triangle. Indexed by global triangle index.
+            \param[in,out] nodeSplitQuality Split quality of each node when it was last built.
+            \return False if the BVH cannot be updated incrementally and needs a full build. The BVH data is unchanged in that case.
+        */
+        bool updateCPU(const std::vector<LightCollection::MeshLightTriangle>& triangles, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices, std::vector<uint64_t>& triangleBitmasks, std::vector<float>& nodeSplitQuality);
+
+        /** Returns statistics of the last build or update.
+        */
+        const UpdateStats& getUpdateStats() const { return mUpdateStats; }
+
         bool renderUI(Gui::Widgets& widget);
 
         const Options& getOptions() const { return mOptions; }
@@ -113,34 +169,86 @@ namespace Falcor
             }
         };
 
+        /** Prepared light data stored as a structure of arrays.
+            The split evaluation streams over a few arrays at a time (e.g. the centers along one axis),
+            which keeps the working set small and lets the compiler vectorize the binning loops.
+        */
         struct TriangleSortData
         {
-            AABB bounds;                                    ///< World-space bounding box for the light source(s).
-            float3 center = {};                             ///< Center point.
-            float3 coneDirection = {};                      ///< Light emission normal direction.
-            float cosConeAngle = 1.f;                       ///< Cosine normal bounding cone (half) angle.
-            float flux = 0.f;                               ///< Precomputed triangle flux (note, this takes doublesidedness into account).
-            uint32_t triangleIndex = MeshLightData::kInvalidIndex; ///< Index into global triangle list.
+            std::vector<float> boundsMin[3];                ///< World-space bounding box min point of the light source(s), per axis.
+            std::vector<float> boundsMax[3];                ///< World-space bounding box max point of the light source(s), per axis.
+            std::vector<float> center[3];                   ///< Bounding box center, per axis. Used for binning and partitioning.
+            std::vector<float> coneDirection[3];            ///< Light emission normal direction, per axis.
+            std::vector<float> cosConeAngle;                ///< Cosine normal bounding cone (half) angle.
+            std::vector<float> flux;                        ///< Precomputed triangle flux (note, this takes doublesidedness into account).
+            std::vector<uint32_t> triangleIndex;            ///< Index into global triangle list.
+
+            size_t size() const { return triangleIndex.size(); }
+            bool empty() const { return triangleIndex.empty(); }
+            void reserve(size_t count);
+            void resize(size_t count);
+
+            /** Prepare the build data for a triangle.
+                \param[in] i Index of the element to write.
+                \param[in] triangle The emissive triangle.
+                \param[in] globalTriangleIndex Index of the triangle in the global triangle list.
+            */
+            void set(size_t i, const LightCollection::MeshLightTriangle& triangle, uint32_t globalTriangleIndex);
+
+            /** Append the build data for a triangle. See set().
+            */
+            void append(const LightCollection::MeshLightTriangle& triangle, uint32_t globalTriangleIndex);
+
+            /** Append a range of elements of another set of prepared light data.
+            */
+            void append(const TriangleSortData& other, const Range& range);
+
+            /** Reorder the elements in a range.
+                \param[in] range Range of elements to reorder.
+                \param[in] order Element index to store at each position of the range, i.e., the element at range.begin + i is read from order[i].
+            */
+            void permute(const Range& range, const std::vector<uint32_t>& order);
+
+            AABB getBounds(size_t i) const { return AABB(float3(boundsMin[0][i], boundsMin[1][i], boundsMin[2][i]), float3(boundsMax[0][i], boundsMax[1][i], boundsMax[2][i])); }
+            float3 getConeDirection(size_t i) const { return float3(coneDirection[0][i], coneDirection[1][i], coneDirection[2][i]); }
+
+            /** Compute the bounds and total flux of a range of elements.
+            */
+            AABB computeBounds(const Range& range, float& totalFlux) const;
         };
 
         struct BuildingData
         {
             std::vector<PackedNode>& nodes;                 ///< BVH nodes generated by the builder.
-            std::vector<TriangleSortData> trianglesData;    ///< Compact list of triangles to include in build.
+            TriangleSortData trianglesData;                 ///< Compact list of triangles to include in build.
             std::vector<uint32_t> triangleIndices;          ///< Triangle indices sorted by leaf node. Each leaf node refers to a contiguous array of triangle indices.
             std::vector<uint64_t> triangleBitmasks;         ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child; this array gets filled in during the build process. Indexed by global triangle index.
-            float currentNodeFlux = 0.f;                    ///< Used by computeSAOHSplit() as the leaf creation cost.
 
             BuildingData(std::vector<PackedNode>& bvhNodes) : nodes(bvhNodes) {}
         };
 
+        /** Per-node data computed when refitting the BVH on the CPU.
+        */
+        struct RefitNodeData
+        {
+            AABB bounds;                                    ///< Bounds of the node.
+            float flux = 0.f;                               ///< Total flux of the node.
+            float3 coneDirection = {};                      ///< Lighting cone direction.
+            float cosConeAngle = kInvalidCosConeAngle;      ///< Cosine of the lighting cone angle.
+            float cost = 0.f;                               ///< Cost metric of the node for the configured split heuristic.
+            Range triangleRange = Range(0, 0);              ///< Range of sorted triangles in the subtree.
+            uint32_t subtreeEnd = 0;                        ///< One past the index of the last node in the subtree.
+            uint32_t parent = std::numeric_limits<uint32_t>::max(); ///< Index of the parent node.
+        };
+
         /** Compute the split according to a specified heuristic.
             \param[in] data Prepared light data.
             \param[in] triangleRange Range of triangles to process.
             \param[in] nodeBounds Bounds for the node to be splitted.
+            \param[in] nodeFlux Total flux of the node to be splitted. Used by computeSplitWithBinnedSAOH() as the leaf creation cost.
             \param[in] parameters Various parameters defining how the building should occur.
         */
-        using SplitHeuristicFunction = std::function<SplitResult(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)>;
+        using SplitHeuristicFunction = std::function<SplitResult(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters)>;
 
         LightBVHBuilder(const Options& options);
 
@@ -149,14 +257,44 @@ namespace Falcor
         bool renderOptions(Gui::Widgets& widget, Options& options) const;
 
         /** Recursive BVH build.
+            Nodes are allocated in depth-first order in the given node list. The right subtree of large nodes is built
+            concurrently into a separate node list, which is appended once both subtrees are done.
+            Concurrent builds only touch disjoint ranges of the prepared light data.
             \param[in] splitHeuristic The splitting heuristic to be used.
             \param[in] bitmask Bit pattern retracing the tree traversal to reach the node to be built: 0=left child, 1=right child.
             \param[in] depth Depth of the node to be built
             \param[in] triangleRange Range of triangles to process.
             \param[in,out] data Prepared light data.
-            \return Index of the allocated node.
+            \param[in,out] nodes Node list of the subtree being built. Child indices are relative to this list.
+            \return Index of the allocated node in the node list.
         */
-        uint32_t buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data);
+        uint32_t buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data, std::vector<PackedNode>& nodes);
+
+        /** Prepare the light data and build the BVH nodes, including the lighting cones.
+            \param[in] triangles Global list of emissive triangles.
+            \param[in,out] data Building data. The nodes are cleared before the build.
+            \return False if there are no triangles to include in the BVH.
+        */
+        bool buildNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, BuildingData& data);
+
+        /** Refit all nodes to the prepared light data on the CPU.
+            \param[in] options Build options.
+            \param[in,out] data Prepared light data. The node attributes are updated if writeNodes is set.
+            \param[out] refitData Per-node refit data.
+            \param[in] writeNodes Write the refitted attributes to the nodes.
+        */
+        static void refitNodes(const Options& options, BuildingData& data, std::vector<RefitNodeData>& refitData, bool writeNodes);
+
+        /** Compute the split quality of all nodes as reference for incremental updates.
+            \param[in,out] data Building data of a BVH that was just built.
+            \param[out] nodeSplitQuality Split quality of each node.
+        */
+        void computeNodeSplitQuality(BuildingData& data, std::vector<float>& nodeSplitQuality) const;
+
+        /** Compute the split quality of an internal node, i.e. the ratio of the summed cost of the children and the cost of the node.
+            Returns zero for leaf nodes.
+        */
+        static float computeSplitQuality(const BuildingData& data, const std::vector<RefitNodeData>& refitData, uint32_t nodeIndex);
 
         /** Recursive computation of lighting cones for all internal nodes.
             \param[in] nodeIndex Index of the current node.
@@ -175,13 +313,15 @@ namespace Falcor
         static float3 computeLightingCone(const Range& triangleRange, const BuildingData& data, float& cosTheta);
 
         // See the documentation of SplitHeuristicFunction.
-        static SplitResult computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, const Options& /*parameters*/);
-        static SplitResult computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters);
-        static SplitResult computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters);
+        static SplitResult computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& /*parameters*/);
+        static SplitResult computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& parameters);
+        static SplitResult computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters);
 
         static SplitHeuristicFunction getSplitFunction(SplitHeuristic heuristic);
 
         // Configuration
         Options mOptions;
+
+        UpdateStats mUpdateStats;
     };
 }
@@ -58,11 +58,13 @@ namespace Falcor
 
         bool samplerChanged = false;
         bool needsRefit = false;
+        bool needsUpdate = false;
 
         // Check if light collection has changed.
         if (is_set(mpScene->getUpdates(), Scene::UpdateFlags::LightCollectionChanged))
         {
-            if (mOptions.buildOptions.allowRefitting && !mNeedsRebuild) needsRefit = true;
+            if (mOptions.buildOptions.allowIncrementalUpdates && !mNeedsRebuild) needsUpdate = true;
+            else if (mOptions.buildOptions.allowRefitting && !mNeedsRebuild) needsRefit = true;
             else mNeedsRebuild = true;
         }
 
@@ -73,6 +75,11 @@ namespace Falcor
             mNeedsRebuild = false;
             samplerChanged = true;
         }
+        else if (needsUpdate)
+        {
+            mpBVHBuilder->update(*mpBVH);
+            samplerChanged = true;
+        }
         else if (needsRefit)
         {
             mpBVH->refit(pRenderContext);
@@ -28,8 +28,12 @@
 #include "AnimatedVertexCache.h"
 #include "Animation.h"
 #include "Core/API/RenderContext.h"
+#include "Core/Platform/OS.h"
 #include "Scene/Scene.h"
+#include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
 #include "Utils/Timing/Profiler.h"
+#include <cstring>
 
 namespace Falcor
 {
@@ -96,14 +100,16 @@ namespace Falcor
         }
     }
 
-    AnimatedVertexCache::AnimatedVertexCache(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes)
+    AnimatedVertexCache::AnimatedVertexCache(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, uint32_t streamingWindowSize)
         : mpScene(pScene)
         , mpPrevVertexData(pPrevVertexData)
-        , mCachedCurves(cachedCurves)
-        , mCachedMeshes(cachedMeshes)
+        , mCachedCurves(std::move(cachedCurves))
+        , mCachedMeshes(std::move(cachedMeshes))
     {
         if (mCachedCurves.empty() && mCachedMeshes.empty()) return;
 
+        if (streamingWindowSize > 0) mStreamingWindowSize = std::max(streamingWindowSize, 2u);
+
         if (!mCachedCurves.empty())
         {
             for (auto& cache : mCachedCurves)
@@ -137,11 +143,13 @@ namespace Falcor
 
             createMeshVertexUpdatePass();
         }
+
+        if (mStreamingWindowSize > 0) initStream();
     }
 
-    AnimatedVertexCache::UniquePtr AnimatedVertexCache::create(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes)
+    AnimatedVertexCache::UniquePtr AnimatedVertexCache::create(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, uint32_t streamingWindowSize)
     {
-        return UniquePtr(new AnimatedVertexCache(pScene, pPrevVertexData, std::move(cachedCurves), std::move(cachedMeshes)));
+        return UniquePtr(new AnimatedVertexCache(pScene, pPrevVertexData, std::move(cachedCurves), std::move(cachedMeshes), streamingWindowSize));
     }
 
     bool AnimatedVertexCache::animate(RenderContext* pRenderContext, double time)
@@ -155,13 +163,13 @@ namespace Falcor
 
             if (mCurveLSSCount > 0)
             {
-                executeCurveLSSVertexUpdatePass(pRenderContext, interpolationInfo);
+                executeCurveLSSVertexUpdatePass(pRenderContext, updateStream(mCurveLSSTrack, interpolationInfo));
                 executeCurveLSSAABBUpdatePass(pRenderContext);
             }
 
             if (mCurvePolyTubeCount > 0)
             {
-                executeCurvePolyTubeVertexUpdatePass(pRenderContext, interpolationInfo);
+                executeCurvePolyTubeVertexUpdatePass(pRenderContext, updateStream(mCurvePolyTubeTrack, interpolationInfo));
             }
 
 
@@ -194,6 +202,8 @@ namespace Falcor
         for (size_t i = 0; i < mpCurveVertexBuffers.size(); i++) m += mpCurveVertexBuffers[i] ? mpCurveVertexBuffers[i]->getSize() : 0;
         m += mpPrevCurveVertexBuffer ? mpPrevCurveVertexBuffer->getSize() : 0;
         m += mpCurveIndexBuffer ? mpCurveIndexBuffer->getSize() : 0;
+        for (size_t i = 0; i < mpCurvePolyTubeVertexBuffers.size(); i++) m += mpCurvePolyTubeVertexBuffers[i] ? mpCurvePolyTubeVertexBuffers[i]->getSize() : 0;
+        m += mpCurvePolyTubeStrandIndexBuffer ? mpCurvePolyTubeStrandIndexBuffer->getSize() : 0;
         for (size_t i = 0; i < mpMeshVertexBuffers.size(); i++) m += mpMeshVertexBuffers[i] ? mpMeshVertexBuffers[i]->getSize() : 0;
         m += mpMeshInterpolationBuffer ? mpMeshInterpolationBuffer->getSize() : 0;
         m += mpMeshMetadataBuffer ? mpMeshMetadataBuffer->getSize() : 0;
@@ -217,6 +227,40 @@ namespace Falcor
         mGlobalCurveAnimationLength = mCurveKeyframeTimes.empty() ? 0 : mCurveKeyframeTimes.back();
     }
 
+    uint32_t AnimatedVertexCache::getResidentKeyframeCount(uint32_t keyframeCount) const
+    {
+        return mStreamingWindowSize > 0 ? VertexCacheStream::getSlotCount(keyframeCount, mStreamingWindowSize) : keyframeCount;
+    }
+
+    void AnimatedVertexCache::fillCurveKeyframe(CurveTessellationMode mode, uint32_t keyframeIndex, DynamicCurveVertexData* pDst) const
+    {
+        const double time = mCurveKeyframeTimes[keyframeIndex];
+        for (const auto& cache : mCachedCurves)
+        {
+            if (cache.tessellationMode != mode) continue;
+
+            const auto& timeSamples = cache.timeSamples;
+            const size_t vertexCount = cache.vertexData[0].size();
+            const size_t k = std::min(size_t(std::lower_bound(timeSamples.begin(), timeSamples.end(), time) - timeSamples.begin()), timeSamples.size() - 1);
+
+            if (timeSamples[k] == time || k == 0)
+            {
+                std::memcpy(pDst, cache.vertexData[k].data(), vertexCount * sizeof(DynamicCurveVertexData));
+            }
+            else
+            {
+                // Linearly interpolate at the missing keyframe.
+                float t = float((time - timeSamples[k - 1]) / (timeSamples[k] - timeSamples[k - 1]));
+                for (size_t p = 0; p < vertexCount; p++)
+                {
+                    pDst[p].position = lerp(cache.vertexData[k - 1][p].position, cache.vertexData[k][p].position, t);
+                }
+            }
+
+            pDst += vertexCount;
+        }
+    }
+
     void AnimatedVertexCache::bindCurveLSSBuffers()
     {
         // Compute curve vertex and index (segment) count.
@@ -232,8 +276,8 @@ namespace Falcor
 
         // Create buffers for vertex positions in curve vertex caches.
         ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
-        mpCurveVertexBuffers.resize(mCurveKeyframeTimes.size());
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++)
+        mpCurveVertexBuffers.resize(getResidentKeyframeCount((uint32_t)mCurveKeyframeTimes.size()));
+        for (uint32_t i = 0; i < mpCurveVertexBuffers.size(); i++)
         {
             mpCurveVertexBuffers[i] = Buffer::createStructured(sizeof(DynamicCurveVertexData), mCurveVertexCount, vbBindFlags, Buffer::CpuAccess::None, nullptr, false);
             mpCurveVertexBuffers[i]->setName("AnimatedVertexCache::mpCurveVertexBuffers[" + std::to_string(i) + "]");
@@ -243,41 +287,25 @@ namespace Falcor
         mpPrevCurveVertexBuffer = Buffer::createStructured(sizeof(DynamicCurveVertexData), mCurveVertexCount, vbBindFlags, Buffer::CpuAccess::None, nullptr, false);
         mpPrevCurveVertexBuffer->setName("AnimatedVertexCache::mpPrevCurveVertexBuffer");
 
-        // Initialize vertex buffers with cached positions.
-        uint32_t offset = 0;
-        for (size_t i = 0; i < mCachedCurves.size(); i++)
+        // Initialize vertex buffers with cached positions. When streaming, they are filled on demand.
+        if (mStreamingWindowSize == 0)
         {
-            if (mCachedCurves[i].tessellationMode != CurveTessellationMode::LinearSweptSphere) continue;
-
-            size_t vertexCount = mCachedCurves[i].vertexData[0].size();
-            uint32_t bufSize = uint32_t(vertexCount * sizeof(DynamicCurveVertexData));
-            uint32_t k = 0;
-            const auto& timeSamples = mCachedCurves[i].timeSamples;
-
+            std::vector<DynamicCurveVertexData> vertices(mCurveVertexCount);
             for (uint32_t j = 0; j < mCurveKeyframeTimes.size(); j++)
             {
-                while (k + 1 < timeSamples.size() && timeSamples[k] < mCurveKeyframeTimes[j]) k++;
-
-                if (timeSamples[k] == mCurveKeyframeTimes[j])
-                {
-                    mpCurveVertexBuffers[j]->setBlob(mCachedCurves[i].vertexData[k].data(), offset, bufSize);
-                }
-                else
-                {
-                    // Linearly interpolate at the missing keyframe.
-                    float t = float((mCurveKeyframeTimes[j] - timeSamples[k - 1]) / (timeSamples[k] - timeSamples[k - 1]));
-                    std::vector<DynamicCurveVertexData> interpVertices(vertexCount);
-                    for (size_t p = 0; p < vertexCount; p++)
-                    {
-                        interpVertices[p].position = lerp(mCachedCurves[i].vertexData[k - 1][p].position, mCachedCurves[i].vertexData[k][p].position, t);
-                    }
-                    mpCurveVertexBuffers[j]->setBlob(interpVertices.data(), offset, bufSize);
-                }
+                fillCurveKeyframe(CurveTessellationMode::LinearSweptSphere, j, vertices.data());
+                mpCurveVertexBuffers[j]->setBlob(vertices.data(), 0, mCurveVertexCount * sizeof(DynamicCurveVertexData));
             }
+        }
 
-            // Initialize it with positions at the first keyframe.
-            mpPrevCurveVertexBuffer->setBlob(mCachedCurves[i].vertexData[0].data(), offset, bufSize);
+        // Initialize previous positions with positions at the first keyframe.
+        uint32_t offset = 0;
+        for (size_t i = 0; i < mCachedCurves.size(); i++)
+        {
+            if (mCachedCurves[i].tessellationMode != CurveTessellationMode::LinearSweptSphere) continue;
 
+            uint32_t bufSize = uint32_t(mCachedCurves[i].vertexData[0].size() * sizeof(DynamicCurveVertexData));
+            mpPrevCurveVertexBuffer->setBlob(mCachedCurves[i].vertexData[0].data(), offset, bufSize);
             offset += bufSize;
         }
 
@@ -345,46 +373,22 @@ namespace Falcor
 
         // Create buffers for vertex positions in curve vertex caches.
         ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
-        mpCurvePolyTubeVertexBuffers.resize(mCurveKeyframeTimes.size());
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++)
+        mpCurvePolyTubeVertexBuffers.resize(getResidentKeyframeCount((uint32_t)mCurveKeyframeTimes.size()));
+        for (uint32_t i = 0; i < mpCurvePolyTubeVertexBuffers.size(); i++)
         {
             mpCurvePolyTubeVertexBuffers[i] = Buffer::createStructured(sizeof(DynamicCurveVertexData), mCurvePolyTubeVertexCount, vbBindFlags, Buffer::CpuAccess::None, nullptr, false);
             mpCurvePolyTubeVertexBuffers[i]->setName("AnimatedVertexCache::mpCurvePolyTubeVertexBuffers[" + std::to_string(i) + "]");
         }
 
-        // Initialize vertex buffers with cached positions.
-        uint32_t offset = 0;
-        for (size_t i = 0; i < mCachedCurves.size(); i++)
+        // Initialize vertex buffers with cached positions. When streaming, they are filled on demand.
+        if (mStreamingWindowSize == 0)
         {
-            if (mCachedCurves[i].tessellationMode != CurveTessellationMode::PolyTube) continue;
-
-            size_t vertexCount = mCachedCurves[i].vertexData[0].size();
-            uint32_t bufSize = uint32_t(vertexCount * sizeof(DynamicCurveVertexData));
-            uint32_t k = 0;
-            const auto& timeSamples = mCachedCurves[i].timeSamples;
-
+            std::vector<DynamicCurveVertexData> vertices(mCurvePolyTubeVertexCount);
             for (uint32_t j = 0; j < mCurveKeyframeTimes.size(); j++)
             {
-                while (k + 1 < timeSamples.size() && timeSamples[k] < mCurveKeyframeTimes[j]) k++;
-
-                if (timeSamples[k] == mCurveKeyframeTimes[j])
-                {
-                    mpCurvePolyTubeVertexBuffers[j]->setBlob(mCachedCurves[i].vertexData[k].data(), offset, bufSize);
-                }
-                else
-                {
-                    // Linearly interpolate at the missing keyframe.
-                    float t = float((mCurveKeyframeTimes[j] - timeSamples[k - 1]) / (timeSamples[k] - timeSamples[k - 1]));
-                    std::vector<DynamicCurveVertexData> interpVertices(vertexCount);
-                    for (size_t p = 0; p < vertexCount; p++)
-                    {
-                        interpVertices[p].position = lerp(mCachedCurves[i].vertexData[k - 1][p].position, mCachedCurves[i].vertexData[k][p].position, t);
-                    }
-                    mpCurvePolyTubeVertexBuffers[j]->setBlob(interpVertices.data(), offset, bufSize);
-                }
+                fillCurveKeyframe(CurveTessellationMode::PolyTube, j, vertices.data());
+                mpCurvePolyTubeVertexBuffers[j]->setBlob(vertices.data(), 0, mCurvePolyTubeVertexCount * sizeof(DynamicCurveVertexData));
             }
-
-            offset += bufSize;
         }
 
         // Create curve strand index buffer.
@@ -393,7 +397,7 @@ namespace Falcor
         mpCurvePolyTubeStrandIndexBuffer->setName("AnimatedVertexCache::mpCurvePolyTubeStrandIndexBuffer");
 
         // Initialize strand index buffer.
-        offset = 0;
+        uint32_t offset = 0;
         const uint32_t strandLastVertexIndex = 0xffffffff;
         std::vector<uint32_t> strandIndexData(mCurvePolyTubeVertexCount);
         for (uint32_t i = 0; i < (uint32_t)mCachedCurves.size(); i++)
@@ -434,7 +438,7 @@ namespace Falcor
         for (const auto& cache : mCachedMeshes)
         {
             mGlobalMeshAnimationLength = std::max(mGlobalMeshAnimationLength, cache.timeSamples.back());
-            mMeshKeyframeCount += (uint32_t)cache.timeSamples.size();
+            mMeshKeyframeCount += getResidentKeyframeCount((uint32_t)cache.timeSamples.size());
             mMaxMeshVertexCount = std::max((uint32_t)cache.vertexData.front().size(), mMaxMeshVertexCount);
         }
     }
@@ -442,6 +446,7 @@ namespace Falcor
     void AnimatedVertexCache::initMeshBuffers()
     {
         mpMeshVertexBuffers.resize(mMeshKeyframeCount);
+        mMeshKeyframeOffsets.reserve(mCachedMeshes.size());
         std::vector<PerMeshMetadata> meshMetadata;
         meshMetadata.reserve(mCachedMeshes.size());
 
@@ -456,17 +461,19 @@ namespace Falcor
             meta.sceneVbOffset = mpScene->getMesh(cache.meshID).vbOffset;
             meta.prevVbOffset = mpScene->getMesh(cache.meshID).prevVbOffset;
             meshMetadata.push_back(meta);
+            mMeshKeyframeOffsets.push_back(keyframeOffset);
 
-            // Create vertex buffer for each keyframe on this mesh
-            for (size_t i = 0; i < cache.vertexData.size(); i++)
+            // Create vertex buffer for each keyframe on this mesh. When streaming, there is one buffer per slot, filled on demand.
+            uint32_t bufferCount = getResidentKeyframeCount((uint32_t)cache.timeSamples.size());
+            for (uint32_t i = 0; i < bufferCount; i++)
             {
-                auto& data = cache.vertexData[i];
+                const void* pData = mStreamingWindowSize == 0 ? cache.vertexData[i].data() : nullptr;
                 size_t index = keyframeOffset + i;
-                mpMeshVertexBuffers[index] = Buffer::createStructured(sizeof(PackedStaticVertexData), (uint32_t)data.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, data.data(), false);
+                mpMeshVertexBuffers[index] = Buffer::createStructured(sizeof(PackedStaticVertexData), meta.vertexCount, ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, pData, false);
                 mpMeshVertexBuffers[index]->setName("AnimatedVertexCache::mpMeshVertexBuffers[" + std::to_string(index) + "]");
             }
 
-            keyframeOffset += (uint32_t)cache.timeSamples.size();
+            keyframeOffset += bufferCount;
         }
 
         mpMeshMetadataBuffer = Buffer::createStructured(sizeof(PerMeshMetadata), (uint32_t)meshMetadata.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, meshMetadata.data(), false);
@@ -500,14 +507,14 @@ namespace Falcor
         FALCOR_ASSERT(mCurveLSSCount > 0);
 
         Program::DefineList defines;
-        defines.add("CURVE_KEYFRAME_COUNT", std::to_string(mCurveKeyframeTimes.size()));
+        defines.add("CURVE_KEYFRAME_COUNT", std::to_string(mpCurveVertexBuffers.size()));
         mpCurveVertexUpdatePass = ComputePass::create(kUpdateCurveVerticesFilename, "main", defines);
 
         auto block = mpCurveVertexUpdatePass->getVars()["gCurveVertexUpdater"];
         auto var = block["curvePerKeyframe"];
 
         // Bind curve vertex data.
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++) var[i]["vertexData"] = mpCurveVertexBuffers[i];
+        for (uint32_t i = 0; i < mpCurveVertexBuffers.size(); i++) var[i]["vertexData"] = mpCurveVertexBuffers[i];
     }
 
     void AnimatedVertexCache::createCurveLSSAABBUpdatePass()
@@ -525,7 +532,7 @@ namespace Falcor
         FALCOR_ASSERT(mCurvePolyTubeCount > 0);
 
         Program::DefineList defines;
-        defines.add("CURVE_KEYFRAME_COUNT", std::to_string(mCurveKeyframeTimes.size()));
+        defines.add("CURVE_KEYFRAME_COUNT", std::to_string(mpCurvePolyTubeVertexBuffers.size()));
         mpCurvePolyTubeVertexUpdatePass = ComputePass::create(kUpdateCurvePolyTubeVerticesFilename, "main", defines);
 
         auto block = mpCurvePolyTubeVertexUpdatePass->getVars()["gCurvePolyTubeVertexUpdater"];
@@ -535,9 +542,71 @@ namespace Falcor
         auto var = block["curvePerKeyframe"];
 
         // Bind curve vertex data.
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++) var[i]["vertexData"] = mpCurvePolyTubeVertexBuffers[i];
+        for (uint32_t i = 0; i < mpCurvePolyTubeVertexBuffers.size(); i++) var[i]["vertexData"] = mpCurvePolyTubeVertexBuffers[i];
+    }
+
+
+    void AnimatedVertexCache::initStream()
+    {
+        FALCOR_ASSERT(mStreamingWindowSize > 0);
+
+        std::vector<VertexCacheStream::TrackDesc> tracks;
+        if (mCurveLSSCount > 0)
+        {
+            mCurveLSSTrack = (uint32_t)tracks.size();
+            tracks.push_back({ (uint32_t)mCurveKeyframeTimes.size(), uint64_t(mCurveVertexCount) * sizeof(DynamicCurveVertexData) });
+        }
+        if (mCurvePolyTubeCount > 0)
+        {
+            mCurvePolyTubeTrack = (uint32_t)tracks.size();
+            tracks.push_back({ (uint32_t)mCurveKeyframeTimes.size(), uint64_t(mCurvePolyTubeVertexCount) * sizeof(DynamicCurveVertexData) });
+        }
+        mMeshTrackOffset = (uint32_t)tracks.size();
+        for (const auto& cache : mCachedMeshes)
+        {
+            tracks.push_back({ (uint32_t)cache.vertexData.size(), uint64_t(cache.vertexData.front().size()) * sizeof(PackedStaticVertexData) });
+        }
+
+        std::filesystem::path path = getTempFilePath();
+        VertexCacheStream::write(path, tracks, [&](uint32_t trackIndex, uint32_t keyframeIndex, void* pData)
+        {
+            if (trackIndex == mCurveLSSTrack) fillCurveKeyframe(CurveTessellationMode::LinearSweptSphere, keyframeIndex, reinterpret_cast<DynamicCurveVertexData*>(pData));
+            else if (trackIndex == mCurvePolyTubeTrack) fillCurveKeyframe(CurveTessellationMode::PolyTube, keyframeIndex, reinterpret_cast<DynamicCurveVertexData*>(pData));
+            else
+            {
+                const auto& data = mCachedMeshes[trackIndex - mMeshTrackOffset].vertexData[keyframeIndex];
+                std::memcpy(pData, data.data(), data.size() * sizeof(PackedStaticVertexData));
+            }
+        });
+        mpStream = VertexCacheStream::open(path, mStreamingWindowSize, true);
+
+        // Keyframes are read from the stream from now on, release the host copies.
+        uint64_t streamSize = 0;
+        for (const auto& track : tracks) streamSize += track.keyframeCount * track.keyframeSize;
+        for (auto& cache : mCachedCurves) std::vector<std::vector<DynamicCurveVertexData>>().swap(cache.vertexData);
+        for (auto& cache : mCachedMeshes) std::vector<std::vector<PackedStaticVertexData>>().swap(cache.vertexData);
+
+        logInfo("AnimatedVertexCache: Streaming {} of keyframes from '{}' with a window of {} keyframes.", formatByteSize(streamSize), path.string(), mStreamingWindowSize);
+    }
+
+    InterpolationInfo AnimatedVertexCache::updateStream(uint32_t trackIndex, const InterpolationInfo& info)
+    {
+        if (!mpStream) return info;
+
+        FALCOR_PROFILE("stream keyframes");
+
+        InterpolationInfo result = info;
+        result.keyframeIndices = mpStream->update(trackIndex, info.keyframeIndices, mLoopAnimations,
+            [this](uint32_t track, uint32_t slot, const void* pData, uint64_t size) { uploadKeyframe(track, slot, pData, size); });
+        return result;
     }
 
+    void AnimatedVertexCache::uploadKeyframe(uint32_t trackIndex, uint32_t slot, const void* pData, uint64_t size)
+    {
+        if (trackIndex == mCurveLSSTrack) mpCurveVertexBuffers[slot]->setBlob(pData, 0, size);
+        else if (trackIndex == mCurvePolyTubeTrack) mpCurvePolyTubeVertexBuffers[slot]->setBlob(pData, 0, size);
+        else mpMeshVertexBuffers[mMeshKeyframeOffsets[trackIndex - mMeshTrackOffset] + slot]->setBlob(pData, 0, size);
+    }
 
     void AnimatedVertexCache::executeMeshVertexUpdatePass(RenderContext* pRenderContext, double t, bool copyPrev)
     {
@@ -550,6 +619,7 @@ namespace Falcor
         {
             auto postInfinityBehavior = mLoopAnimations ? Animation::Behavior::Cycle : Animation::Behavior::Constant;
             mMeshInterpolationInfo[i] = calculateInterpolation(t, mCachedMeshes[i].timeSamples, mPreInfinityBehavior, postInfinityBehavior);
+            if (!copyPrev) mMeshInterpolationInfo[i] = updateStream(mMeshTrackOffset + (uint32_t)i, mMeshInterpolationInfo[i]);
         }
 
         mpMeshInterpolationBuffer->setBlob(mMeshInterpolationInfo.data(), 0, mpMeshInterpolationBuffer->getSize());
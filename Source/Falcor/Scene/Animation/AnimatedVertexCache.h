@@ -28,6 +28,7 @@
 #pragma once
 #include "Animation.h"
 #include "SharedTypes.slang"
+#include "VertexCacheStream.h"
 #include "Core/API/Buffer.h"
 #include "Scene/Curves/CurveConfig.h"
 #include "Scene/SceneTypes.slang"
@@ -78,7 +79,15 @@ namespace Falcor
         using UniqueConstPtr = std::unique_ptr<const AnimatedVertexCache>;
         ~AnimatedVertexCache() = default;
 
-        static UniquePtr create(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes);
+        /** Create a new object.
+            \param[in] pScene Scene the cached data belongs to.
+            \param[in] pPrevVertexData Buffer holding the previous vertex positions of dynamic meshes.
+            \param[in] cachedCurves Cached curve animations.
+            \param[in] cachedMeshes Cached mesh animations.
+            \param[in] streamingWindowSize Number of keyframes kept resident per cache when streaming keyframes from disk, or 0 to keep all keyframes resident.
+            \return A new object, or throws an exception if creation failed.
+        */
+        static UniquePtr create(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, uint32_t streamingWindowSize = 0);
 
         void setIsLooped(bool looped) { mLoopAnimations = looped; }
 
@@ -100,10 +109,26 @@ namespace Falcor
 
         Buffer::SharedPtr getPrevCurveVertexData() const { return mpPrevCurveVertexBuffer; }
 
+        /** Get the GPU memory usage in bytes.
+            When streaming, this only includes the keyframes in the resident window.
+        */
         uint64_t getMemoryUsageInBytes() const;
 
+        /** Returns true if keyframes are streamed from disk.
+        */
+        bool isStreaming() const { return mpStream != nullptr; }
+
+        /** Get the keyframe stream, or nullptr if not streaming.
+        */
+        const VertexCacheStream* getStream() const { return mpStream.get(); }
+
     private:
-        AnimatedVertexCache(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes);
+        AnimatedVertexCache(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, uint32_t streamingWindowSize);
+
+        uint32_t getResidentKeyframeCount(uint32_t keyframeCount) const;
+
+        // Write the vertex data of all curves with the given tessellation mode at a merged curve keyframe, interpolating missing keyframes.
+        void fillCurveKeyframe(CurveTessellationMode mode, uint32_t keyframeIndex, DynamicCurveVertexData* pDst) const;
 
         void initCurveKeyframes();
         void bindCurveLSSBuffers();
@@ -118,6 +143,13 @@ namespace Falcor
 
         void createMeshVertexUpdatePass();
 
+        // Write all keyframes to a stream file and release the host copies.
+        void initStream();
+
+        // Make the keyframes of a track resident and remap the interpolation info to their slots.
+        InterpolationInfo updateStream(uint32_t trackIndex, const InterpolationInfo& info);
+        void uploadKeyframe(uint32_t trackIndex, uint32_t slot, const void* pData, uint64_t size);
+
         void executeMeshVertexUpdatePass(RenderContext* pContext, double t, bool copyPrev = false);
 
         // Interpolate vertex positions.
@@ -137,6 +169,15 @@ namespace Falcor
         Buffer::SharedPtr mpPrevVertexData; ///< Owned by AnimationController
         Animation::Behavior mPreInfinityBehavior = Animation::Behavior::Constant; // How the animation behaves before the first keyframe.
 
+        // Keyframe streaming. The stream has one track for each curve tessellation mode in use, followed by one track per cached mesh.
+        // Keyframe buffers then hold a window of slots instead of all keyframes.
+        static constexpr uint32_t kInvalidTrack = std::numeric_limits<uint32_t>::max();
+        uint32_t mStreamingWindowSize = 0;
+        VertexCacheStream::UniquePtr mpStream;
+        uint32_t mCurveLSSTrack = kInvalidTrack;
+        uint32_t mCurvePolyTubeTrack = kInvalidTrack;
+        uint32_t mMeshTrackOffset = kInvalidTrack;
+
         std::vector<CachedCurve> mCachedCurves;
         uint32_t mCurveLSSCount = 0;
         uint32_t mCurvePolyTubeCount = 0;
@@ -172,7 +213,8 @@ namespace Falcor
 
         std::vector<CachedMesh> mCachedMeshes;
         std::vector<InterpolationInfo> mMeshInterpolationInfo;
-        uint32_t mMeshKeyframeCount = 0; ///< Total count of all keyframes for all meshes
+        uint32_t mMeshKeyframeCount = 0; ///< Total count of all resident keyframes for all meshes
+        std::vector<uint32_t> mMeshKeyframeOffsets; ///< Offset of the keyframes of each mesh in mpMeshVertexBuffers
         uint32_t mMaxMeshVertexCount = 0; ///< Greatest vertex count a mesh has
 
         std::vector<Buffer::SharedPtr> mpMeshVertexBuffers;
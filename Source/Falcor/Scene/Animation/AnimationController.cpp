@@ -96,7 +96,7 @@ namespace Falcor
         return UniquePtr(new AnimationController(pScene, staticVertexData, skinningVertexData, prevVertexCount, animations));
     }
 
-    void AnimationController::addAnimatedVertexCaches(std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const StaticVertexVector& staticVertexData)
+    void AnimationController::addAnimatedVertexCaches(std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const StaticVertexVector& staticVertexData, uint32_t streamingWindowSize)
     {
         size_t totalAnimatedMeshVertexCount = 0;
 
@@ -160,7 +160,7 @@ namespace Falcor
             mpPrevVertexData->setBlob(prevVertexData.data(), byteOffset, prevVertexData.size() * sizeof(PrevVertexData));
         }
 
-        mpVertexCache = AnimatedVertexCache::create(mpScene, mpPrevVertexData, std::move(cachedCurves), std::move(cachedMeshes));
+        mpVertexCache = AnimatedVertexCache::create(mpScene, mpPrevVertexData, std::move(cachedCurves), std::move(cachedMeshes), streamingWindowSize);
 
         // Note: It is a workaround to have two pre-infinity behaviors for the cached animation.
         // We need `Cycle` behavior when the length of cached animation is smaller than the length of mesh animation (e.g., tiger forest).
@@ -484,6 +484,13 @@ namespace Falcor
         widget.var("Snippet Start", mAnimationSnippetStart, 0.0, mAnimationSnippetEnd);
         widget.var("Snippet End", mAnimationSnippetEnd, 0.0);
 
+        if (mpVertexCache && mpVertexCache->isStreaming())
+        {
+            const auto& stats = mpVertexCache->getStream()->getStats();
+            widget.text(fmt::format("Vertex cache window: {} keyframes", mpVertexCache->getStream()->getWindowSize()));
+            widget.text(fmt::format("Keyframes loaded: {} ({} prefetched, {} stalls)", stats.keyframesLoaded, stats.keyframesPrefetched, stats.stalls));
+        }
+
         for (auto& animation : mAnimations)
         {
             if (auto animGroup = widget.group(animation->getName()))
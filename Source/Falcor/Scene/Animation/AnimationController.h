@@ -57,8 +57,9 @@ namespace Falcor
         static UniquePtr create(Scene* pScene, const StaticVertexVector& staticVertexData, const SkinningVertexVector& skinningVertexData, uint32_t prevVertexCount, const std::vector<Animation::SharedPtr>& animations);
 
         /** Add animated vertex caches (curves and meshes) to the controller.
+            \param[in] streamingWindowSize Number of keyframes kept resident per cache when streaming keyframes from disk, or 0 to keep all keyframes resident.
         */
-        void addAnimatedVertexCaches(std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const StaticVertexVector& staticVertexData);
+        void addAnimatedVertexCaches(std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const StaticVertexVector& staticVertexData, uint32_t streamingWindowSize = 0);
 
         /** Returns true if controller contains animations.
         */
@@ -0,0 +1,280 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "VertexCacheStream.h"
+#include "Core/Errors.h"
+#include "Utils/Logger.h"
+#include <cstring>
+
+namespace Falcor
+{
+    namespace
+    {
+        const char* kMagic = "FalcorV$";
+        const uint32_t kVersion = 1;
+
+        struct Header
+        {
+            uint8_t magic[8]{};
+            uint32_t version = 0;
+            uint32_t trackCount = 0;
+        };
+
+        struct TrackHeader
+        {
+            uint32_t keyframeCount = 0;
+            uint32_t reserved = 0;
+            uint64_t keyframeSize = 0;
+        };
+    }
+
+    VertexCacheStream::VertexCacheStream(const std::filesystem::path& path, uint32_t windowSize, bool deleteOnClose)
+        : mPath(path)
+        , mWindowSize(windowSize)
+        , mDeleteOnClose(deleteOnClose)
+    {
+        checkArgument(windowSize >= 2, "'windowSize' ({}) must be at least 2.", windowSize);
+
+        mFile.open(path, std::ios::binary);
+        if (!mFile) throw RuntimeError("Failed to open vertex cache stream '{}'.", path.string());
+
+        Header header;
+        mFile.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!mFile || std::memcmp(header.magic, kMagic, sizeof(header.magic)) != 0 || header.version != kVersion)
+        {
+            throw RuntimeError("Vertex cache stream '{}' has an invalid header.", path.string());
+        }
+
+        uint64_t fileOffset = sizeof(Header) + header.trackCount * sizeof(TrackHeader);
+        mTracks.resize(header.trackCount);
+        for (auto& track : mTracks)
+        {
+            TrackHeader trackHeader;
+            mFile.read(reinterpret_cast<char*>(&trackHeader), sizeof(trackHeader));
+            if (!mFile) throw RuntimeError("Vertex cache stream '{}' has an invalid track table.", path.string());
+
+            track.desc.keyframeCount = trackHeader.keyframeCount;
+            track.desc.keyframeSize = trackHeader.keyframeSize;
+            track.fileOffset = fileOffset;
+            track.slots.resize(getSlotCount(trackHeader.keyframeCount, windowSize), kInvalidKeyframe);
+            fileOffset += trackHeader.keyframeCount * trackHeader.keyframeSize;
+        }
+
+        mFile.seekg(0, std::ios::end);
+        if (uint64_t(mFile.tellg()) < fileOffset) throw RuntimeError("Vertex cache stream '{}' is truncated.", path.string());
+    }
+
+    VertexCacheStream::~VertexCacheStream()
+    {
+        // Background reads access the file, wait for them before closing it.
+        for (auto& track : mTracks)
+        {
+            for (auto& [keyframeIndex, read] : track.pendingReads)
+            {
+                try
+                {
+                    read.task.finish();
+                }
+                catch (const std::exception& e)
+                {
+                    logWarning("Failed to read keyframe {} from vertex cache stream: {}", keyframeIndex, e.what());
+                }
+            }
+        }
+
+        mFile.close();
+        if (mDeleteOnClose)
+        {
+            std::error_code ec;
+            std::filesystem::remove(mPath, ec);
+        }
+    }
+
+    void VertexCacheStream::write(const std::filesystem::path& path, const std::vector<TrackDesc>& tracks, const ReadCallback& readKeyframe)
+    {
+        std::ofstream fs(path, std::ios::binary);
+        if (!fs) throw RuntimeError("Failed to create vertex cache stream '{}'.", path.string());
+
+        Header header;
+        std::memcpy(header.magic, kMagic, sizeof(header.magic));
+        header.version = kVersion;
+        header.trackCount = (uint32_t)tracks.size();
+        fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        for (const auto& track : tracks)
+        {
+            TrackHeader trackHeader;
+            trackHeader.keyframeCount = track.keyframeCount;
+            trackHeader.keyframeSize = track.keyframeSize;
+            fs.write(reinterpret_cast<const char*>(&trackHeader), sizeof(trackHeader));
+        }
+
+        std::vector<uint8_t> data;
+        for (uint32_t trackIndex = 0; trackIndex < (uint32_t)tracks.size(); trackIndex++)
+        {
+            data.resize(tracks[trackIndex].keyframeSize);
+            for (uint32_t keyframeIndex = 0; keyframeIndex < tracks[trackIndex].keyframeCount; keyframeIndex++)
+            {
+                readKeyframe(trackIndex, keyframeIndex, data.data());
+                fs.write(reinterpret_cast<const char*>(data.data()), data.size());
+            }
+        }
+
+        if (!fs) throw RuntimeError("Failed to write vertex cache stream '{}'.", path.string());
+    }
+
+    VertexCacheStream::UniquePtr VertexCacheStream::open(const std::filesystem::path& path, uint32_t windowSize, bool deleteOnClose)
+    {
+        return UniquePtr(new VertexCacheStream(path, windowSize, deleteOnClose));
+    }
+
+    uint2 VertexCacheStream::update(uint32_t trackIndex, uint2 keyframeIndices, bool wrap, const UploadCallback& upload)
+    {
+        checkArgument(trackIndex < mTracks.size(), "'trackIndex' ({}) is out of range.", trackIndex);
+        auto& track = mTracks[trackIndex];
+        const uint32_t keyframeCount = track.desc.keyframeCount;
+        checkArgument(keyframeIndices.x < keyframeCount && keyframeIndices.y < keyframeCount, "'keyframeIndices' ({}, {}) are out of range.", keyframeIndices.x, keyframeIndices.y);
+
+        // The window holds the requested pair followed by the keyframes to prefetch.
+        std::vector<uint32_t> window;
+        window.reserve(track.slots.size());
+        window.push_back(keyframeIndices.x);
+        if (keyframeIndices.y != keyframeIndices.x) window.push_back(keyframeIndices.y);
+        uint32_t next = keyframeIndices.y;
+        while (window.size() < track.slots.size())
+        {
+            if (++next == keyframeCount)
+            {
+                if (!wrap) break;
+                next = 0;
+            }
+            if (std::find(window.begin(), window.end(), next) != window.end()) break;
+            window.push_back(next);
+        }
+
+        // Drop background reads that fell out of the window. Reads still in flight are kept until they are done.
+        for (auto it = track.pendingReads.begin(); it != track.pendingReads.end();)
+        {
+            bool inWindow = std::find(window.begin(), window.end(), it->first) != window.end();
+            if (!inWindow && !it->second.task.isRunning()) it = track.pendingReads.erase(it);
+            else ++it;
+        }
+
+        uint2 slots;
+        slots.x = makeResident(trackIndex, keyframeIndices.x, window, upload);
+        slots.y = makeResident(trackIndex, keyframeIndices.y, window, upload);
+
+        // Upload prefetched keyframes that are ready and start reading the remaining ones.
+        for (size_t i = 2; i < window.size(); i++)
+        {
+            uint32_t keyframeIndex = window[i];
+            if (getSlot(trackIndex, keyframeIndex) != kInvalidSlot) continue;
+
+            auto it = track.pendingReads.find(keyframeIndex);
+            if (it != track.pendingReads.end())
+            {
+                if (!it->second.task.isRunning()) makeResident(trackIndex, keyframeIndex, window, upload);
+                continue;
+            }
+
+            PendingRead read;
+            read.pData = std::make_shared<std::vector<uint8_t>>(track.desc.keyframeSize);
+            read.task = Threading::dispatchTask([this, trackIndex, keyframeIndex, pData = read.pData]() { readKeyframe(trackIndex, keyframeIndex, pData->data()); });
+            track.pendingReads.emplace(keyframeIndex, std::move(read));
+        }
+
+        return slots;
+    }
+
+    uint32_t VertexCacheStream::getSlot(uint32_t trackIndex, uint32_t keyframeIndex) const
+    {
+        const auto& slots = mTracks[trackIndex].slots;
+        auto it = std::find(slots.begin(), slots.end(), keyframeIndex);
+        return it != slots.end() ? (uint32_t)(it - slots.begin()) : kInvalidSlot;
+    }
+
+    uint64_t VertexCacheStream::getStagingSizeInBytes() const
+    {
+        uint64_t size = 0;
+        for (const auto& track : mTracks) size += track.pendingReads.size() * track.desc.keyframeSize;
+        return size;
+    }
+
+    void VertexCacheStream::readKeyframe(uint32_t trackIndex, uint32_t keyframeIndex, void* pData)
+    {
+        const auto& track = mTracks[trackIndex];
+        std::lock_guard<std::mutex> lock(mFileMutex);
+        mFile.clear();
+        mFile.seekg(track.fileOffset + keyframeIndex * track.desc.keyframeSize);
+        mFile.read(reinterpret_cast<char*>(pData), track.desc.keyframeSize);
+        if (!mFile) throw RuntimeError("Failed to read keyframe {} of track {} from vertex cache stream '{}'.", keyframeIndex, trackIndex, mPath.string());
+    }
+
+    uint32_t VertexCacheStream::makeResident(uint32_t trackIndex, uint32_t keyframeIndex, const std::vector<uint32_t>& window, const UploadCallback& upload)
+    {
+        uint32_t slot = getSlot(trackIndex, keyframeIndex);
+        if (slot != kInvalidSlot) return slot;
+
+        auto& track = mTracks[trackIndex];
+
+        // Take the data from a background read if there is one, otherwise read it now.
+        std::shared_ptr<std::vector<uint8_t>> pData;
+        auto it = track.pendingReads.find(keyframeIndex);
+        if (it != track.pendingReads.end())
+        {
+            if (it->second.task.isRunning()) mStats.stalls++;
+            else mStats.keyframesPrefetched++;
+            pData = std::move(it->second.pData);
+            Threading::Task task = it->second.task;
+            track.pendingReads.erase(it);
+            task.finish();
+        }
+        else
+        {
+            mStats.stalls++;
+            pData = std::make_shared<std::vector<uint8_t>>(track.desc.keyframeSize);
+            readKeyframe(trackIndex, keyframeIndex, pData->data());
+        }
+
+        // Evict a keyframe outside of the window. There is always one as the window is not larger than the number of slots.
+        for (uint32_t i = 0; i < (uint32_t)track.slots.size(); i++)
+        {
+            if (std::find(window.begin(), window.end(), track.slots[i]) == window.end())
+            {
+                slot = i;
+                break;
+            }
+        }
+        FALCOR_ASSERT(slot != kInvalidSlot);
+
+        upload(trackIndex, slot, pData->data(), pData->size());
+        track.slots[slot] = keyframeIndex;
+        mStats.keyframesLoaded++;
+
+        return slot;
+    }
+}
@@ -0,0 +1,158 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/Vector.h"
+#include "Utils/Threading.h"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Falcor
+{
+    /** Streams keyframes of animated vertex caches from a file on disk.
+
+        The keyframes are organized in tracks. All keyframes of a track have the same size and are
+        stored contiguously in the file. Only a window of keyframes around the current playback position
+        is kept resident: each track owns a fixed number of slots, and update() maps the keyframes needed
+        for the current frame to slots, reading missing keyframes and prefetching the following ones on
+        worker threads. The data is handed to a user supplied callback to be uploaded to the slot.
+    */
+    class FALCOR_API VertexCacheStream
+    {
+    public:
+        using UniquePtr = std::unique_ptr<VertexCacheStream>;
+
+        static constexpr uint32_t kInvalidSlot = 0xffffffff;
+        static constexpr uint32_t kInvalidKeyframe = 0xffffffff;
+
+        struct TrackDesc
+        {
+            uint32_t keyframeCount = 0;     ///< Number of keyframes in the track.
+            uint64_t keyframeSize = 0;      ///< Size of a single keyframe in bytes.
+        };
+
+        struct Stats
+        {
+            uint64_t keyframesLoaded = 0;       ///< Number of keyframes uploaded to a slot.
+            uint64_t keyframesPrefetched = 0;   ///< Number of uploaded keyframes that were read ahead of time on a worker thread.
+            uint64_t stalls = 0;                ///< Number of uploaded keyframes that the caller had to read or wait for.
+        };
+
+        /** Callback writing the data of a keyframe to a buffer of `keyframeSize` bytes.
+        */
+        using ReadCallback = std::function<void(uint32_t trackIndex, uint32_t keyframeIndex, void* pData)>;
+
+        /** Callback uploading the data of a keyframe to a slot.
+        */
+        using UploadCallback = std::function<void(uint32_t trackIndex, uint32_t slot, const void* pData, uint64_t size)>;
+
+        ~VertexCacheStream();
+
+        /** Write a keyframe stream file.
+            \param[in] path File path.
+            \param[in] tracks List of tracks.
+            \param[in] readKeyframe Callback providing the data of each keyframe.
+        */
+        static void write(const std::filesystem::path& path, const std::vector<TrackDesc>& tracks, const ReadCallback& readKeyframe);
+
+        /** Open a keyframe stream file.
+            \param[in] path File path.
+            \param[in] windowSize Number of keyframes kept resident per track. Must be at least 2.
+            \param[in] deleteOnClose Delete the file when the stream is destroyed.
+            \return A new object, or throws an exception if the file could not be opened.
+        */
+        static UniquePtr open(const std::filesystem::path& path, uint32_t windowSize, bool deleteOnClose = false);
+
+        /** Get the number of slots for a given keyframe count and window size.
+        */
+        static uint32_t getSlotCount(uint32_t keyframeCount, uint32_t windowSize) { return std::min(keyframeCount, windowSize); }
+
+        uint32_t getTrackCount() const { return (uint32_t)mTracks.size(); }
+        const TrackDesc& getTrack(uint32_t trackIndex) const { return mTracks[trackIndex].desc; }
+        uint32_t getSlotCount(uint32_t trackIndex) const { return (uint32_t)mTracks[trackIndex].slots.size(); }
+        uint32_t getWindowSize() const { return mWindowSize; }
+        const std::filesystem::path& getPath() const { return mPath; }
+
+        /** Make the keyframes needed for the current frame resident and prefetch the keyframes following them.
+            Keyframes that are not yet available are read on the calling thread.
+            \param[in] trackIndex Track index.
+            \param[in] keyframeIndices Pair of keyframes to interpolate between.
+            \param[in] wrap If true, prefetching continues at the first keyframe after the last one (looped playback).
+            \param[in] upload Callback uploading keyframe data to a slot.
+            \return Slots holding the requested pair of keyframes.
+        */
+        uint2 update(uint32_t trackIndex, uint2 keyframeIndices, bool wrap, const UploadCallback& upload);
+
+        /** Get the slot holding a keyframe.
+            \return Slot index or kInvalidSlot if the keyframe is not resident.
+        */
+        uint32_t getSlot(uint32_t trackIndex, uint32_t keyframeIndex) const;
+
+        /** Get the amount of host memory used for keyframes read ahead of time.
+        */
+        uint64_t getStagingSizeInBytes() const;
+
+        const Stats& getStats() const { return mStats; }
+
+    private:
+        struct PendingRead
+        {
+            Threading::Task task;
+            std::shared_ptr<std::vector<uint8_t>> pData;
+        };
+
+        struct Track
+        {
+            TrackDesc desc;
+            uint64_t fileOffset = 0;
+            std::vector<uint32_t> slots;                    ///< Keyframe held by each slot.
+            std::map<uint32_t, PendingRead> pendingReads;   ///< Background reads keyed by keyframe index.
+        };
+
+        VertexCacheStream(const std::filesystem::path& path, uint32_t windowSize, bool deleteOnClose);
+
+        void readKeyframe(uint32_t trackIndex, uint32_t keyframeIndex, void* pData);
+        uint32_t makeResident(uint32_t trackIndex, uint32_t keyframeIndex, const std::vector<uint32_t>& window, const UploadCallback& upload);
+
+        std::filesystem::path mPath;
+        uint32_t mWindowSize = 0;
+        bool mDeleteOnClose = false;
+
+        std::vector<Track> mTracks;
+        std::ifstream mFile;
+        std::mutex mFileMutex;          ///< Guards mFile, which is shared by background reads.
+        Stats mStats;
+    };
+}
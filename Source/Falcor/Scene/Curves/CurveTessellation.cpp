@@ -31,6 +31,7 @@
 #include "Utils/Math/MathHelpers.h"
 #include "Utils/Math/CubicSpline.h"
 #include "Utils/Math/Matrix/Matrix.h"
+#include "Utils/Threading.h"
 #include <glm/gtx/quaternion.hpp>
 #include <cmath>
 
@@ -83,7 +84,67 @@ namespace Falcor
             return float4(xyz, sphere.w * scale);
         }
 
-        void optimizeStrandGeometry(CubicSplineCache& splineCache, const CurveArrays& curveArrays, StrandArrays& strandArrays, StrandArrays& optimizedStrandArrays, uint32_t pointOffset, uint32_t subdivPerSegment, uint32_t keepOneEveryXVerticesPerStrand, float widthScale)
+        /** Output layout of the kept strands. It is computed in a first pass so that the strands can be tessellated in parallel,
+            writing directly into the preallocated result arrays.
+        */
+        struct StrandLayout
+        {
+            std::vector<uint32_t> inputOffsets;     ///< Offset of the first control point of each kept strand in the input arrays.
+            std::vector<uint32_t> outputOffsets;    ///< Offset of the first tessellated point of each kept strand. The total point count is appended.
+            uint32_t maxVertexCountPerStrand = 0;
+
+            uint32_t getStrandCount() const { return (uint32_t)inputOffsets.size(); }
+            uint32_t getPointCount() const { return outputOffsets.back(); }
+        };
+
+        uint32_t countUniqueControlPoints(const float3* controlPoints, uint32_t vertexCount)
+        {
+            uint32_t count = 1;
+            for (uint32_t j = 0; j < vertexCount - 1; j++)
+            {
+                if (controlPoints[j] != controlPoints[j + 1]) count++;
+            }
+            return count;
+        }
+
+        StrandLayout computeStrandLayout(uint32_t strandCount, const uint32_t* vertexCountsPerStrand, const float3* controlPoints, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand)
+        {
+            StrandLayout layout;
+            const uint32_t keptStrandCount = div_round_up(strandCount, keepOneEveryXStrands);
+            layout.inputOffsets.resize(keptStrandCount);
+            layout.outputOffsets.resize(keptStrandCount + 1);
+
+            uint32_t pointOffset = 0;
+            for (uint32_t i = 0; i < strandCount; i++)
+            {
+                if (i % keepOneEveryXStrands == 0)
+                {
+                    layout.inputOffsets[i / keepOneEveryXStrands] = pointOffset;
+                    layout.maxVertexCountPerStrand = std::max(layout.maxVertexCountPerStrand, vertexCountsPerStrand[i]);
+                }
+                pointOffset += vertexCountsPerStrand[i];
+            }
+
+            // Duplicate control points are removed before tessellation, so the point counts depend on the control points.
+            Threading::parallelFor(0, keptStrandCount, [&](size_t s)
+            {
+                uint32_t uniqueCount = countUniqueControlPoints(controlPoints + layout.inputOffsets[s], vertexCountsPerStrand[s * keepOneEveryXStrands]);
+                layout.outputOffsets[s] = div_round_up(subdivPerSegment * (uniqueCount - 1), keepOneEveryXVerticesPerStrand) + 1;
+            });
+
+            uint32_t outputOffset = 0;
+            for (uint32_t s = 0; s < keptStrandCount; s++)
+            {
+                uint32_t pointCount = layout.outputOffsets[s];
+                layout.outputOffsets[s] = outputOffset;
+                outputOffset += pointCount;
+            }
+            layout.outputOffsets[keptStrandCount] = outputOffset;
+
+            return layout;
+        }
+
+        uint32_t removeDuplicateControlPoints(const CurveArrays& curveArrays, StrandArrays& strandArrays, uint32_t pointOffset)
         {
             strandArrays.controlPoints.clear();
             strandArrays.UVs.clear();
@@ -105,7 +166,12 @@ namespace Falcor
             strandArrays.widths.push_back(curveArrays.widths[pointOffset + strandArrays.vertexCount - 1]);
             if (curveArrays.UVs) strandArrays.UVs.push_back(curveArrays.UVs[pointOffset + strandArrays.vertexCount - 1]);
 
-            optimizedStrandArrays.vertexCount = static_cast<uint32_t>(strandArrays.controlPoints.size());
+            return static_cast<uint32_t>(strandArrays.controlPoints.size());
+        }
+
+        void optimizeStrandGeometry(CubicSplineCache& splineCache, const CurveArrays& curveArrays, StrandArrays& strandArrays, StrandArrays& optimizedStrandArrays, uint32_t pointOffset, uint32_t subdivPerSegment, uint32_t keepOneEveryXVerticesPerStrand, float widthScale)
+        {
+            optimizedStrandArrays.vertexCount = removeDuplicateControlPoints(curveArrays, strandArrays, pointOffset);
 
             const CubicSpline<float3>& splinePoints = splineCache.optSplinePoints.setup(strandArrays.controlPoints.data(), optimizedStrandArrays.vertexCount);
             const CubicSpline<float>& splineWidths = splineCache.optSplineWidths.setup(strandArrays.widths.data(), optimizedStrandArrays.vertexCount);
@@ -183,7 +249,7 @@ namespace Falcor
             t = glm::rotate(rotQuat, t);
         }
 
-        void updateMeshResultBuffers(CurveTessellation::MeshResult& result, const CurveArrays& curveArrays, StrandArrays& optimizedStrandArrays, const float3& fwd, const float3& s, const float3& t, uint32_t pointCountPerCrossSection, const float& widthScale, uint32_t j)
+        void updateMeshResultBuffers(CurveTessellation::MeshResult& result, const CurveArrays& curveArrays, StrandArrays& optimizedStrandArrays, const float3& fwd, const float3& s, const float3& t, uint32_t pointCountPerCrossSection, const float& widthScale, uint32_t vertexOffset, uint32_t j)
         {
             // Mesh vertices, normals, tangents, and texCrds (if any).
             for (uint32_t k = 0; k < pointCountPerCrossSection; k++)
@@ -192,31 +258,34 @@ namespace Falcor
                 float3 vNormal = std::cos(phi) * s + std::sin(phi) * t;
 
                 float curveRadius = 0.5f * optimizedStrandArrays.widths[j];
-                result.vertices.push_back(optimizedStrandArrays.controlPoints[j] + curveRadius * vNormal);
-                result.normals.push_back(vNormal);
-                result.tangents.push_back(float4(fwd.x, fwd.y, fwd.z, 1));
-                result.radii.push_back(curveRadius);
+                const uint32_t v = vertexOffset + k;
+                result.vertices[v] = optimizedStrandArrays.controlPoints[j] + curveRadius * vNormal;
+                result.normals[v] = vNormal;
+                result.tangents[v] = float4(fwd.x, fwd.y, fwd.z, 1);
+                result.radii[v] = curveRadius;
 
                 if (curveArrays.UVs)
                 {
-                    result.texCrds.push_back(optimizedStrandArrays.UVs[j]);
+                    result.texCrds[v] = optimizedStrandArrays.UVs[j];
                 }
             }
         }
 
-        void connectFaceVertices(CurveTessellation::MeshResult& result, uint32_t meshVertexOffset, uint32_t pointCountPerCrossSection, uint32_t quadCountLimit, uint32_t nextCrossSectionVertexOffset, uint32_t multiplier, uint32_t j)
+        void connectFaceVertices(CurveTessellation::MeshResult& result, uint32_t meshVertexOffset, uint32_t pointCountPerCrossSection, uint32_t quadCountLimit, uint32_t nextCrossSectionVertexOffset, uint32_t multiplier, uint32_t faceOffset, uint32_t j)
         {
+            uint32_t* faceVertexCounts = &result.faceVertexCounts[faceOffset];
+            uint32_t* faceVertexIndices = &result.faceVertexIndices[3 * faceOffset];
             for (uint32_t k = 0; k < quadCountLimit; k++)
             {
-                result.faceVertexCounts.push_back(3);
-                result.faceVertexIndices.push_back(meshVertexOffset + multiplier * j * pointCountPerCrossSection + k);
-                result.faceVertexIndices.push_back(meshVertexOffset + multiplier * j * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection);
-                result.faceVertexIndices.push_back(meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection);
-
-                result.faceVertexCounts.push_back(3);
-                result.faceVertexIndices.push_back(meshVertexOffset + multiplier * j * pointCountPerCrossSection + k);
-                result.faceVertexIndices.push_back(meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection);
-                result.faceVertexIndices.push_back(meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + k);
+                *faceVertexCounts++ = 3;
+                *faceVertexIndices++ = meshVertexOffset + multiplier * j * pointCountPerCrossSection + k;
+                *faceVertexIndices++ = meshVertexOffset + multiplier * j * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection;
+                *faceVertexIndices++ = meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection;
+
+                *faceVertexCounts++ = 3;
+                *faceVertexIndices++ = meshVertexOffset + multiplier * j * pointCountPerCrossSection + k;
+                *faceVertexIndices++ = meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection;
+                *faceVertexIndices++ = meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + k;
             }
         }
     }
@@ -230,93 +299,88 @@ namespace Falcor
         FALCOR_ASSERT(degree == 1);
         result.degree = degree;
 
-        uint32_t pointCounts = 0;
-        uint32_t segCounts = 0;
-        uint32_t maxVertexCountsPerStrand = 0;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
-        {
-            uint32_t tmpPointCount = div_round_up(subdivPerSegment * (vertexCountsPerStrand[i] - 1), keepOneEveryXVerticesPerStrand) + 1;
-            pointCounts += tmpPointCount;
-            segCounts += tmpPointCount - 1;
-            maxVertexCountsPerStrand = std::max(maxVertexCountsPerStrand, vertexCountsPerStrand[i]);
-        }
-        result.indices.reserve(segCounts);
-        result.points.reserve(pointCounts);
-        result.radius.reserve(pointCounts);
-        result.texCrds.reserve(pointCounts);
-
-        uint32_t pointOffset = 0;
+        // Count the points of each strand and allocate the result arrays.
+        const StrandLayout layout = computeStrandLayout(strandCount, vertexCountsPerStrand, controlPoints, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand);
+        const uint32_t keptStrandCount = layout.getStrandCount();
+        result.indices.resize(layout.getPointCount() - keptStrandCount);
+        result.points.resize(layout.getPointCount());
+        result.radius.resize(layout.getPointCount());
+        if (UVs) result.texCrds.resize(layout.getPointCount());
 
-        StrandArrays strandArrays;
-        strandArrays.controlPoints.reserve(maxVertexCountsPerStrand);
-        strandArrays.widths.reserve(maxVertexCountsPerStrand);
-        strandArrays.UVs.reserve(maxVertexCountsPerStrand);
         CurveArrays curveArrays(controlPoints, widths, UVs);
 
-        StrandArrays optimizedStrandArrays;
-        CubicSplineCache splineCache;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+        // Tessellate the strands in parallel. Each strand writes to its own range of the result arrays.
+        Threading::parallelForChunks(0, keptStrandCount, [&](size_t begin, size_t end)
         {
-            optimizedStrandArrays.controlPoints.clear();
-            optimizedStrandArrays.UVs.clear();
-            optimizedStrandArrays.widths.clear();
-            optimizedStrandArrays.vertexCount = 0;
-            strandArrays.vertexCount = vertexCountsPerStrand[i];
-
-            optimizeStrandGeometry(splineCache, curveArrays, strandArrays, optimizedStrandArrays, pointOffset, subdivPerSegment, keepOneEveryXVerticesPerStrand, widthScale);
+            StrandArrays strandArrays;
+            strandArrays.controlPoints.reserve(layout.maxVertexCountPerStrand);
+            strandArrays.widths.reserve(layout.maxVertexCountPerStrand);
+            strandArrays.UVs.reserve(layout.maxVertexCountPerStrand);
+            CubicSplineCache splineCache;
 
-            const CubicSpline<float3>& splinePoints = splineCache.splinePoints.setup(strandArrays.controlPoints.data(), optimizedStrandArrays.vertexCount);
-            const CubicSpline<float>& splineWidths = splineCache.splineWidths.setup(strandArrays.widths.data(), optimizedStrandArrays.vertexCount);
-
-            uint32_t tmpCount = 0;
-            for (uint32_t j = 0; j < optimizedStrandArrays.vertexCount - 1; j++)
+            for (uint32_t strandIndex = (uint32_t)begin; strandIndex < (uint32_t)end; strandIndex++)
             {
-                for (uint32_t k = 0; k < subdivPerSegment; k++)
-                {
-                    if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
-                    {
-                        float t = (float)k / (float)subdivPerSegment;
-                        result.indices.push_back((uint32_t)result.points.size());
-
-                        // Pre-transform curve points.
-                        float4 sph = transformSphere(xform, float4(splinePoints.interpolate(j, t), splineWidths.interpolate(j, t) * 0.5f * widthScale));
+                strandArrays.vertexCount = vertexCountsPerStrand[strandIndex * keepOneEveryXStrands];
+                const uint32_t vertexCount = removeDuplicateControlPoints(curveArrays, strandArrays, layout.inputOffsets[strandIndex]);
 
-                        result.points.push_back(sph.xyz);
-                        result.radius.push_back(sph.w);
-                    }
-                    tmpCount++;
-                }
-            }
+                const CubicSpline<float3>& splinePoints = splineCache.splinePoints.setup(strandArrays.controlPoints.data(), vertexCount);
+                const CubicSpline<float>& splineWidths = splineCache.splineWidths.setup(strandArrays.widths.data(), vertexCount);
 
-            // Always keep the last vertex.
-            float4 sph = transformSphere(xform, float4(splinePoints.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f), splineWidths.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f) * 0.5f * widthScale));
-            result.points.push_back(sph.xyz);
-            result.radius.push_back(sph.w);
+                // Each preceding strand has one more point than segments.
+                uint32_t pointIndex = layout.outputOffsets[strandIndex];
+                uint32_t segmentIndex = pointIndex - strandIndex;
 
-            // Texture coordinates.
-            if (UVs)
-            {
-                const CubicSpline<float2>& splineUVs = splineCache.splineUVs.setup(strandArrays.UVs.data(), optimizedStrandArrays.vertexCount);
-                tmpCount = 0;
-                for (uint32_t j = 0; j < optimizedStrandArrays.vertexCount - 1; j++)
+                uint32_t tmpCount = 0;
+                for (uint32_t j = 0; j < vertexCount - 1; j++)
                 {
                     for (uint32_t k = 0; k < subdivPerSegment; k++)
                     {
                         if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
                         {
                             float t = (float)k / (float)subdivPerSegment;
-                            result.texCrds.push_back(splineUVs.interpolate(j, t));
+                            result.indices[segmentIndex++] = pointIndex;
+
+                            // Pre-transform curve points.
+                            float4 sph = transformSphere(xform, float4(splinePoints.interpolate(j, t), splineWidths.interpolate(j, t) * 0.5f * widthScale));
+
+                            result.points[pointIndex] = sph.xyz;
+                            result.radius[pointIndex] = sph.w;
+                            pointIndex++;
                         }
                         tmpCount++;
                     }
                 }
 
                 // Always keep the last vertex.
-                result.texCrds.push_back(splineUVs.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f));
-            }
+                float4 sph = transformSphere(xform, float4(splinePoints.interpolate(vertexCount - 2, 1.f), splineWidths.interpolate(vertexCount - 2, 1.f) * 0.5f * widthScale));
+                result.points[pointIndex] = sph.xyz;
+                result.radius[pointIndex] = sph.w;
+                FALCOR_ASSERT(pointIndex + 1 == layout.outputOffsets[strandIndex + 1]);
 
-            for (uint32_t j = i; j < std::min(strandCount, i + keepOneEveryXStrands); j++) pointOffset += vertexCountsPerStrand[j];
-        }
+                // Texture coordinates.
+                if (UVs)
+                {
+                    const CubicSpline<float2>& splineUVs = splineCache.splineUVs.setup(strandArrays.UVs.data(), vertexCount);
+                    pointIndex = layout.outputOffsets[strandIndex];
+                    tmpCount = 0;
+                    for (uint32_t j = 0; j < vertexCount - 1; j++)
+                    {
+                        for (uint32_t k = 0; k < subdivPerSegment; k++)
+                        {
+                            if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
+                            {
+                                float t = (float)k / (float)subdivPerSegment;
+                                result.texCrds[pointIndex++] = splineUVs.interpolate(j, t);
+                            }
+                            tmpCount++;
+                        }
+                    }
+
+                    // Always keep the last vertex.
+                    result.texCrds[pointIndex] = splineUVs.interpolate(vertexCount - 2, 1.f);
+                }
+            }
+        });
 
         return result;
     }
@@ -324,74 +388,72 @@ namespace Falcor
     CurveTessellation::MeshResult CurveTessellation::convertToPolytube(uint32_t strandCount, const uint32_t* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, uint32_t pointCountPerCrossSection)
     {
         MeshResult result;
-        uint32_t vertexCounts = 0;
-        uint32_t faceCounts = 0;
-        uint32_t maxVertexCountsPerStrand = 0;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
-        {
-            uint32_t tmpPointCount = div_round_up(subdivPerSegment * (vertexCountsPerStrand[i] - 1), keepOneEveryXVerticesPerStrand) + 1;
-            vertexCounts += pointCountPerCrossSection * tmpPointCount;
-            faceCounts += 2 * pointCountPerCrossSection * (tmpPointCount - 1);
-            maxVertexCountsPerStrand = std::max(maxVertexCountsPerStrand, vertexCountsPerStrand[i]);
-        }
-        result.vertices.reserve(vertexCounts);
-        result.normals.reserve(vertexCounts);
-        result.tangents.reserve(vertexCounts);
-        result.texCrds.reserve(vertexCounts);
-        result.radii.reserve(vertexCounts);
-        result.faceVertexCounts.reserve(faceCounts);
-        result.faceVertexIndices.reserve(faceCounts * 3);
-
-        uint32_t pointOffset = 0;
-        uint32_t meshVertexOffset = 0;
-
-        StrandArrays strandArrays;
-        strandArrays.controlPoints.reserve(maxVertexCountsPerStrand);
-        strandArrays.widths.reserve(maxVertexCountsPerStrand);
-        strandArrays.UVs.reserve(maxVertexCountsPerStrand);
+
+        // Count the cross-sections of each strand and allocate the result arrays.
+        const StrandLayout layout = computeStrandLayout(strandCount, vertexCountsPerStrand, controlPoints, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand);
+        const uint32_t keptStrandCount = layout.getStrandCount();
+        const uint32_t vertexCounts = pointCountPerCrossSection * layout.getPointCount();
+        const uint32_t faceCounts = 2 * pointCountPerCrossSection * (layout.getPointCount() - keptStrandCount);
+        result.vertices.resize(vertexCounts);
+        result.normals.resize(vertexCounts);
+        result.tangents.resize(vertexCounts);
+        if (UVs) result.texCrds.resize(vertexCounts);
+        result.radii.resize(vertexCounts);
+        result.faceVertexCounts.resize(faceCounts);
+        result.faceVertexIndices.resize(faceCounts * 3);
+
         CurveArrays curveArrays(controlPoints, widths, UVs);
 
-        StrandArrays optimizedStrandArrays;
-        CubicSplineCache splineCache;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+        // Tessellate the strands in parallel. Each strand writes to its own range of the result arrays.
+        Threading::parallelForChunks(0, keptStrandCount, [&](size_t begin, size_t end)
         {
-            optimizedStrandArrays.controlPoints.clear();
-            optimizedStrandArrays.UVs.clear();
-            optimizedStrandArrays.widths.clear();
-            optimizedStrandArrays.vertexCount = 0;
+            StrandArrays strandArrays;
+            strandArrays.controlPoints.reserve(layout.maxVertexCountPerStrand);
+            strandArrays.widths.reserve(layout.maxVertexCountPerStrand);
+            strandArrays.UVs.reserve(layout.maxVertexCountPerStrand);
+
+            StrandArrays optimizedStrandArrays;
+            CubicSplineCache splineCache;
+            for (uint32_t strandIndex = (uint32_t)begin; strandIndex < (uint32_t)end; strandIndex++)
+            {
+                optimizedStrandArrays.controlPoints.clear();
+                optimizedStrandArrays.UVs.clear();
+                optimizedStrandArrays.widths.clear();
+                optimizedStrandArrays.vertexCount = 0;
 
-            strandArrays.vertexCount = vertexCountsPerStrand[i];
+                strandArrays.vertexCount = vertexCountsPerStrand[strandIndex * keepOneEveryXStrands];
 
-            optimizeStrandGeometry(splineCache, curveArrays, strandArrays, optimizedStrandArrays, pointOffset, subdivPerSegment, keepOneEveryXVerticesPerStrand, widthScale);
+                optimizeStrandGeometry(splineCache, curveArrays, strandArrays, optimizedStrandArrays, layout.inputOffsets[strandIndex], subdivPerSegment, keepOneEveryXVerticesPerStrand, widthScale);
+                FALCOR_ASSERT(optimizedStrandArrays.controlPoints.size() == layout.outputOffsets[strandIndex + 1] - layout.outputOffsets[strandIndex]);
 
-            for (uint32_t j = i; j < std::min(strandCount, i + keepOneEveryXStrands); j++) pointOffset += vertexCountsPerStrand[j];
+                // Each preceding strand has one more cross-section than segments.
+                const uint32_t meshVertexOffset = pointCountPerCrossSection * layout.outputOffsets[strandIndex];
+                const uint32_t faceOffset = 2 * pointCountPerCrossSection * (layout.outputOffsets[strandIndex] - strandIndex);
 
-            // Build the initial frame.
-            float3 fwd, s, t;
-            fwd = normalize(optimizedStrandArrays.controlPoints[1] - optimizedStrandArrays.controlPoints[0]);
-            buildFrame(fwd, s, t);
+                // Build the initial frame.
+                float3 fwd, s, t;
+                fwd = normalize(optimizedStrandArrays.controlPoints[1] - optimizedStrandArrays.controlPoints[0]);
+                buildFrame(fwd, s, t);
 
-            // Create mesh.
-            for (uint32_t j = 0; j < optimizedStrandArrays.controlPoints.size(); j++)
-            {
-                // Update the curve's frame vectors: [fwd, s, t]
-                updateCurveFrame(optimizedStrandArrays, fwd, s, t, j);
+                // Create mesh.
+                for (uint32_t j = 0; j < optimizedStrandArrays.controlPoints.size(); j++)
+                {
+                    // Update the curve's frame vectors: [fwd, s, t]
+                    updateCurveFrame(optimizedStrandArrays, fwd, s, t, j);
 
-                // Mesh vertices, normals, tangents, and texCrds (if any).
-                updateMeshResultBuffers(result, curveArrays, optimizedStrandArrays, fwd, s, t, pointCountPerCrossSection, widthScale, j);
+                    // Mesh vertices, normals, tangents, and texCrds (if any).
+                    updateMeshResultBuffers(result, curveArrays, optimizedStrandArrays, fwd, s, t, pointCountPerCrossSection, widthScale, meshVertexOffset + j * pointCountPerCrossSection, j);
 
-                // Mesh faces.
-                if (j < optimizedStrandArrays.controlPoints.size() - 1)
-                {
-                    uint32_t quadCountLimit = pointCountPerCrossSection;
-                    connectFaceVertices(result, meshVertexOffset, pointCountPerCrossSection, quadCountLimit, 1, 1, j);
+                    // Mesh faces.
+                    if (j < optimizedStrandArrays.controlPoints.size() - 1)
+                    {
+                        uint32_t quadCountLimit = pointCountPerCrossSection;
+                        connectFaceVertices(result, meshVertexOffset, pointCountPerCrossSection, quadCountLimit, 1, 1, faceOffset + 2 * pointCountPerCrossSection * j, j);
+                    }
                 }
             }
+        });
 
-            meshVertexOffset += pointCountPerCrossSection * (uint32_t)optimizedStrandArrays.controlPoints.size();
-        }
         return result;
     }
-
-
 }
@@ -30,7 +30,7 @@
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
-#include "Utils/NumericRange.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Math/FalcorMath.h"
@@ -39,12 +39,12 @@
 #include "Scene/Material/Material.h"
 #include "Scene/Material/StandardMaterial.h"
 
+#include <assimp/DefaultIOSystem.h>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 #include <assimp/pbrmaterial.h>
 
-#include <execution>
 #include <fstream>
 
 namespace Falcor
@@ -539,8 +539,7 @@ namespace Falcor
 
             // Pre-process meshes.
             std::vector<SceneBuilder::ProcessedMesh> processedMeshes(meshes.size());
-            auto range = NumericRange<size_t>(0, meshes.size());
-            std::for_each(std::execution::par, range.begin(), range.end(), [&] (size_t i) {
+            Threading::parallelFor(0, meshes.size(), [&] (size_t i) {
                 const aiMesh* pAiMesh = meshes[i];
                 const uint32_t perFaceIndexCount = pAiMesh->mFaces[0].mNumIndices;
 
@@ -976,6 +975,25 @@ namespace Falcor
 
             validateBones(data);
         }
+
+        /** Assimp IO system that records the files opened while importing.
+            This captures files referenced by the scene file, like the .mtl files of .obj scenes or the buffers of .gltf scenes.
+        */
+        class RecordingIOSystem : public Assimp::DefaultIOSystem
+        {
+        public:
+            Assimp::IOStream* Open(const char* pFile, const char* pMode) override
+            {
+                Assimp::IOStream* pStream = DefaultIOSystem::Open(pFile, pMode);
+                if (pStream) mOpenedFiles.push_back(pFile);
+                return pStream;
+            }
+
+            const std::vector<std::filesystem::path>& getOpenedFiles() const { return mOpenedFiles; }
+
+        private:
+            std::vector<std::filesystem::path> mOpenedFiles;
+        };
     }
 
     void AssimpImporter::import(const std::filesystem::path& path, SceneBuilder& builder, const Dictionary& dict)
@@ -1009,8 +1027,13 @@ namespace Falcor
         Assimp::Importer importer;
         importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, removeFlags);
 
+        // The importer takes ownership of the IO system.
+        auto pIOSystem = new RecordingIOSystem();
+        importer.SetIOHandler(pIOSystem);
+
         const aiScene* pScene = importer.ReadFile(fullPath.string().c_str(), assimpFlags);
         if (!pScene) throw ImporterError(path, "Failed to open scene: {}", importer.GetErrorString());
+        for (const auto& openedPath : pIOSystem->getOpenedFiles()) builder.addCacheDependency(openedPath);
         timeReport.measure("Loading asset file");
 
         ImporterData data(path, pScene, builder);
@@ -149,6 +149,32 @@ namespace Falcor
             return mAreaLights[lightIndex];
         }
 
+        void BasicScene::addIncludedFile(std::filesystem::path path)
+        {
+            mIncludedFiles.push_back(std::move(path));
+        }
+
+        void BasicScene::mergeImported(BasicScene& imported, const std::function<void(MaterialSceneEntity&)>& remapMaterial, const std::function<void(ShapeSceneEntity&)>& remapShape)
+        {
+            for (auto& material : imported.mMaterials)
+            {
+                remapMaterial(material);
+                mMaterials.push_back(std::move(material));
+            }
+            std::move(imported.mAreaLights.begin(), imported.mAreaLights.end(), std::back_inserter(mAreaLights));
+            std::move(imported.mLights.begin(), imported.mLights.end(), std::back_inserter(mLights));
+            std::move(imported.mMedia.begin(), imported.mMedia.end(), std::back_inserter(mMedia));
+            mNamedMaterials.merge(imported.mNamedMaterials);
+            mFloatTextures.merge(imported.mFloatTextures);
+            mSpectrumTextures.merge(imported.mSpectrumTextures);
+            for (auto& [name, instanceDefinition] : imported.mInstanceDefinitions)
+            {
+                for (auto& shape : instanceDefinition.shapes) remapShape(shape);
+                mInstanceDefinitions.emplace(name, std::move(instanceDefinition));
+            }
+            std::move(imported.mIncludedFiles.begin(), imported.mIncludedFiles.end(), std::back_inserter(mIncludedFiles));
+        }
+
         std::filesystem::path BasicScene::resolvePath(const std::filesystem::path& path) const
         {
             if (path.is_absolute()) return path;
@@ -445,6 +471,94 @@ namespace Falcor
             mInstances.push_back(std::move(instance));
         }
 
+        void BasicSceneBuilder::onInclude(const std::filesystem::path& path, FileLoc loc)
+        {
+            mScene.addIncludedFile(path);
+        }
+
+        std::unique_ptr<ParserTarget> BasicSceneBuilder::onImportBegin(const std::filesystem::path& path, FileLoc loc)
+        {
+            VERIFY_WORLD("Import");
+
+            if (mpActiveInstanceDefinition)
+            {
+                throwError(loc, "Import can't be called inside instance definition.");
+            }
+
+            mScene.addIncludedFile(path);
+
+            // The imported file is built into its own scene, starting from the current graphics state.
+            // Materials created by the imported file are indexed after the materials that exist at this point,
+            // so inherited material references can be told apart when merging.
+            auto pImportedScene = std::make_unique<BasicScene>(mScene.getSearchPath());
+            auto pBuilder = std::make_unique<BasicSceneBuilder>(*pImportedScene);
+            pBuilder->mpImportedScene = std::move(pImportedScene);
+            pBuilder->mCurrentBlock = mCurrentBlock;
+            pBuilder->mGraphicsState = mGraphicsState;
+            pBuilder->mNamedCoordinateSystems = mNamedCoordinateSystems;
+            pBuilder->mImportedMaterialIndexBase = mImportedMaterialIndexBase + (uint32_t)mScene.getMaterials().size();
+            return pBuilder;
+        }
+
+        void BasicSceneBuilder::onImportEnd(std::unique_ptr<ParserTarget> pImportTarget, FileLoc loc)
+        {
+            auto pBuilder = dynamic_cast<BasicSceneBuilder*>(pImportTarget.get());
+            FALCOR_ASSERT(pBuilder && pBuilder->mpImportedScene);
+
+            if (pBuilder->mpActiveInstanceDefinition)
+            {
+                throwError(loc, "Missing end to ObjectBegin in imported file.");
+            }
+
+            if (!pBuilder->mStack.empty())
+            {
+                throwError(loc, "Missing end to AttributeBegin in imported file.");
+            }
+
+            auto mergeNames = [&](std::set<std::string>& names, const std::set<std::string>& importedNames, const char* type)
+            {
+                for (const auto& name : importedNames)
+                {
+                    if (!names.insert(name).second) throwError(loc, "Imported file redefines {} '{}'.", type, name);
+                }
+            };
+            mergeNames(mNamedMaterialNames, pBuilder->mNamedMaterialNames, "named material");
+            mergeNames(mMediumNames, pBuilder->mMediumNames, "medium");
+            mergeNames(mFloatTextureNames, pBuilder->mFloatTextureNames, "float texture");
+            mergeNames(mSpectrumTextureNames, pBuilder->mSpectrumTextureNames, "spectrum texture");
+            mergeNames(mInstanceNames, pBuilder->mInstanceNames, "object instance");
+
+            // Material indices created by the imported file are relative to its base index.
+            // Indices below the base refer to materials of this scene and are kept as is.
+            const uint32_t materialIndexBase = pBuilder->mImportedMaterialIndexBase;
+            const uint32_t materialOffset = mImportedMaterialIndexBase + (uint32_t)mScene.getMaterials().size();
+            const uint32_t areaLightOffset = mScene.getAreaLightCount();
+
+            auto remapShape = [&](ShapeSceneEntity& shape)
+            {
+                if (uint32_t* pIndex = std::get_if<uint32_t>(&shape.materialRef); pIndex && *pIndex >= materialIndexBase)
+                {
+                    *pIndex = *pIndex - materialIndexBase + materialOffset;
+                }
+                if (shape.lightIndex >= 0) shape.lightIndex += areaLightOffset;
+            };
+            auto remapMaterial = [&](MaterialSceneEntity& material)
+            {
+                material.name = fmt::format("Unnamed{}", mUnamedMaterialIndex++);
+            };
+
+            mScene.mergeImported(*pBuilder->mpImportedScene, remapMaterial, remapShape);
+
+            // Imported files are merged after the importing file has been parsed, so their shapes and instances
+            // are appended after all shapes and instances of the importing file, not at the position of the Import directive.
+            for (auto& shape : pBuilder->mShapes)
+            {
+                remapShape(shape);
+                mShapes.push_back(std::move(shape));
+            }
+            std::move(pBuilder->mInstances.begin(), pBuilder->mInstances.end(), std::back_inserter(mInstances));
+        }
+
         void BasicSceneBuilder::onEndOfFiles()
         {
             if (mCurrentBlock != BlockState::WorldBlock)
@@ -601,7 +715,7 @@ namespace Falcor
             VERIFY_WORLD("Material");
             ParameterDictionary dict(std::move(params), mGraphicsState.materialAttributes, mGraphicsState.pColorSpace);
 
-            mGraphicsState.currentMaterial = mScene.addMaterial(MaterialSceneEntity(fmt::format("Unnamed{}", mUnamedMaterialIndex++), name, std::move(dict), loc));
+            mGraphicsState.currentMaterial = mImportedMaterialIndexBase + mScene.addMaterial(MaterialSceneEntity(fmt::format("Unnamed{}", mUnamedMaterialIndex++), name, std::move(dict), loc));
         }
 
         void BasicSceneBuilder::onMakeNamedMaterial(const std::string& name, ParsedParameterVector params, FileLoc loc)
@@ -40,6 +40,7 @@
 #include <glm/gtx/string_cast.hpp>
 
 #include <filesystem>
+#include <functional>
 #include <map>
 #include <set>
 #include <string>
@@ -228,7 +229,7 @@ namespace Falcor
             rmcv::mat4 transform;
         };
 
-        class BasicScene
+        class FALCOR_API BasicScene
         {
         public:
             BasicScene(const std::filesystem::path& searchPath);
@@ -246,6 +247,15 @@ namespace Falcor
             void addShapes(std::vector<ShapeSceneEntity>& shapes);
             void addInstanceDefinition(InstanceDefinitionSceneEntity instanceDefinition);
             void addInstances(std::vector<InstanceSceneEntity>& instances);
+            void addIncludedFile(std::filesystem::path path);
+
+            /** Merge the entities of a scene built from an imported file into this scene.
+                Materials, area lights, lights, media, textures, instance definitions, shapes and instances are appended in order.
+                \param[in] imported Scene built from the imported file. Its entities are moved out.
+                \param[in] remapMaterial Callback to adjust unnamed materials before they are added.
+                \param[in] remapShape Callback to adjust material and area light references of shapes in instance definitions.
+            */
+            void mergeImported(BasicScene& imported, const std::function<void(MaterialSceneEntity&)>& remapMaterial, const std::function<void(ShapeSceneEntity&)>& remapShape);
 
             const CameraSceneEntity& getCamera() const { return mCamera; }
 
@@ -258,6 +268,9 @@ namespace Falcor
             const std::vector<ShapeSceneEntity>& getShapes() const { return mShapes; }
             const std::map<std::string, InstanceDefinitionSceneEntity>& getInstanceDefinitions() const { return mInstanceDefinitions; }
             const std::vector<InstanceSceneEntity>& getInstances() const { return mInstances; }
+            const std::vector<std::filesystem::path>& getIncludedFiles() const { return mIncludedFiles; }
+            const std::filesystem::path& getSearchPath() const { return mSearchPath; }
+            uint32_t getAreaLightCount() const { return (uint32_t)mAreaLights.size(); }
 
             /** Get a named or unnamed material.
             */
@@ -290,6 +303,8 @@ namespace Falcor
 
             std::map<std::string, InstanceDefinitionSceneEntity> mInstanceDefinitions;
             std::vector<InstanceSceneEntity> mInstances;
+
+            std::vector<std::filesystem::path> mIncludedFiles;
         };
 
         constexpr uint32_t kMaxTransforms = 2;
@@ -338,7 +353,7 @@ namespace Falcor
             Transform t[kMaxTransforms];
         };
 
-        class BasicSceneBuilder : public ParserTarget
+        class FALCOR_API BasicSceneBuilder : public ParserTarget
         {
         public:
             BasicSceneBuilder(BasicScene& scene);
@@ -382,6 +397,15 @@ namespace Falcor
             void onObjectEnd(FileLoc loc) override;
             void onObjectInstance(const std::string& name, FileLoc loc) override;
 
+            void onInclude(const std::filesystem::path& path, FileLoc loc) override;
+            std::unique_ptr<ParserTarget> onImportBegin(const std::filesystem::path& path, FileLoc loc) override;
+
+            /** Merge the scene built from an imported file into this scene.
+                The entities of the imported file are appended after the entities of the importing file,
+                i.e. shapes defined after an Import directive come before the shapes of the imported file.
+                Imported files are merged in the order of their Import directives.
+            */
+            void onImportEnd(std::unique_ptr<ParserTarget> pImportTarget, FileLoc loc) override;
             void onEndOfFiles() override;
 
         private:
@@ -422,6 +446,7 @@ namespace Falcor
                 Float transformStartTime = 0, transformEndTime = 1;
             };
 
+            std::unique_ptr<BasicScene> mpImportedScene;    ///< Scene owned by builders of imported files. Merged into the importing scene in onImportEnd().
             BasicScene& mScene;
 
             enum class BlockState { OptionsBlock, WorldBlock };
@@ -447,6 +472,7 @@ namespace Falcor
             std::unique_ptr<ActiveInstanceDefinition> mpActiveInstanceDefinition;
 
             uint32_t mUnamedMaterialIndex = 0;
+            uint32_t mImportedMaterialIndexBase = 0;        ///< Offset added to material indices of imported files to distinguish them from inherited material indices.
             std::set<std::string> mNamedMaterialNames;
             std::set<std::string> mMediumNames;
             std::set<std::string> mFloatTextureNames;
@@ -34,12 +34,10 @@
 #include "LoopSubdivide.h"
 #include "Core/Assert.h"
 #include "Core/Errors.h"
+#include "Utils/Threading.h"
 
 #include <algorithm>
-#include <map>
-#include <memory>
-#include <memory_resource>
-#include <set>
+#include <utility>
 
 #include <cmath>
 
@@ -47,482 +45,475 @@ namespace Falcor
 {
     namespace pbrt
     {
-        struct SDFace;
-        struct SDVertex;
-
         #define NEXT(i) (((i) + 1) % 3)
         #define PREV(i) (((i) + 2) % 3)
 
-        struct SDVertex
+        namespace
         {
-            SDVertex(const float3& p = float3(0.f)) : p(p) {}
-
-            int valence();
-            void oneRing(float3 *p);
-
-            float3 p;
-            SDFace* startFace = nullptr;
-            SDVertex* child = nullptr;
-            bool regular = false;
-            bool boundary = false;
-        };
+            const uint32_t kInvalidIndex = uint32_t(-1);
 
-        struct SDFace
-        {
-            SDFace()
+            /** Open addressing hash table mapping undirected edges to indices.
+                Slots holding kInvalidIndex are treated as empty by the callers, which is used instead of erasing entries.
+            */
+            class EdgeTable
             {
-                for (uint32_t i = 0; i < 3; ++i)
+            public:
+                explicit EdgeTable(size_t expectedCount)
                 {
-                    v[i] = nullptr;
-                    f[i] = nullptr;
+                    size_t capacity = 16;
+                    while (capacity < 2 * expectedCount) capacity *= 2;
+                    mKeys.assign(capacity, kEmptyKey);
+                    mValues.resize(capacity);
                 }
-                for (uint32_t i = 0; i < 4; ++i)
+
+                /** Returns the value of the edge (v0, v1), inserting kInvalidIndex if the edge is not in the table.
+                */
+                uint32_t& operator()(uint32_t v0, uint32_t v1)
                 {
-                    children[i] = nullptr;
+                    if (2 * (mCount + 1) > mKeys.size()) grow();
+                    const uint64_t key = (uint64_t(std::min(v0, v1)) << 32) | std::max(v0, v1);
+                    size_t slot = findSlot(key);
+                    if (mKeys[slot] == kEmptyKey)
+                    {
+                        mKeys[slot] = key;
+                        mValues[slot] = kInvalidIndex;
+                        mCount++;
+                    }
+                    return mValues[slot];
                 }
-            }
 
-            uint32_t vnum(SDVertex* vert) const
-            {
-                for (int i = 0; i < 3; ++i)
+            private:
+                static constexpr uint64_t kEmptyKey = uint64_t(-1);
+
+                size_t findSlot(uint64_t key) const
                 {
-                    if (v[i] == vert) return i;
+                    const size_t mask = mKeys.size() - 1;
+                    size_t slot = size_t((key * 0x9e3779b97f4a7c15ull) >> 32) & mask;
+                    while (mKeys[slot] != kEmptyKey && mKeys[slot] != key) slot = (slot + 1) & mask;
+                    return slot;
                 }
-                throw RuntimeError("Basic logic error in SDFace::vnum().");
-            }
 
-            SDFace* nextFace(SDVertex* vert) const { return f[vnum(vert)]; }
-            SDFace* prevFace(SDVertex* vert) const { return f[PREV(vnum(vert))]; }
-            SDVertex* nextVert(SDVertex* vert) const { return v[NEXT(vnum(vert))]; }
-            SDVertex* prevVert(SDVertex* vert) const { return v[PREV(vnum(vert))]; }
-            SDVertex* otherVert(SDVertex* v0, SDVertex* v1)
-            {
-                for (uint32_t i = 0; i < 3; ++i)
+                void grow()
                 {
-                    if (v[i] != v0 && v[i] != v1) return v[i];
+                    std::vector<uint64_t> keys(2 * mKeys.size(), kEmptyKey);
+                    std::vector<uint32_t> values(keys.size());
+                    std::swap(keys, mKeys);
+                    std::swap(values, mValues);
+                    for (size_t i = 0; i < keys.size(); ++i)
+                    {
+                        if (keys[i] == kEmptyKey) continue;
+                        size_t slot = findSlot(keys[i]);
+                        mKeys[slot] = keys[i];
+                        mValues[slot] = values[i];
+                    }
                 }
-                throw RuntimeError("Basic logic error in SDFace::otherVert()");
-            }
-
-            SDVertex* v[3];
-            SDFace* f[3];
-            SDFace* children[4];
-        };
-
-        struct SDEdge
-        {
-            SDEdge(SDVertex* v0 = nullptr, SDVertex* v1 = nullptr)
-            {
-                v[0] = std::min(v0, v1);
-                v[1] = std::max(v0, v1);
-                f[0] = f[1] = nullptr;
-                f0edgeNum = -1;
-            }
 
-            bool operator<(const SDEdge &e2) const
-            {
-                if (v[0] == e2.v[0]) return v[1] < e2.v[1];
-                return v[0] < e2.v[0];
-            }
-
-            SDVertex* v[2];
-            SDFace* f[2];
-            int f0edgeNum;
-        };
+                std::vector<uint64_t> mKeys;
+                std::vector<uint32_t> mValues;
+                size_t mCount = 0;
+            };
 
-        static float3 weightOneRing(SDVertex* vert, float beta);
-        static float3 weightBoundary(SDVertex* vert, float beta);
-
-        inline int SDVertex::valence()
-        {
-            SDFace* f = startFace;
-            if (!boundary)
+            /** Subdivision mesh stored in flat arrays.
+                Face f has the vertices faceVertices[3 * f + k] and the neighbor faceNeighbors[3 * f + k] across the edge
+                from vertex k to vertex NEXT(k), i.e., 3 * f + k acts as a half-edge index.
+            */
+            struct SubdivisionMesh
             {
-                // Compute valence of interior vertex.
-                int nf = 1;
-                while ((f = f->nextFace(this)) != startFace) ++nf;
-                return nf;
-            }
-            else
-            {
-                // Compute valence of boundary vertex
-                int nf = 1;
-                while ((f = f->nextFace(this)) != nullptr) ++nf;
-                f = startFace;
-                while ((f = f->prevFace(this)) != nullptr) ++nf;
-                return nf + 1;
-            }
-        }
-
-        inline float beta(uint32_t valence)
-        {
-            if (valence == 3)
-                return 3.f / 16.f;
-            else
-                return 3.f / (8.f * valence);
-        }
-
-        inline float loopGamma(uint32_t valence)
-        {
-            return 1.f / (valence + 3.f / (8.f * beta(valence)));
-        }
+                std::vector<float3> positions;
+                std::vector<uint32_t> startFaces;       ///< One face adjacent to each vertex. Rings are traversed starting at this face.
+                std::vector<uint8_t> boundary;
+                std::vector<uint8_t> regular;
+                std::vector<uint32_t> faceVertices;
+                std::vector<uint32_t> faceNeighbors;
 
-        LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> indices)
-        {
-            std::vector<SDVertex*> vertices;
-            std::vector<SDFace*> faces;
+                uint32_t getVertexCount() const { return (uint32_t)positions.size(); }
+                uint32_t getFaceCount() const { return (uint32_t)(faceVertices.size() / 3); }
 
-            // Allocate vertices and faces.
-            std::unique_ptr<SDVertex[]> verts = std::make_unique<SDVertex[]>(positions.size());
-            for (size_t i = 0; i < positions.size(); ++i)
-            {
-                verts[i] = SDVertex(positions[i]);
-                vertices.push_back(&verts[i]);
-            }
-            size_t faceCount = indices.size() / 3;
-            std::unique_ptr<SDFace[]> fs = std::make_unique<SDFace[]>(faceCount);
-            for (size_t i = 0; i < faceCount; ++i)
-            {
-                faces.push_back(&fs[i]);
-            }
-
-            // Set face to vertex pointers.
-            const uint32_t* vp = indices.data();
-            for (size_t i = 0; i < faceCount; ++i, vp += 3)
-            {
-                SDFace* f = faces[i];
-                for (uint32_t j = 0; j < 3; ++j)
+                void resize(uint32_t vertexCount, uint32_t faceCount)
                 {
-                    SDVertex* v = vertices[vp[j]];
-                    f->v[j] = v;
-                    v->startFace = f;
+                    positions.resize(vertexCount);
+                    startFaces.resize(vertexCount);
+                    boundary.resize(vertexCount);
+                    regular.resize(vertexCount);
+                    faceVertices.resize(3 * size_t(faceCount));
+                    faceNeighbors.resize(3 * size_t(faceCount));
                 }
-            }
 
-            // Set neighbor pointers in faces.
-            std::set<SDEdge> edges;
-            for (size_t i = 0; i < faceCount; ++i)
-            {
-                SDFace* f = faces[i];
-                for (uint32_t edgeNum = 0; edgeNum < 3; ++edgeNum)
+                uint32_t vnum(uint32_t face, uint32_t vertex) const
                 {
-                    // Update neighbor pointer for edgeNum.
-                    int v0 = edgeNum, v1 = NEXT(edgeNum);
-                    SDEdge e(f->v[v0], f->v[v1]);
-                    if (edges.find(e) == edges.end())
+                    for (uint32_t i = 0; i < 3; ++i)
                     {
-                        // Handle new edge.
-                        e.f[0] = f;
-                        e.f0edgeNum = edgeNum;
-                        edges.insert(e);
-                    }
-                    else
-                    {
-                        // Handle previously seen edge.
-                        e =* edges.find(e);
-                        e.f[0]->f[e.f0edgeNum] = f;
-                        f->f[edgeNum] = e.f[0];
-                        edges.erase(e);
+                        if (faceVertices[3 * face + i] == vertex) return i;
                     }
+                    throw RuntimeError("Basic logic error in SubdivisionMesh::vnum().");
                 }
-            }
-
-            // Finish vertex initialization.
-            for (size_t i = 0; i < positions.size(); ++i)
-            {
-                SDVertex* v = vertices[i];
-                SDFace* f = v->startFace;
-                do
-                {
-                    f = f->nextFace(v);
-                } while ((f != nullptr) && f != v->startFace);
-                v->boundary = (f == nullptr);
-                if (!v->boundary && v->valence() == 6) v->regular = true;
-                else if (v->boundary && v->valence() == 4) v->regular = true;
-                else v->regular = false;
-            }
-
-            // Refine LoopSubdiv into triangles.
-            std::vector<SDFace*> f = faces;
-            std::vector<SDVertex*> v = vertices;
 
-            std::pmr::monotonic_buffer_resource buffer;
-            std::pmr::polymorphic_allocator<SDVertex> vertexAllocator(&buffer);
-            std::pmr::polymorphic_allocator<SDFace> faceAllocator(&buffer);
+                uint32_t nextFace(uint32_t face, uint32_t vertex) const { return faceNeighbors[3 * face + vnum(face, vertex)]; }
+                uint32_t prevFace(uint32_t face, uint32_t vertex) const { return faceNeighbors[3 * face + PREV(vnum(face, vertex))]; }
+                uint32_t nextVert(uint32_t face, uint32_t vertex) const { return faceVertices[3 * face + NEXT(vnum(face, vertex))]; }
+                uint32_t prevVert(uint32_t face, uint32_t vertex) const { return faceVertices[3 * face + PREV(vnum(face, vertex))]; }
 
-            for (size_t i = 0; i < levels; ++i)
-            {
-                // Update f and v for next level of subdivision.
-                std::vector<SDFace*> newFaces;
-                std::vector<SDVertex*> newVertices;
-
-                // Allocate next level of children in mesh tree.
-                for (SDVertex* vertex : v)
+                uint32_t otherVert(uint32_t face, uint32_t v0, uint32_t v1) const
                 {
-                    vertex->child = vertexAllocator.allocate(1);
-                    vertex->child->regular = vertex->regular;
-                    vertex->child->boundary = vertex->boundary;
-                    newVertices.push_back(vertex->child);
-                }
-                for (SDFace* face : f)
-                {
-                    for (uint32_t k = 0; k < 4; ++k)
+                    for (uint32_t i = 0; i < 3; ++i)
                     {
-                        face->children[k] = faceAllocator.allocate(1);
-                        newFaces.push_back(face->children[k]);
+                        uint32_t v = faceVertices[3 * face + i];
+                        if (v != v0 && v != v1) return v;
                     }
+                    throw RuntimeError("Basic logic error in SubdivisionMesh::otherVert()");
                 }
 
-                // Update vertex positions and create new edge vertices.
-
-                // Update vertex positions for even vertices.
-                for (SDVertex* vertex : v)
+                uint32_t valence(uint32_t vertex) const
                 {
-                    if (!vertex->boundary)
+                    const uint32_t startFace = startFaces[vertex];
+                    uint32_t f = startFace;
+                    if (!boundary[vertex])
                     {
-                        // Apply one-ring rule for even vertex.
-                        if (vertex->regular) vertex->child->p = weightOneRing(vertex, 1.f / 16.f);
-                        else vertex->child->p = weightOneRing(vertex, beta(vertex->valence()));
+                        // Compute valence of interior vertex.
+                        uint32_t nf = 1;
+                        while ((f = nextFace(f, vertex)) != startFace) ++nf;
+                        return nf;
                     }
                     else
                     {
-                        // Apply boundary rule for even vertex.
-                        vertex->child->p = weightBoundary(vertex, 1.f / 8.f);
+                        // Compute valence of boundary vertex.
+                        uint32_t nf = 1;
+                        while ((f = nextFace(f, vertex)) != kInvalidIndex) ++nf;
+                        f = startFace;
+                        while ((f = prevFace(f, vertex)) != kInvalidIndex) ++nf;
+                        return nf + 1;
                     }
                 }
 
-                // Compute new odd edge vertices.
-                std::map<SDEdge, SDVertex*> edgeVerts;
-                for (SDFace* face : f)
+                /** Call func(position) for the one-ring vertices of a vertex in ring order.
+                */
+                template<typename F>
+                void oneRing(uint32_t vertex, F func) const
                 {
-                    for (uint32_t k = 0; k < 3; ++k)
+                    uint32_t face = startFaces[vertex];
+                    if (!boundary[vertex])
                     {
-                        // Compute odd vertex on kth edge.
-                        SDEdge edge(face->v[k], face->v[NEXT(k)]);
-                        SDVertex* vert = edgeVerts[edge];
-                        if (vert == nullptr)
+                        // Get one-ring vertices for interior vertex.
+                        do
                         {
-                            // Create and initialize new odd vertex
-                            vert = vertexAllocator.allocate(1);
-                            newVertices.push_back(vert);
-                            vert->regular = true;
-                            vert->boundary = (face->f[k] == nullptr);
-                            vert->startFace = face->children[3];
-
-                            // Apply edge rules to compute new vertex position
-                            if (vert->boundary)
-                            {
-                                vert->p = 0.5f * edge.v[0]->p;
-                                vert->p += 0.5f * edge.v[1]->p;
-                            }
-                            else
-                            {
-                                vert->p = 3.f / 8.f * edge.v[0]->p;
-                                vert->p += 3.f / 8.f * edge.v[1]->p;
-                                vert->p += 1.f / 8.f * face->otherVert(edge.v[0], edge.v[1])->p;
-                                vert->p += 1.f / 8.f * face->f[k]->otherVert(edge.v[0], edge.v[1])->p;
-                            }
-                            edgeVerts[edge] = vert;
+                            func(positions[nextVert(face, vertex)]);
+                            face = nextFace(face, vertex);
+                        } while (face != startFaces[vertex]);
+                    }
+                    else
+                    {
+                        // Get one-ring vertices for boundary vertex.
+                        uint32_t f2;
+                        while ((f2 = nextFace(face, vertex)) != kInvalidIndex)
+                        {
+                            face = f2;
                         }
+                        func(positions[nextVert(face, vertex)]);
+                        do
+                        {
+                            func(positions[prevVert(face, vertex)]);
+                            face = prevFace(face, vertex);
+                        } while (face != kInvalidIndex);
                     }
                 }
 
-                // Update new mesh topology.
-
-                // Update even vertex face pointers.
-                for (SDVertex* vertex : v)
+                float3 weightOneRing(uint32_t vertex, float beta) const
                 {
-                    int vertNum = vertex->startFace->vnum(vertex);
-                    vertex->child->startFace = vertex->startFace->children[vertNum];
-                }
-
-                // Update face neighbor pointers.
-                for (SDFace* face : f)
-                {
-                    for (uint32_t j = 0; j < 3; ++j)
-                    {
-                        // Update children f pointers for siblings.
-                        face->children[3]->f[j] = face->children[NEXT(j)];
-                        face->children[j]->f[NEXT(j)] = face->children[3];
-
-                        // Update children f pointers for neighbor children.
-                        SDFace* f2 = face->f[j];
-                        face->children[j]->f[j] = f2 != nullptr ? f2->children[f2->vnum(face->v[j])] : nullptr;
-                        f2 = face->f[PREV(j)];
-                        face->children[j]->f[PREV(j)] = f2 != nullptr ? f2->children[f2->vnum(face->v[j])] : nullptr;
-                    }
+                    uint32_t valence = this->valence(vertex);
+                    float3 p = (1 - valence * beta) * positions[vertex];
+                    oneRing(vertex, [&](const float3& ringPos) { p += beta * ringPos; });
+                    return p;
                 }
 
-                // Update face vertex pointers.
-                for (SDFace* face : f)
+                float3 weightBoundary(uint32_t vertex, float beta) const
                 {
-                    for (uint32_t j = 0; j < 3; ++j)
+                    // Only the first and the last vertex of the one-ring are used.
+                    bool first = true;
+                    float3 firstPos(0.f);
+                    float3 lastPos(0.f);
+                    oneRing(vertex, [&](const float3& ringPos)
                     {
-                        // Update child vertex pointer to new even vertex
-                        face->children[j]->v[j] = face->v[j]->child;
-
-                        // Update child vertex pointer to new odd vertex
-                        SDVertex *vert = edgeVerts[SDEdge(face->v[j], face->v[NEXT(j)])];
-                        face->children[j]->v[NEXT(j)] = vert;
-                        face->children[NEXT(j)]->v[j] = vert;
-                        face->children[3]->v[j] = vert;
-                    }
+                        if (first) firstPos = ringPos;
+                        lastPos = ringPos;
+                        first = false;
+                    });
+                    float3 p = (1 - 2 * beta) * positions[vertex];
+                    p += beta * firstPos;
+                    p += beta * lastPos;
+                    return p;
                 }
+            };
 
-                // Prepare for next level of subdivision
-                f = newFaces;
-                v = newVertices;
+            inline float beta(uint32_t valence)
+            {
+                if (valence == 3)
+                    return 3.f / 16.f;
+                else
+                    return 3.f / (8.f * valence);
             }
 
-            // Push vertices to limit surface.
-            std::vector<float3> pLimit(v.size());
-            for (size_t i = 0; i < v.size(); ++i)
+            inline float loopGamma(uint32_t valence)
             {
-                if (v[i]->boundary) pLimit[i] = weightBoundary(v[i], 1.f / 5.f);
-                else pLimit[i] = weightOneRing(v[i], loopGamma(v[i]->valence()));
+                return 1.f / (valence + 3.f / (8.f * beta(valence)));
             }
-            for (size_t i = 0; i < v.size(); ++i)
+
+            void initializeMesh(fstd::span<const float3> positions, fstd::span<const uint32_t> indices, SubdivisionMesh& mesh)
             {
-                v[i]->p = pLimit[i];
+                const uint32_t vertexCount = (uint32_t)positions.size();
+                const uint32_t faceCount = (uint32_t)(indices.size() / 3);
+                mesh.resize(vertexCount, faceCount);
+                std::copy(positions.begin(), positions.end(), mesh.positions.begin());
+                std::fill(mesh.startFaces.begin(), mesh.startFaces.end(), kInvalidIndex);
+                std::fill(mesh.faceNeighbors.begin(), mesh.faceNeighbors.end(), kInvalidIndex);
+
+                // Set face to vertex indices.
+                for (uint32_t i = 0; i < 3 * faceCount; ++i)
+                {
+                    uint32_t v = indices[i];
+                    if (v >= vertexCount) throw RuntimeError("Vertex index {} is out of range.", v);
+                    mesh.faceVertices[i] = v;
+                    mesh.startFaces[v] = i / 3;
+                }
+
+                // Set neighbor indices in faces. The table holds the first half-edge seen for each edge until it is matched.
+                EdgeTable edges(3 * size_t(faceCount));
+                for (uint32_t f = 0; f < faceCount; ++f)
+                {
+                    for (uint32_t edgeNum = 0; edgeNum < 3; ++edgeNum)
+                    {
+                        uint32_t& halfEdge = edges(mesh.faceVertices[3 * f + edgeNum], mesh.faceVertices[3 * f + NEXT(edgeNum)]);
+                        if (halfEdge == kInvalidIndex)
+                        {
+                            // Handle new edge.
+                            halfEdge = 3 * f + edgeNum;
+                        }
+                        else
+                        {
+                            // Handle previously seen edge.
+                            mesh.faceNeighbors[halfEdge] = f;
+                            mesh.faceNeighbors[3 * f + edgeNum] = halfEdge / 3;
+                            halfEdge = kInvalidIndex;
+                        }
+                    }
+                }
+
+                // Finish vertex initialization.
+                for (uint32_t v = 0; v < vertexCount; ++v)
+                {
+                    if (mesh.startFaces[v] == kInvalidIndex) throw RuntimeError("Vertex {} is not referenced by any face.", v);
+                }
+                Threading::parallelFor(0, vertexCount, [&](size_t i)
+                {
+                    const uint32_t v = (uint32_t)i;
+                    uint32_t f = mesh.startFaces[v];
+                    do
+                    {
+                        f = mesh.nextFace(f, v);
+                    } while (f != kInvalidIndex && f != mesh.startFaces[v]);
+                    mesh.boundary[v] = f == kInvalidIndex;
+                    uint32_t valence = mesh.valence(v);
+                    mesh.regular[v] = mesh.boundary[v] ? valence == 4 : valence == 6;
+                });
             }
 
-            // Compute vertex tangents on limit surface.
-            std::vector<float3> Ns;
-            Ns.reserve(v.size());
-            std::vector<float3> pRing(16, float3());
-            for (SDVertex* vertex : v)
+            /** Refine a mesh by one level of Loop subdivision.
+                Vertices and faces are numbered like the pbrt-v3 implementation: even vertices keep their index, odd vertices
+                follow in the order their edges are first seen when iterating over the faces, and face f is split into faces 4f..4f+3.
+            */
+            void refineMesh(const SubdivisionMesh& mesh, SubdivisionMesh& refined)
             {
-                float3 S(0.f);
-                float3 T(0.f);
-                uint32_t valence = vertex->valence();
-                if (valence > pRing.size()) pRing.resize(valence);
-                vertex->oneRing(&pRing[0]);
-                if (!vertex->boundary)
+                const uint32_t vertexCount = mesh.getVertexCount();
+                const uint32_t faceCount = mesh.getFaceCount();
+
+                // Assign odd vertices to edges.
+                std::vector<uint32_t> edgeVertices(3 * size_t(faceCount));
+                std::vector<uint32_t> oddVertexHalfEdges;
+                oddVertexHalfEdges.reserve(3 * size_t(faceCount) / 2);
+                EdgeTable edges(3 * size_t(faceCount) / 2);
+                for (uint32_t h = 0; h < 3 * faceCount; ++h)
                 {
-                    // Compute tangents of interior face
-                    for (uint32_t j = 0; j < valence; ++j)
+                    uint32_t& vert = edges(mesh.faceVertices[h], mesh.faceVertices[3 * (h / 3) + NEXT(h % 3)]);
+                    if (vert == kInvalidIndex)
                     {
-                        S += std::cos(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
-                        T += std::sin(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
+                        vert = vertexCount + (uint32_t)oddVertexHalfEdges.size();
+                        oddVertexHalfEdges.push_back(h);
                     }
+                    edgeVertices[h] = vert;
                 }
-                else
+
+                refined.resize(vertexCount + (uint32_t)oddVertexHalfEdges.size(), 4 * faceCount);
+
+                // Update vertex positions for even vertices.
+                Threading::parallelFor(0, vertexCount, [&](size_t i)
                 {
-                    // Compute tangents of boundary face
-                    S = pRing[valence - 1] - pRing[0];
-                    if (valence == 2)
+                    const uint32_t v = (uint32_t)i;
+                    if (!mesh.boundary[v])
                     {
-                        T = float3(pRing[0] + pRing[1] - 2.f * vertex->p);
+                        // Apply one-ring rule for even vertex.
+                        if (mesh.regular[v]) refined.positions[v] = mesh.weightOneRing(v, 1.f / 16.f);
+                        else refined.positions[v] = mesh.weightOneRing(v, beta(mesh.valence(v)));
                     }
-                    else if (valence == 3)
+                    else
                     {
-                        T = pRing[1] - vertex->p;
+                        // Apply boundary rule for even vertex.
+                        refined.positions[v] = mesh.weightBoundary(v, 1.f / 8.f);
                     }
-                    else if (valence == 4) // regular
+                    refined.boundary[v] = mesh.boundary[v];
+                    refined.regular[v] = mesh.regular[v];
+                    const uint32_t startFace = mesh.startFaces[v];
+                    refined.startFaces[v] = 4 * startFace + mesh.vnum(startFace, v);
+                });
+
+                // Compute new odd edge vertices.
+                Threading::parallelFor(0, oddVertexHalfEdges.size(), [&](size_t i)
+                {
+                    const uint32_t h = oddVertexHalfEdges[i];
+                    const uint32_t face = h / 3;
+                    const uint32_t v0 = std::min(mesh.faceVertices[h], mesh.faceVertices[3 * face + NEXT(h % 3)]);
+                    const uint32_t v1 = std::max(mesh.faceVertices[h], mesh.faceVertices[3 * face + NEXT(h % 3)]);
+                    const uint32_t neighbor = mesh.faceNeighbors[h];
+                    const uint32_t vert = vertexCount + (uint32_t)i;
+                    refined.regular[vert] = true;
+                    refined.boundary[vert] = neighbor == kInvalidIndex;
+                    refined.startFaces[vert] = 4 * face + 3;
+
+                    // Apply edge rules to compute new vertex position.
+                    float3 p;
+                    if (neighbor == kInvalidIndex)
                     {
-                        T = float3(-1.f * pRing[0] + 2.f * pRing[1] + 2.f * pRing[2] + -1.f * pRing[3] + -2.f * vertex->p);
+                        p = 0.5f * mesh.positions[v0];
+                        p += 0.5f * mesh.positions[v1];
                     }
                     else
                     {
-                        float theta = float(M_PI) / float(valence - 1);
-                        T = float3(std::sin(theta) * (pRing[0] + pRing[valence - 1]));
-                        for (uint32_t k = 1; k < valence - 1; ++k)
-                        {
-                            float wt = (2 * std::cos(theta) - 2) * std::sin((k)*theta);
-                            T += float3(wt * pRing[k]);
-                        }
-                        T = -T;
+                        p = 3.f / 8.f * mesh.positions[v0];
+                        p += 3.f / 8.f * mesh.positions[v1];
+                        p += 1.f / 8.f * mesh.positions[mesh.otherVert(face, v0, v1)];
+                        p += 1.f / 8.f * mesh.positions[mesh.otherVert(neighbor, v0, v1)];
                     }
-                }
-                Ns.push_back(cross(S, T));
-            }
+                    refined.positions[vert] = p;
+                });
 
-            // Create triangle mesh from subdivision mesh
-            {
-                size_t ntris = f.size();
-                std::vector<uint32_t> verts(3 * ntris);
-                uint32_t *vp = verts.data();
-                uint32_t totVerts = (uint32_t)v.size();
-                std::map<SDVertex*, uint32_t> usedVerts;
-                for (uint32_t i = 0; i < totVerts; ++i)
-                {
-                    usedVerts[v[i]] = i;
-                }
-                for (size_t i = 0; i < ntris; ++i)
+                // Update new mesh topology.
+                Threading::parallelFor(0, faceCount, [&](size_t i)
                 {
+                    const uint32_t face = (uint32_t)i;
+                    const uint32_t* v = &mesh.faceVertices[3 * face];
+                    const uint32_t* f = &mesh.faceNeighbors[3 * face];
+                    uint32_t* childVertices = &refined.faceVertices[12 * face];
+                    uint32_t* childNeighbors = &refined.faceNeighbors[12 * face];
+                    auto child = [&](uint32_t k) { return 4 * face + k; };
+                    auto neighborChild = [&](uint32_t f2, uint32_t vert) { return f2 != kInvalidIndex ? 4 * f2 + mesh.vnum(f2, vert) : kInvalidIndex; };
+
                     for (uint32_t j = 0; j < 3; ++j)
                     {
-                        *vp = usedVerts[f[i]->v[j]];
-                        ++vp;
+                        // Update children neighbors for siblings.
+                        childNeighbors[3 * 3 + j] = child(NEXT(j));
+                        childNeighbors[3 * j + NEXT(j)] = child(3);
+
+                        // Update children neighbors for neighbor children.
+                        childNeighbors[3 * j + j] = neighborChild(f[j], v[j]);
+                        childNeighbors[3 * j + PREV(j)] = neighborChild(f[PREV(j)], v[j]);
+
+                        // Update child vertex index to new even vertex.
+                        childVertices[3 * j + j] = v[j];
+
+                        // Update child vertex index to new odd vertex.
+                        const uint32_t vert = edgeVertices[3 * face + j];
+                        childVertices[3 * j + NEXT(j)] = vert;
+                        childVertices[3 * NEXT(j) + j] = vert;
+                        childVertices[3 * 3 + j] = vert;
                     }
-                }
-
-                LoopSubdivideResult result;
-                result.positions = std::move(pLimit);
-                result.normals = std::move(Ns);
-                result.indices = std::move(verts);
-                return result;
+                });
             }
         }
 
-        static float3 weightOneRing(SDVertex* vert, float beta)
+        LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> indices)
         {
-            // Put vert one-ring in pRing.
-            uint32_t valence = vert->valence();
-            FALCOR_ASSERT(valence < 16);
-            float3 pRing[16];
-
-            vert->oneRing(pRing);
-            float3 p = (1 - valence * beta) * vert->p;
-            for (uint32_t i = 0; i < valence; ++i)
+            // The current and the next level are kept in two meshes whose storage is reused between levels.
+            SubdivisionMesh mesh;
+            SubdivisionMesh refined;
+            initializeMesh(positions, indices, mesh);
+
+            // Refine LoopSubdiv into triangles.
+            for (uint32_t i = 0; i < levels; ++i)
             {
-                p += beta * pRing[i];
+                refineMesh(mesh, refined);
+                std::swap(mesh, refined);
             }
-            return p;
-        }
 
-        void SDVertex::oneRing(float3* p)
-        {
-            if (!boundary)
+            const uint32_t vertexCount = mesh.getVertexCount();
+
+            // Push vertices to limit surface.
+            std::vector<float3> pLimit(vertexCount);
+            Threading::parallelFor(0, vertexCount, [&](size_t i)
             {
-                // Get one-ring vertices for interior vertex.
-                SDFace* face = startFace;
-                do
-                {
-                    *p++ = face->nextVert(this)->p;
-                    face = face->nextFace(this);
-                } while (face != startFace);
-            }
-            else
+                const uint32_t v = (uint32_t)i;
+                if (mesh.boundary[v]) pLimit[v] = mesh.weightBoundary(v, 1.f / 5.f);
+                else pLimit[v] = mesh.weightOneRing(v, loopGamma(mesh.valence(v)));
+            });
+            std::swap(mesh.positions, pLimit);
+
+            // Compute vertex tangents on limit surface.
+            std::vector<float3> Ns(vertexCount);
+            Threading::parallelForChunks(0, vertexCount, [&](size_t begin, size_t end)
             {
-                // Get one-ring vertices for boundary vertex.
-                SDFace* face = startFace;
-                SDFace* f2;
-                while ((f2 = face->nextFace(this)) != nullptr)
+                std::vector<float3> pRing;
+                for (uint32_t v = (uint32_t)begin; v < (uint32_t)end; ++v)
                 {
-                    face = f2;
+                    const float3& p = mesh.positions[v];
+                    float3 S(0.f);
+                    float3 T(0.f);
+                    uint32_t valence = mesh.valence(v);
+                    pRing.clear();
+                    mesh.oneRing(v, [&](const float3& ringPos) { pRing.push_back(ringPos); });
+                    if (!mesh.boundary[v])
+                    {
+                        // Compute tangents of interior face
+                        for (uint32_t j = 0; j < valence; ++j)
+                        {
+                            S += std::cos(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
+                            T += std::sin(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
+                        }
+                    }
+                    else
+                    {
+                        // Compute tangents of boundary face
+                        S = pRing[valence - 1] - pRing[0];
+                        if (valence == 2)
+                        {
+                            T = float3(pRing[0] + pRing[1] - 2.f * p);
+                        }
+                        else if (valence == 3)
+                        {
+                            T = pRing[1] - p;
+                        }
+                        else if (valence == 4) // regular
+                        {
+                            T = float3(-1.f * pRing[0] + 2.f * pRing[1] + 2.f * pRing[2] + -1.f * pRing[3] + -2.f * p);
+                        }
+                        else
+                        {
+                            float theta = float(M_PI) / float(valence - 1);
+                            T = float3(std::sin(theta) * (pRing[0] + pRing[valence - 1]));
+                            for (uint32_t k = 1; k < valence - 1; ++k)
+                            {
+                                float wt = (2 * std::cos(theta) - 2) * std::sin((k)*theta);
+                                T += float3(wt * pRing[k]);
+                            }
+                            T = -T;
+                        }
+                    }
+                    Ns[v] = cross(S, T);
                 }
-                *p++ = face->nextVert(this)->p;
-                do
-                {
-                    *p++ = face->prevVert(this)->p;
-                    face = face->prevFace(this);
-                } while (face != nullptr);
-            }
-        }
-
-        static float3 weightBoundary(SDVertex* vert, float beta)
-        {
-            // Put vert one-ring in pRing.
-            uint32_t valence = vert->valence();
-            FALCOR_ASSERT(valence < 16);
-            float3 pRing[16];
-
-            vert->oneRing(pRing);
-            float3 p = (1 - 2 * beta) * vert->p;
-            p += beta * pRing[0];
-            p += beta * pRing[valence - 1];
-            return p;
+            });
+
+            // Create triangle mesh from subdivision mesh.
+            LoopSubdivideResult result;
+            result.positions = std::move(mesh.positions);
+            result.normals = std::move(Ns);
+            result.indices = std::move(mesh.faceVertices);
+            return result;
         }
     }
 }
@@ -63,6 +63,7 @@
 #include "Builder.h"
 #include "Helpers.h"
 #include "LoopSubdivide.h"
+#include "PLYReader.h"
 #include "EnvMapConverter.h"
 #include "Core/Assert.h"
 #include "Core/Errors.h"
@@ -72,6 +73,7 @@
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Math/FalcorMath.h"
 #include "Utils/Math/FNVHash.h"
+#include "Utils/Threading.h"
 #include "Scene/Importer.h"
 #include "Scene/Material/Material.h"
 #include "Scene/Material/StandardMaterial.h"
@@ -211,6 +213,13 @@ namespace Falcor
 
             std::map<std::string, InstanceDefinition> instanceDefinitions;
 
+            struct PLYMeshEntry
+            {
+                std::unique_ptr<const PLYMesh> pMesh;   ///< The loaded mesh. Null if loading failed or all shapes using it have been created.
+                size_t shapeCount = 0;                  ///< Number of shapes that have not yet been created from the mesh.
+            };
+            std::map<std::filesystem::path, PLYMeshEntry> plyMeshes; ///< PLY meshes loaded by loadPLYMeshes().
+
             size_t curveCount = 0;
 
             bool usePBRTMaterials = false;
@@ -691,6 +700,7 @@ namespace Falcor
                 else if (!filename.empty())
                 {
                     auto path = ctx.resolver(filename);
+                    ctx.builder.addCacheDependency(path);
                     auto pOctTexture = Falcor::Texture::createFromFile(path, false, false);
                     // TODO: Use equal-area octahedral parametrization when env map supports it.
                     logWarning(entity.loc, "Environment map is converted from equal-area octahedral to lat-long parametrization. Exact results cannot be expected.");
@@ -788,6 +798,7 @@ namespace Falcor
                 }
                 bool sRGB = encoding == "sRGB";
 
+                ctx.builder.addCacheDependency(path);
                 floatTexture.texture = Falcor::Texture::createFromFile(path, generateMips, sRGB);
             }
             else if (type == "checkerboard")
@@ -907,6 +918,7 @@ namespace Falcor
                 }
                 bool sRGB = encoding == "sRGB";
 
+                ctx.builder.addCacheDependency(path);
                 spectrumTexture.texture = Falcor::Texture::createFromFile(path, generateMips, sRGB);
             }
             else if (type == "checkerboard")
@@ -1286,6 +1298,7 @@ namespace Falcor
                 auto normalmap = params.getString("normalmap", "");
                 if (!normalmap.empty())
                 {
+                    ctx.builder.addCacheDependency(ctx.resolver(normalmap));
                     auto pNormalMap = Texture::createFromFile(ctx.resolver(normalmap), true, false);
                     pMaterial->setTexture(Material::TextureSlot::Normal, pNormalMap);
                 }
@@ -1537,9 +1550,27 @@ namespace Falcor
                 auto filename = params.getString("filename", "");
                 auto path = ctx.resolver(filename);
 
-                shape.pTriangleMesh = Falcor::TriangleMesh::createFromFile(path.string());
-                if (shape.pTriangleMesh) shape.pTriangleMesh->setName(filename);
+                ctx.builder.addCacheDependency(path);
+                auto it = ctx.plyMeshes.find(path);
+                FALCOR_ASSERT(it != ctx.plyMeshes.end() && it->second.shapeCount > 0);
+                if (const auto& pMesh = it->second.pMesh)
+                {
+                    // Texture coordinates are flipped to match the image orientation used in Falcor.
+                    Falcor::TriangleMesh::VertexList vertexList(pMesh->positions.size());
+                    for (size_t i = 0; i < pMesh->positions.size(); ++i)
+                    {
+                        auto& vertex = vertexList[i];
+                        vertex.position = pMesh->positions[i];
+                        vertex.normal = pMesh->normals[i];
+                        vertex.texCoord = pMesh->texCoords.empty() ? float2(0.f) : float2(pMesh->texCoords[i].x, 1.f - pMesh->texCoords[i].y);
+                    }
+                    shape.pTriangleMesh = Falcor::TriangleMesh::create(vertexList, pMesh->indices);
+                    shape.pTriangleMesh->setName(filename);
+                }
                 shape.transform = entity.transform;
+
+                // Free the PLY mesh once the last shape using it has been created.
+                if (--it->second.shapeCount == 0) it->second.pMesh.reset();
             }
             else if (type == "loopsubdiv")
             {
@@ -1677,6 +1708,42 @@ namespace Falcor
             }
         }
 
+        /** Load the PLY files referenced by 'plymesh' shapes.
+            The files are loaded in parallel up front, as parsing large binary meshes dominates the scene build time.
+            Each file is loaded once, even if it is referenced by multiple shapes.
+        */
+        void loadPLYMeshes(BuilderContext& ctx)
+        {
+            std::vector<std::filesystem::path> paths;
+            auto addShape = [&](const ShapeSceneEntity& entity)
+            {
+                if (entity.name != "plymesh") return;
+                auto path = ctx.resolver(entity.params.getString("filename", ""));
+                if (ctx.plyMeshes[path].shapeCount++ == 0) paths.push_back(path);
+            };
+
+            for (const auto& entity : ctx.scene.getShapes()) addShape(entity);
+            for (const auto& [_, instanceDefinition] : ctx.scene.getInstanceDefinitions())
+            {
+                for (const auto& entity : instanceDefinition.shapes) addShape(entity);
+            }
+
+            std::vector<std::unique_ptr<const PLYMesh>> meshes(paths.size());
+            Threading::parallelFor(0, paths.size(), [&](size_t i)
+            {
+                try
+                {
+                    meshes[i] = std::make_unique<PLYMesh>(loadPLY(paths[i]));
+                }
+                catch (const RuntimeError& e)
+                {
+                    logWarning("Failed to load PLY mesh: {}", e.what());
+                }
+            }, 1);
+
+            for (size_t i = 0; i < paths.size(); ++i) ctx.plyMeshes[paths[i]].pMesh = std::move(meshes[i]);
+        }
+
         InstanceDefinition createInstanceDefinition(BuilderContext& ctx, const InstanceDefinitionSceneEntity& entity)
         {
             InstanceDefinition instanceDefinition;
@@ -1774,15 +1841,31 @@ namespace Falcor
                 }
             }
 
+            // Load PLY meshes in parallel before processing the shapes.
+            loadPLYMeshes(ctx);
+
             // Process shapes and create meshes.
-            for (const auto& entity : ctx.scene.getShapes())
+            // The triangle meshes are collected and added as a batch to pre-process them in parallel.
             {
-                auto shape = createShape(ctx, entity);
-                if (shape.pTriangleMesh)
+                std::vector<NodeID> nodeIDs;
+                std::vector<TriangleMesh::SharedPtr> triangleMeshes;
+                std::vector<Material::SharedPtr> meshMaterials;
+
+                for (const auto& entity : ctx.scene.getShapes())
                 {
-                    auto nodeID = ctx.builder.addNode({ entity.name, shape.transform });
-                    auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
-                    ctx.builder.addMeshInstance(nodeID, meshID);
+                    auto shape = createShape(ctx, entity);
+                    if (shape.pTriangleMesh)
+                    {
+                        nodeIDs.push_back(ctx.builder.addNode({ entity.name, shape.transform }));
+                        triangleMeshes.push_back(shape.pTriangleMesh);
+                        meshMaterials.push_back(shape.pMaterial);
+                    }
+                }
+
+                auto meshIDs = ctx.builder.addTriangleMeshes(triangleMeshes, meshMaterials);
+                for (size_t i = 0; i < meshIDs.size(); ++i)
+                {
+                    ctx.builder.addMeshInstance(nodeIDs[i], meshIDs[i]);
                 }
             }
 
@@ -1851,6 +1934,7 @@ namespace Falcor
             pbrt::BasicScene pbrtScene(fullPath.parent_path());
             pbrt::BasicSceneBuilder pbrtBuilder(pbrtScene);
             pbrt::parseFile(pbrtBuilder, fullPath);
+            for (const auto& includedPath : pbrtScene.getIncludedFiles()) builder.addCacheDependency(includedPath);
             timeReport.measure("Parsing pbrt scene");
 
             pbrt::BuilderContext ctx { pbrtScene, builder };
@@ -0,0 +1,628 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "PLYReader.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Core/Platform/OS.h"
+#include "Core/Platform/MemoryMappedFile.h"
+
+#include <fast_float/fast_float.h>
+
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+namespace Falcor
+{
+    namespace pbrt
+    {
+        namespace
+        {
+            enum class PropertyType
+            {
+                Int8,
+                UInt8,
+                Int16,
+                UInt16,
+                Int32,
+                UInt32,
+                Float32,
+                Float64,
+            };
+
+            enum class Format
+            {
+                Ascii,
+                BinaryLittleEndian,
+                BinaryBigEndian,
+            };
+
+            struct Property
+            {
+                std::string name;
+                PropertyType type = PropertyType::Float32;
+                bool isList = false;
+                PropertyType countType = PropertyType::UInt8;   ///< Type of the item count for list properties.
+            };
+
+            struct Element
+            {
+                std::string name;
+                size_t count = 0;
+                std::vector<Property> properties;
+            };
+
+            size_t getTypeSize(PropertyType type)
+            {
+                switch (type)
+                {
+                case PropertyType::Int8:
+                case PropertyType::UInt8:
+                    return 1;
+                case PropertyType::Int16:
+                case PropertyType::UInt16:
+                    return 2;
+                case PropertyType::Int32:
+                case PropertyType::UInt32:
+                case PropertyType::Float32:
+                    return 4;
+                case PropertyType::Float64:
+                    return 8;
+                default:
+                    FALCOR_UNREACHABLE();
+                    return 0;
+                }
+            }
+
+            bool parseType(std::string_view str, PropertyType& type)
+            {
+                if (str == "char" || str == "int8") type = PropertyType::Int8;
+                else if (str == "uchar" || str == "uint8") type = PropertyType::UInt8;
+                else if (str == "short" || str == "int16") type = PropertyType::Int16;
+                else if (str == "ushort" || str == "uint16") type = PropertyType::UInt16;
+                else if (str == "int" || str == "int32") type = PropertyType::Int32;
+                else if (str == "uint" || str == "uint32") type = PropertyType::UInt32;
+                else if (str == "float" || str == "float32") type = PropertyType::Float32;
+                else if (str == "double" || str == "float64") type = PropertyType::Float64;
+                else return false;
+                return true;
+            }
+
+            template<typename T>
+            T load(const uint8_t* p, bool swap)
+            {
+                T value;
+                if (swap)
+                {
+                    uint8_t bytes[sizeof(T)];
+                    for (size_t i = 0; i < sizeof(T); ++i) bytes[i] = p[sizeof(T) - 1 - i];
+                    std::memcpy(&value, bytes, sizeof(T));
+                }
+                else
+                {
+                    std::memcpy(&value, p, sizeof(T));
+                }
+                return value;
+            }
+
+            /** Reads values from the element data section of a PLY file.
+                Values are returned in the order they are stored, independent of the file format.
+            */
+            class Reader
+            {
+            public:
+                Reader(const uint8_t* pData, const uint8_t* pEnd, Format format, const std::string& name)
+                    : mpData(pData)
+                    , mpEnd(pEnd)
+                    , mFormat(format)
+                    , mName(name)
+                {}
+
+                bool isBinary() const { return mFormat != Format::Ascii; }
+                bool isSwapped() const { return mFormat == Format::BinaryBigEndian; }
+                const uint8_t* getData() const { return mpData; }
+                size_t getRemainingSize() const { return (size_t)(mpEnd - mpData); }
+
+                /** Check that the given number of bytes is available and advance past them.
+                    \return Pointer to the skipped bytes.
+                */
+                const uint8_t* consume(size_t size)
+                {
+                    FALCOR_ASSERT(isBinary());
+                    if ((size_t)(mpEnd - mpData) < size) throw RuntimeError("Unexpected end of file in PLY file '{}'.", mName);
+                    const uint8_t* p = mpData;
+                    mpData += size;
+                    return p;
+                }
+
+                /** Check that the given number of values is available and advance past them.
+                    The count is checked against the remaining size before multiplying, so corrupt counts cannot overflow.
+                    \return Pointer to the skipped bytes.
+                */
+                const uint8_t* consume(size_t count, size_t valueSize)
+                {
+                    if (valueSize != 0 && count > getRemainingSize() / valueSize) throw RuntimeError("Unexpected end of file in PLY file '{}'.", mName);
+                    return consume(count * valueSize);
+                }
+
+                /** Check that the given number of records can be stored in the remaining data.
+                    Every record takes at least one byte, which rejects corrupt counts before memory is allocated for them.
+                */
+                void checkRecordCount(size_t count) const
+                {
+                    if (count > getRemainingSize()) throw RuntimeError("Unexpected end of file in PLY file '{}'.", mName);
+                }
+
+                int64_t readInt(PropertyType type)
+                {
+                    if (isBinary())
+                    {
+                        const uint8_t* p = consume(getTypeSize(type));
+                        return loadInt(p, type);
+                    }
+                    else
+                    {
+                        auto token = nextToken();
+                        if (type == PropertyType::Float32 || type == PropertyType::Float64) return (int64_t)parseFloat(token);
+                        int64_t value = 0;
+                        auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+                        if (ec != std::errc() || ptr != token.data() + token.size()) throw RuntimeError("Invalid integer '{}' in PLY file '{}'.", token, mName);
+                        return value;
+                    }
+                }
+
+                double readFloat(PropertyType type)
+                {
+                    if (isBinary())
+                    {
+                        const uint8_t* p = consume(getTypeSize(type));
+                        return loadFloat(p, type);
+                    }
+                    else
+                    {
+                        return parseFloat(nextToken());
+                    }
+                }
+
+                /** Skip a property value (or all values of a list property).
+                */
+                void skip(const Property& property)
+                {
+                    int64_t count = property.isList ? readInt(property.countType) : 1;
+                    if (count < 0) throw RuntimeError("Invalid list count {} in PLY file '{}'.", count, mName);
+                    if (isBinary())
+                    {
+                        consume((size_t)count, getTypeSize(property.type));
+                    }
+                    else
+                    {
+                        for (int64_t i = 0; i < count; ++i) nextToken();
+                    }
+                }
+
+                int64_t loadInt(const uint8_t* p, PropertyType type) const
+                {
+                    const bool swap = isSwapped();
+                    switch (type)
+                    {
+                    case PropertyType::Int8: return (int8_t)*p;
+                    case PropertyType::UInt8: return *p;
+                    case PropertyType::Int16: return load<int16_t>(p, swap);
+                    case PropertyType::UInt16: return load<uint16_t>(p, swap);
+                    case PropertyType::Int32: return load<int32_t>(p, swap);
+                    case PropertyType::UInt32: return load<uint32_t>(p, swap);
+                    case PropertyType::Float32: return (int64_t)load<float>(p, swap);
+                    case PropertyType::Float64: return (int64_t)load<double>(p, swap);
+                    default: FALCOR_UNREACHABLE(); return 0;
+                    }
+                }
+
+                double loadFloat(const uint8_t* p, PropertyType type) const
+                {
+                    switch (type)
+                    {
+                    case PropertyType::Float32: return load<float>(p, isSwapped());
+                    case PropertyType::Float64: return load<double>(p, isSwapped());
+                    default: return (double)loadInt(p, type);
+                    }
+                }
+
+            private:
+                std::string_view nextToken()
+                {
+                    while (mpData < mpEnd && std::isspace(*mpData)) ++mpData;
+                    const uint8_t* pBegin = mpData;
+                    while (mpData < mpEnd && !std::isspace(*mpData)) ++mpData;
+                    if (pBegin == mpData) throw RuntimeError("Unexpected end of file in PLY file '{}'.", mName);
+                    return std::string_view((const char*)pBegin, mpData - pBegin);
+                }
+
+                double parseFloat(std::string_view token)
+                {
+                    const char* begin = token.data();
+                    const char* end = begin + token.size();
+                    // Skip '+' character, fast_float::from_chars doesn't handle '+'.
+                    if (begin < end && *begin == '+') ++begin;
+                    double value = 0.0;
+                    auto [ptr, ec] = fast_float::from_chars(begin, end, value);
+                    if (ec != std::errc() || ptr != end) throw RuntimeError("Invalid number '{}' in PLY file '{}'.", token, mName);
+                    return value;
+                }
+
+                const uint8_t* mpData;
+                const uint8_t* mpEnd;
+                Format mFormat;
+                const std::string& mName;
+            };
+
+            /** Parse the PLY header.
+                \param[in,out] pData Pointer to the start of the file. Set to the start of the element data on return.
+            */
+            std::vector<Element> parseHeader(const uint8_t*& pData, const uint8_t* pEnd, Format& format, const std::string& name)
+            {
+                auto nextLine = [&]()
+                {
+                    const uint8_t* pBegin = pData;
+                    while (pData < pEnd && *pData != '\n') ++pData;
+                    if (pData == pEnd) throw RuntimeError("Unexpected end of header in PLY file '{}'.", name);
+                    std::string_view line((const char*)pBegin, pData - pBegin);
+                    ++pData;
+                    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+                    return line;
+                };
+
+                auto splitLine = [](std::string_view line)
+                {
+                    std::vector<std::string_view> tokens;
+                    size_t pos = 0;
+                    while (pos < line.size())
+                    {
+                        while (pos < line.size() && std::isspace((unsigned char)line[pos])) ++pos;
+                        size_t start = pos;
+                        while (pos < line.size() && !std::isspace((unsigned char)line[pos])) ++pos;
+                        if (pos > start) tokens.push_back(line.substr(start, pos - start));
+                    }
+                    return tokens;
+                };
+
+                if (nextLine() != "ply") throw RuntimeError("Missing 'ply' magic in PLY file '{}'.", name);
+
+                std::vector<Element> elements;
+                bool hasFormat = false;
+
+                while (true)
+                {
+                    auto line = nextLine();
+                    auto tokens = splitLine(line);
+                    if (tokens.empty()) continue;
+
+                    const auto& keyword = tokens[0];
+                    if (keyword == "end_header")
+                    {
+                        break;
+                    }
+                    else if (keyword == "comment" || keyword == "obj_info")
+                    {
+                        continue;
+                    }
+                    else if (keyword == "format" && tokens.size() == 3)
+                    {
+                        if (tokens[1] == "ascii") format = Format::Ascii;
+                        else if (tokens[1] == "binary_little_endian") format = Format::BinaryLittleEndian;
+                        else if (tokens[1] == "binary_big_endian") format = Format::BinaryBigEndian;
+                        else throw RuntimeError("Unknown format '{}' in PLY file '{}'.", tokens[1], name);
+                        hasFormat = true;
+                    }
+                    else if (keyword == "element" && tokens.size() == 3)
+                    {
+                        Element element;
+                        element.name = tokens[1];
+                        auto [ptr, ec] = std::from_chars(tokens[2].data(), tokens[2].data() + tokens[2].size(), element.count);
+                        if (ec != std::errc()) throw RuntimeError("Invalid element count '{}' in PLY file '{}'.", tokens[2], name);
+                        elements.push_back(std::move(element));
+                    }
+                    else if (keyword == "property" && !elements.empty())
+                    {
+                        Property property;
+                        bool valid = false;
+                        if (tokens.size() == 5 && tokens[1] == "list")
+                        {
+                            property.isList = true;
+                            property.name = tokens[4];
+                            valid = parseType(tokens[2], property.countType) && parseType(tokens[3], property.type);
+                        }
+                        else if (tokens.size() == 3)
+                        {
+                            property.name = tokens[2];
+                            valid = parseType(tokens[1], property.type);
+                        }
+                        if (!valid) throw RuntimeError("Invalid property '{}' in PLY file '{}'.", line, name);
+                        elements.back().properties.push_back(std::move(property));
+                    }
+                    else
+                    {
+                        throw RuntimeError("Invalid header line '{}' in PLY file '{}'.", line, name);
+                    }
+                }
+
+                if (!hasFormat) throw RuntimeError("Missing format in PLY file '{}'.", name);
+                return elements;
+            }
+
+            void readVertices(Reader& reader, const Element& element, PLYMesh& mesh, const std::string& name)
+            {
+                // Attributes are only loaded if all their components are present.
+                uint32_t positionMask = 0, normalMask = 0, texCoordMask = 0;
+                for (size_t i = 0; i < element.properties.size(); ++i)
+                {
+                    const auto& property = element.properties[i];
+                    if (property.isList) throw RuntimeError("List property '{}' in vertex element not supported in PLY file '{}'.", property.name, name);
+
+                    const auto& n = property.name;
+                    if (n == "x") positionMask |= 1;
+                    else if (n == "y") positionMask |= 2;
+                    else if (n == "z") positionMask |= 4;
+                    else if (n == "nx") normalMask |= 1;
+                    else if (n == "ny") normalMask |= 2;
+                    else if (n == "nz") normalMask |= 4;
+                    else if (n == "u" || n == "s" || n == "texture_u" || n == "texture_s") texCoordMask |= 1;
+                    else if (n == "v" || n == "t" || n == "texture_v" || n == "texture_t") texCoordMask |= 2;
+                }
+
+                if (positionMask != 7) throw RuntimeError("Missing vertex positions in PLY file '{}'.", name);
+                if (element.count == 0) return;
+                reader.checkRecordCount(element.count);
+
+                mesh.positions.resize(element.count);
+                float* pPositions = &mesh.positions[0].x;
+                float* pNormals = nullptr;
+                float* pTexCoords = nullptr;
+                if (normalMask == 7)
+                {
+                    mesh.normals.resize(element.count);
+                    pNormals = &mesh.normals[0].x;
+                }
+                if (texCoordMask == 3)
+                {
+                    mesh.texCoords.resize(element.count);
+                    pTexCoords = &mesh.texCoords[0].x;
+                }
+
+                // Map vertex properties to attribute components. Properties without a target are skipped.
+                struct Target
+                {
+                    float* pDst = nullptr;
+                    size_t stride = 0;
+                };
+                std::vector<Target> targets(element.properties.size());
+
+                for (size_t i = 0; i < element.properties.size(); ++i)
+                {
+                    const auto& n = element.properties[i].name;
+                    if (n == "x") targets[i] = { pPositions + 0, 3 };
+                    else if (n == "y") targets[i] = { pPositions + 1, 3 };
+                    else if (n == "z") targets[i] = { pPositions + 2, 3 };
+                    else if (pNormals && n == "nx") targets[i] = { pNormals + 0, 3 };
+                    else if (pNormals && n == "ny") targets[i] = { pNormals + 1, 3 };
+                    else if (pNormals && n == "nz") targets[i] = { pNormals + 2, 3 };
+                    else if (pTexCoords && (n == "u" || n == "s" || n == "texture_u" || n == "texture_s")) targets[i] = { pTexCoords + 0, 2 };
+                    else if (pTexCoords && (n == "v" || n == "t" || n == "texture_v" || n == "texture_t")) targets[i] = { pTexCoords + 1, 2 };
+                }
+
+                if (reader.isBinary())
+                {
+                    // Vertex records have a fixed size in binary files.
+                    // Gather each property with a strided loop over all vertices.
+                    std::vector<size_t> offsets(element.properties.size());
+                    size_t recordSize = 0;
+                    for (size_t i = 0; i < element.properties.size(); ++i)
+                    {
+                        offsets[i] = recordSize;
+                        recordSize += getTypeSize(element.properties[i].type);
+                    }
+
+                    const uint8_t* pData = reader.consume(element.count, recordSize);
+                    for (size_t i = 0; i < element.properties.size(); ++i)
+                    {
+                        const auto& target = targets[i];
+                        if (!target.pDst) continue;
+
+                        const uint8_t* pSrc = pData + offsets[i];
+                        const PropertyType type = element.properties[i].type;
+                        if (type == PropertyType::Float32 && !reader.isSwapped())
+                        {
+                            for (size_t j = 0; j < element.count; ++j) std::memcpy(target.pDst + j * target.stride, pSrc + j * recordSize, sizeof(float));
+                        }
+                        else
+                        {
+                            for (size_t j = 0; j < element.count; ++j) target.pDst[j * target.stride] = (float)reader.loadFloat(pSrc + j * recordSize, type);
+                        }
+                    }
+                }
+                else
+                {
+                    for (size_t j = 0; j < element.count; ++j)
+                    {
+                        for (size_t i = 0; i < element.properties.size(); ++i)
+                        {
+                            float value = (float)reader.readFloat(element.properties[i].type);
+                            if (targets[i].pDst) targets[i].pDst[j * targets[i].stride] = value;
+                        }
+                    }
+                }
+            }
+
+            void readFaces(Reader& reader, const Element& element, PLYMesh& mesh, const std::string& name)
+            {
+                // Other properties, like the 'face_indices' that pbrt uses for Ptex lookups, are skipped.
+                int vertexIndicesProperty = -1;
+                for (size_t i = 0; i < element.properties.size(); ++i)
+                {
+                    const auto& property = element.properties[i];
+                    if (property.isList && (property.name == "vertex_indices" || property.name == "vertex_index")) vertexIndicesProperty = (int)i;
+                }
+
+                if (vertexIndicesProperty < 0) throw RuntimeError("Missing vertex indices in PLY file '{}'.", name);
+
+                // Most files contain triangles or quads only, reserve for the triangle case.
+                reader.checkRecordCount(element.count);
+                mesh.indices.reserve(element.count * 3);
+
+                const PropertyType indexType = element.properties[vertexIndicesProperty].type;
+                const size_t indexSize = getTypeSize(indexType);
+                std::vector<int64_t> polygon;
+
+                for (size_t j = 0; j < element.count; ++j)
+                {
+                    uint32_t vertexCount = 0;
+                    for (size_t i = 0; i < element.properties.size(); ++i)
+                    {
+                        const auto& property = element.properties[i];
+                        if ((int)i == vertexIndicesProperty)
+                        {
+                            const int64_t count = reader.readInt(property.countType);
+                            if (count < 0 || count > std::numeric_limits<uint32_t>::max()) throw RuntimeError("Invalid polygon vertex count {} in PLY file '{}'.", count, name);
+                            vertexCount = (uint32_t)count;
+                            polygon.resize(vertexCount);
+                            if (reader.isBinary())
+                            {
+                                const uint8_t* p = reader.consume(vertexCount, indexSize);
+                                for (uint32_t k = 0; k < vertexCount; ++k) polygon[k] = reader.loadInt(p + k * indexSize, indexType);
+                            }
+                            else
+                            {
+                                for (uint32_t k = 0; k < vertexCount; ++k) polygon[k] = reader.readInt(indexType);
+                            }
+                        }
+                        else
+                        {
+                            reader.skip(property);
+                        }
+                    }
+
+                    for (uint32_t k = 0; k < vertexCount; ++k)
+                    {
+                        if (polygon[k] < 0 || polygon[k] > std::numeric_limits<uint32_t>::max()) throw RuntimeError("Invalid vertex index {} in PLY file '{}'.", polygon[k], name);
+                    }
+
+                    // Split polygons into a triangle fan. Degenerate polygons with less than 3 vertices produce no triangles.
+                    for (uint32_t k = 2; k < vertexCount; ++k)
+                    {
+                        mesh.indices.push_back((uint32_t)polygon[0]);
+                        mesh.indices.push_back((uint32_t)polygon[k - 1]);
+                        mesh.indices.push_back((uint32_t)polygon[k]);
+                    }
+                }
+            }
+
+            void skipElement(Reader& reader, const Element& element)
+            {
+                bool hasList = false;
+                size_t recordSize = 0;
+                for (const auto& property : element.properties)
+                {
+                    hasList |= property.isList;
+                    recordSize += getTypeSize(property.type);
+                }
+
+                if (reader.isBinary() && !hasList)
+                {
+                    reader.consume(element.count, recordSize);
+                    return;
+                }
+
+                for (size_t j = 0; j < element.count; ++j)
+                {
+                    for (const auto& property : element.properties) reader.skip(property);
+                }
+            }
+
+            /** Compute area weighted vertex normals.
+            */
+            void computeNormals(PLYMesh& mesh)
+            {
+                mesh.normals.assign(mesh.positions.size(), float3(0.f));
+                for (size_t i = 0; i < mesh.indices.size(); i += 3)
+                {
+                    const uint32_t i0 = mesh.indices[i], i1 = mesh.indices[i + 1], i2 = mesh.indices[i + 2];
+                    const float3 n = glm::cross(mesh.positions[i1] - mesh.positions[i0], mesh.positions[i2] - mesh.positions[i0]);
+                    mesh.normals[i0] += n;
+                    mesh.normals[i1] += n;
+                    mesh.normals[i2] += n;
+                }
+                for (auto& n : mesh.normals)
+                {
+                    const float len = glm::length(n);
+                    n = len > 0.f ? n / len : float3(0.f, 0.f, 1.f);
+                }
+            }
+        }
+
+        PLYMesh loadPLY(const std::filesystem::path& path)
+        {
+            if (hasExtension(path, "gz"))
+            {
+                auto decompressed = decompressFile(path);
+                return loadPLY(decompressed.data(), decompressed.size(), path.string());
+            }
+
+            MemoryMappedFile file(path, MemoryMappedFile::AccessHint::SequentialScan);
+            if (!file.isOpen()) throw RuntimeError("Failed to open PLY file '{}'.", path);
+            return loadPLY(file.getData(), file.getSize(), path.string());
+        }
+
+        PLYMesh loadPLY(const void* pData, size_t size, const std::string& name)
+        {
+            const uint8_t* pBegin = static_cast<const uint8_t*>(pData);
+            const uint8_t* pEnd = pBegin + size;
+
+            Format format = Format::Ascii;
+            auto elements = parseHeader(pBegin, pEnd, format, name);
+
+            PLYMesh mesh;
+            Reader reader(pBegin, pEnd, format, name);
+            for (const auto& element : elements)
+            {
+                if (element.name == "vertex") readVertices(reader, element, mesh, name);
+                else if (element.name == "face") readFaces(reader, element, mesh, name);
+                else skipElement(reader, element);
+            }
+
+            if (mesh.positions.empty() || mesh.indices.empty()) throw RuntimeError("PLY file '{}' does not contain any triangles.", name);
+            for (uint32_t index : mesh.indices)
+            {
+                if (index >= mesh.positions.size()) throw RuntimeError("Vertex index {} out of bounds in PLY file '{}'.", index, name);
+            }
+            if (mesh.normals.empty()) computeNormals(mesh);
+
+            return mesh;
+        }
+    }
+}
@@ -0,0 +1,68 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/Vector.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    namespace pbrt
+    {
+        /** Triangle mesh loaded from a PLY file.
+            The attribute arrays are laid out as expected by SceneBuilder::Mesh with per-vertex frequency.
+        */
+        struct PLYMesh
+        {
+            std::vector<float3> positions;      ///< Vertex positions.
+            std::vector<float3> normals;        ///< Vertex normals. Computed from the triangles if not stored in the file.
+            std::vector<float2> texCoords;      ///< Vertex texture coordinates as stored in the file. Empty if not available.
+            std::vector<uint32_t> indices;      ///< Triangle vertex indices. Polygons are split into triangle fans.
+        };
+
+        /** Load a triangle mesh from a PLY file.
+            Supports the ascii, binary_little_endian and binary_big_endian formats as well as gzip compressed files (.ply.gz).
+            The file is parsed in a single pass directly into the output arrays. The function is thread safe,
+            so multiple files can be loaded concurrently.
+            Throws a RuntimeError if the file cannot be read or is malformed.
+            \param[in] path File path.
+            \return The loaded mesh.
+        */
+        FALCOR_API PLYMesh loadPLY(const std::filesystem::path& path);
+
+        /** Load a triangle mesh from PLY data in memory.
+            \param[in] pData Pointer to the PLY data.
+            \param[in] size Size of the PLY data in bytes.
+            \param[in] name Name used in error messages.
+            \return The loaded mesh.
+        */
+        FALCOR_API PLYMesh loadPLY(const void* pData, size_t size, const std::string& name);
+    }
+}
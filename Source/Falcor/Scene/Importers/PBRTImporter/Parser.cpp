@@ -36,11 +36,14 @@
 #include "Core/Assert.h"
 #include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 
 #include <fast_float/fast_float.h>
 
 #include <atomic>
 #include <charconv>
+#include <exception>
+#include <mutex>
 
 namespace Falcor
 {
@@ -95,6 +98,10 @@ namespace Falcor
             }
             else
             {
+                auto pMappedFile = std::make_unique<MemoryMappedFile>(path, MemoryMappedFile::AccessHint::SequentialScan);
+                if (pMappedFile->isOpen()) return std::make_unique<Tokenizer>(std::move(pMappedFile), path);
+
+                // Fall back to reading the file into memory (empty files cannot be mapped).
                 std::string str = readFile(path);
                 return std::make_unique<Tokenizer>(std::move(str), path);
             }
@@ -109,13 +116,30 @@ namespace Falcor
             : mPath(path)
             , mContents(std::move(str))
         {
-            auto pFilename = std::make_unique<std::string>(path.string());
-            mLoc = FileLoc(*pFilename);
-            getFilenames().push_back(std::move(pFilename));
+            init(mContents.data(), mContents.size());
+        }
+
+        Tokenizer::Tokenizer(std::unique_ptr<MemoryMappedFile> pMappedFile, const std::filesystem::path& path)
+            : mPath(path)
+            , mpMappedFile(std::move(pMappedFile))
+        {
+            FALCOR_ASSERT(mpMappedFile && mpMappedFile->isOpen());
+            init(static_cast<const char*>(mpMappedFile->getData()), mpMappedFile->getSize());
+        }
+
+        void Tokenizer::init(const char* pData, size_t size)
+        {
+            static std::mutex filenamesMutex;
+            {
+                std::lock_guard<std::mutex> lock(filenamesMutex);
+                auto pFilename = std::make_unique<std::string>(mPath.string());
+                mLoc = FileLoc(*pFilename);
+                getFilenames().push_back(std::move(pFilename));
+            }
 
-            mPos = mContents.data();
-            mEnd = mPos + mContents.size();
-            if (isUTF16(mContents.data(), mContents.size())) throwError("File is encoded with UTF-16, which is not currently supported.");
+            mPos = pData;
+            mEnd = mPos + size;
+            if (isUTF16(pData, size)) throwError("File is encoded with UTF-16, which is not currently supported.");
         }
 
         bool Tokenizer::isUTF16(const void* ptr, size_t len) const
@@ -268,6 +292,90 @@ namespace Falcor
             return value;
         }
 
+        /** Parse a number without error reporting. Used by Tokenizer::readNumberArray(),
+            which leaves invalid numbers to parseInt()/parseFloat() for reporting the error.
+            \return True if the whole string is a valid number.
+        */
+        static bool tryParseNumber(const char* begin, const char* end, int32_t& result)
+        {
+            if (*begin == '+') begin++;
+            int64_t value;
+            auto [ptr, ec] = std::from_chars(begin, end, value);
+            if (ptr != end || ec != std::errc()) return false;
+            if (value < std::numeric_limits<int32_t>::lowest() || value > std::numeric_limits<int32_t>::max()) return false;
+            result = (int32_t)value;
+            return true;
+        }
+
+        static bool tryParseNumber(const char* begin, const char* end, Float& result)
+        {
+            if (*begin == '+') begin++;
+            auto [ptr, ec] = fast_float::from_chars(begin, end, result);
+            return ptr == end && ec == std::errc();
+        }
+
+        static bool isNumberStart(char ch)
+        {
+            return (ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.';
+        }
+
+        static bool isTokenDelimiter(char ch)
+        {
+            return ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r' || ch == '"' || ch == '[' || ch == ']';
+        }
+
+        template<typename T>
+        bool Tokenizer::readNumberArray(std::vector<T>& values)
+        {
+            while (true)
+            {
+                // Arrays may continue in the including file, let the regular path handle the end of the file.
+                if (mPos == mEnd) return false;
+
+                const char ch = *mPos;
+                if (ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r')
+                {
+                    getChar();
+                }
+                else if (ch == '#')
+                {
+                    // Comment: scan to EOL (or EOF).
+                    while (mPos != mEnd && *mPos != '\n' && *mPos != '\r') getChar();
+                }
+                else if (ch == ']')
+                {
+                    getChar();
+                    return true;
+                }
+                else if (isNumberStart(ch))
+                {
+                    // Numbers never contain newlines, so only the column needs to be updated.
+                    const char* tokenStart = mPos;
+                    const char* tokenEnd = tokenStart + 1;
+                    while (tokenEnd != mEnd && !isTokenDelimiter(*tokenEnd)) ++tokenEnd;
+
+                    T value;
+                    if (!tryParseNumber(tokenStart, tokenEnd, value))
+                    {
+                        // Let the regular path report the error.
+                        return false;
+                    }
+                    values.push_back(value);
+
+                    mLoc.column += uint32_t(tokenEnd - tokenStart);
+                    mPos = tokenEnd;
+                }
+                else
+                {
+                    // Not a number, continue with the regular path.
+                    return false;
+                }
+            }
+        }
+
+        template bool Tokenizer::readNumberArray(std::vector<Float>& values);
+        template bool Tokenizer::readNumberArray(std::vector<int>& values);
+
         inline bool isQuotedString(const std::string_view str)
         {
             return str.size() >= 2 && str[0] == '"' && str.back() == '"';
@@ -285,8 +393,17 @@ namespace Falcor
         constexpr uint32_t TokenOptional = 0;
         constexpr uint32_t TokenRequired = 1;
 
-        template <typename Next, typename Unget>
-        static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
+        /** Returns true if the values of a parameter type are always floating-point numbers.
+        */
+        static bool isFloatParameterType(const std::string& type)
+        {
+            return type == "float" || type == "point" || type == "point2" || type == "point3" ||
+                type == "vector" || type == "vector2" || type == "vector3" || type == "normal" || type == "normal3" ||
+                type == "rgb" || type == "blackbody";
+        }
+
+        template <typename Next, typename Unget, typename ReadNumbers>
+        static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken, ReadNumbers readNumbers)
         {
             ParsedParameterVector parameterVector;
 
@@ -416,7 +533,20 @@ namespace Falcor
 
                 if (val.token == "[")
                 {
-                    while (true)
+                    // Parse numeric arrays directly into the typed value lists.
+                    // Falls back to the regular path if a value is not a number.
+                    bool done = false;
+                    if (valType == Int)
+                    {
+                        done = readNumbers(param.ints);
+                    }
+                    else if (isFloatParameterType(param.type))
+                    {
+                        done = readNumbers(param.floats);
+                        if (!param.floats.empty()) valType = Float;
+                    }
+
+                    while (!done)
                     {
                         val = *nextToken(TokenRequired);
                         if (val.token == "]") break;
@@ -428,19 +558,28 @@ namespace Falcor
                     addVal(val);
                 }
 
-                parameterVector.push_back(param);
+                parameterVector.push_back(std::move(param));
             }
 
             return parameterVector;
         }
 
-        void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
+        void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer, const std::filesystem::path& searchPath)
         {
             static std::atomic<bool> warnedTransformBeginEndDeprecated{false};
 
             logInfo("PBRTImporter: Started parsing '{}'.", tokenizer->getPath().string());
 
-            auto searchPath = tokenizer->getPath().parent_path();
+            /** Imported file that is parsed concurrently into a separate parser target.
+            */
+            struct Import
+            {
+                FileLoc loc;
+                std::unique_ptr<ParserTarget> pTarget;
+                std::exception_ptr exception;
+            };
+            std::vector<std::unique_ptr<Import>> imports;
+            Threading::TaskGroup importTasks;
 
             std::vector<std::unique_ptr<Tokenizer>> fileStack;
             fileStack.push_back(std::move(tokenizer));
@@ -491,6 +630,14 @@ namespace Falcor
                 ungetToken = t;
             };
 
+            /** Helper function reading the values of a numeric array from the current file.
+            */
+            auto readNumbers = [&](auto& values) -> bool
+            {
+                FALCOR_ASSERT(!ungetToken.has_value() && !fileStack.empty());
+                return fileStack.back()->readNumberArray(values);
+            };
+
             /** Helper function for pbrt API entrypoints that take a single string
                 parameter and a ParameterVector (e.g. onShape()).
             */
@@ -499,7 +646,7 @@ namespace Falcor
                 Token t = *nextToken(TokenRequired);
                 std::string_view dequoted = dequoteString(t);
                 std::string n = toString(dequoted);
-                ParsedParameterVector parameterVector = parseParameters(nextToken, unget);
+                ParsedParameterVector parameterVector = parseParameters(nextToken, unget, readNumbers);
                 (target.*apiFunc)(n, std::move(parameterVector), loc);
             };
 
@@ -614,13 +761,34 @@ namespace Falcor
                         Token filenameToken = *nextToken(TokenRequired);
                         std::string filename = toString(dequoteString(filenameToken));
                         auto path = searchPath / filename;
+                        target.onInclude(path, tok->loc);
                         std::unique_ptr<Tokenizer> includeTokenizer = Tokenizer::createFromFile(path);
                         logInfo("PBRTImporter: Started parsing '{}'.", includeTokenizer->getPath().string());
                         fileStack.push_back(std::move(includeTokenizer));
                     }
                     else if (tok->token == "Import")
                     {
-                        throwError(tok->loc, "'Import' directive not supported yet.");
+                        Token filenameToken = *nextToken(TokenRequired);
+                        std::string filename = toString(dequoteString(filenameToken));
+                        auto path = searchPath / filename;
+
+                        // Parse the imported file on a worker thread into its own parser target.
+                        // The targets are merged in the order of the Import directives once the current file is parsed.
+                        auto pImport = std::make_unique<Import>();
+                        pImport->loc = tok->loc;
+                        pImport->pTarget = target.onImportBegin(path, tok->loc);
+                        importTasks.run([pImport = pImport.get(), path, searchPath]()
+                        {
+                            try
+                            {
+                                parse(*pImport->pTarget, Tokenizer::createFromFile(path), searchPath);
+                            }
+                            catch (...)
+                            {
+                                pImport->exception = std::current_exception();
+                            }
+                        });
+                        imports.push_back(std::move(pImport));
                     }
                     else if (tok->token == "Identity")
                     {
@@ -827,7 +995,7 @@ namespace Falcor
                         Token t = *nextToken(TokenRequired);
                         std::string_view dequoted = dequoteString(t);
                         std::string texName = toString(dequoted);
-                        ParsedParameterVector params = parseParameters(nextToken, unget);
+                        ParsedParameterVector params = parseParameters(nextToken, unget, readNumbers);
                         target.onTexture(name, type, texName, std::move(params), tok->loc);
                     }
                     else
@@ -851,19 +1019,28 @@ namespace Falcor
                     syntaxError(*tok);
                 }
             }
+
+            // Wait for the imported files and merge them in order. Errors are reported in order as well.
+            importTasks.wait();
+            for (auto& pImport : imports)
+            {
+                if (pImport->exception) std::rethrow_exception(pImport->exception);
+                target.onImportEnd(std::move(pImport->pTarget), pImport->loc);
+            }
         }
 
         void parseFile(ParserTarget& target, const std::filesystem::path& path)
         {
             auto tokenizer = Tokenizer::createFromFile(path);
-            parse(target, std::move(tokenizer));
+            parse(target, std::move(tokenizer), path.parent_path());
             target.onEndOfFiles();
         }
 
         void parseString(ParserTarget& target, std::string str)
         {
             auto tokenizer = Tokenizer::createFromString(std::move(str));
-            parse(target, std::move(tokenizer));
+            auto searchPath = tokenizer->getPath().parent_path();
+            parse(target, std::move(tokenizer), searchPath);
             target.onEndOfFiles();
         }
     }
@@ -35,6 +35,8 @@
 
 #include "Types.h"
 #include "Parameters.h"
+#include "Core/Macros.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include <functional>
 #include <filesystem>
 #include <memory>
@@ -45,7 +47,7 @@ namespace Falcor
 {
     namespace pbrt
     {
-        class ParserTarget
+        class FALCOR_API ParserTarget
         {
         public:
             virtual ~ParserTarget();
@@ -93,11 +95,30 @@ namespace Falcor
             virtual void onObjectEnd(FileLoc loc) = 0;
             virtual void onObjectInstance(const std::string& name, FileLoc loc) = 0;
 
+            /** Called when the parser starts reading an included file.
+            */
+            virtual void onInclude(const std::filesystem::path& path, FileLoc loc) = 0;
+
+            /** Called when the parser encounters an Import directive.
+                Imported files cannot modify the graphics state of the importing file, which allows them to be parsed concurrently.
+                \param[in] path Path of the imported file.
+                \param[in] loc Location of the Import directive.
+                \return A new parser target for the imported file. It is used on a worker thread and passed to onImportEnd() once the file is parsed.
+            */
+            virtual std::unique_ptr<ParserTarget> onImportBegin(const std::filesystem::path& path, FileLoc loc) = 0;
+
+            /** Called when an imported file has been parsed.
+                Imported files are completed in the order of their Import directives, after the importing file has been parsed.
+                \param[in] pImportTarget The parser target returned by onImportBegin().
+                \param[in] loc Location of the Import directive.
+            */
+            virtual void onImportEnd(std::unique_ptr<ParserTarget> pImportTarget, FileLoc loc) = 0;
+
             virtual void onEndOfFiles() = 0;
         };
 
-        void parseFile(ParserTarget& target, const std::filesystem::path& path);
-        void parseString(ParserTarget& target, std::string str);
+        FALCOR_API void parseFile(ParserTarget& target, const std::filesystem::path& path);
+        FALCOR_API void parseString(ParserTarget& target, std::string str);
 
         struct Token
         {
@@ -108,11 +129,16 @@ namespace Falcor
             FileLoc loc;
         };
 
-        class Tokenizer
+        class FALCOR_API Tokenizer
         {
         public:
             Tokenizer(std::string str, const std::filesystem::path& path);
 
+            /** Create a tokenizer reading from a memory mapped file.
+                Tokens are views into the mapping, so the file contents are never copied.
+            */
+            Tokenizer(std::unique_ptr<MemoryMappedFile> pMappedFile, const std::filesystem::path& path);
+
             static std::unique_ptr<Tokenizer> createFromFile(const std::filesystem::path& path);
             static std::unique_ptr<Tokenizer> createFromString(std::string str);
 
@@ -121,6 +147,16 @@ namespace Falcor
             */
             std::optional<Token> next();
 
+            /** Parse the values of a numeric array directly into a typed buffer, without creating tokens.
+                This is the fast path for large arrays such as the vertex data of triangle meshes.
+                Must be called after the opening bracket has been read. Parsing stops at the closing bracket,
+                which is consumed, or at the first non-numeric value or the end of the file, which are left for next().
+                \param[in,out] values Parsed values are appended to this list (Float or int).
+                \return True if the closing bracket was reached.
+            */
+            template<typename T>
+            bool readNumberArray(std::vector<T>& values);
+
             const std::filesystem::path& getPath() const { return mPath; }
 
         private:
@@ -133,6 +169,8 @@ namespace Falcor
                 return filenames;
             }
 
+            void init(const char* pData, size_t size);
+
             bool isUTF16(const void* ptr, size_t len) const;
 
             int getChar()
@@ -164,7 +202,8 @@ namespace Falcor
 
             std::filesystem::path mPath;    ///< File path we're reading from.
             FileLoc mLoc;                   ///< File location.
-            std::string mContents;          ///< File contents we're parsing.
+            std::string mContents;          ///< File contents we're parsing (if not memory mapped).
+            std::unique_ptr<MemoryMappedFile> mpMappedFile; ///< Memory mapped file we're parsing.
 
             const char* mPos;               ///< Current position in the file.
             const char* mEnd;               ///< End of the file (one past).
@@ -34,6 +34,7 @@
 #include "Scene/Material/HairMaterial.h"
 #include "Scene/Material/StandardMaterial.h"
 #include "Utils/Settings.h"
+#include "Utils/Threading.h"
 
 #include <glm/gtx/matrix_decompose.hpp>
 
@@ -1126,8 +1127,7 @@ namespace Falcor
         void addMeshesToSceneBuilder(ImporterContext& ctx, TimeReport& timeReport)
         {
             // Process collected mesh tasks.
-            NumericRange<size_t> meshRange(0, ctx.meshTasks.size());
-            std::for_each(std::execution::par, meshRange.begin(), meshRange.end(),
+            Threading::parallelFor(0, ctx.meshTasks.size(),
                 [&](size_t i)
                 {
                     FALCOR_ASSERT(ctx.meshTasks[i].sampleIdx == 0);
@@ -1162,8 +1162,7 @@ namespace Falcor
                 }
 
                 // Process time-sampled mesh keyframes
-                NumericRange<size_t> keyframeRange(0, ctx.meshKeyframeTasks.size());
-                std::for_each(std::execution::par, keyframeRange.begin(), keyframeRange.end(),
+                Threading::parallelFor(0, ctx.meshKeyframeTasks.size(),
                     [&](size_t i)
                     {
                         auto& task = ctx.meshKeyframeTasks[i];
@@ -1292,8 +1291,7 @@ namespace Falcor
         void addCurvesToSceneBuilder(ImporterContext& ctx, TimeReport& timeReport)
         {
             // Process collected curves.
-            NumericRange<size_t> range(0, ctx.curves.size());
-            std::for_each(std::execution::par, range.begin(), range.end(),
+            Threading::parallelFor(0, ctx.curves.size(),
                 [&](size_t i) { processCurve(ctx.curves[i], ctx); }
             );
 
@@ -1473,6 +1471,7 @@ namespace Falcor
             return;
         }
 
+        builder.addCacheDependency(envMapPath);
         EnvMap::SharedPtr pEnvMap = EnvMap::createFromFile(envMapPath);
 
         if (pEnvMap == nullptr)
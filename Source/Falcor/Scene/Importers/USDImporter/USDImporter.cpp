@@ -320,6 +320,13 @@ namespace Falcor
             throw ImporterError(path, "Failed to open USD stage.");
         }
 
+        // Record all layers contributing to the stage as scene cache dependencies.
+        for (const auto& pLayer : pStage->GetUsedLayers())
+        {
+            const std::string layerPath = pLayer->GetRealPath();
+            if (!layerPath.empty()) builder.addCacheDependency(layerPath);
+        }
+
         timeReport.measure("Open stage");
 
         ImporterContext ctx(path, pStage, builder, dict, timeReport);
@@ -0,0 +1,291 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "EmissiveTextureIntegrator.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Resolve a texel coordinate using an address mode.
+            \return Coordinate in [0, n), or -1 if the texel is outside the texture in border mode.
+        */
+        int64_t resolveAddress(int64_t i, int64_t n, Sampler::AddressMode mode)
+        {
+            switch (mode)
+            {
+            case Sampler::AddressMode::Wrap:
+                return ((i % n) + n) % n;
+            case Sampler::AddressMode::Mirror:
+            {
+                int64_t p = ((i % (2 * n)) + 2 * n) % (2 * n);
+                return p < n ? p : 2 * n - 1 - p;
+            }
+            case Sampler::AddressMode::Clamp:
+                return std::clamp(i, int64_t(0), n - 1);
+            case Sampler::AddressMode::Border:
+                return i >= 0 && i < n ? i : -1;
+            case Sampler::AddressMode::MirrorOnce:
+                return std::min(i < 0 ? -i - 1 : i, n - 1);
+            default:
+                FALCOR_UNREACHABLE();
+                return -1;
+            }
+        }
+
+        /** Clip a convex polygon against the half-plane sign * (p[axis] - bound) >= 0.
+            \return Number of output vertices.
+        */
+        uint32_t clipPolygon(const float2* pIn, uint32_t count, float2* pOut, uint32_t axis, float bound, float sign)
+        {
+            uint32_t outCount = 0;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const float2& a = pIn[i];
+                const float2& b = pIn[(i + 1) % count];
+                const float da = sign * (a[axis] - bound);
+                const float db = sign * (b[axis] - bound);
+                if (da >= 0.f) pOut[outCount++] = a;
+                if ((da >= 0.f) != (db >= 0.f))
+                {
+                    float2 p = a + (b - a) * (da / (da - db));
+                    p[axis] = bound;
+                    pOut[outCount++] = p;
+                }
+            }
+            return outCount;
+        }
+
+        float edgeFunction(const float2& a, const float2& b, const float2& p)
+        {
+            return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+        }
+
+        template<typename T, uint32_t N, typename Convert>
+        void decodeTexels(const uint8_t* pData, uint32_t width, uint32_t height, uint32_t rowPitch, const int channelMap[3], std::vector<float3>& texels, Convert convert)
+        {
+            for (uint32_t y = 0; y < height; y++)
+            {
+                const T* pRow = reinterpret_cast<const T*>(pData + (size_t)y * rowPitch);
+                float3* pDst = texels.data() + (size_t)y * width;
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    const T* pTexel = pRow + (size_t)x * N;
+                    float3 c(0.f);
+                    for (uint32_t i = 0; i < 3; i++)
+                    {
+                        if (channelMap[i] >= 0) c[i] = convert(pTexel[channelMap[i]], i);
+                    }
+                    pDst[x] = c;
+                }
+            }
+        }
+    }
+
+    float3 EmissiveTextureIntegrator::TextureData::fetch(int64_t x, int64_t y) const
+    {
+        FALCOR_ASSERT(width > 0 && height > 0 && texels.size() == (size_t)width * height);
+        x = resolveAddress(x, width, addressModeU);
+        y = resolveAddress(y, height, addressModeV);
+        if (x < 0 || y < 0) return float3(0.f);
+        return texels[(size_t)y * width + (size_t)x];
+    }
+
+    float3 EmissiveTextureIntegrator::TextureData::sample(float2 uv) const
+    {
+        return fetch((int64_t)std::floor((double)uv.x * width), (int64_t)std::floor((double)uv.y * height));
+    }
+
+    bool EmissiveTextureIntegrator::isFormatSupported(ResourceFormat format)
+    {
+        const FormatType type = getFormatType(format);
+        const uint32_t channelCount = getFormatChannelCount(format);
+        const uint32_t channelBits = getNumChannelBits(format, 0);
+
+        // Require uniform channel sizes without padding.
+        if (isCompressedFormat(format) || channelCount == 0 || getFormatBytesPerBlock(format) * 8 != channelCount * channelBits) return false;
+
+        switch (type)
+        {
+        case FormatType::Unorm: return channelBits == 8 || channelBits == 16;
+        case FormatType::UnormSrgb: return channelBits == 8;
+        case FormatType::Float: return channelBits == 16 || channelBits == 32;
+        default: return false;
+        }
+    }
+
+    EmissiveTextureIntegrator::TextureData EmissiveTextureIntegrator::createTextureData(const void* pData, uint32_t width, uint32_t height, uint32_t rowPitch, ResourceFormat format, Sampler::AddressMode addressModeU, Sampler::AddressMode addressModeV)
+    {
+        FALCOR_ASSERT(pData);
+        checkArgument(width > 0 && height > 0, "Texture dimensions must be non-zero");
+        if (!isFormatSupported(format)) throw RuntimeError("Format {} is not supported", to_string(format));
+        checkArgument((uint64_t)width * getFormatBytesPerBlock(format) <= rowPitch, "Row pitch is too small for the texture width");
+
+        const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+        const FormatType type = getFormatType(format);
+        const uint32_t channelCount = getFormatChannelCount(format);
+        const uint32_t channelBits = getNumChannelBits(format, 0);
+        const bool srgb = type == FormatType::UnormSrgb;
+
+        // Map RGB to storage channels.
+        int channelMap[3] = { -1, -1, -1 };
+        for (uint32_t i = 0; i < std::min(channelCount, 3u); i++) channelMap[i] = (int)i;
+        if (format == ResourceFormat::BGRA8Unorm || format == ResourceFormat::BGRA8UnormSrgb || format == ResourceFormat::BGRX8Unorm || format == ResourceFormat::BGRX8UnormSrgb)
+        {
+            std::swap(channelMap[0], channelMap[2]);
+        }
+
+        TextureData texture;
+        texture.width = width;
+        texture.height = height;
+        texture.addressModeU = addressModeU;
+        texture.addressModeV = addressModeV;
+        texture.texels.resize((size_t)width * height);
+
+        auto unorm8 = [srgb](uint8_t v, uint32_t) { float f = v / 255.f; return srgb ? sRGBToLinear(f) : f; };
+        auto unorm16 = [](uint16_t v, uint32_t) { return v / 65535.f; };
+        auto float16 = [](uint16_t v, uint32_t) { return f16tof32(v); };
+        auto float32 = [](float v, uint32_t) { return v; };
+
+#define dispatch_channels(T, convert) \
+        switch (channelCount) \
+        { \
+        case 1: decodeTexels<T, 1>(pBytes, width, height, rowPitch, channelMap, texture.texels, convert); break; \
+        case 2: decodeTexels<T, 2>(pBytes, width, height, rowPitch, channelMap, texture.texels, convert); break; \
+        case 3: decodeTexels<T, 3>(pBytes, width, height, rowPitch, channelMap, texture.texels, convert); break; \
+        case 4: decodeTexels<T, 4>(pBytes, width, height, rowPitch, channelMap, texture.texels, convert); break; \
+        default: FALCOR_UNREACHABLE(); \
+        }
+
+        if (channelBits == 8) { dispatch_channels(uint8_t, unorm8); }
+        else if (type == FormatType::Unorm) { dispatch_channels(uint16_t, unorm16); }
+        else if (channelBits == 16) { dispatch_channels(uint16_t, float16); }
+        else { dispatch_channels(float, float32); }
+#undef dispatch_channels
+
+        return texture;
+    }
+
+    float3 EmissiveTextureIntegrator::integrateTriangle(const TextureData& texture, const float2 texCoords[3], float* pWeight)
+    {
+        FALCOR_ASSERT(texture.width > 0 && texture.height > 0);
+        const float2 dim((float)texture.width, (float)texture.height);
+
+        // Place the triangle in texel space, offset so that the positions are positive.
+        // This matches the placement done by the raster integrator.
+        const float2 uvOffset = floor(min(min(texCoords[0], texCoords[1]), texCoords[2]));
+        float2 pos[3];
+        for (uint32_t i = 0; i < 3; i++) pos[i] = (texCoords[i] - uvOffset) * dim;
+
+        const float2 posMin = min(min(pos[0], pos[1]), pos[2]);
+        const float2 posMax = max(max(pos[0], pos[1]), pos[2]);
+        const int64_t x0 = (int64_t)std::floor(posMin.x);
+        const int64_t y0 = (int64_t)std::floor(posMin.y);
+        const int64_t x1 = (int64_t)std::floor(posMax.x) + 1;
+        const int64_t y1 = (int64_t)std::floor(posMax.y) + 1;
+        const int64_t baseX = (int64_t)uvOffset.x * texture.width;
+        const int64_t baseY = (int64_t)uvOffset.y * texture.height;
+
+        // Orient the edge functions so that the interior is positive independent of winding.
+        const float orientation = edgeFunction(pos[0], pos[1], pos[2]) < 0.f ? -1.f : 1.f;
+        auto isInside = [&](float2 p)
+        {
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                if (orientation * edgeFunction(pos[i], pos[(i + 1) % 3], p) < 0.f) return false;
+            }
+            return true;
+        };
+
+        double sum[3] = {};
+        double weight = 0.0;
+        for (int64_t y = y0; y < y1; y++)
+        {
+            for (int64_t x = x0; x < x1; x++)
+            {
+                // Texels with all corners inside the triangle are fully covered.
+                // For the remaining texels touched by the triangle, compute the coverage analytically.
+                const float2 texelMin((float)x, (float)y);
+                const float2 texelMax = texelMin + float2(1.f);
+                float w = 1.f;
+                if (!isInside(texelMin) || !isInside(texelMax) || !isInside(float2(texelMin.x, texelMax.y)) || !isInside(float2(texelMax.x, texelMin.y)))
+                {
+                    w = std::min(computeClippedTriangleArea(pos, texelMin, texelMax), 1.f);
+                    if (!(w > 0.f)) continue;
+                }
+
+                const float3 color = texture.fetch(baseX + x, baseY + y);
+                for (uint32_t i = 0; i < 3; i++) sum[i] += (double)color[i] * w;
+                weight += w;
+            }
+        }
+
+        if (pWeight) *pWeight = (float)weight;
+
+        if (weight > 0.0)
+        {
+            return float3((float)(sum[0] / weight), (float)(sum[1] / weight), (float)(sum[2] / weight));
+        }
+
+        // The triangle is degenerate in texture space. Approximate the emission by the average over its vertices.
+        return (texture.sample(texCoords[0]) + texture.sample(texCoords[1]) + texture.sample(texCoords[2])) / 3.f;
+    }
+
+    float EmissiveTextureIntegrator::computeClippedTriangleArea(const float2 vertices[3], float2 minPos, float2 maxPos)
+    {
+        // Clip against the four sides of the box (Sutherland-Hodgman).
+        // Each clip adds at most one vertex to the convex polygon, so 7 vertices are sufficient.
+        float2 bufA[8];
+        float2 bufB[8];
+        bufA[0] = vertices[0];
+        bufA[1] = vertices[1];
+        bufA[2] = vertices[2];
+        uint32_t count = 3;
+        count = clipPolygon(bufA, count, bufB, 0, minPos.x, 1.f);
+        count = clipPolygon(bufB, count, bufA, 0, maxPos.x, -1.f);
+        count = clipPolygon(bufA, count, bufB, 1, minPos.y, 1.f);
+        count = clipPolygon(bufB, count, bufA, 1, maxPos.y, -1.f);
+        if (count < 3) return 0.f;
+
+        // Compute the area using the shoelace formula.
+        // Positions are taken relative to the first vertex to avoid cancellation far from the origin.
+        float area = 0.f;
+        for (uint32_t i = 1; i + 1 < count; i++)
+        {
+            const float2 a = bufA[i] - bufA[0];
+            const float2 b = bufA[i + 1] - bufA[0];
+            area += a.x * b.y - b.x * a.y;
+        }
+        return std::abs(0.5f * area);
+    }
+}
@@ -0,0 +1,107 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/API/Formats.h"
+#include "Core/API/Sampler.h"
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU integrator for textured emissive triangles.
+
+        This is the CPU counterpart of the raster integrator in EmissiveIntegrator.3d.slang and computes the same quantity.
+        Each triangle is rasterized conservatively in texture space at mip 0 with one sample per texel.
+        Fully covered texels have unit weight, and texels on the triangle's edges are weighted by the analytically
+        computed area of the triangle clipped to the texel. Texels are fetched with nearest filtering using the
+        address modes of the material sampler. The sums are accumulated per triangle in double precision, so the
+        result is deterministic and independent of how triangles are distributed over threads.
+    */
+    class FALCOR_API EmissiveTextureIntegrator
+    {
+    public:
+        /** Emissive texture data (mip 0) in linear RGB.
+        */
+        struct TextureData
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            Sampler::AddressMode addressModeU = Sampler::AddressMode::Wrap;
+            Sampler::AddressMode addressModeV = Sampler::AddressMode::Wrap;
+            std::vector<float3> texels;     ///< Texels in row-major order (width * height elements).
+
+            /** Fetch a texel. Coordinates outside the texture are resolved using the address modes.
+                Texels outside the texture in border mode are black.
+            */
+            float3 fetch(int64_t x, int64_t y) const;
+
+            /** Sample the texture with nearest filtering.
+            */
+            float3 sample(float2 uv) const;
+        };
+
+        /** Check if texture data in the given format can be decoded on the CPU.
+            Supported are uncompressed 8/16-bit unorm, 16/32-bit float and 8-bit sRGB formats.
+        */
+        static bool isFormatSupported(ResourceFormat format);
+
+        /** Decode texture data into linear RGB.
+            Missing channels are read as zero, as when sampling the texture on the GPU.
+            \param[in] pData Texel data.
+            \param[in] width Width in texels.
+            \param[in] height Height in texels.
+            \param[in] rowPitch Row pitch in bytes.
+            \param[in] format Texel format. Throws if the format is not supported.
+            \param[in] addressModeU Address mode used when fetching texels along u.
+            \param[in] addressModeV Address mode used when fetching texels along v.
+            \return Decoded texture data.
+        */
+        static TextureData createTextureData(const void* pData, uint32_t width, uint32_t height, uint32_t rowPitch, ResourceFormat format,
+            Sampler::AddressMode addressModeU = Sampler::AddressMode::Wrap, Sampler::AddressMode addressModeV = Sampler::AddressMode::Wrap);
+
+        /** Compute the average texel value over a triangle in texture space.
+            If the triangle is degenerate in texture space (line or point), the average of the texture
+            sampled at the three vertices is returned instead.
+            \param[in] texture Texture data.
+            \param[in] texCoords Texture coordinates of the triangle's vertices.
+            \param[out] pWeight Optional. Total texel coverage of the triangle.
+            \return Average texel value.
+        */
+        static float3 integrateTriangle(const TextureData& texture, const float2 texCoords[3], float* pWeight = nullptr);
+
+        /** Compute the area of a 2D triangle clipped to an axis-aligned box.
+            \param[in] vertices Triangle vertices.
+            \param[in] minPos Box minimum.
+            \param[in] maxPos Box maximum.
+            \return Area of the clipped triangle (non-negative).
+        */
+        static float computeClippedTriangleArea(const float2 vertices[3], float2 minPos, float2 maxPos);
+    };
+}
@@ -27,13 +27,18 @@
  **************************************************************************/
 #include "LightCollection.h"
 #include "LightCollectionShared.slang"
+#include "EmissiveTextureIntegrator.h"
 #include "Core/API/Device.h"
 #include "Scene/Scene.h"
+#include "Scene/SceneCache.h"
 #include "Scene/Material/BasicMaterial.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Color/ColorHelpers.slang"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Timing/Profiler.h"
 #include <sstream>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -49,12 +54,13 @@ namespace Falcor
         const char kFinalizeIntegrationFile[] = "Scene/Lights/FinalizeIntegration.cs.slang";
     }
 
-    LightCollection::SharedPtr LightCollection::create(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene)
+    LightCollection::SharedPtr LightCollection::create(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene, const Options& options)
     {
-        return SharedPtr(new LightCollection(pRenderContext, pScene));
+        return SharedPtr(new LightCollection(pRenderContext, pScene, options));
     }
 
-    LightCollection::LightCollection(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene)
+    LightCollection::LightCollection(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene, const Options& options)
+        : mOptions(options)
     {
         FALCOR_ASSERT(pScene);
         mpScene = pScene;
@@ -62,10 +68,6 @@ namespace Falcor
         // Setup the lights.
         setupMeshLights(*pScene);
 
-        // Create program for integrating emissive textures.
-        // This should be done after lights are setup, so that we know which sampler state etc. to use.
-        initIntegrator(*pScene);
-
         // Create programs for building/updating the mesh lights.
         Shader::DefineList defines = pScene->getSceneDefines();
         mpTriangleListBuilder = ComputePass::create(kBuildTriangleListFile, "buildTriangleList", defines);
@@ -246,19 +248,39 @@ namespace Falcor
             prepareTriangleData(pRenderContext, scene);
             timeReport.measure("LightCollection::build preparation");
 
-            // Pre-integrate emissive triangles.
-            // TODO: We might want to redo this in update() for animated meshes or after scale changes as that affects the flux.
-            integrateEmissive(pRenderContext, scene);
+            mStatsValid = false;
+
+            // Reuse the pre-integrated triangles from the scene cache if they were computed from the same inputs.
+            // This avoids integrating and reading back the data, so the triangles are immediately available on the CPU.
+            const auto cacheSignature = computeCacheSignature(scene);
+            if (cacheSignature && readCache(scene, *cacheSignature))
+            {
+                timeReport.measure("LightCollection::build read cache");
+            }
+            else
+            {
+                // Pre-integrate emissive triangles.
+                // TODO: We might want to redo this in update() for animated meshes or after scale changes as that affects the flux.
+                if (mOptions.integratorBackend == IntegratorBackend::CPU && integrateEmissiveCPU(pRenderContext, scene))
+                {
+                    FALCOR_ASSERT(mCPUInvalidData == CPUOutOfDateFlags::None);
+                }
+                else
+                {
+                    integrateEmissive(pRenderContext, scene);
 
-            timeReport.measure("LightCollection::build integrate emissive");
+                    mCPUInvalidData = CPUOutOfDateFlags::All;
+                    mStagingBufferValid = false;
+                    prepareSyncCPUData(pRenderContext);
+                }
 
-            // Build list of active triangles.
-            mCPUInvalidData = CPUOutOfDateFlags::All;
-            mStagingBufferValid = false;
-            mStatsValid = false;
+                timeReport.measure("LightCollection::build integrate emissive");
 
-            prepareSyncCPUData(pRenderContext);
-            updateActiveTriangleList();
+                // Build list of active triangles.
+                updateActiveTriangleList();
+
+                if (cacheSignature) writeCache(scene, *cacheSignature);
+            }
 
             timeReport.measure("LightCollection::build finalize");
             timeReport.printToLog();
@@ -349,6 +371,10 @@ namespace Falcor
         FALCOR_ASSERT(mTriangleCount > 0);
         FALCOR_ASSERT(mMeshLights.size() > 0);
 
+        // Create program for integrating emissive textures.
+        // This is done lazily as the CPU integrator doesn't need it, and it requires device features not available everywhere.
+        if (!mIntegrator.pProgram) initIntegrator(scene);
+
         // Prepare program vars.
         mIntegrator.pVars = GraphicsVars::create(mIntegrator.pProgram.get());
         mIntegrator.pVars["gScene"] = scene.getParameterBlock();
@@ -433,6 +459,191 @@ namespace Falcor
 #endif
     }
 
+    bool LightCollection::integrateEmissiveCPU(RenderContext* pRenderContext, const Scene& scene)
+    {
+        FALCOR_ASSERT(mTriangleCount > 0);
+        FALCOR_ASSERT(mMeshLights.size() > 0);
+
+        // Gather the emissive parameters per mesh light and check that all emissive textures can be decoded.
+        struct EmissiveParams
+        {
+            float3 color;
+            float factor = 0.f;
+            uint32_t textureIndex = MeshLightData::kInvalidIndex;
+        };
+
+        std::vector<EmissiveParams> params(mMeshLights.size());
+        std::vector<Texture::SharedPtr> textures;
+        std::unordered_map<const Texture*, uint32_t> textureIndices;
+
+        for (size_t lightIdx = 0; lightIdx < mMeshLights.size(); lightIdx++)
+        {
+            auto pMaterial = scene.getMaterial(MaterialID::fromSlang(mMeshLights[lightIdx].materialID))->toBasicMaterial();
+            FALCOR_ASSERT(pMaterial);
+            params[lightIdx].color = pMaterial->getData().emissive;
+            params[lightIdx].factor = pMaterial->getData().emissiveFactor;
+
+            if (auto pTexture = pMaterial->getEmissiveTexture())
+            {
+                if (!EmissiveTextureIntegrator::isFormatSupported(pTexture->getFormat()))
+                {
+                    logInfo("LightCollection: Emissive texture '{}' uses format {} which is not supported by the CPU integrator. Using the GPU integrator.", pTexture->getSourcePath(), to_string(pTexture->getFormat()));
+                    return false;
+                }
+                auto it = textureIndices.try_emplace(pTexture.get(), (uint32_t)textures.size()).first;
+                if (it->second == textures.size()) textures.push_back(pTexture);
+                params[lightIdx].textureIndex = it->second;
+            }
+        }
+
+        // Schedule the readback of the triangle data and read back the emissive textures (mip 0) in the meantime.
+        mCPUInvalidData = CPUOutOfDateFlags::TriangleData;
+        mStagingBufferValid = false;
+        prepareSyncCPUData(pRenderContext);
+
+        const auto addressModeU = mpSamplerState ? mpSamplerState->getAddressModeU() : Sampler::AddressMode::Wrap;
+        const auto addressModeV = mpSamplerState ? mpSamplerState->getAddressModeV() : Sampler::AddressMode::Wrap;
+        std::vector<EmissiveTextureIntegrator::TextureData> textureData(textures.size());
+        for (size_t i = 0; i < textures.size(); i++)
+        {
+            const Texture* pTexture = textures[i].get();
+            const uint32_t width = pTexture->getWidth(0);
+            const uint32_t height = pTexture->getHeight(0);
+            auto data = pRenderContext->readTextureSubresource(pTexture, pTexture->getSubresourceIndex(0, 0));
+            textureData[i] = EmissiveTextureIntegrator::createTextureData(data.data(), width, height, getFormatRowPitch(pTexture->getFormat(), width), pTexture->getFormat(), addressModeU, addressModeV);
+        }
+
+        syncCPUData();
+        FALCOR_ASSERT(mMeshLightTriangles.size() == mTriangleCount);
+
+        // Integrate the triangles in parallel.
+        // The flux is computed as in FinalizeIntegration.cs.slang.
+        Threading::parallelFor(0, mTriangleCount, [&](size_t triIdx)
+        {
+            auto& tri = mMeshLightTriangles[triIdx];
+            const auto& p = params[tri.lightIdx];
+
+            float3 averageEmissiveColor = p.color;
+            if (p.textureIndex != MeshLightData::kInvalidIndex)
+            {
+                const float2 texCoords[3] = { tri.vtx[0].uv, tri.vtx[1].uv, tri.vtx[2].uv };
+                averageEmissiveColor = EmissiveTextureIntegrator::integrateTriangle(textureData[p.textureIndex], texCoords);
+            }
+            tri.averageRadiance = averageEmissiveColor * p.factor;
+
+            // We assume diffuse emitters and integrate per side (hemisphere) => the scale factor is pi.
+            tri.flux = luminance(tri.averageRadiance) * tri.area * (float)M_PI;
+        }, 64);
+
+        updateFluxData();
+        return true;
+    }
+
+    void LightCollection::updateFluxData()
+    {
+        FALCOR_ASSERT(mpFluxData && mMeshLightTriangles.size() == mTriangleCount);
+
+        std::vector<EmissiveFlux> fluxData(mTriangleCount);
+        for (uint32_t triIdx = 0; triIdx < mTriangleCount; triIdx++)
+        {
+            fluxData[triIdx].flux = mMeshLightTriangles[triIdx].flux;
+            fluxData[triIdx].averageRadiance = mMeshLightTriangles[triIdx].averageRadiance;
+        }
+        mpFluxData->setBlob(fluxData.data(), 0, fluxData.size() * sizeof(EmissiveFlux));
+    }
+
+    std::optional<SHA1::MD> LightCollection::computeCacheSignature(const Scene& scene) const
+    {
+        if (!mOptions.useSceneCache || !scene.getSceneCacheKey()) return {};
+
+        SHA1 sha1;
+        sha1.update(mMeshLights.data(), mMeshLights.size() * sizeof(MeshLightData));
+
+        const auto& globalMatrices = scene.getAnimationController()->getGlobalMatrices();
+        for (const auto& meshLight : mMeshLights)
+        {
+            const GeometryInstanceData& instanceData = scene.getGeometryInstance(meshLight.instanceID);
+
+            // The vertices of dynamic meshes depend on the current animation state, so they are not cached.
+            if (scene.getMesh(MeshID::fromSlang(instanceData.geometryID)).isDynamic()) return {};
+            sha1.update(globalMatrices[instanceData.globalMatrixID]);
+
+            auto pMaterial = scene.getMaterial(MaterialID::fromSlang(meshLight.materialID))->toBasicMaterial();
+            FALCOR_ASSERT(pMaterial);
+            sha1.update(pMaterial->getData().emissive);
+            sha1.update(pMaterial->getData().emissiveFactor);
+            if (auto pTexture = pMaterial->getEmissiveTexture())
+            {
+                const std::string path = pTexture->getSourcePath().string();
+                sha1.update(path.data(), path.size());
+                sha1.update(pTexture->getWidth());
+                sha1.update(pTexture->getHeight());
+                sha1.update(pTexture->getFormat());
+            }
+        }
+
+        if (mpSamplerState)
+        {
+            sha1.update(mpSamplerState->getAddressModeU());
+            sha1.update(mpSamplerState->getAddressModeV());
+        }
+
+        return sha1.finalize();
+    }
+
+    bool LightCollection::readCache(const Scene& scene, const SHA1::MD& signature)
+    {
+        FALCOR_ASSERT(scene.getSceneCacheKey());
+
+        auto data = SceneCache::readLightCollection(*scene.getSceneCacheKey());
+        if (!data) return false;
+
+        if (data->signature != signature || data->triangles.size() != mTriangleCount)
+        {
+            logInfo("LightCollection: Cached emissive triangles are out of date.");
+            return false;
+        }
+        for (uint32_t triIdx : data->activeTriangleList)
+        {
+            if (triIdx >= mTriangleCount)
+            {
+                logWarning("LightCollection: Invalid active triangle index in light collection cache.");
+                return false;
+            }
+        }
+
+        // The GPU triangle data was built in prepareTriangleData(). Upload the flux and use the cached CPU data as is.
+        mMeshLightTriangles = std::move(data->triangles);
+        mCPUInvalidData = CPUOutOfDateFlags::None;
+        mStagingBufferValid = true;
+        updateFluxData();
+
+        mActiveTriangleList = std::move(data->activeTriangleList);
+        uploadActiveTriangleList();
+
+        return true;
+    }
+
+    void LightCollection::writeCache(const Scene& scene, const SHA1::MD& signature) const
+    {
+        FALCOR_ASSERT(scene.getSceneCacheKey());
+        FALCOR_ASSERT(mCPUInvalidData == CPUOutOfDateFlags::None);
+
+        CachedData data;
+        data.signature = signature;
+        data.triangles = mMeshLightTriangles;
+        data.activeTriangleList = mActiveTriangleList;
+
+        try
+        {
+            SceneCache::writeLightCollection(*scene.getSceneCacheKey(), data);
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to write light collection cache: {}", e.what());
+        }
+    }
+
     void LightCollection::computeStats() const
     {
         if (mStatsValid) return;
@@ -529,10 +740,7 @@ namespace Falcor
         syncCPUData();
 
         const uint32_t triCount = (uint32_t)mMeshLightTriangles.size();
-        const uint32_t kInvalidActiveIndex = ~0u;
 
-        mTriToActiveList.clear();
-        mTriToActiveList.resize(triCount, kInvalidActiveIndex);
         mActiveTriangleList.clear();
         mActiveTriangleList.reserve(triCount);
 
@@ -541,11 +749,27 @@ namespace Falcor
         {
             if (mMeshLightTriangles[triIdx].flux > 0.f)
             {
-                mTriToActiveList[triIdx] = (uint32_t)mActiveTriangleList.size();
                 mActiveTriangleList.push_back(triIdx);
             }
         }
 
+        uploadActiveTriangleList();
+    }
+
+    void LightCollection::uploadActiveTriangleList()
+    {
+        // Build the mapping from triangles to active triangles and update the GPU buffers.
+        const uint32_t triCount = (uint32_t)mMeshLightTriangles.size();
+        const uint32_t kInvalidActiveIndex = ~0u;
+
+        mTriToActiveList.clear();
+        mTriToActiveList.resize(triCount, kInvalidActiveIndex);
+        for (uint32_t activeIdx = 0; activeIdx < (uint32_t)mActiveTriangleList.size(); activeIdx++)
+        {
+            FALCOR_ASSERT(mActiveTriangleList[activeIdx] < triCount);
+            mTriToActiveList[mActiveTriangleList[activeIdx]] = activeIdx;
+        }
+
         FALCOR_ASSERT(mActiveTriangleList.size() <= std::numeric_limits<uint32_t>::max());
         const uint32_t activeCount = (uint32_t)mActiveTriangleList.size();
 
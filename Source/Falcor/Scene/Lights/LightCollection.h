@@ -34,9 +34,11 @@
 #include "Core/State/GraphicsState.h"
 #include "Core/Program/GraphicsProgram.h"
 #include "Core/Program/ProgramVars.h"
+#include "Utils/CryptoUtils.h"
 #include "Utils/Math/Vector.h"
 #include "RenderGraph/BasePasses/ComputePass.h"
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace Falcor
@@ -52,6 +54,10 @@ namespace Falcor
         This class has utility functions for updating and pre-processing the mesh lights.
         The LightCollection can be used standalone, but more commonly it will be wrapped
         by an emissive light sampler.
+
+        If the scene was loaded from or written to a scene cache, the pre-integrated triangles are stored
+        alongside the cache. Subsequent loads reuse them, which avoids integrating and reading back the
+        emissive data from the GPU.
     */
     class FALCOR_API LightCollection
     {
@@ -70,6 +76,22 @@ namespace Falcor
             std::vector<UpdateFlags> lightsUpdateInfo;
         };
 
+        /** Backend used for pre-integrating the emission over the emissive triangles.
+        */
+        enum class IntegratorBackend : uint32_t
+        {
+            GPU,    ///< Rasterize the triangles in texture space on the GPU. Requires conservative rasterization tier 3 and SM 6.6.
+            CPU,    ///< Rasterize the triangles in texture space on the CPU. Falls back to the GPU for emissive textures in formats that cannot be decoded on the CPU.
+        };
+
+        /** Light collection options.
+        */
+        struct Options
+        {
+            IntegratorBackend integratorBackend = IntegratorBackend::CPU;   ///< Backend for pre-integrating emissive triangles.
+            bool useSceneCache = true;                                      ///< Read/write the pre-integrated triangles from/to the scene cache if the scene uses one.
+        };
+
         struct MeshLightStats
         {
             // Stats before pre-processing (input data).
@@ -115,6 +137,15 @@ namespace Falcor
             }
         };
 
+        /** Pre-integrated emissive triangles stored in the scene cache.
+        */
+        struct CachedData
+        {
+            SHA1::MD signature = {};                    ///< Hash of the inputs the data was computed from (mesh lights, instance transforms and emissive materials).
+            std::vector<MeshLightTriangle> triangles;   ///< All mesh light triangles including the pre-integrated flux.
+            std::vector<uint32_t> activeTriangleList;   ///< List of active (non-culled) triangles.
+        };
+
 
         ~LightCollection() = default;
 
@@ -122,9 +153,10 @@ namespace Falcor
             Note that update() must be called before the collection is ready to use.
             \param[in] pRenderContext The render context.
             \param[in] pScene The scene.
+            \param[in] options Light collection options.
             \return A pointer to a new light collection object, or throws an exception if creation failed.
         */
-        static SharedPtr create(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene);
+        static SharedPtr create(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene, const Options& options = Options());
 
         /** Updates the light collection to the current state of the scene.
             \param[in] pRenderContext The render context.
@@ -185,7 +217,7 @@ namespace Falcor
         };
 
     protected:
-        LightCollection(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene);
+        LightCollection(RenderContext* pRenderContext, const std::shared_ptr<Scene>& pScene, const Options& options);
 
         void initIntegrator(const Scene& scene);
         void setupMeshLights(const Scene& scene);
@@ -193,9 +225,15 @@ namespace Falcor
         void prepareTriangleData(RenderContext* pRenderContext, const Scene& scene);
         void prepareMeshData(const Scene& scene);
         void integrateEmissive(RenderContext* pRenderContext, const Scene& scene);
+        bool integrateEmissiveCPU(RenderContext* pRenderContext, const Scene& scene);
+        void updateFluxData();
+        std::optional<SHA1::MD> computeCacheSignature(const Scene& scene) const;
+        bool readCache(const Scene& scene, const SHA1::MD& signature);
+        void writeCache(const Scene& scene, const SHA1::MD& signature) const;
         void computeStats() const;
         void buildTriangleList(RenderContext* pRenderContext, const Scene& scene);
         void updateActiveTriangleList();
+        void uploadActiveTriangleList();
         void updateTrianglePositions(RenderContext* pRenderContext, const Scene& scene, const std::vector<uint32_t>& updatedLights);
 
         void copyDataToStagingBuffer(RenderContext* pRenderContext) const;
@@ -203,6 +241,7 @@ namespace Falcor
 
         // Internal state
         std::weak_ptr<Scene>                    mpScene;                ///< Weak pointer to scene (scene owns LightCollection).
+        Options                                 mOptions;               ///< Light collection options.
 
         std::vector<MeshLightData>              mMeshLights;            ///< List of all mesh lights.
         uint32_t                                mTriangleCount = 0;     ///< Total number of triangles in all mesh lights (= mMeshLightTriangles.size()). This may include culled triangles.
@@ -33,6 +33,7 @@
 #include "Core/Program/ProgramVars.h"
 #include "Utils/Logger.h"
 #include "Utils/Math/Common.h"
+#include "Utils/Math/FNVHash.h"
 #include "Utils/Color/ColorHelpers.slang"
 #include "Utils/Scripting/ScriptBindings.h"
 #include <sstream>
@@ -588,6 +589,37 @@ namespace Falcor
         return (*this) == (*other);
     }
 
+    size_t BasicMaterial::hash() const
+    {
+        FNVHash64 hash;
+        const size_t baseHash = getBaseHash();
+        hash.insert(&baseHash, sizeof(baseHash));
+
+        // Hash the fields compared in operator==(). The default samplers are not hashed,
+        // materials that only differ in their samplers are resolved by the full comparison.
+        // Floating-point values are offset by +0 to map -0 to +0, as they compare equal.
+#define hash_field(_a) hash.insert(&mData._a, sizeof(mData._a))
+#define hash_float_field(_a) { const auto value = mData._a + 0.f; hash.insert(&value, sizeof(value)); }
+        hash_field(flags);
+        hash_float_field(displacementScale);
+        hash_float_field(displacementOffset);
+        hash_field(baseColor);
+        hash_field(specular);
+        hash_float_field(emissive);
+        hash_float_field(emissiveFactor);
+        hash_field(IoR);
+        hash_field(diffuseTransmission);
+        hash_field(specularTransmission);
+        hash_field(transmission);
+        hash_field(volumeAbsorption);
+        hash_field(volumeAnisotropy);
+        hash_field(volumeScattering);
+#undef hash_float_field
+#undef hash_field
+
+        return (size_t)hash.get();
+    }
+
     bool BasicMaterial::operator==(const BasicMaterial& other) const
     {
         if (!isBaseEqual(other)) return false;
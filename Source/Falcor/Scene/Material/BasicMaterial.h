@@ -68,6 +68,11 @@ namespace Falcor
         */
         bool isEqual(const Material::SharedPtr& pOther) const override;
 
+        /** Compute a hash of the material properties.
+            \return Hash value. Materials that compare equal have the same hash.
+        */
+        size_t hash() const override;
+
         /** Set the alpha mode.
         */
         void setAlphaMode(AlphaMode alphaMode) override;
@@ -28,6 +28,7 @@
 #include "MERLMaterial.h"
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
+#include "Utils/Math/FNVHash.h"
 #include "Utils/Image/ImageIO.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Rendering/Materials/BSDFIntegrator.h"
@@ -123,6 +124,16 @@ namespace Falcor
         return true;
     }
 
+    size_t MERLMaterial::hash() const
+    {
+        FNVHash64 hash;
+        const size_t baseHash = getBaseHash();
+        const std::string path = mPath.string();
+        hash.insert(&baseHash, sizeof(baseHash));
+        hash.insert(path.data(), path.size());
+        return (size_t)hash.get();
+    }
+
     Program::ShaderModuleList MERLMaterial::getShaderModules() const
     {
         return { Program::ShaderModule(kShaderFile) };
@@ -30,6 +30,7 @@
 #include "MaterialSystem.h"
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
+#include "Utils/Math/FNVHash.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Rendering/Materials/LobeType.slang"
 
@@ -303,6 +304,36 @@ namespace Falcor
         return true;
     }
 
+    size_t Material::getBaseHash() const
+    {
+        // This function hashes the data compared in isBaseEqual().
+        // Floating-point values are offset by +0 to map -0 to +0, as they compare equal.
+
+        FNVHash64 hash;
+        hash.insert(&mHeader, sizeof(mHeader));
+
+        const float3 translation = mTextureTransform.getTranslation() + 0.f;
+        const float3 scaling = mTextureTransform.getScaling() + 0.f;
+        const float4 rotation = float4(mTextureTransform.getRotation().x, mTextureTransform.getRotation().y, mTextureTransform.getRotation().z, mTextureTransform.getRotation().w) + 0.f;
+        hash.insert(&translation, sizeof(translation));
+        hash.insert(&scaling, sizeof(scaling));
+        hash.insert(&rotation, sizeof(rotation));
+
+        FALCOR_ASSERT(mTextureSlotInfo.size() == mTextureSlotData.size());
+        for (size_t i = 0; i < mTextureSlotInfo.size(); i++)
+        {
+            if (!hasTextureSlot((TextureSlot)i)) continue;
+            const auto& info = mTextureSlotInfo[i];
+            const Texture* pTexture = mTextureSlotData[i].pTexture.get();
+            hash.insert(info.name.data(), info.name.size());
+            hash.insert(&info.mask, sizeof(info.mask));
+            hash.insert(&info.srgb, sizeof(info.srgb));
+            hash.insert(&pTexture, sizeof(pTexture));
+        }
+
+        return (size_t)hash.get();
+    }
+
     FALCOR_SCRIPT_BINDING(Material)
     {
         using namespace pybind11::literals;
@@ -156,6 +156,12 @@ namespace Falcor
         */
         virtual bool isEqual(const Material::SharedPtr& pOther) const = 0;
 
+        /** Compute a hash of the material properties.
+            Materials that compare equal with isEqual() have the same hash. The name is not included.
+            \return Hash value.
+        */
+        virtual size_t hash() const = 0;
+
         /** Set the double-sided flag. This flag doesn't affect the cull state, just the shading.
         */
         virtual void setDoubleSided(bool doubleSided);
@@ -319,6 +325,7 @@ namespace Falcor
         void updateTextureHandle(MaterialSystem* pOwner, const TextureSlot slot, TextureHandle& handle);
         void updateDefaultTextureSamplerID(MaterialSystem* pOwner, const Sampler::SharedPtr& pSampler);
         bool isBaseEqual(const Material& other) const;
+        size_t getBaseHash() const;
 
         template<typename T>
         MaterialDataBlob prepareDataBlob(const T& data) const
@@ -198,9 +198,9 @@ namespace Falcor
         checkArgument(pMaterial != nullptr, "'pMaterial' is missing");
 
         // Reuse previously added materials.
-        if (auto it = std::find(mMaterials.begin(), mMaterials.end(), pMaterial); it != mMaterials.end())
+        if (auto it = mMaterialIDs.find(pMaterial.get()); it != mMaterialIDs.end())
         {
-            return MaterialID{(size_t)std::distance(mMaterials.begin(), it) };
+            return it->second;
         }
 
         // Add material.
@@ -217,6 +217,7 @@ namespace Falcor
 
         pMaterial->registerUpdateCallback([this](auto flags) { mMaterialUpdates |= flags; });
         mMaterials.push_back(pMaterial);
+        mMaterialIDs.emplace(pMaterial.get(), materialID);
         mMaterialsChanged = true;
 
         return materialID;
@@ -228,9 +229,12 @@ namespace Falcor
         checkArgument(pReplacement != nullptr, "'pReplacement' is missing");
 
         // Find material to replace.
-        if (auto it = std::find(mMaterials.begin(), mMaterials.end(), pMaterial); it != mMaterials.end())
+        if (auto it = mMaterialIDs.find(pMaterial.get()); it != mMaterialIDs.end())
         {
-            *it = pReplacement;
+            const MaterialID materialID = it->second;
+            mMaterials[materialID.get()] = pReplacement;
+            mMaterialIDs.erase(it);
+            mMaterialIDs.emplace(pReplacement.get(), materialID);
 
             if (pReplacement->getDefaultTextureSampler() == nullptr)
             {
@@ -292,26 +296,48 @@ namespace Falcor
         idMap.resize(mMaterials.size());
 
         // Find unique set of materials.
+        // The unique materials are bucketed by hash, so each material is only compared against materials with the same hash.
+        std::unordered_multimap<size_t, MaterialID> uniqueMaterialIDs;
+        uniqueMaterialIDs.reserve(mMaterials.size());
+        mMaterialHashCollisionCount = 0;
+
         for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id)
         {
             const auto& pMaterial = mMaterials[id.get()];
-            auto it = std::find_if(uniqueMaterials.begin(), uniqueMaterials.end(), [&pMaterial](const auto& m) { return m->isEqual(pMaterial); });
-            if (it == uniqueMaterials.end())
+            const size_t hash = pMaterial->hash();
+
+            auto [begin, end] = uniqueMaterialIDs.equal_range(hash);
+            auto it = std::find_if(begin, end, [&](const auto& entry)
+            {
+                if (uniqueMaterials[entry.second.get()]->isEqual(pMaterial)) return true;
+                mMaterialHashCollisionCount++;
+                return false;
+            });
+
+            if (it == end)
             {
                 idMap[id.get()] = MaterialID{ uniqueMaterials.size() };
+                uniqueMaterialIDs.emplace(hash, idMap[id.get()]);
                 uniqueMaterials.push_back(pMaterial);
             }
             else
             {
-                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), (*it)->getName());
-                idMap[id.get()] = MaterialID{ (size_t)std::distance(uniqueMaterials.begin(), it) };
+                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), uniqueMaterials[it->second.get()]->getName());
+                idMap[id.get()] = it->second;
             }
         }
 
+        if (mMaterialHashCollisionCount > 0)
+        {
+            logInfo("Resolved {} material hash collisions when removing duplicate materials.", mMaterialHashCollisionCount);
+        }
+
         size_t removed = mMaterials.size() - uniqueMaterials.size();
         if (removed > 0)
         {
             mMaterials = uniqueMaterials;
+            mMaterialIDs.clear();
+            for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id) mMaterialIDs.emplace(mMaterials[id.get()].get(), id);
             mMaterialsChanged = true;
         }
 
@@ -321,11 +347,14 @@ namespace Falcor
     void MaterialSystem::optimizeMaterials()
     {
         // Gather a list of all textures to analyze.
+        // Textures loaded from bitmaps have already been analyzed on the CPU by the texture manager. The others are analyzed on the GPU.
         std::vector<std::pair<Material::SharedPtr, Material::TextureSlot>> materialSlots;
-        std::vector<Texture::SharedPtr> textures;
+        std::vector<TextureAnalyzer::Result> results;
+        std::vector<std::pair<Material::SharedPtr, Material::TextureSlot>> gpuMaterialSlots;
+        std::vector<Texture::SharedPtr> gpuTextures;
         size_t maxCount = mMaterials.size() * (size_t)Material::TextureSlot::Count;
         materialSlots.reserve(maxCount);
-        textures.reserve(maxCount);
+        results.reserve(maxCount);
 
         for (const auto& pMaterial : mMaterials)
         {
@@ -334,41 +363,55 @@ namespace Falcor
                 auto slot = (Material::TextureSlot)i;
                 if (auto pTexture = pMaterial->getTexture(slot))
                 {
-                    materialSlots.push_back({ pMaterial, slot });
-                    textures.push_back(pTexture);
+                    if (auto analysis = mpTextureManager->getTextureAnalysis(pTexture))
+                    {
+                        materialSlots.push_back({ pMaterial, slot });
+                        results.push_back(*analysis);
+                    }
+                    else
+                    {
+                        gpuMaterialSlots.push_back({ pMaterial, slot });
+                        gpuTextures.push_back(pTexture);
+                    }
                 }
             }
         }
 
-        if (textures.empty()) return;
+        if (materialSlots.empty() && gpuTextures.empty()) return;
+
+        // Analyze the textures that were not analyzed at load time on the GPU.
+        logInfo("Analyzing {} material textures ({} on the CPU at load time).", materialSlots.size() + gpuTextures.size(), materialSlots.size());
 
-        // Analyze the textures.
-        logInfo("Analyzing {} material textures.", textures.size());
+        if (!gpuTextures.empty())
+        {
+            TextureAnalyzer::SharedPtr pAnalyzer = TextureAnalyzer::create();
+            auto pResults = Buffer::create(gpuTextures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::UnorderedAccess);
+            pAnalyzer->analyze(gpDevice->getRenderContext(), gpuTextures, pResults);
 
-        TextureAnalyzer::SharedPtr pAnalyzer = TextureAnalyzer::create();
-        auto pResults = Buffer::create(textures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::UnorderedAccess);
-        pAnalyzer->analyze(gpDevice->getRenderContext(), textures, pResults);
+            // Copy result to staging buffer for readback.
+            // This is mostly to avoid a full flush and the associated perf warning.
+            // We do not have any other useful GPU work, but unrelated GPU tasks can be in flight.
+            auto pResultsStaging = Buffer::create(gpuTextures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::None, Buffer::CpuAccess::Read);
+            gpDevice->getRenderContext()->copyResource(pResultsStaging.get(), pResults.get());
+            gpDevice->getRenderContext()->flush(false);
+            mpFence->gpuSignal(gpDevice->getRenderContext()->getLowLevelData()->getCommandQueue());
 
-        // Copy result to staging buffer for readback.
-        // This is mostly to avoid a full flush and the associated perf warning.
-        // We do not have any other useful GPU work, but unrelated GPU tasks can be in flight.
-        auto pResultsStaging = Buffer::create(textures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::None, Buffer::CpuAccess::Read);
-        gpDevice->getRenderContext()->copyResource(pResultsStaging.get(), pResults.get());
-        gpDevice->getRenderContext()->flush(false);
-        mpFence->gpuSignal(gpDevice->getRenderContext()->getLowLevelData()->getCommandQueue());
+            // Wait for results to become available.
+            mpFence->syncCpu();
+            const TextureAnalyzer::Result* gpuResults = static_cast<const TextureAnalyzer::Result*>(pResultsStaging->map(Buffer::MapType::Read));
+            materialSlots.insert(materialSlots.end(), gpuMaterialSlots.begin(), gpuMaterialSlots.end());
+            results.insert(results.end(), gpuResults, gpuResults + gpuTextures.size());
+            pResultsStaging->unmap();
+        }
 
-        // Wait for results to become available. Then optimize the materials.
-        mpFence->syncCpu();
-        const TextureAnalyzer::Result* results = static_cast<const TextureAnalyzer::Result*>(pResultsStaging->map(Buffer::MapType::Read));
+        // Optimize the materials.
         Material::TextureOptimizationStats stats = {};
 
-        for (size_t i = 0; i < textures.size(); i++)
+        for (size_t i = 0; i < materialSlots.size(); i++)
         {
             materialSlots[i].first->optimizeTexture(materialSlots[i].second, results[i], stats);
         }
 
-        pResultsStaging->unmap();
-
         // Log optimization stats.
         if (size_t totalRemoved = std::accumulate(stats.texturesRemoved.begin(), stats.texturesRemoved.end(), 0ull); totalRemoved > 0)
         {
@@ -533,6 +576,7 @@ namespace Falcor
         s.materialCount = mMaterials.size();
         s.materialOpaqueCount = 0;
         s.materialMemoryInBytes += mpMaterialDataBuffer ? mpMaterialDataBuffer->getSize() : 0;
+        s.materialHashCollisionCount = mMaterialHashCollisionCount;
 
         std::set<Texture::SharedPtr> textures;
         for (const auto& pMaterial : mMaterials)
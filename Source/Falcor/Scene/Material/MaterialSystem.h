@@ -38,6 +38,7 @@
 #include <memory>
 #include <vector>
 #include <set>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -68,6 +69,7 @@ namespace Falcor
             uint64_t textureCompressedCount = 0;        ///< Number of unique compressed textures.
             uint64_t textureTexelCount = 0;             ///< Total number of texels in all textures.
             uint64_t textureMemoryInBytes = 0;          ///< Total memory in bytes used by the textures.
+            uint64_t materialHashCollisionCount = 0;    ///< Number of material hash collisions resolved by a full comparison in the last call to removeDuplicateMaterials().
         };
 
         /** Create a material system.
@@ -198,6 +200,7 @@ namespace Falcor
         Material::SharedPtr getMaterialByName(const std::string& name) const;
 
         /** Remove all duplicate materials.
+            Materials are bucketed by Material::hash() and only materials with identical hashes are compared in full.
             \param[in] idMap Vector that holds for each material the ID of the material that replaces it.
             \return The number of materials removed.
         */
@@ -225,6 +228,8 @@ namespace Falcor
         void uploadMaterial(const uint32_t materialID);
 
         std::vector<Material::SharedPtr> mMaterials;                ///< List of all materials.
+        std::unordered_map<const Material*, MaterialID> mMaterialIDs; ///< Map from material to its ID for fast lookup of previously added materials.
+        uint64_t mMaterialHashCollisionCount = 0;                   ///< Number of hash collisions in the last call to removeDuplicateMaterials().
         std::vector<Material::UpdateFlags> mMaterialsUpdateFlags;   ///< List of all material update flags, after the update() calls
         TextureManager::SharedPtr mpTextureManager;                 ///< Texture manager holding all material textures.
         Program::ShaderModuleList mShaderModules;                   ///< Shader modules for all materials in use.
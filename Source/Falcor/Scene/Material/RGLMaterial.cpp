@@ -30,6 +30,7 @@
 #include "RGLCommon.h"
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
+#include "Utils/Math/FNVHash.h"
 #include "Utils/Image/ImageIO.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Rendering/Materials/BSDFIntegrator.h"
@@ -137,6 +138,16 @@ namespace Falcor
         return true;
     }
 
+    size_t RGLMaterial::hash() const
+    {
+        FNVHash64 hash;
+        const size_t baseHash = getBaseHash();
+        const std::string path = mFilePath.string();
+        hash.insert(&baseHash, sizeof(baseHash));
+        hash.insert(path.data(), path.size());
+        return (size_t)hash.get();
+    }
+
     Program::ShaderModuleList RGLMaterial::getShaderModules() const
     {
         return { Program::ShaderModule(kShaderFile) };
@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "NDSDFGrid.h"
 #include "Core/API/RenderContext.h"
+#include "Utils/Threading.h"
 
 namespace Falcor
 {
@@ -148,14 +149,14 @@ namespace Falcor
             lodFormattedValues.resize(lodWidthInValues * lodWidthInValues * lodWidthInValues);
 
             uint32_t lodReadStride = 1 << (lodCount - lod - 1);
-            for (uint32_t z = 0; z < lodWidthInValues; z++)
+            Threading::parallelFor(0, lodWidthInValues, [&](size_t z)
             {
                 for (uint32_t y = 0; y < lodWidthInValues; y++)
                 {
                     for (uint32_t x = 0; x < lodWidthInValues; x++)
                     {
-                        uint32_t writeLocation = x + lodWidthInValues * (y + lodWidthInValues * z);
-                        uint32_t readLocation = lodReadStride * (x + gridWidthInValues * (y + gridWidthInValues * z));
+                        uint32_t writeLocation = x + lodWidthInValues * (y + lodWidthInValues * (uint32_t)z);
+                        uint32_t readLocation = lodReadStride * (x + gridWidthInValues * (y + gridWidthInValues * (uint32_t)z));
 
                         float normalizedValue = glm::clamp(cornerValues[readLocation] / normalizationFactor, -1.0f, 1.0f);
 
@@ -163,7 +164,7 @@ namespace Falcor
                         lodFormattedValues[writeLocation] = integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
                     }
                 }
-            }
+            });
         }
     }
 
@@ -0,0 +1,478 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "SDFBrickFile.h"
+#include "SDFValueProcessor.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/Logger.h"
+#include "Utils/Math/Common.h"
+#include "Utils/Threading.h"
+#include <lz4frame.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kMagic[8] = { 'S', 'D', 'F', 'B', 'r', 'i', 'c', 'k' };
+        const uint32_t kVersion = 1;
+
+        /** Number of narrow band bricks compressed together as one LZ4 frame.
+        */
+        const uint32_t kBricksPerBlock = 256;
+
+        /** Number of blocks per worker thread decompressed before invoking the brick callbacks.
+        */
+        const uint32_t kBlocksPerWorker = 4;
+
+        /** Scale used to quantize the values of bricks outside the narrow band.
+            Conversion to int16_t truncates towards zero, so the stored distances are never overestimated.
+        */
+        const float kCoarseScale = float(INT16_MAX) / glm::root_three<float>();
+
+        int16_t quantizeCoarse(float value)
+        {
+            return int16_t(std::clamp(value, -glm::root_three<float>(), glm::root_three<float>()) * kCoarseScale);
+        }
+
+        std::vector<uint8_t> compressFrame(const void* pData, size_t size)
+        {
+            LZ4F_preferences_t prefs = {};
+            prefs.frameInfo.contentSize = size;
+            std::vector<uint8_t> compressed(LZ4F_compressFrameBound(size, &prefs));
+            size_t compressedSize = LZ4F_compressFrame(compressed.data(), compressed.size(), pData, size, &prefs);
+            if (LZ4F_isError(compressedSize)) throw RuntimeError("Failed to compress SDF brick data: {}", LZ4F_getErrorName(compressedSize));
+            compressed.resize(compressedSize);
+            return compressed;
+        }
+
+        void decompressFrame(const std::vector<uint8_t>& compressed, void* pDst, size_t size)
+        {
+            LZ4F_dctx* pContext = nullptr;
+            if (LZ4F_isError(LZ4F_createDecompressionContext(&pContext, LZ4F_VERSION))) throw RuntimeError("Failed to create LZ4 decompression context.");
+
+            const uint8_t* pSrc = compressed.data();
+            uint8_t* pOut = static_cast<uint8_t*>(pDst);
+            size_t srcLeft = compressed.size();
+            size_t dstLeft = size;
+            size_t result = 1;
+            while (result != 0 && srcLeft > 0)
+            {
+                size_t srcSize = srcLeft;
+                size_t dstSize = dstLeft;
+                result = LZ4F_decompress(pContext, pOut, &dstSize, pSrc, &srcSize, nullptr);
+                if (LZ4F_isError(result)) break;
+                pSrc += srcSize;
+                srcLeft -= srcSize;
+                pOut += dstSize;
+                dstLeft -= dstSize;
+            }
+            LZ4F_freeDecompressionContext(pContext);
+
+            if (LZ4F_isError(result)) throw RuntimeError("Failed to decompress SDF brick data: {}", LZ4F_getErrorName(result));
+            if (result != 0 || dstLeft != 0) throw RuntimeError("Truncated SDF brick data.");
+        }
+    }
+
+    /** Classifies, quantizes and writes bricks one layer (slab of bricks along z) at a time.
+    */
+    class SDFBrickFile::Writer
+    {
+    public:
+        Writer(const std::filesystem::path& path, const Desc& desc)
+            : mDesc(desc)
+            , mFile(path, std::ios::out | std::ios::binary)
+        {
+            checkArgument(desc.gridWidth > 0, "'gridWidth' must be greater than 0.");
+            checkArgument(desc.brickWidth > 0, "'brickWidth' must be greater than 0.");
+            if (!mFile.good()) throw RuntimeError("Failed to open SDF brick file '{}' for writing.", path);
+
+            mDesc.narrowBandThickness = std::max(mDesc.narrowBandThickness, 1.f);
+            mBrickGridWidth = SDFValueProcessor::getBrickGridWidth(desc.gridWidth, desc.brickWidth);
+            mValuesPerBrick = (desc.brickWidth + 1) * (desc.brickWidth + 1) * (desc.brickWidth + 1);
+            mNarrowBandDistance = getNarrowBandDistance(mDesc);
+            mCoarseValues.resize((size_t)mBrickGridWidth * mBrickGridWidth * mBrickGridWidth);
+            mRanges.resize((size_t)mBrickGridWidth * mBrickGridWidth);
+
+            // Reserve space for the header, it is written when all offsets are known.
+            Header header = {};
+            mFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+
+        uint32_t getBrickGridWidth() const { return mBrickGridWidth; }
+
+        /** Process a layer of bricks.
+            \param[in] brickZ Brick coordinate along z.
+            \param[in] pSlices Corner values of the slices starting at z = brickZ * brickWidth.
+        */
+        void writeLayer(uint32_t brickZ, const float* pSlices)
+        {
+            const uint32_t gridWidth = mDesc.gridWidth;
+            const uint32_t brickWidth = mDesc.brickWidth;
+            const uint32_t n = mBrickGridWidth;
+            const size_t valuesPerRow = gridWidth + 1;
+            const size_t valuesPerSlice = valuesPerRow * valuesPerRow;
+            const uint32_t z0 = brickZ * brickWidth;
+
+            SDFValueProcessor::processBricks(pSlices, gridWidth, brickWidth, brickZ, brickZ + 1, mRanges.data());
+
+            // Classify and quantize each row of bricks in parallel.
+            std::vector<std::vector<uint8_t>> rowData(n);
+            Threading::parallelFor(0, n, [&](size_t brickY)
+            {
+                std::vector<float> brickValues(mValuesPerBrick);
+                for (uint32_t brickX = 0; brickX < n; ++brickX)
+                {
+                    const auto& range = mRanges[brickX + n * brickY];
+                    uint32_t brickIndex = brickX + n * ((uint32_t)brickY + n * brickZ);
+                    mCoarseValues[brickIndex] = quantizeCoarse(range.getClosestValue());
+                    if (!range.isNarrowBand(mNarrowBandDistance)) continue;
+
+                    // Gather the corner values of the brick, clamped to the grid.
+                    uint32_t i = 0;
+                    for (uint32_t z = 0; z <= brickWidth; ++z)
+                    {
+                        const float* pSlice = pSlices + (std::min(z0 + z, gridWidth) - z0) * valuesPerSlice;
+                        for (uint32_t y = 0; y <= brickWidth; ++y)
+                        {
+                            const float* pRow = pSlice + std::min((uint32_t)brickY * brickWidth + y, gridWidth) * valuesPerRow;
+                            for (uint32_t x = 0; x <= brickWidth; ++x) brickValues[i++] = pRow[std::min(brickX * brickWidth + x, gridWidth)];
+                        }
+                    }
+
+                    appendBrick(rowData[brickY], brickIndex, range, brickValues);
+                }
+            }, 1);
+
+            // Append the bricks to the blocks in order.
+            const size_t brickSize = sizeof(BrickHeader) + mValuesPerBrick * sizeof(uint16_t);
+            for (const auto& data : rowData)
+            {
+                for (size_t offset = 0; offset < data.size(); offset += brickSize)
+                {
+                    mBlockData.insert(mBlockData.end(), data.begin() + offset, data.begin() + offset + brickSize);
+                    mBrickCount++;
+                    if (++mBlockBrickCount == kBricksPerBlock) flushBlock();
+                }
+            }
+        }
+
+        /** Write the remaining data and the header.
+        */
+        void finish()
+        {
+            flushBlock();
+
+            Header header = {};
+            std::memcpy(header.magic, kMagic, sizeof(kMagic));
+            header.version = kVersion;
+            header.gridWidth = mDesc.gridWidth;
+            header.brickWidth = mDesc.brickWidth;
+            header.narrowBandThickness = mDesc.narrowBandThickness;
+            header.brickCount = mBrickCount;
+            header.blockCount = (uint32_t)mBlocks.size();
+            header.blockTableOffset = (uint64_t)mFile.tellp();
+
+            mFile.write(reinterpret_cast<const char*>(mBlocks.data()), mBlocks.size() * sizeof(BlockDesc));
+
+            auto coarseValues = compressFrame(mCoarseValues.data(), mCoarseValues.size() * sizeof(int16_t));
+            header.coarseValuesSize = coarseValues.size();
+            mFile.write(reinterpret_cast<const char*>(coarseValues.data()), coarseValues.size());
+
+            mFile.seekp(0);
+            mFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            mFile.close();
+            if (mFile.fail()) throw RuntimeError("Failed to write SDF brick file.");
+        }
+
+    private:
+        void appendBrick(std::vector<uint8_t>& data, uint32_t brickIndex, const SDFValueProcessor::BrickRange& range, const std::vector<float>& values)
+        {
+            BrickHeader brickHeader = { brickIndex, range.minValue, range.maxValue };
+            size_t offset = data.size();
+            data.resize(offset + sizeof(BrickHeader) + mValuesPerBrick * sizeof(uint16_t));
+            std::memcpy(data.data() + offset, &brickHeader, sizeof(BrickHeader));
+
+            float scale = range.maxValue > range.minValue ? float(UINT16_MAX) / (range.maxValue - range.minValue) : 0.f;
+            uint16_t* pDst = reinterpret_cast<uint16_t*>(data.data() + offset + sizeof(BrickHeader));
+            for (uint32_t i = 0; i < mValuesPerBrick; ++i)
+            {
+                pDst[i] = uint16_t((values[i] - range.minValue) * scale + 0.5f);
+            }
+        }
+
+        void flushBlock()
+        {
+            if (mBlockBrickCount == 0) return;
+
+            auto compressed = compressFrame(mBlockData.data(), mBlockData.size());
+            mBlocks.push_back({ (uint64_t)mFile.tellp(), (uint32_t)compressed.size(), mBlockBrickCount });
+            mFile.write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+
+            mBlockData.clear();
+            mBlockBrickCount = 0;
+        }
+
+        Desc mDesc;
+        std::ofstream mFile;
+        uint32_t mBrickGridWidth = 0;
+        uint32_t mValuesPerBrick = 0;
+        float mNarrowBandDistance = 0.f;
+
+        std::vector<int16_t> mCoarseValues;
+        std::vector<SDFValueProcessor::BrickRange> mRanges;    ///< Ranges of the bricks in the current layer.
+        std::vector<uint8_t> mBlockData;
+        std::vector<BlockDesc> mBlocks;
+        uint32_t mBlockBrickCount = 0;
+        uint32_t mBrickCount = 0;
+    };
+
+    void SDFBrickFile::write(const std::filesystem::path& path, const std::vector<float>& cornerValues, const Desc& desc)
+    {
+        const size_t valuesPerSlice = (size_t)(desc.gridWidth + 1) * (desc.gridWidth + 1);
+        checkArgument(cornerValues.size() == valuesPerSlice * (desc.gridWidth + 1), "'cornerValues' must contain (gridWidth + 1)^3 values.");
+
+        Writer writer(path, desc);
+        for (uint32_t brickZ = 0; brickZ < writer.getBrickGridWidth(); ++brickZ)
+        {
+            writer.writeLayer(brickZ, cornerValues.data() + brickZ * desc.brickWidth * valuesPerSlice);
+        }
+        writer.finish();
+    }
+
+    float SDFBrickFile::getNarrowBandDistance(const Desc& desc)
+    {
+        return std::max(desc.narrowBandThickness, 1.f) * glm::root_three<float>() / desc.gridWidth;
+    }
+
+    void SDFBrickFile::convertDenseFile(const std::filesystem::path& srcPath, const std::filesystem::path& dstPath, uint32_t brickWidth, float narrowBandThickness)
+    {
+        std::ifstream file(srcPath, std::ios::in | std::ios::binary);
+        if (!file.good()) throw RuntimeError("Failed to open SDF grid file '{}' for reading.", srcPath);
+
+        Desc desc;
+        file.read(reinterpret_cast<char*>(&desc.gridWidth), sizeof(uint32_t));
+        desc.brickWidth = brickWidth;
+        desc.narrowBandThickness = narrowBandThickness;
+
+        const size_t valuesPerSlice = (size_t)(desc.gridWidth + 1) * (desc.gridWidth + 1);
+        const uint64_t expectedSize = sizeof(uint32_t) + valuesPerSlice * (desc.gridWidth + 1) * sizeof(float);
+        if (!file.good() || desc.gridWidth == 0 || std::filesystem::file_size(srcPath) != expectedSize)
+        {
+            throw RuntimeError("SDF grid file '{}' is invalid.", srcPath);
+        }
+
+        // Only keep the slices of the current layer of bricks in memory.
+        Writer writer(dstPath, desc);
+        std::vector<float> slices((desc.brickWidth + 1) * valuesPerSlice);
+        for (uint32_t brickZ = 0; brickZ < writer.getBrickGridWidth(); ++brickZ)
+        {
+            uint32_t z0 = brickZ * desc.brickWidth;
+            uint32_t sliceCount = std::min(z0 + desc.brickWidth, desc.gridWidth) - z0 + 1;
+            file.seekg(sizeof(uint32_t) + z0 * valuesPerSlice * sizeof(float));
+            file.read(reinterpret_cast<char*>(slices.data()), sliceCount * valuesPerSlice * sizeof(float));
+            if (!file.good()) throw RuntimeError("Failed to read SDF grid file '{}'.", srcPath);
+            writer.writeLayer(brickZ, slices.data());
+        }
+        writer.finish();
+    }
+
+    bool SDFBrickFile::isBrickFile(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        char magic[sizeof(kMagic)] = {};
+        file.read(magic, sizeof(magic));
+        return file.good() && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+    }
+
+    SDFBrickFile::UniquePtr SDFBrickFile::open(const std::filesystem::path& path)
+    {
+        return UniquePtr(new SDFBrickFile(path));
+    }
+
+    SDFBrickFile::SDFBrickFile(const std::filesystem::path& path)
+        : mPath(path)
+        , mFile(path, std::ios::in | std::ios::binary)
+    {
+        if (!mFile.good()) throw RuntimeError("Failed to open SDF brick file '{}'.", path);
+
+        Header header = {};
+        mFile.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!mFile.good() || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) throw RuntimeError("'{}' is not an SDF brick file.", path);
+        if (header.version != kVersion) throw RuntimeError("SDF brick file '{}' has unsupported version {}.", path, header.version);
+        if (header.gridWidth == 0 || header.brickWidth == 0) throw RuntimeError("SDF brick file '{}' is invalid.", path);
+
+        mDesc.gridWidth = header.gridWidth;
+        mDesc.brickWidth = header.brickWidth;
+        mDesc.narrowBandThickness = header.narrowBandThickness;
+        mBrickGridWidth = div_round_up(header.gridWidth, header.brickWidth);
+        mBrickCount = header.brickCount;
+
+        const uint64_t fileSize = std::filesystem::file_size(path);
+        const uint64_t tableSize = header.blockCount * sizeof(BlockDesc);
+        if (header.blockTableOffset + tableSize + header.coarseValuesSize > fileSize) throw RuntimeError("SDF brick file '{}' is truncated.", path);
+
+        mBlocks.resize(header.blockCount);
+        mFile.seekg(header.blockTableOffset);
+        mFile.read(reinterpret_cast<char*>(mBlocks.data()), tableSize);
+
+        std::vector<uint8_t> coarseValues(header.coarseValuesSize);
+        mFile.read(reinterpret_cast<char*>(coarseValues.data()), coarseValues.size());
+        if (!mFile.good()) throw RuntimeError("Failed to read SDF brick file '{}'.", path);
+
+        mCoarseValues.resize((size_t)mBrickGridWidth * mBrickGridWidth * mBrickGridWidth);
+        decompressFrame(coarseValues, mCoarseValues.data(), mCoarseValues.size() * sizeof(int16_t));
+
+        uint32_t brickCount = 0;
+        for (const auto& block : mBlocks)
+        {
+            if (block.offset + block.compressedSize > header.blockTableOffset) throw RuntimeError("SDF brick file '{}' is invalid.", path);
+            brickCount += block.brickCount;
+        }
+        if (brickCount != mBrickCount) throw RuntimeError("SDF brick file '{}' is invalid.", path);
+    }
+
+    float SDFBrickFile::getCoarseValue(const uint3& brickCoord) const
+    {
+        FALCOR_ASSERT(brickCoord.x < mBrickGridWidth && brickCoord.y < mBrickGridWidth && brickCoord.z < mBrickGridWidth);
+        return mCoarseValues[brickCoord.x + mBrickGridWidth * (brickCoord.y + (size_t)mBrickGridWidth * brickCoord.z)] / kCoarseScale;
+    }
+
+    void SDFBrickFile::readBricks(const BrickCallback& callback)
+    {
+        const uint32_t valuesPerBrick = (mDesc.brickWidth + 1) * (mDesc.brickWidth + 1) * (mDesc.brickWidth + 1);
+        const size_t brickSize = sizeof(BrickHeader) + valuesPerBrick * sizeof(uint16_t);
+        const uint32_t brickGridSize = mBrickGridWidth * mBrickGridWidth * mBrickGridWidth;
+
+        struct DecodedBlock
+        {
+            std::vector<uint8_t> compressed;
+            std::vector<uint32_t> brickIndices;
+            std::vector<float> values;
+        };
+
+        const uint32_t batchSize = std::max(1u, Threading::getWorkerCount()) * kBlocksPerWorker;
+        std::vector<DecodedBlock> batch(std::min(batchSize, (uint32_t)mBlocks.size()));
+
+        for (size_t firstBlock = 0; firstBlock < mBlocks.size(); firstBlock += batchSize)
+        {
+            const size_t blockCount = std::min(mBlocks.size() - firstBlock, (size_t)batchSize);
+
+            // Read the compressed blocks sequentially.
+            for (size_t i = 0; i < blockCount; ++i)
+            {
+                const auto& block = mBlocks[firstBlock + i];
+                batch[i].compressed.resize(block.compressedSize);
+                mFile.seekg(block.offset);
+                mFile.read(reinterpret_cast<char*>(batch[i].compressed.data()), block.compressedSize);
+                if (!mFile.good()) throw RuntimeError("Failed to read SDF brick file '{}'.", mPath);
+            }
+
+            // Decompress and dequantize in parallel.
+            Threading::parallelFor(0, blockCount, [&](size_t i)
+            {
+                const auto& block = mBlocks[firstBlock + i];
+                auto& decoded = batch[i];
+
+                std::vector<uint8_t> data(block.brickCount * brickSize);
+                decompressFrame(decoded.compressed, data.data(), data.size());
+
+                decoded.brickIndices.resize(block.brickCount);
+                decoded.values.resize((size_t)block.brickCount * valuesPerBrick);
+                for (uint32_t b = 0; b < block.brickCount; ++b)
+                {
+                    BrickHeader brickHeader;
+                    std::memcpy(&brickHeader, data.data() + b * brickSize, sizeof(BrickHeader));
+                    if (brickHeader.brickIndex >= brickGridSize) throw RuntimeError("SDF brick file '{}' has an invalid brick index.", mPath);
+                    decoded.brickIndices[b] = brickHeader.brickIndex;
+
+                    const uint16_t* pSrc = reinterpret_cast<const uint16_t*>(data.data() + b * brickSize + sizeof(BrickHeader));
+                    float* pDst = decoded.values.data() + (size_t)b * valuesPerBrick;
+                    float scale = (brickHeader.maxValue - brickHeader.minValue) / float(UINT16_MAX);
+                    for (uint32_t v = 0; v < valuesPerBrick; ++v) pDst[v] = brickHeader.minValue + pSrc[v] * scale;
+                }
+            }, 1);
+
+            // Hand the bricks to the caller in file order.
+            for (size_t i = 0; i < blockCount; ++i)
+            {
+                const auto& decoded = batch[i];
+                for (size_t b = 0; b < decoded.brickIndices.size(); ++b)
+                {
+                    uint32_t brickIndex = decoded.brickIndices[b];
+                    uint3 brickCoord(brickIndex % mBrickGridWidth, (brickIndex / mBrickGridWidth) % mBrickGridWidth, brickIndex / (mBrickGridWidth * mBrickGridWidth));
+                    callback(brickCoord, decoded.values.data() + b * valuesPerBrick);
+                }
+            }
+        }
+    }
+
+    std::vector<float> SDFBrickFile::readDenseValues()
+    {
+        const uint32_t gridWidth = mDesc.gridWidth;
+        const uint32_t brickWidth = mDesc.brickWidth;
+        const size_t valuesPerRow = gridWidth + 1;
+        const size_t valuesPerSlice = valuesPerRow * valuesPerRow;
+        std::vector<float> values(valuesPerSlice * valuesPerRow);
+
+        // Fill in the values of bricks outside the narrow band. Corners shared by several bricks take the value of the last brick.
+        Threading::parallelFor(0, valuesPerRow, [&](size_t z)
+        {
+            uint32_t brickZ = std::min((uint32_t)z / brickWidth, mBrickGridWidth - 1);
+            for (uint32_t y = 0; y <= gridWidth; ++y)
+            {
+                uint32_t brickY = std::min(y / brickWidth, mBrickGridWidth - 1);
+                float* pRow = values.data() + z * valuesPerSlice + y * valuesPerRow;
+                for (uint32_t x = 0; x <= gridWidth; ++x)
+                {
+                    pRow[x] = getCoarseValue(uint3(std::min(x / brickWidth, mBrickGridWidth - 1), brickY, brickZ));
+                }
+            }
+        });
+
+        // Overwrite with the narrow band bricks.
+        readBricks([&](const uint3& brickCoord, const float* pValues)
+        {
+            const uint3 origin = brickCoord * brickWidth;
+            const uint3 extent = glm::min(origin + uint3(brickWidth), uint3(gridWidth)) - origin;
+            for (uint32_t z = 0; z <= extent.z; ++z)
+            {
+                for (uint32_t y = 0; y <= extent.y; ++y)
+                {
+                    const float* pSrc = pValues + (y + (brickWidth + 1) * z) * (brickWidth + 1);
+                    float* pDst = values.data() + (origin.z + z) * valuesPerSlice + (origin.y + y) * valuesPerRow + origin.x;
+                    std::memcpy(pDst, pSrc, (extent.x + 1) * sizeof(float));
+                }
+            }
+        });
+
+        return values;
+    }
+}
@@ -0,0 +1,175 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Falcor
+{
+    /** Sparse, quantized and compressed file format for SDF grid values (.sdfz).
+
+        The legacy .sdfg format stores all (gridWidth + 1)^3 corner values as floats. This format instead
+        divides the grid into bricks of brickWidth^3 voxels and only stores the bricks that are within a
+        narrow band of the surface. Each narrow band brick stores its (brickWidth + 1)^3 corner values quantized
+        to 16 bits relative to the value range of the brick. Bricks are grouped into blocks that are
+        compressed as independent LZ4 frames.
+
+        All other bricks store a single value, the distance with the smallest magnitude among its corners.
+        This means that distances outside of the narrow band are underestimated when read back.
+
+        File layout:
+        - Header
+        - Blocks of narrow band bricks. Each brick is a BrickHeader followed by the quantized values.
+        - Block table (BlockDesc per block).
+        - LZ4 frame holding one int16_t value per brick of the brick grid.
+    */
+    class FALCOR_API SDFBrickFile
+    {
+    public:
+        using UniquePtr = std::unique_ptr<SDFBrickFile>;
+
+        static constexpr uint32_t kDefaultBrickWidth = 8;
+        static constexpr float kDefaultNarrowBandThickness = 4.f;
+
+        struct Desc
+        {
+            uint32_t gridWidth = 0;                                 ///< Grid width in voxels.
+            uint32_t brickWidth = kDefaultBrickWidth;               ///< Brick width in voxels.
+            float narrowBandThickness = kDefaultNarrowBandThickness;///< Bricks with a corner closer to the surface than this many voxel diagonals are stored.
+        };
+
+        /** Callback receiving the (brickWidth + 1)^3 corner values of a narrow band brick, stored with x fastest.
+            Values of bricks overlapping the edge of the grid are clamped to the grid.
+        */
+        using BrickCallback = std::function<void(const uint3& brickCoord, const float* pValues)>;
+
+        /** Write corner values to a file.
+            \param[in] path File path.
+            \param[in] cornerValues The corner values for all voxels in the grid, (gridWidth + 1)^3 values.
+            \param[in] desc Grid and brick description.
+        */
+        static void write(const std::filesystem::path& path, const std::vector<float>& cornerValues, const Desc& desc);
+
+        /** Convert a legacy dense .sdfg file. The source file is streamed in slabs of bricks.
+            \param[in] srcPath Path of the .sdfg file.
+            \param[in] dstPath Path of the .sdfz file.
+            \param[in] brickWidth Brick width in voxels.
+            \param[in] narrowBandThickness Narrow band thickness in voxel diagonals.
+        */
+        static void convertDenseFile(const std::filesystem::path& srcPath, const std::filesystem::path& dstPath, uint32_t brickWidth = kDefaultBrickWidth, float narrowBandThickness = kDefaultNarrowBandThickness);
+
+        /** Get the distance to the surface, in grid units ([0, 1]), within which a brick is part of the narrow band.
+            \param[in] desc Grid and brick description.
+            \return The narrow band distance, the thickness in voxel diagonals (at least one) scaled to grid units.
+        */
+        static float getNarrowBandDistance(const Desc& desc);
+
+        /** Check if a file is a sparse brick file.
+        */
+        static bool isBrickFile(const std::filesystem::path& path);
+
+        /** Open a file for reading.
+            \param[in] path File path.
+            \return A new object, or throws an exception if the file is invalid.
+        */
+        static UniquePtr open(const std::filesystem::path& path);
+
+        const Desc& getDesc() const { return mDesc; }
+
+        /** Get the path of the file.
+        */
+        const std::filesystem::path& getPath() const { return mPath; }
+
+        /** Get the number of bricks along each axis of the grid.
+        */
+        uint32_t getBrickGridWidth() const { return mBrickGridWidth; }
+
+        /** Get the number of narrow band bricks stored in the file.
+        */
+        uint32_t getBrickCount() const { return mBrickCount; }
+
+        /** Get the value representing a brick outside of the narrow band.
+        */
+        float getCoarseValue(const uint3& brickCoord) const;
+
+        /** Read all narrow band bricks. Blocks are decompressed in parallel, the callback is invoked on the calling thread in file order.
+            \param[in] callback Callback receiving the brick values.
+        */
+        void readBricks(const BrickCallback& callback);
+
+        /** Read the file into a dense grid of (gridWidth + 1)^3 corner values.
+        */
+        std::vector<float> readDenseValues();
+
+    private:
+        struct Header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t gridWidth;
+            uint32_t brickWidth;
+            float narrowBandThickness;
+            uint32_t brickCount;
+            uint32_t blockCount;
+            uint64_t blockTableOffset;
+            uint64_t coarseValuesSize;
+        };
+
+        struct BlockDesc
+        {
+            uint64_t offset;
+            uint32_t compressedSize;
+            uint32_t brickCount;
+        };
+
+        struct BrickHeader
+        {
+            uint32_t brickIndex;
+            float minValue;
+            float maxValue;
+        };
+
+        class Writer;
+
+        SDFBrickFile(const std::filesystem::path& path);
+
+        std::filesystem::path mPath;
+        std::ifstream mFile;
+        Desc mDesc;
+        uint32_t mBrickGridWidth = 0;
+        uint32_t mBrickCount = 0;
+        std::vector<BlockDesc> mBlocks;
+        std::vector<int16_t> mCoarseValues;
+    };
+}
@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "SDFGrid.h"
+#include "SDFBrickFile.h"
 #include "NormalizedDenseSDFGrid/NDSDFGrid.h"
 #include "SparseVoxelSet/SDFSVS.h"
 #include "SparseBrickSet/SDFSBS.h"
@@ -38,6 +39,7 @@
 #include "Utils/Math/Common.h"
 #include "Utils/Math/Matrix/Matrix.h"
 #include "Utils/Scripting/ScriptBindings.h"
+#include "Utils/Threading.h"
 #include <nlohmann/json.hpp>
 #include <random>
 #include <fstream>
@@ -293,11 +295,48 @@ namespace Falcor
         setValuesInternal(cornerValues);
     }
 
+    void SDFGrid::setValuesFromBrickFile(SDFBrickFile& file)
+    {
+        const uint32_t gridWidth = file.getDesc().gridWidth;
+        Type type = getType();
+        if (type != Type::SparseBrickSet && !isPowerOf2(gridWidth))
+        {
+            throw RuntimeError("Grid width ({}) must be a power of 2 for SDFGrid type of {}", gridWidth, getTypeName(type));
+        }
+
+        mGridWidth = gridWidth;
+
+        setValuesFromBrickFileInternal(file);
+    }
+
+    void SDFGrid::setValuesFromBrickFileInternal(SDFBrickFile& file)
+    {
+        setValuesInternal(file.readDenseValues());
+    }
+
     bool SDFGrid::loadValuesFromFile(const std::filesystem::path& path)
     {
         std::filesystem::path fullPath;
         if (findFileInDataDirectories(path, fullPath))
         {
+            if (SDFBrickFile::isBrickFile(fullPath))
+            {
+                try
+                {
+                    auto pFile = SDFBrickFile::open(fullPath);
+                    setValuesFromBrickFile(*pFile);
+                }
+                catch (const RuntimeError& e)
+                {
+                    logWarning("SDFGrid::loadValuesFromFile() failed to load '{}': {}", path, e.what());
+                    return false;
+                }
+
+                mInitializedWithPrimitives = false;
+                mSourcePath = fullPath;
+                return true;
+            }
+
             std::ifstream file(fullPath, std::ios::in | std::ios::binary);
 
             if (file.is_open())
@@ -313,6 +352,7 @@ namespace Falcor
                 setValues(cornerValues, gridWidth);
 
                 mInitializedWithPrimitives = false;
+                mSourcePath = fullPath;
                 return true;
             }
         }
@@ -336,39 +376,59 @@ namespace Falcor
             holes[s] = float4(p, dist(rng) * 0.2f + 0.01f);
         }
 
-        uint32_t gridWidthInValues = 1 + gridWidth;
-        uint32_t totalValueCount = gridWidthInValues * gridWidthInValues * gridWidthInValues;
-        std::vector<float> cornerValues(totalValueCount, 0.0f);
+        const uint32_t gridWidthInValues = 1 + gridWidth;
+        const size_t valuesPerSlice = (size_t)gridWidthInValues * gridWidthInValues;
+        std::vector<float> cornerValues(valuesPerSlice * gridWidthInValues, 0.0f);
 
-        for (uint32_t z = 0; z < gridWidthInValues; z++)
+        // Evaluate one row along x at a time with the holes in the outer loop, so that the loops over x can be vectorized.
+        Threading::parallelFor(0, gridWidthInValues, [&](size_t z)
         {
+            std::vector<float> xLocal(gridWidthInValues);
+            for (uint32_t x = 0; x < gridWidthInValues; x++) xLocal[x] = float(x) / float(gridWidth) - 0.5f;
+            const float zLocal = float(z) / float(gridWidth) - 0.5f;
+
             for (uint32_t y = 0; y < gridWidthInValues; y++)
             {
-                for (uint32_t x = 0; x < gridWidthInValues; x++)
-                {
-                    float3 pLocal = (float3(x, y, z) / float(gridWidth)) - 0.5f;
-                    float sd;
+                const float yLocal = float(y) / float(gridWidth) - 0.5f;
+                float* pRow = cornerValues.data() + z * valuesPerSlice + y * gridWidthInValues;
 
-                    // Create a Box.
+                // Create a Box.
+                {
+                    const float dy = std::abs(yLocal) - kHalfCheeseExtent;
+                    const float dz = std::abs(zLocal) - kHalfCheeseExtent;
+                    const float dyOutside = glm::max(dy, 0.0f) * glm::max(dy, 0.0f);
+                    const float dzOutside = glm::max(dz, 0.0f) * glm::max(dz, 0.0f);
+                    for (uint32_t x = 0; x < gridWidthInValues; x++)
                     {
-                        float3 d = abs(pLocal) - float3(kHalfCheeseExtent);
-                        float outsideDist = glm::length(float3(glm::max(d.x, 0.0f), glm::max(d.y, 0.0f), glm::max(d.z, 0.0f)));
-                        float insideDist = glm::min(glm::max(glm::max(d.x, d.y), d.z), 0.0f);
-                        sd = outsideDist + insideDist;
+                        const float dx = std::abs(xLocal[x]) - kHalfCheeseExtent;
+                        float outsideDist = std::sqrt(glm::max(dx, 0.0f) * glm::max(dx, 0.0f) + dyOutside + dzOutside);
+                        float insideDist = glm::min(glm::max(glm::max(dx, dy), dz), 0.0f);
+                        pRow[x] = outsideDist + insideDist;
                     }
+                }
 
-                    // Create holes.
-                    for (uint32_t s = 0; s < kHoleCount; s++)
+                // Create holes.
+                for (uint32_t s = 0; s < kHoleCount; s++)
+                {
+                    const float4 holeData = holes[s];
+                    const float oy = yLocal - holeData.y;
+                    const float oz = zLocal - holeData.z;
+                    const float oy2 = oy * oy;
+                    const float oz2 = oz * oz;
+                    for (uint32_t x = 0; x < gridWidthInValues; x++)
                     {
-                        float4 holeData = holes[s];
-                        sd = glm::max(sd, -(glm::length(pLocal - holeData.xyz) - holeData.w));
+                        const float ox = xLocal[x] - holeData.x;
+                        pRow[x] = glm::max(pRow[x], -(std::sqrt(ox * ox + oy2 + oz2) - holeData.w));
                     }
+                }
 
-                    // We don't care about distance further away than the length of the diagonal of the unit cube where the SDF grid is defined.
-                    cornerValues[x + gridWidthInValues * (y + gridWidthInValues * z)] = glm::clamp(sd, -glm::root_three<float>(), glm::root_three<float>());
+                // We don't care about distance further away than the length of the diagonal of the unit cube where the SDF grid is defined.
+                for (uint32_t x = 0; x < gridWidthInValues; x++)
+                {
+                    pRow[x] = glm::clamp(pRow[x], -glm::root_three<float>(), glm::root_three<float>());
                 }
             }
-        }
+        });
 
         setValues(cornerValues, gridWidth);
     }
@@ -377,6 +437,7 @@ namespace Falcor
     {
         if (!pRenderContext) pRenderContext = gpDevice->getRenderContext();
 
+        if (mHasGridRepresentation) prepareSDFGridTexture(pRenderContext);
         createEvaluatePrimitivesPass(false, mHasGridRepresentation);
 
         updatePrimitivesBuffer();
@@ -399,17 +460,35 @@ namespace Falcor
         pFence->syncCpu();
         const float* pValues = reinterpret_cast<const float*>(pValuesStagingBuffer->map(Buffer::MapType::Read));
 
-        std::ofstream file(path, std::ios::out | std::ios::binary);
-
-        if (file.is_open())
+        bool success = true;
+        if (hasExtension(path, "sdfz"))
         {
-            file.write(reinterpret_cast<const char*>(&mGridWidth), sizeof(uint32_t));
-            file.write(reinterpret_cast<const char*>(pValues), valueCount * sizeof(float));
-            file.close();
+            SDFBrickFile::Desc desc;
+            desc.gridWidth = mGridWidth;
+            try
+            {
+                SDFBrickFile::write(path, std::vector<float>(pValues, pValues + valueCount), desc);
+            }
+            catch (const RuntimeError& e)
+            {
+                logWarning("SDFGrid::writeValuesFromPrimitivesToFile() failed to write '{}': {}", path, e.what());
+                success = false;
+            }
+        }
+        else
+        {
+            std::ofstream file(path, std::ios::out | std::ios::binary);
+
+            if (file.is_open())
+            {
+                file.write(reinterpret_cast<const char*>(&mGridWidth), sizeof(uint32_t));
+                file.write(reinterpret_cast<const char*>(pValues), valueCount * sizeof(float));
+                file.close();
+            }
         }
 
         pValuesStagingBuffer->unmap();
-        return true;
+        return success;
     }
 
     uint32_t SDFGrid::loadPrimitivesFromFile(const std::filesystem::path& path, uint32_t gridWidth, const std::filesystem::path& dir)
@@ -450,6 +529,7 @@ namespace Falcor
         setPrimitives(primitives, gridWidth);
 
         mInitializedWithPrimitives = true;
+        mSourcePath = fullPath;
         return (uint32_t)mPrimitives.size();
     }
 
@@ -537,6 +617,8 @@ namespace Falcor
         sdfGrid.def_static("createSVS", [](){ return SDFGrid::SharedPtr(SDFSVS::create()); });
         sdfGrid.def_static("createSBS", createSBS);
         sdfGrid.def_static("createSVO", [](){ return SDFGrid::SharedPtr(SDFSVO::create()); });
+        sdfGrid.def_static("convertValuesFile", &SDFBrickFile::convertDenseFile,
+            "srcPath"_a, "dstPath"_a, "brickWidth"_a = SDFBrickFile::kDefaultBrickWidth, "narrowBandThickness"_a = SDFBrickFile::kDefaultNarrowBandThickness);
         sdfGrid.def("loadValuesFromFile", &SDFGrid::loadValuesFromFile, "path"_a);
         sdfGrid.def("loadPrimitivesFromFile", &SDFGrid::loadPrimitivesFromFile, "path"_a, "gridWidth"_a, "dir"_a = "");
         sdfGrid.def("generateCheeseValues", &SDFGrid::generateCheeseValues, "gridWidth"_a, "seed"_a);
@@ -40,6 +40,7 @@
 namespace Falcor
 {
     class RenderContext;
+    class SDFBrickFile;
     struct ShaderVar;
 
     /** SDF grid base class, stored by distance values at grid cell/voxel corners.
@@ -123,7 +124,7 @@ namespace Falcor
         void setValues(const std::vector<float>& cornerValues, uint32_t gridWidth);
 
         /** Set the signed distance values of the SDF grid from a file.
-            \param[in] path The path of a .sdfg file.
+            \param[in] path The path of a .sdfg or .sdfz file. The format is detected from the file contents.
             \return true if the values could be set, otherwise false.
         */
         bool loadValuesFromFile(const std::filesystem::path& path);
@@ -135,7 +136,7 @@ namespace Falcor
         void generateCheeseValues(uint32_t gridWidth, uint32_t seed);
 
         /** Evaluates the SDF grid primitives on to a grid and writes the grid to a file.
-            \param[in] path A path to the file that should store the values.
+            \param[in] path A path to the file that should store the values. Paths with the .sdfz extension are written in the sparse brick format (see SDFBrickFile).
             \return true if the values could be written, otherwise false.
         */
         bool writeValuesFromPrimitivesToFile(const std::filesystem::path& path, RenderContext* pRenderContext = nullptr);
@@ -231,11 +232,30 @@ namespace Falcor
         */
         uint32_t getBakedPrimitiveCount() const { return mBakedPrimitiveCount; };
 
+        /** Get the path of the file the values or primitives were loaded from.
+            \return The full path, or an empty path if the grid was not loaded from a file.
+        */
+        const std::filesystem::path& getSourcePath() const { return mSourcePath; }
+
         static std::string getTypeName(Type type);
 
     protected:
         virtual void setValuesInternal(const std::vector<float>& cornerValues) = 0;
 
+        /** Set the values and grid width from a sparse brick file. Throws an exception if the grid width is not supported by the grid type.
+        */
+        void setValuesFromBrickFile(SDFBrickFile& file);
+
+        /** Set the values from a sparse brick file. mGridWidth is set before this is called.
+            The default implementation expands the file into a dense grid of corner values and calls setValuesInternal().
+            \param[in] file The opened brick file.
+        */
+        virtual void setValuesFromBrickFileInternal(SDFBrickFile& file);
+
+        /** Make sure that mpSDFGridTexture holds the value representation, for grid types that can be created without it.
+        */
+        virtual void prepareSDFGridTexture(RenderContext* pRenderContext) {}
+
         void createEvaluatePrimitivesPass(bool writeToTexture3D, bool mergeWithSDField);
 
         void updatePrimitivesBuffer();
@@ -254,6 +274,7 @@ namespace Falcor
         bool                    mBakePrimitives = false;            ///< True if the primitives should be baked into the value representation.
         bool                    mHasGridRepresentation = false;     ///< True if a value representation exists.
         bool                    mInitializedWithPrimitives = false; ///< True if the grid was initialized with primitives.
+        std::filesystem::path   mSourcePath;                        ///< Path of the file loaded by loadValuesFromFile() or loadPrimitivesFromFile().
 
         Texture::SharedPtr      mpSDFGridTexture;                   ///< A texture on the GPU holding the value representation.
         ComputePass::SharedPtr  mpEvaluatePrimitivesPass;
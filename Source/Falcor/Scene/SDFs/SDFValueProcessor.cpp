@@ -0,0 +1,146 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "SDFValueProcessor.h"
+#include "Core/Assert.h"
+#include "Utils/Threading.h"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Minimum number of values per task when quantizing a flat array.
+        */
+        const size_t kQuantizeGrainSize = 1 << 16;
+
+        /** Quantize a row of values. The loop is branch-free so that it can be vectorized.
+        */
+        template<typename T>
+        void quantizeRow(const float* pSrc, size_t count, float scale, T* pDst)
+        {
+            const float maxValue = float(std::numeric_limits<T>::max());
+            for (size_t i = 0; i < count; ++i)
+            {
+                float v = std::min(std::max(pSrc[i] * scale, -1.f), 1.f) * maxValue;
+                pDst[i] = T(v + (v >= 0.f ? 0.5f : -0.5f));
+            }
+        }
+
+        /** Update per-column minimum and maximum values with a row of values.
+        */
+        void accumulateRow(const float* pSrc, size_t count, float* pMin, float* pMax)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                pMin[i] = std::min(pMin[i], pSrc[i]);
+                pMax[i] = std::max(pMax[i], pSrc[i]);
+            }
+        }
+
+        template<typename T>
+        void quantizeParallel(const float* pValues, size_t count, float scale, T* pDst)
+        {
+            Threading::parallelForChunks(0, count, [&](size_t begin, size_t end)
+            {
+                quantizeRow(pValues + begin, end - begin, scale, pDst + begin);
+            }, kQuantizeGrainSize);
+        }
+
+        template<typename T>
+        void processBricksParallel(const float* pSlices, uint32_t gridWidth, uint32_t brickWidth, uint32_t brickZBegin, uint32_t brickZEnd, SDFValueProcessor::BrickRange* pRanges, float scale, T* pQuantized)
+        {
+            FALCOR_ASSERT(gridWidth > 0 && brickWidth > 0);
+            const uint32_t n = SDFValueProcessor::getBrickGridWidth(gridWidth, brickWidth);
+            FALCOR_ASSERT(brickZBegin <= brickZEnd && brickZEnd <= n);
+
+            const size_t valuesPerRow = gridWidth + 1;
+            const size_t valuesPerSlice = valuesPerRow * valuesPerRow;
+            const uint32_t sliceBegin = brickZBegin * brickWidth;
+
+            // Each task processes one row of bricks along x. Column ranges are accumulated over all rows of values
+            // in the bricks and then reduced per brick, so the inner loops run over whole rows of the grid.
+            Threading::parallelFor(0, (size_t)(brickZEnd - brickZBegin) * n, [&](size_t task)
+            {
+                const uint32_t brickZ = brickZBegin + uint32_t(task / n);
+                const uint32_t brickY = uint32_t(task % n);
+                const uint32_t z0 = brickZ * brickWidth;
+                const uint32_t z1 = std::min(z0 + brickWidth, gridWidth);
+                const uint32_t y0 = brickY * brickWidth;
+                const uint32_t y1 = std::min(y0 + brickWidth, gridWidth);
+
+                std::vector<float> columnMin(valuesPerRow, std::numeric_limits<float>::max());
+                std::vector<float> columnMax(valuesPerRow, -std::numeric_limits<float>::max());
+
+                for (uint32_t z = z0; z <= z1; ++z)
+                {
+                    // Boundary slices and rows are shared with the next layer/row of bricks, which quantizes them.
+                    const bool ownsZ = z < z0 + brickWidth || brickZ == n - 1;
+                    const size_t sliceOffset = (z - sliceBegin) * valuesPerSlice;
+                    for (uint32_t y = y0; y <= y1; ++y)
+                    {
+                        const bool ownsY = y < y0 + brickWidth || brickY == n - 1;
+                        const size_t rowOffset = sliceOffset + y * valuesPerRow;
+                        accumulateRow(pSlices + rowOffset, valuesPerRow, columnMin.data(), columnMax.data());
+                        if (pQuantized && ownsZ && ownsY) quantizeRow(pSlices + rowOffset, valuesPerRow, scale, pQuantized + rowOffset);
+                    }
+                }
+
+                SDFValueProcessor::BrickRange* pRowRanges = pRanges + n * (brickY + (size_t)n * (brickZ - brickZBegin));
+                for (uint32_t brickX = 0; brickX < n; ++brickX)
+                {
+                    const uint32_t x0 = brickX * brickWidth;
+                    const uint32_t x1 = std::min(x0 + brickWidth, gridWidth);
+                    pRowRanges[brickX].minValue = *std::min_element(columnMin.begin() + x0, columnMin.begin() + x1 + 1);
+                    pRowRanges[brickX].maxValue = *std::max_element(columnMax.begin() + x0, columnMax.begin() + x1 + 1);
+                }
+            }, 1);
+        }
+    }
+
+    void SDFValueProcessor::quantize(const float* pValues, size_t count, float scale, int8_t* pDst)
+    {
+        quantizeParallel(pValues, count, scale, pDst);
+    }
+
+    void SDFValueProcessor::quantize(const float* pValues, size_t count, float scale, int16_t* pDst)
+    {
+        quantizeParallel(pValues, count, scale, pDst);
+    }
+
+    void SDFValueProcessor::processBricks(const float* pSlices, uint32_t gridWidth, uint32_t brickWidth, uint32_t brickZBegin, uint32_t brickZEnd, BrickRange* pRanges, float scale, int16_t* pQuantized)
+    {
+        processBricksParallel(pSlices, gridWidth, brickWidth, brickZBegin, brickZEnd, pRanges, scale, pQuantized);
+    }
+
+    void SDFValueProcessor::processBricks(const float* pSlices, uint32_t gridWidth, uint32_t brickWidth, uint32_t brickZBegin, uint32_t brickZEnd, BrickRange* pRanges, float scale, int8_t* pQuantized)
+    {
+        processBricksParallel(pSlices, gridWidth, brickWidth, brickZBegin, brickZEnd, pRanges, scale, pQuantized);
+    }
+}
@@ -0,0 +1,89 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Falcor
+{
+    /** Multi-threaded CPU processing of SDF grid corner values.
+
+        Values are stored with x fastest, i.e., value (x, y, z) is at index x + w * (y + w * z) where w = gridWidth + 1.
+        The kernels work on whole rows along x using fixed-width loops that the compiler vectorizes, and distribute
+        slices or bricks over worker threads.
+    */
+    class FALCOR_API SDFValueProcessor
+    {
+    public:
+        /** Value range of a brick of corner values.
+        */
+        struct BrickRange
+        {
+            float minValue;
+            float maxValue;
+
+            /** Returns the value closest to the surface, or zero if the brick contains a sign change.
+            */
+            float getClosestValue() const { return minValue > 0.f ? minValue : (maxValue < 0.f ? maxValue : 0.f); }
+
+            /** Returns true if the brick contains a sign change or a value within the given distance of the surface.
+            */
+            bool isNarrowBand(float narrowBandDistance) const { return minValue <= narrowBandDistance && maxValue >= -narrowBandDistance; }
+        };
+
+        /** Quantize values to signed normalized integers, i.e., round(clamp(value * scale, -1, 1) * INT_MAX).
+            \param[in] pValues Values.
+            \param[in] count Number of values.
+            \param[in] scale Scale applied before clamping.
+            \param[out] pDst Quantized values.
+        */
+        static void quantize(const float* pValues, size_t count, float scale, int8_t* pDst);
+        static void quantize(const float* pValues, size_t count, float scale, int16_t* pDst);
+
+        /** Compute the value ranges of bricks and optionally quantize the values in the same pass.
+            Bricks span brickWidth voxels, i.e., (brickWidth + 1)^3 corner values, and neighboring bricks share
+            their boundary values. Bricks overlapping the edge of the grid are clamped to the grid.
+            The function processes the layers of bricks (slabs along z) in [brickZBegin, brickZEnd).
+            \param[in] pSlices Values starting at slice z = brickZBegin * brickWidth.
+            \param[in] gridWidth Grid width in voxels.
+            \param[in] brickWidth Brick width in voxels.
+            \param[in] brickZBegin First layer of bricks.
+            \param[in] brickZEnd One past the last layer of bricks.
+            \param[out] pRanges Ranges of the processed bricks, indexed by x + n * (y + n * (z - brickZBegin)) where n is the number of bricks per axis.
+            \param[in] scale Scale used for quantization.
+            \param[out] pQuantized Quantized values, laid out like pSlices. Each value is written once, by the layer that owns its slice. Can be nullptr.
+        */
+        static void processBricks(const float* pSlices, uint32_t gridWidth, uint32_t brickWidth, uint32_t brickZBegin, uint32_t brickZEnd, BrickRange* pRanges, float scale = 1.f, int16_t* pQuantized = nullptr);
+        static void processBricks(const float* pSlices, uint32_t gridWidth, uint32_t brickWidth, uint32_t brickZBegin, uint32_t brickZEnd, BrickRange* pRanges, float scale, int8_t* pQuantized);
+
+        /** Returns the number of bricks per axis.
+        */
+        static uint32_t getBrickGridWidth(uint32_t gridWidth, uint32_t brickWidth) { return (gridWidth + brickWidth - 1) / brickWidth; }
+    };
+}
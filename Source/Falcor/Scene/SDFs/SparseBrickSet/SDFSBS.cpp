@@ -26,10 +26,13 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "SDFSBS.h"
+#include "Scene/SDFs/SDFBrickFile.h"
+#include "Scene/SDFs/SDFValueProcessor.h"
 #include "Core/API/Device.h"
 #include "Core/API/RenderContext.h"
 #include "Core/API/IndirectCommands.h"
 #include "Utils/Math/MathHelpers.h"
+#include "Utils/Threading.h"
 #include "Scene/SDFs/SDFVoxelTypes.slang"
 
 namespace Falcor
@@ -89,7 +92,7 @@ namespace Falcor
     SDFGrid::UpdateFlags SDFSBS::update(RenderContext* pRenderContext)
     {
         // No update is performed if the SDF grid isn't dirty or isn't constructed from primitives and should not be created as an empty grid.
-        bool isEmpty = mPrimitives.empty() && !mpSDFGridTexture && !mWasEmpty;
+        bool isEmpty = mPrimitives.empty() && !mpSDFGridTexture && mBrickFilePath.empty() && !mWasEmpty;
         if ((!mPrimitivesDirty || (mPrimitives.empty() && !mHasGridRepresentation)) && !isEmpty) return UpdateFlags::None;
 
         // Update grid texture, if user loads an sdf-file.
@@ -98,6 +101,7 @@ namespace Falcor
             createSDFGridTexture(pRenderContext, mSDField);
             mSDField.clear();
         }
+        prepareSDFGridTexture(pRenderContext);
         return createResourcesFromPrimitivesAndSDField(pRenderContext, false);
     }
 
@@ -114,12 +118,21 @@ namespace Falcor
 
         if (!mPrimitives.empty())
         {
+            prepareSDFGridTexture(pRenderContext);
             createResourcesFromPrimitivesAndSDField(pRenderContext, deleteScratchData);
         }
+        else if (!mLoadedBrickCoords.empty())
+        {
+            createResourcesFromLoadedBricks(pRenderContext, deleteScratchData);
+        }
         else if (mPrimitives.empty() && mpSDFGridTexture != nullptr)
         {
             createResourcesFromSDField(pRenderContext, deleteScratchData);
         }
+        else if (!mBrickFilePath.empty() && mpBrickTexture)
+        {
+            // The bricks loaded from the brick file have already been created.
+        }
         else
         {
             // Use default value for the grid width if it was not initialized.
@@ -268,81 +281,174 @@ namespace Falcor
                 mpCreateBricksFromSDFieldPass = ComputePass::create(desc, { {"COMPRESS_BRICKS", mCompressed ? "1" : "0"} });
             }
 
-            // TextureWidth = kBrickWidthInValues * kBrickWidthInValues * BricksAlongX
-            // TextureHeight = kBrickWidthInValues * BricksAlongY
-            // TotalBrickCount = BricksAlongX * BricksAlongY
-            // Set TextureWidth = TextureHeight and solve for BricksAlongX.
-            // This gives: BricksAlongX = ceil(sqrt(TotalNumBricks / kBrickWidthInValues).
-            // And: BricksAlongY = ceil(TotalNumBricks / BricksAlongX).
-            // This should give TextureWidth ~= TextureHeight.
+            allocateBrickTexture();
 
-            uint32_t brickWidthInValues = mBrickWidth + 1;
-            uint32_t bricksAlongX = (uint32_t)std::ceil(std::sqrt((float)mBrickCount / brickWidthInValues));
-            uint32_t bricksAlongY = (uint32_t)std::ceil((float)mBrickCount / bricksAlongX);
+            auto paramBlock = mpCreateBricksFromSDFieldPass["gParamBlock"];
+            paramBlock["virtualGridWidth"] = mGridWidth;
+            paramBlock["virtualBrickCount"] = virtualBrickCount;
+            paramBlock["virtualBricksPerAxis"] = mVirtualBricksPerAxis;
+            paramBlock["brickCount"] = mBrickCount;
+            paramBlock["brickWidthInVoxels"] = mBrickWidth;
+            paramBlock["bricksPerAxis"] = mBricksPerAxis;
+            paramBlock["sdfGrid"] = mpSDFGridTexture;
+            paramBlock["indirectionBuffer"] = mpIndirectionBuffer;
+            paramBlock["brickAABBs"] = mpBrickAABBsBuffer;
+            paramBlock["bricks"] = mCompressed ? mpBrickScratchTexture : mpBrickTexture;
+            mpCreateBricksFromSDFieldPass->execute(pRenderContext, virtualBrickCount, 1);
+        }
 
-            // Create brick texture.
-            if (!mpBrickTexture || mBricksPerAxis.x < bricksAlongX || mBricksPerAxis.y < bricksAlongY)
-            {
-                mBricksPerAxis = uint2(bricksAlongX, bricksAlongY);
+        // Copy the uncompressed brick texture to the compressed brick texture.
+        if (mCompressed) pRenderContext->copyResource(mpBrickTexture.get(), mpBrickScratchTexture.get());
 
-                uint32_t textureWidth = brickWidthInValues * brickWidthInValues * bricksAlongX;
-                uint32_t textureHeight = brickWidthInValues * bricksAlongY;
+        if (deleteScratchData)
+        {
+            mpAssignBrickValidityPass.reset();
+            mpPrefixSumPass.reset();
+            mpCopyIndirectionBufferPass.reset();
+            mpCreateBricksFromSDFieldPass.reset();
 
-                if (mCompressed)
-                {
-                    mpBrickTexture = Texture::create2D(textureWidth, textureHeight, ResourceFormat::BC4Snorm, 1, 1);
+            mpBrickScratchTexture.reset();
+            mpValidityBuffer.reset();
+            mpIndirectionBuffer.reset();
+            mpCountBuffer.reset();
+        }
 
-                    // Compression scheme may change the actual width and height to something else.
-                    mBrickTextureDimensions = uint2(mpBrickTexture->getWidth(), mpBrickTexture->getHeight());
+        mWasEmpty = false;
+    }
 
-                    mpBrickScratchTexture = Texture::create2D(mBrickTextureDimensions.x / 4, mBrickTextureDimensions.y / 4, ResourceFormat::RG32Int, 1, 1, nullptr, Resource::BindFlags::UnorderedAccess);
-                }
-                else
-                {
-                    mpBrickTexture = Texture::create2D(textureWidth, textureHeight, ResourceFormat::R8Snorm, 1, 1, nullptr, ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource);
+    void SDFSBS::createResourcesFromLoadedBricks(RenderContext* pRenderContext, bool deleteScratchData)
+    {
+        FALCOR_ASSERT(!mLoadedBrickCoords.empty() && mLoadedBrickValues.size() == mLoadedBrickCoords.size() * (mBrickWidth + 1) * (mBrickWidth + 1) * (mBrickWidth + 1));
 
-                    mBrickTextureDimensions = uint2(textureWidth, textureHeight);
-                }
+        mVirtualBricksPerAxis = std::max(mVirtualBricksPerAxis, (uint32_t)std::ceil(float(mGridWidth) / mBrickWidth));
+        uint32_t virtualBrickCount = mVirtualBricksPerAxis * mVirtualBricksPerAxis * mVirtualBricksPerAxis;
+        mBrickCount = (uint32_t)mLoadedBrickCoords.size();
+
+        // The loaded bricks are sorted by virtual brick ID, which gives them the same brick IDs as the prefix sum over the brick validity in createResourcesFromSDField().
+        {
+            std::vector<uint32_t> indirection(virtualBrickCount, std::numeric_limits<uint32_t>::max());
+            for (uint32_t brickID = 0; brickID < mBrickCount; brickID++)
+            {
+                const uint3& virtualBrickCoords = mLoadedBrickCoords[brickID];
+                indirection[virtualBrickCoords.x + mVirtualBricksPerAxis * (virtualBrickCoords.y + mVirtualBricksPerAxis * virtualBrickCoords.z)] = brickID;
             }
 
-            if (!mpBrickAABBsBuffer || mpBrickAABBsBuffer->getElementCount() < mBrickCount)
+            mpIndirectionBuffer = Buffer::createStructured(sizeof(uint32_t), virtualBrickCount, ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, indirection.data(), false);
+        }
+
+        // Copy indirection buffer to indirection texture.
+        {
+            if (!mpCopyIndirectionBufferPass)
             {
-                mpBrickAABBsBuffer = Buffer::createStructured(sizeof(AABB), mBrickCount, ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, nullptr, false);
+                Program::Desc desc;
+                desc.addShaderLibrary(kCopyIndirectionBufferShaderName).csEntry("main");
+                mpCopyIndirectionBufferPass = ComputePass::create(desc);
             }
 
-            auto paramBlock = mpCreateBricksFromSDFieldPass["gParamBlock"];
+            if (!mpIndirectionTexture || mpIndirectionTexture->getWidth() < mVirtualBricksPerAxis)
+            {
+                mpIndirectionTexture = Texture::create3D(mVirtualBricksPerAxis, mVirtualBricksPerAxis, mVirtualBricksPerAxis, ResourceFormat::R32Uint, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
+                mpIndirectionTexture->setName("SDFSBS::IndirectionTextureValues");
+            }
+
+            auto paramBlock = mpCopyIndirectionBufferPass["gParamBlock"];
+            paramBlock["virtualBricksPerAxis"] = mVirtualBricksPerAxis;
+            paramBlock["indirectionBuffer"] = mpIndirectionBuffer;
+            paramBlock["indirectionTexture"] = mpIndirectionTexture;
+            mpCopyIndirectionBufferPass->execute(pRenderContext, uint3(mVirtualBricksPerAxis));
+        }
+
+        // Create bricks and brick AABBs, reading the brick values from a buffer instead of the SD field.
+        {
+            if (!mpCreateBricksFromLoadedBricksPass)
+            {
+                Program::Desc desc;
+                desc.addShaderLibrary(kCreateBricksFromSDFieldShaderName).csEntry("main");
+                mpCreateBricksFromLoadedBricksPass = ComputePass::create(desc, { {"COMPRESS_BRICKS", mCompressed ? "1" : "0"}, {"USE_BRICK_VALUES", "1"} });
+            }
+
+            allocateBrickTexture();
+
+            Buffer::SharedPtr pBrickValuesBuffer = Buffer::createTyped(ResourceFormat::R16Snorm, (uint32_t)mLoadedBrickValues.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, mLoadedBrickValues.data());
+
+            auto paramBlock = mpCreateBricksFromLoadedBricksPass["gParamBlock"];
             paramBlock["virtualGridWidth"] = mGridWidth;
             paramBlock["virtualBrickCount"] = virtualBrickCount;
             paramBlock["virtualBricksPerAxis"] = mVirtualBricksPerAxis;
             paramBlock["brickCount"] = mBrickCount;
             paramBlock["brickWidthInVoxels"] = mBrickWidth;
             paramBlock["bricksPerAxis"] = mBricksPerAxis;
-            paramBlock["sdfGrid"] = mpSDFGridTexture;
+            paramBlock["brickValues"] = pBrickValuesBuffer;
             paramBlock["indirectionBuffer"] = mpIndirectionBuffer;
             paramBlock["brickAABBs"] = mpBrickAABBsBuffer;
             paramBlock["bricks"] = mCompressed ? mpBrickScratchTexture : mpBrickTexture;
-            mpCreateBricksFromSDFieldPass->execute(pRenderContext, virtualBrickCount, 1);
+            mpCreateBricksFromLoadedBricksPass->execute(pRenderContext, virtualBrickCount, 1);
         }
 
         // Copy the uncompressed brick texture to the compressed brick texture.
         if (mCompressed) pRenderContext->copyResource(mpBrickTexture.get(), mpBrickScratchTexture.get());
 
+        // The loaded bricks are only uploaded once.
+        mLoadedBrickCoords = {};
+        mLoadedBrickValues = {};
+
         if (deleteScratchData)
         {
-            mpAssignBrickValidityPass.reset();
-            mpPrefixSumPass.reset();
             mpCopyIndirectionBufferPass.reset();
-            mpCreateBricksFromSDFieldPass.reset();
+            mpCreateBricksFromLoadedBricksPass.reset();
 
             mpBrickScratchTexture.reset();
-            mpValidityBuffer.reset();
             mpIndirectionBuffer.reset();
-            mpCountBuffer.reset();
         }
 
         mWasEmpty = false;
     }
 
+    void SDFSBS::allocateBrickTexture()
+    {
+        // TextureWidth = kBrickWidthInValues * kBrickWidthInValues * BricksAlongX
+        // TextureHeight = kBrickWidthInValues * BricksAlongY
+        // TotalBrickCount = BricksAlongX * BricksAlongY
+        // Set TextureWidth = TextureHeight and solve for BricksAlongX.
+        // This gives: BricksAlongX = ceil(sqrt(TotalNumBricks / kBrickWidthInValues).
+        // And: BricksAlongY = ceil(TotalNumBricks / BricksAlongX).
+        // This should give TextureWidth ~= TextureHeight.
+
+        uint32_t brickWidthInValues = mBrickWidth + 1;
+        uint32_t bricksAlongX = (uint32_t)std::ceil(std::sqrt((float)mBrickCount / brickWidthInValues));
+        uint32_t bricksAlongY = (uint32_t)std::ceil((float)mBrickCount / bricksAlongX);
+
+        // Create brick texture.
+        if (!mpBrickTexture || mBricksPerAxis.x < bricksAlongX || mBricksPerAxis.y < bricksAlongY)
+        {
+            mBricksPerAxis = uint2(bricksAlongX, bricksAlongY);
+
+            uint32_t textureWidth = brickWidthInValues * brickWidthInValues * bricksAlongX;
+            uint32_t textureHeight = brickWidthInValues * bricksAlongY;
+
+            if (mCompressed)
+            {
+                mpBrickTexture = Texture::create2D(textureWidth, textureHeight, ResourceFormat::BC4Snorm, 1, 1);
+
+                // Compression scheme may change the actual width and height to something else.
+                mBrickTextureDimensions = uint2(mpBrickTexture->getWidth(), mpBrickTexture->getHeight());
+
+                mpBrickScratchTexture = Texture::create2D(mBrickTextureDimensions.x / 4, mBrickTextureDimensions.y / 4, ResourceFormat::RG32Int, 1, 1, nullptr, Resource::BindFlags::UnorderedAccess);
+            }
+            else
+            {
+                mpBrickTexture = Texture::create2D(textureWidth, textureHeight, ResourceFormat::R8Snorm, 1, 1, nullptr, ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource);
+
+                mBrickTextureDimensions = uint2(textureWidth, textureHeight);
+            }
+        }
+
+        if (!mpBrickAABBsBuffer || mpBrickAABBsBuffer->getElementCount() < mBrickCount)
+        {
+            mpBrickAABBsBuffer = Buffer::createStructured(sizeof(AABB), mBrickCount, ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, nullptr, false);
+        }
+    }
+
     SDFGrid::UpdateFlags SDFSBS::createResourcesFromPrimitivesAndSDField(RenderContext* pRenderContext, bool deleteScratchData)
     {
         // Assume AABBs will change.
@@ -966,18 +1072,224 @@ namespace Falcor
 
     void SDFSBS::setValuesInternal(const std::vector<float>& cornerValues)
     {
+        mLoadedBrickCoords = {};
+        mLoadedBrickValues = {};
+        mBrickFilePath.clear();
+
         uint32_t gridWidthInValues = mGridWidth + 1;
         uint32_t valueCount = gridWidthInValues * gridWidthInValues * gridWidthInValues;
         mSDField.resize(valueCount);
 
         // The grid is in the size [-1, 1] thus the longest distance that can be stored is sqrt(3) (the length from corner to corner)
         constexpr float normalizationFactor = 1.f;// 1.f / glm::root_three<float>();
-        for (uint32_t v = 0; v < valueCount; v++)
+        SDFValueProcessor::quantize(cornerValues.data(), valueCount, normalizationFactor, mSDField.data());
+    }
+
+    void SDFSBS::setValuesFromBrickFileInternal(SDFBrickFile& file)
+    {
+        // Find the bricks that contain surface straight from the narrow band bricks in the file, without expanding the file into a dense SD field.
+        // The brick values and validity are the same as createResourcesFromSDField() finds in the SD field that readDenseValues() describes.
+        const uint32_t fileBrickWidth = file.getDesc().brickWidth;
+        const uint32_t fileBrickGridWidth = file.getBrickGridWidth();
+        const uint32_t fileValuesPerBrick = (fileBrickWidth + 1) * (fileBrickWidth + 1) * (fileBrickWidth + 1);
+        const size_t fileBrickGridSize = (size_t)fileBrickGridWidth * fileBrickGridWidth * fileBrickGridWidth;
+        const uint32_t kNoSlot = std::numeric_limits<uint32_t>::max();
+
+        constexpr float normalizationFactor = 1.f;
+
+        mSDField = {};
+        mpSDFGridTexture.reset();
+        mBrickFilePath = file.getPath();
+        mHasGridRepresentation = true;
+        mCurrentBakedPrimitiveCount = 0;
+        mBakedPrimitiveCount = 0;
+
+        std::vector<float> coarseValues(fileBrickGridSize);
+        for (uint32_t z = 0; z < fileBrickGridWidth; ++z)
         {
-            float normalizedValue = glm::clamp(cornerValues[v] * normalizationFactor, -1.0f, 1.0f);
-            float integerScale = normalizedValue * float(INT16_MAX);
-            mSDField[v] = integerScale >= 0.0f ? int16_t(integerScale + 0.5f) : int16_t(integerScale - 0.5f);
+            for (uint32_t y = 0; y < fileBrickGridWidth; ++y)
+            {
+                for (uint32_t x = 0; x < fileBrickGridWidth; ++x)
+                {
+                    coarseValues[x + fileBrickGridWidth * (y + (size_t)fileBrickGridWidth * z)] = file.getCoarseValue(uint3(x, y, z));
+                }
+            }
         }
+        std::vector<int16_t> quantizedCoarseValues(coarseValues.size());
+        SDFValueProcessor::quantize(coarseValues.data(), coarseValues.size(), normalizationFactor, quantizedCoarseValues.data());
+        coarseValues = {};
+
+        // Keep the quantized narrow band bricks. Bricks are numbered in file order, corners shared by several narrow band bricks take the value of the last one.
+        std::vector<uint32_t> fileBrickSlots(fileBrickGridSize, kNoSlot);
+        std::vector<int16_t> narrowBandValues;
+        narrowBandValues.reserve((size_t)file.getBrickCount() * fileValuesPerBrick);
+        file.readBricks([&](const uint3& brickCoord, const float* pValues)
+        {
+            const size_t offset = narrowBandValues.size();
+            fileBrickSlots[brickCoord.x + fileBrickGridWidth * (brickCoord.y + (size_t)fileBrickGridWidth * brickCoord.z)] = (uint32_t)(offset / fileValuesPerBrick);
+            narrowBandValues.resize(offset + fileValuesPerBrick);
+            SDFValueProcessor::quantize(pValues, fileValuesPerBrick, normalizationFactor, narrowBandValues.data() + offset);
+        });
+
+        // Get the first and last file brick along each axis that has a corner at grid coordinates c.
+        auto getFirstFileBrick = [&](const uint3& c) { return (glm::max(c, uint3(1)) - uint3(1)) / fileBrickWidth; };
+        auto getLastFileBrick = [&](const uint3& c) { return glm::min(c / fileBrickWidth, uint3(fileBrickGridWidth - 1)); };
+        auto getFileBrickIndex = [&](uint32_t x, uint32_t y, uint32_t z) { return x + fileBrickGridWidth * (y + (size_t)fileBrickGridWidth * z); };
+
+        // Get the value at a grid corner, the same value as readDenseValues() returns.
+        auto getValue = [&](const uint3& c) -> int16_t
+        {
+            const uint3 first = getFirstFileBrick(c);
+            const uint3 last = getLastFileBrick(c);
+
+            uint32_t slot = kNoSlot;
+            uint3 fileBrickCoords;
+            for (uint32_t z = first.z; z <= last.z; ++z)
+            {
+                for (uint32_t y = first.y; y <= last.y; ++y)
+                {
+                    for (uint32_t x = first.x; x <= last.x; ++x)
+                    {
+                        uint32_t candidate = fileBrickSlots[getFileBrickIndex(x, y, z)];
+                        if (candidate != kNoSlot && (slot == kNoSlot || candidate > slot))
+                        {
+                            slot = candidate;
+                            fileBrickCoords = uint3(x, y, z);
+                        }
+                    }
+                }
+            }
+
+            if (slot == kNoSlot) return quantizedCoarseValues[getFileBrickIndex(last.x, last.y, last.z)];
+
+            const uint3 localCoords = c - fileBrickCoords * fileBrickWidth;
+            return narrowBandValues[(size_t)slot * fileValuesPerBrick + localCoords.x + (fileBrickWidth + 1) * (localCoords.y + (fileBrickWidth + 1) * localCoords.z)];
+        };
+
+        // A brick that only has corners in file bricks outside the narrow band holds the coarse values of those bricks.
+        // It can only contain surface if the coarse values have different signs.
+        auto mayContainSurface = [&](const uint3& minCorner, const uint3& maxCorner)
+        {
+            const uint3 first = getFirstFileBrick(minCorner);
+            const uint3 last = getLastFileBrick(maxCorner);
+            for (uint32_t z = first.z; z <= last.z; ++z)
+            {
+                for (uint32_t y = first.y; y <= last.y; ++y)
+                {
+                    for (uint32_t x = first.x; x <= last.x; ++x)
+                    {
+                        if (fileBrickSlots[getFileBrickIndex(x, y, z)] != kNoSlot) return true;
+                    }
+                }
+            }
+
+            const uint3 firstCoarse = getLastFileBrick(minCorner);
+            bool anyNonPositive = false;
+            bool anyNonNegative = false;
+            for (uint32_t z = firstCoarse.z; z <= last.z; ++z)
+            {
+                for (uint32_t y = firstCoarse.y; y <= last.y; ++y)
+                {
+                    for (uint32_t x = firstCoarse.x; x <= last.x; ++x)
+                    {
+                        int16_t value = quantizedCoarseValues[getFileBrickIndex(x, y, z)];
+                        anyNonPositive |= value <= 0;
+                        anyNonNegative |= value >= 0;
+                    }
+                }
+            }
+            return anyNonPositive && anyNonNegative;
+        };
+
+        // Find the bricks that contain surface, one layer of bricks at a time. A brick contains surface if one of its voxels has corner values
+        // of both signs, see SDFVoxelCommon.containsSurface(). Like in SDFSBSAssignBrickValidityFromSDFieldPass, voxels outside the grid are ignored.
+        const uint32_t virtualBricksPerAxis = (uint32_t)std::ceil(float(mGridWidth) / mBrickWidth);
+        const uint32_t brickWidthInValues = mBrickWidth + 1;
+        const uint32_t valuesPerBrick = brickWidthInValues * brickWidthInValues * brickWidthInValues;
+
+        struct BrickLayer
+        {
+            std::vector<uint3> coords;
+            std::vector<int16_t> values;
+        };
+        std::vector<BrickLayer> layers(virtualBricksPerAxis);
+
+        Threading::parallelFor(0, virtualBricksPerAxis, [&](size_t brickZ)
+        {
+            BrickLayer& layer = layers[brickZ];
+            std::vector<int16_t> brickValues(valuesPerBrick);
+
+            for (uint32_t brickY = 0; brickY < virtualBricksPerAxis; ++brickY)
+            {
+                for (uint32_t brickX = 0; brickX < virtualBricksPerAxis; ++brickX)
+                {
+                    const uint3 virtualBrickCoords(brickX, brickY, (uint32_t)brickZ);
+                    const uint3 minCorner = virtualBrickCoords * mBrickWidth;
+                    const uint3 maxCorner = glm::min(minCorner + mBrickWidth, uint3(mGridWidth));
+                    if (!mayContainSurface(minCorner, maxCorner)) continue;
+
+                    // Corners outside the grid are not used, SDFSBSCreateBricksFromSDField writes a constant for them.
+                    for (uint32_t z = 0; z < brickWidthInValues; ++z)
+                    {
+                        for (uint32_t y = 0; y < brickWidthInValues; ++y)
+                        {
+                            for (uint32_t x = 0; x < brickWidthInValues; ++x)
+                            {
+                                brickValues[x + brickWidthInValues * (y + brickWidthInValues * z)] = getValue(glm::min(minCorner + uint3(x, y, z), maxCorner));
+                            }
+                        }
+                    }
+
+                    bool containsSurface = false;
+                    const uint3 voxelCount = maxCorner - minCorner;
+                    for (uint32_t z = 0; z < voxelCount.z && !containsSurface; ++z)
+                    {
+                        for (uint32_t y = 0; y < voxelCount.y && !containsSurface; ++y)
+                        {
+                            for (uint32_t x = 0; x < voxelCount.x && !containsSurface; ++x)
+                            {
+                                bool anyNonPositive = false;
+                                bool anyNonNegative = false;
+                                for (uint32_t i = 0; i < 8; ++i)
+                                {
+                                    int16_t value = brickValues[(x + (i & 1)) + brickWidthInValues * ((y + ((i >> 1) & 1)) + brickWidthInValues * (z + (i >> 2)))];
+                                    anyNonPositive |= value <= 0;
+                                    anyNonNegative |= value >= 0;
+                                }
+                                containsSurface = anyNonPositive && anyNonNegative;
+                            }
+                        }
+                    }
+
+                    if (containsSurface)
+                    {
+                        layer.coords.push_back(virtualBrickCoords);
+                        layer.values.insert(layer.values.end(), brickValues.begin(), brickValues.end());
+                    }
+                }
+            }
+        });
+
+        // Concatenate the layers, this sorts the bricks by virtual brick ID.
+        mLoadedBrickCoords.clear();
+        mLoadedBrickValues.clear();
+        for (const auto& layer : layers)
+        {
+            mLoadedBrickCoords.insert(mLoadedBrickCoords.end(), layer.coords.begin(), layer.coords.end());
+            mLoadedBrickValues.insert(mLoadedBrickValues.end(), layer.values.begin(), layer.values.end());
+        }
+    }
+
+    void SDFSBS::prepareSDFGridTexture(RenderContext* pRenderContext)
+    {
+        // The loaded bricks can't be combined with primitives, expand the brick file into an SD field texture the first time the grid is edited.
+        if (mBrickFilePath.empty() || mpSDFGridTexture) return;
+
+        auto pFile = SDFBrickFile::open(mBrickFilePath);
+        FALCOR_ASSERT(pFile->getDesc().gridWidth == mGridWidth);
+        setValuesInternal(pFile->readDenseValues());
+        createSDFGridTexture(pRenderContext, mSDField);
+        mSDField.clear();
     }
 
     void SDFSBS::createSDFGridTexture(RenderContext* pRenderContext, const std::vector<int16_t>& sdField)
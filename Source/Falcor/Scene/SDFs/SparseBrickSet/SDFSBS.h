@@ -70,6 +70,7 @@ namespace Falcor
 
     protected:
         void createResourcesFromSDField(RenderContext* pRenderContext, bool deleteScratchData);
+        void createResourcesFromLoadedBricks(RenderContext* pRenderContext, bool deleteScratchData);
         SDFGrid::UpdateFlags createResourcesFromPrimitivesAndSDField(RenderContext* pRenderContext, bool deleteScratchData);
 
         void expandSDFGridTexture(RenderContext* pRenderContext, bool deleteScratchData, uint32_t oldGridWidthInSDField, uint32_t gridWidthInSDField);
@@ -78,8 +79,11 @@ namespace Falcor
         void allocatePrimitiveBits();
 
         virtual void setValuesInternal(const std::vector<float>& cornerValues) override;
+        virtual void setValuesFromBrickFileInternal(SDFBrickFile& file) override;
+        virtual void prepareSDFGridTexture(RenderContext* pRenderContext) override;
 
         void createSDFGridTexture(RenderContext* pRenderContext, const std::vector<int16_t>& sdField);
+        void allocateBrickTexture();
 
         uint32_t calcMaxBrickCountPerAxis() const;
         uint32_t fetchCount(RenderContext* pRenderContext, const Buffer::SharedPtr& pBuffer);
@@ -91,6 +95,9 @@ namespace Falcor
 
         // CPU data.
         std::vector<int16_t> mSDField;
+        std::vector<uint3> mLoadedBrickCoords;          ///< Virtual brick coords of the bricks that contain surface, found when loading a brick file.
+        std::vector<int16_t> mLoadedBrickValues;        ///< Quantized corner values of the loaded bricks, (mBrickWidth + 1)^3 values per brick.
+        std::filesystem::path mBrickFilePath;           ///< The brick file the values were loaded from. Expanded into an SD field texture if the grid is edited.
 
         // Specs.
         uint32_t mDefaultGridWidth = 0;                 ///< The grid width used if the grid was not loaded from a file (it is empty).
@@ -122,6 +129,7 @@ namespace Falcor
         ComputePass::SharedPtr mpResetBrickValidityPass;
         ComputePass::SharedPtr mpCopyIndirectionBufferPass;
         ComputePass::SharedPtr mpCreateBricksFromSDFieldPass;
+        ComputePass::SharedPtr mpCreateBricksFromLoadedBricksPass;
 
         // Compute passes used to build the SBS from primitives.
         ComputePass::SharedPtr mpCreateRootChunksFromPrimitives;
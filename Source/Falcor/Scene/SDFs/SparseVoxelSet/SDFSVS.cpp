@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "SDFSVS.h"
+#include "Scene/SDFs/SDFValueProcessor.h"
 #include "Core/API/Device.h"
 #include "Core/API/RenderContext.h"
 #include "Utils/Math/MathHelpers.h"
@@ -179,12 +180,6 @@ namespace Falcor
         mValues.resize(valueCount);
 
         float normalizationMultipler = 2.0f * mGridWidth / glm::root_three<float>();
-        for (uint32_t v = 0; v < valueCount; v++)
-        {
-            float normalizedValue = glm::clamp(cornerValues[v] * normalizationMultipler, -1.0f, 1.0f);
-
-            float integerScale = normalizedValue * float(INT8_MAX);
-            mValues[v] = integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
-        }
+        SDFValueProcessor::quantize(cornerValues.data(), valueCount, normalizationMultipler, mValues.data());
     }
 }
@@ -135,6 +135,7 @@ namespace Falcor
     {
         // Copy/move scene data to member variables.
         mPath = sceneData.path;
+        mSceneCacheKey = sceneData.sceneCacheKey;
         mRenderSettings = sceneData.renderSettings;
         mCameras = std::move(sceneData.cameras);
         mSelectedCamera = sceneData.selectedCamera;
@@ -224,7 +225,7 @@ namespace Falcor
         }
 
         // Must be placed after curve data/AABB creation.
-        mpAnimationController->addAnimatedVertexCaches(std::move(sceneData.cachedCurves), std::move(sceneData.cachedMeshes), sceneData.meshStaticData);
+        mpAnimationController->addAnimatedVertexCaches(std::move(sceneData.cachedCurves), std::move(sceneData.cachedMeshes), sceneData.meshStaticData, sceneData.vertexCacheStreamingWindow);
 
         // Finalize scene.
         finalize();
@@ -1526,6 +1527,19 @@ namespace Falcor
                 mGrids[i]->setShaderData(var[i]);
             }
         }
+        else if (is_set(combinedUpdates, GridVolume::UpdateFlags::GridResourcesChanged))
+        {
+            // Streamed grid sequences recreate the resources of their ring grids when loading new frames. Rebind the grids of those volumes only.
+            auto var = mpSceneBlock["grids"];
+            for (const auto& pGridVolume : mGridVolumes)
+            {
+                if (!is_set(pGridVolume->getUpdates(), GridVolume::UpdateFlags::GridResourcesChanged)) continue;
+                for (const auto& pGrid : pGridVolume->getAllGrids())
+                {
+                    if (auto it = mGridIDs.find(pGrid); it != mGridIDs.end()) pGrid->setShaderData(var[it->second.get()]);
+                }
+            }
+        }
 
         // Upload volumes and clear updates.
         uint32_t volumeIndex = 0;
@@ -2006,6 +2020,7 @@ namespace Falcor
                 << "  Material count (opaque): " << s.materials.materialOpaqueCount << std::endl
                 << "  Material count (non-opaque): " << (s.materials.materialCount - s.materials.materialOpaqueCount) << std::endl
                 << "  Material memory: " << formatByteSize(s.materials.materialMemoryInBytes) << std::endl
+                << "  Material hash collisions: " << s.materials.materialHashCollisionCount << std::endl
                 << "  Texture count (total): " << s.materials.textureCount << std::endl
                 << "  Texture count (compressed): " << s.materials.textureCompressedCount << std::endl
                 << "  Texture texel count: " << s.materials.textureTexelCount << std::endl
@@ -3929,6 +3944,7 @@ namespace Falcor
         d["materialCount"] = materials.materialCount;
         d["materialOpaqueCount"] = materials.materialOpaqueCount;
         d["materialMemoryInBytes"] = materials.materialMemoryInBytes;
+        d["materialHashCollisionCount"] = materials.materialHashCollisionCount;
         d["textureCount"] = materials.textureCount;
         d["textureCompressedCount"] = materials.textureCompressedCount;
         d["textureTexelCount"] = materials.textureTexelCount;
@@ -46,6 +46,7 @@
 #include "Core/Macros.h"
 #include "Core/API/VAO.h"
 #include "Core/API/RtAccelerationStructure.h"
+#include "Utils/CryptoUtils.h"
 #include "Utils/Math/AABB.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/Math/Matrix.h"
@@ -305,6 +306,7 @@ namespace Falcor
         struct SceneData
         {
             std::filesystem::path path;                             ///< Path of the asset file the scene was loaded from.
+            std::optional<SHA1::MD> sceneCacheKey;                  ///< Key of the scene cache the scene was loaded from or written to. Not stored in the scene cache.
             RenderSettings renderSettings;                          ///< Render settings.
             std::vector<Camera::SharedPtr> cameras;                 ///< List of cameras.
             uint32_t selectedCamera = 0;                            ///< Index of selected camera.
@@ -327,6 +329,7 @@ namespace Falcor
             std::vector<std::vector<uint32_t>> meshIdToInstanceIds; ///< Mapping of what instances belong to which mesh.
             std::vector<MeshGroup> meshGroups;                      ///< List of mesh groups. Each group maps to a BLAS for ray tracing.
             std::vector<CachedMesh> cachedMeshes;                   ///< Cached data for vertex-animated meshes.
+            uint32_t vertexCacheStreamingWindow = 0;                ///< Number of keyframes kept resident per vertex cache when streaming from disk. Zero keeps all keyframes resident. Not stored in the scene cache.
             uint32_t prevVertexCount = 0;                           ///< Number of vertices that the AnimationController needs to allocate to store previous frame vertices.
 
             bool useCompressedHitInfo = false;                      ///< True if scene should used compressed HitInfo (on scenes with triangles meshes only).
@@ -1017,6 +1020,10 @@ namespace Falcor
         */
         const std::filesystem::path& getPath() const { return mPath; }
 
+        /** Get the key of the scene cache the scene was loaded from or written to, if any.
+        */
+        const std::optional<SHA1::MD>& getSceneCacheKey() const { return mSceneCacheKey; }
+
         /** Get the animation controller.
         */
         const AnimationController* getAnimationController() const { return mpAnimationController.get(); }
@@ -1416,6 +1423,7 @@ namespace Falcor
         bool mRebuildBlas = true;                           ///< Flag to indicate BLASes need to be rebuilt.
 
         std::filesystem::path mPath;
+        std::optional<SHA1::MD> mSceneCacheKey;             ///< Key of the scene cache the scene was loaded from or written to.
         bool mFinalized = false;                            ///< True if scene is ready to be bound to the GPU.
     };
 
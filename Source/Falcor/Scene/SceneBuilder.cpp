@@ -36,9 +36,13 @@
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Math/MathHelpers.h"
+#include "Utils/Threading.h"
+#include "Utils/Math/FNVHash.h"
 #include <mikktspace.h>
 #include <filesystem>
 #include <cmath>
+#include <cstring>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -48,6 +52,22 @@ namespace Falcor
         // The target is max 16M triangles per BLAS (= approx 0.5GB post-compaction). Note that this is not a strict limit.
         const size_t kMaxTrianglesPerBLAS = 1ull << 24;
 
+        // Default quantization step used for the vertex attributes when welding vertices.
+        // This can be overridden with the 'SceneBuilder:vertexWeldEpsilon' option.
+        const float kDefaultVertexWeldEpsilon = 1e-6f;
+
+        // Compute a hash of the contents of each scene cache dependency.
+        // This can be enabled with the 'SceneBuilder:cacheDependencyContentHash' option to reuse caches when files are touched but not changed.
+        const bool kDefaultCacheDependencyContentHash = false;
+
+        // Write the scene cache in the uncompressed memory mapped format.
+        // This can be enabled with the 'SceneBuilder:mappedSceneCache' option to reduce load times at the cost of disk space.
+        const bool kDefaultMappedSceneCache = false;
+
+        // Number of keyframes of vertex-animated meshes and curves kept resident, the rest is streamed from disk.
+        // This can be enabled with the 'SceneBuilder:vertexCacheStreamingWindow' option to reduce memory usage of long vertex caches.
+        const uint32_t kDefaultVertexCacheStreamingWindow = 0;
+
         // Texture coordinates for textured emissive materials are quantized for performance reasons.
         // We'll log a warning if the maximum quantization error exceeds this value.
         const float kMaxTexelError = 0.5f;
@@ -175,6 +195,48 @@ namespace Falcor
             return true;
         }
 
+        /** Quantized vertex used as key for welding vertices.
+            All floating-point attributes are quantized to integer multiples of the weld epsilon.
+        */
+        struct VertexWeldKey
+        {
+            int64_t position[3];
+            int64_t normal[3];
+            int64_t tangent[4];
+            int64_t texCrd[2];
+            int64_t curveRadius;
+            int64_t boneWeights[4];
+            uint32_t boneIDs[4];
+
+            VertexWeldKey(const SceneBuilder::Mesh::Vertex& v, float epsilon)
+            {
+                const double scale = 1.0 / epsilon;
+                auto quantize = [scale](float x) { return (int64_t)std::llround((double)x * scale); };
+                for (int i = 0; i < 3; ++i) position[i] = quantize(v.position[i]);
+                for (int i = 0; i < 3; ++i) normal[i] = quantize(v.normal[i]);
+                for (int i = 0; i < 4; ++i) tangent[i] = quantize(v.tangent[i]);
+                for (int i = 0; i < 2; ++i) texCrd[i] = quantize(v.texCrd[i]);
+                curveRadius = quantize(v.curveRadius);
+                for (int i = 0; i < 4; ++i) boneWeights[i] = quantize(v.boneWeights[i]);
+                for (int i = 0; i < 4; ++i) boneIDs[i] = v.boneIDs[i];
+            }
+
+            bool operator==(const VertexWeldKey& other) const
+            {
+                return std::memcmp(this, &other, sizeof(VertexWeldKey)) == 0;
+            }
+        };
+
+        static_assert(std::has_unique_object_representations_v<VertexWeldKey>, "VertexWeldKey must not have padding");
+
+        struct VertexWeldKeyHash
+        {
+            size_t operator()(const VertexWeldKey& key) const
+            {
+                return fnvHashArray64(&key, sizeof(key));
+            }
+        };
+
         std::vector<uint32_t> compact16BitIndices(const std::vector<uint32_t>& indices)
         {
             if (indices.empty()) return {};
@@ -237,7 +299,10 @@ namespace Falcor
         {
             try
             {
-                pBuilder->mpScene = Scene::create(SceneCache::readCache(pBuilder->mSceneCacheKey));
+                Scene::SceneData sceneData = SceneCache::readCache(pBuilder->mSceneCacheKey);
+                sceneData.vertexCacheStreamingWindow = settings.getOption("SceneBuilder:vertexCacheStreamingWindow", kDefaultVertexCacheStreamingWindow);
+                sceneData.sceneCacheKey = pBuilder->mSceneCacheKey;
+                pBuilder->mpScene = Scene::create(std::move(sceneData));
                 return pBuilder;
             }
             catch (const std::exception& e)
@@ -253,9 +318,36 @@ namespace Falcor
     void SceneBuilder::import(const std::filesystem::path& path, const Dictionary& dict)
     {
         mSceneData.path = path;
+        addCacheDependency(path);
         Importer::import(path, *this, dict);
     }
 
+    void SceneBuilder::addCacheDependency(const std::filesystem::path& path)
+    {
+        if (!mWriteSceneCache) return;
+
+        std::filesystem::path fullPath = path;
+        if (!std::filesystem::exists(fullPath) && !findFileInDataDirectories(path, fullPath))
+        {
+            logWarning("Scene cache dependency '{}' not found.", path);
+            return;
+        }
+        fullPath = std::filesystem::absolute(fullPath).lexically_normal();
+
+        {
+            std::lock_guard<std::mutex> lock(mCacheDependencyMutex);
+            if (!mCacheDependencyPaths.insert(fullPath).second) return;
+        }
+
+        // Compute the dependency outside the lock as hashing large files can take a while.
+        const bool computeContentHash = mSettings.getOption("SceneBuilder:cacheDependencyContentHash", kDefaultCacheDependencyContentHash);
+        if (auto dependency = SceneCache::Dependency::create(fullPath, computeContentHash))
+        {
+            std::lock_guard<std::mutex> lock(mCacheDependencyMutex);
+            mCacheDependencies.push_back(std::move(*dependency));
+        }
+    }
+
     Scene::SharedPtr SceneBuilder::getScene()
     {
         if (mpScene) return mpScene;
@@ -277,6 +369,12 @@ namespace Falcor
             addMeshInstance(nodeID, meshID);
         }
 
+        if (is_set(mFlags, Flags::WeldVertices) && mWeldOutputVertexCount > 0)
+        {
+            logInfo("Vertex welding reduced the vertex count from {} to {} (reduction ratio {:.2f}).",
+                mWeldInputVertexCount, mWeldOutputVertexCount, (double)mWeldInputVertexCount / mWeldOutputVertexCount);
+        }
+
         // Post-process the scene data.
         TimeReport timeReport;
 
@@ -323,11 +421,16 @@ namespace Falcor
         for (auto& sdfInstanceData : mSceneData.sdfGridInstances) sdfInstanceData.instanceIndex = tlasInstanceIndex++;
 
         mSceneData.useCompressedHitInfo = is_set(mFlags, Flags::UseCompressedHitInfo);
+        mSceneData.vertexCacheStreamingWindow = mSettings.getOption("SceneBuilder:vertexCacheStreamingWindow", kDefaultVertexCacheStreamingWindow);
 
         // Write scene cache if requested.
         if (mWriteSceneCache)
         {
-            SceneCache::writeCache(mSceneData, mSceneCacheKey);
+            // Sort dependencies to get a deterministic cache file independent of the import order.
+            std::sort(mCacheDependencies.begin(), mCacheDependencies.end(), [](const auto& a, const auto& b) { return a.path < b.path; });
+            const bool mappedSceneCache = mSettings.getOption("SceneBuilder:mappedSceneCache", kDefaultMappedSceneCache);
+            SceneCache::writeCache(mSceneData, mSceneCacheKey, mCacheDependencies, mappedSceneCache ? SceneCache::Format::Mapped : SceneCache::Format::Compressed);
+            mSceneData.sceneCacheKey = mSceneCacheKey;
             timeReport.measure("Writing cache");
         }
 
@@ -348,7 +451,48 @@ namespace Falcor
         return addProcessedMesh(processMesh(mesh));
     }
 
+    std::vector<MeshID> SceneBuilder::addMeshes(fstd::span<const Mesh> meshes)
+    {
+        // Pre-process the meshes in parallel. This is thread safe as processMesh() does not modify the builder.
+        std::vector<ProcessedMesh> processedMeshes(meshes.size());
+        Threading::parallelFor(0, meshes.size(), [&](size_t i) { processedMeshes[i] = processMesh(meshes[i]); }, 1);
+
+        // Add the processed meshes sequentially to ensure a deterministic ordering.
+        std::vector<MeshID> meshIDs;
+        meshIDs.reserve(processedMeshes.size());
+        for (auto& processedMesh : processedMeshes)
+        {
+            meshIDs.push_back(addProcessedMesh(processedMesh));
+            processedMesh = {};
+        }
+        return meshIDs;
+    }
+
     MeshID SceneBuilder::addTriangleMesh(const TriangleMesh::SharedPtr& pTriangleMesh, const Material::SharedPtr& pMaterial)
+    {
+        return addProcessedMesh(processTriangleMesh(pTriangleMesh, pMaterial));
+    }
+
+    std::vector<MeshID> SceneBuilder::addTriangleMeshes(fstd::span<const TriangleMesh::SharedPtr> triangleMeshes, fstd::span<const Material::SharedPtr> materials)
+    {
+        checkArgument(triangleMeshes.size() == materials.size(), "'triangleMeshes' and 'materials' must have the same size");
+
+        // Pre-process the meshes in parallel.
+        std::vector<ProcessedMesh> processedMeshes(triangleMeshes.size());
+        Threading::parallelFor(0, triangleMeshes.size(), [&](size_t i) { processedMeshes[i] = processTriangleMesh(triangleMeshes[i], materials[i]); }, 1);
+
+        // Add the processed meshes sequentially to ensure a deterministic ordering.
+        std::vector<MeshID> meshIDs;
+        meshIDs.reserve(processedMeshes.size());
+        for (auto& processedMesh : processedMeshes)
+        {
+            meshIDs.push_back(addProcessedMesh(processedMesh));
+            processedMesh = {};
+        }
+        return meshIDs;
+    }
+
+    SceneBuilder::ProcessedMesh SceneBuilder::processTriangleMesh(const TriangleMesh::SharedPtr& pTriangleMesh, const Material::SharedPtr& pMaterial) const
     {
         checkArgument(pTriangleMesh != nullptr, "'pTriangleMesh' is missing");
         checkArgument(pMaterial != nullptr, "'pMaterial' is missing");
@@ -378,7 +522,7 @@ namespace Falcor
         mesh.normals = { normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
         mesh.texCrds = { texCoords.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
 
-        return addMesh(mesh);
+        return processMesh(mesh);
     }
 
     SceneBuilder::ProcessedMesh SceneBuilder::processMesh(const Mesh& mesh_, MeshAttributeIndices* pAttributeIndices) const
@@ -396,6 +540,7 @@ namespace Falcor
         ProcessedMesh processedMesh;
 
         processedMesh.name = mesh.name;
+        processedMesh.inputVertexCount = mesh.vertexCount;
         processedMesh.topology = mesh.topology;
         processedMesh.pMaterial = mesh.pMaterial;
         processedMesh.isFrontFaceCW = mesh.isFrontFaceCW;
@@ -481,7 +626,49 @@ namespace Falcor
             pAttributeIndices->reserve(mesh.vertexCount);
         }
 
-        if (mesh.mergeDuplicateVertices)
+        // Welding merges vertices with different original indices, so each output vertex can't be mapped back to a single
+        // set of attribute indices. Callers asking for them (e.g. to remap vertex animation keyframes) use the merge below.
+        const bool weldVertices = mesh.mergeDuplicateVertices && is_set(mFlags, Flags::WeldVertices) && pAttributeIndices == nullptr;
+
+        if (weldVertices)
+        {
+            // Merge vertices across the whole mesh using a hash table keyed on the quantized vertex attributes.
+            // Unlike the linked-list search below, this also finds duplicates that do not share the same original index.
+            const float epsilon = mSettings.getOption("SceneBuilder:vertexWeldEpsilon", kDefaultVertexWeldEpsilon);
+            if (!(epsilon > 0.f)) throw RuntimeError("Error when adding the mesh '{}' to the scene. Vertex weld epsilon must be positive.", mesh.name);
+
+            vertices.reserve(mesh.vertexCount);
+
+            std::unordered_map<VertexWeldKey, uint32_t, VertexWeldKeyHash> vertexMap;
+            vertexMap.reserve(mesh.vertexCount);
+
+            for (uint32_t face = 0; face < mesh.faceCount; face++)
+            {
+                for (uint32_t vert = 0; vert < 3; vert++)
+                {
+                    const Mesh::Vertex v = mesh.getVertex(face, vert);
+
+                    FALCOR_ASSERT(vertices.size() < std::numeric_limits<uint32_t>::max());
+                    auto [it, inserted] = vertexMap.try_emplace(VertexWeldKey(v, epsilon), (uint32_t)vertices.size());
+
+                    // Insert new vertex if we couldn't find it. The first vertex in each cell is used as representative.
+                    if (inserted)
+                    {
+                        vertices.push_back({ v, invalidIndex });
+
+                        if (pAttributeIndices)
+                        {
+                            pAttributeIndices->push_back(mesh.getAttributeIndices(face, vert));
+                            FALCOR_ASSERT(vertices.size() == pAttributeIndices->size());
+                        }
+                    }
+
+                    // Store new vertex index.
+                    indices[face * 3 + vert] = it->second;
+                }
+            }
+        }
+        else if (mesh.mergeDuplicateVertices)
         {
             vertices.reserve(mesh.vertexCount);
 
@@ -563,7 +750,8 @@ namespace Falcor
         FALCOR_ASSERT(indices.size() == mesh.indexCount);
         if (vertices.size() != mesh.vertexCount)
         {
-            logDebug("Mesh with name '{}' had original vertex count {}, new vertex count {}.", mesh.name, mesh.vertexCount, vertices.size());
+            logDebug("Mesh with name '{}' had original vertex count {}, new vertex count {} (reduction ratio {:.2f}).",
+                mesh.name, mesh.vertexCount, vertices.size(), (double)mesh.vertexCount / vertices.size());
         }
 
         // Validate vertex data to check for invalid numbers and missing tangent frame.
@@ -652,6 +840,12 @@ namespace Falcor
         spec.isFrontFaceCW = mesh.isFrontFaceCW;
         spec.skeletonNodeID = mesh.skeletonNodeId;
 
+        if (is_set(mFlags, Flags::WeldVertices))
+        {
+            mWeldInputVertexCount += mesh.inputVertexCount;
+            mWeldOutputVertexCount += mesh.staticData.size();
+        }
+
         spec.vertexCount = (uint32_t)mesh.staticData.size();
         spec.staticVertexCount = (uint32_t)mesh.staticData.size();
         spec.skinningVertexCount = (uint32_t)mesh.skinningData.size();
@@ -803,6 +997,7 @@ namespace Falcor
         desc.materialID = addMaterial(pMaterial);
         desc.sdfGridID = SdfGridID(mSceneData.sdfGrids.size());
         mSceneData.sdfGrids.push_back(pSDFGrid);
+        if (!pSDFGrid->getSourcePath().empty()) addCacheDependency(pSDFGrid->getSourcePath());
 
         mSceneData.sdfGridDesc.push_back(desc);
         mSceneData.sdfGridMaxLODCount = glm::max(bitScanReverse(pSDFGrid->getGridWidth()) + 1, mSceneData.sdfGridMaxLODCount);
@@ -827,6 +1022,7 @@ namespace Falcor
     void SceneBuilder::loadMaterialTexture(const Material::SharedPtr& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path)
     {
         checkArgument(pMaterial != nullptr, "'pMaterial' is missing");
+        addCacheDependency(path);
         if (!mpMaterialTextureLoader)
         {
             mpMaterialTextureLoader.reset(new MaterialTextureLoader(mSceneData.pMaterials->getTextureManager(), !is_set(mFlags, Flags::AssumeLinearSpaceTextures)));
@@ -861,11 +1057,30 @@ namespace Falcor
             pGridVolume->setNodeID(nodeID);
         }
 
+        for (const auto& pGrid : pGridVolume->getAllGrids())
+        {
+            if (!pGrid->getSourcePath().empty()) addCacheDependency(pGrid->getSourcePath());
+        }
+        for (uint32_t slot = 0; slot < (uint32_t)GridVolume::GridSlot::Count; ++slot)
+        {
+            const auto& pStreamer = pGridVolume->getGridSequenceStreamer((GridVolume::GridSlot)slot);
+            if (!pStreamer) continue;
+            for (const auto& path : pStreamer->getPaths()) addCacheDependency(path);
+        }
+
         mSceneData.gridVolumes.push_back(pGridVolume);
         FALCOR_ASSERT(mSceneData.gridVolumes.size() <= std::numeric_limits<uint32_t>::max());
         return VolumeID{ mSceneData.gridVolumes.size() - 1 };
     }
 
+    // Environment map
+
+    void SceneBuilder::setEnvMap(EnvMap::SharedPtr pEnvMap)
+    {
+        if (pEnvMap && !pEnvMap->getPath().empty()) addCacheDependency(pEnvMap->getPath());
+        mSceneData.pEnvMap = pEnvMap;
+    }
+
     // Lights
 
     Light::SharedPtr SceneBuilder::getLight(const std::string& name) const
@@ -2824,6 +3039,7 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("WeldVertices", SceneBuilder::Flags::WeldVertices);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
         ScriptBindings::addEnumBinaryOperators(flags);
@@ -2849,6 +3065,7 @@ namespace Falcor
         sceneBuilder.def("replaceMaterial", &SceneBuilder::replaceMaterial, "material"_a, "replacement"_a);
         sceneBuilder.def("getMaterial", &SceneBuilder::getMaterial, "name"_a);
         sceneBuilder.def("loadMaterialTexture", &SceneBuilder::loadMaterialTexture, "material"_a, "slot"_a, "path"_a);
+        sceneBuilder.def("addCacheDependency", &SceneBuilder::addCacheDependency, "path"_a);
         sceneBuilder.def("waitForMaterialTextureLoading", &SceneBuilder::waitForMaterialTextureLoading);
         sceneBuilder.def("addGridVolume", &SceneBuilder::addGridVolume, "gridVolume"_a, "nodeID"_a = NodeID::kInvalidID);
         sceneBuilder.def("addVolume", &SceneBuilder::addGridVolume, "gridVolume"_a, "nodeID"_a = NodeID::kInvalidID); // PYTHONDEPRECATED
@@ -43,8 +43,12 @@
 #include "Utils/Scripting/Dictionary.h"
 #include "Utils/Settings.h"
 
+#include <fstd/span.h> // TODO C++20: Replace with <span>
+
 #include <filesystem>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -77,6 +81,7 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            WeldVertices                    = 0x20000,  ///< Merge duplicate vertices across the whole mesh using a hash table with quantized keys, instead of only among vertices sharing the same original index. Use this option for non-indexed or per-corner indexed input data. Not applied to meshes whose attribute indices are requested from processMesh(), e.g. meshes with vertex animation keyframes.
 
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
@@ -270,6 +275,7 @@ namespace Falcor
             Material::SharedPtr pMaterial;
             NodeID skeletonNodeId{ NodeID::Invalid() }; ///< Forwarded from Mesh struct.
 
+            uint32_t inputVertexCount = 0;      ///< Number of vertices in the input mesh before merging duplicate vertices.
             uint64_t indexCount = 0;            ///< Number of indices, or zero if non-indexed.
             bool use16BitIndices = false;       ///< True if the indices are in 16-bit format.
             bool isFrontFaceCW = false;         ///< Indicate whether front-facing side has clockwise winding in object space.
@@ -340,6 +346,13 @@ namespace Falcor
         */
         void import(const std::filesystem::path& path, const Dictionary& dict = Dictionary());
 
+        /** Add an input file the scene depends on.
+            The file is recorded in the scene cache and the cache is rebuilt if the file changes.
+            Importers should call this for every file they read. This function is thread safe.
+            \param path The file path. This can be a full path or a relative path from a data directory.
+        */
+        void addCacheDependency(const std::filesystem::path& path);
+
         /** Get the scene. Make sure to add all the objects before calling this function
             \return nullptr if something went wrong, otherwise a new Scene object
         */
@@ -384,6 +397,15 @@ namespace Falcor
         */
         MeshID addMesh(const Mesh& mesh);
 
+        /** Add a batch of meshes.
+            The meshes are pre-processed in parallel on the global thread pool and then added in submission order.
+            The assigned mesh IDs are therefore identical to calling addMesh() on each mesh in turn.
+            Throws an exception if something went wrong.
+            \param meshes The meshes to add.
+            \return The IDs of the meshes in the scene, in the same order as the input.
+        */
+        std::vector<MeshID> addMeshes(fstd::span<const Mesh> meshes);
+
         /** Add a triangle mesh.
             \param The triangle mesh to add.
             \param pMaterial The material to use for the mesh.
@@ -391,14 +413,31 @@ namespace Falcor
         */
         MeshID addTriangleMesh(const TriangleMesh::SharedPtr& pTriangleMesh, const Material::SharedPtr& pMaterial);
 
+        /** Add a batch of triangle meshes.
+            The meshes are pre-processed in parallel and added in submission order (see addMeshes()).
+            \param triangleMeshes The triangle meshes to add.
+            \param materials The materials to use for the meshes. Must have the same size as triangleMeshes.
+            \return The IDs of the meshes in the scene, in the same order as the input.
+        */
+        std::vector<MeshID> addTriangleMeshes(fstd::span<const TriangleMesh::SharedPtr> triangleMeshes, fstd::span<const Material::SharedPtr> materials);
+
         /** Pre-process a mesh into the data format that is used in the global scene buffers.
             Throws an exception if something went wrong.
             \param mesh The mesh to pre-process.
             \param pAttributeIndices Optional. If specified, the attribute indices used to create the final mesh vertices will be saved here.
+                Flags::WeldVertices is ignored in this case, as welded vertices can have different attribute indices.
             \return The pre-processed mesh.
         */
         ProcessedMesh processMesh(const Mesh& mesh, MeshAttributeIndices* pAttributeIndices = nullptr) const;
 
+        /** Pre-process a triangle mesh into the data format that is used in the global scene buffers.
+            Throws an exception if something went wrong.
+            \param pTriangleMesh The triangle mesh to pre-process.
+            \param pMaterial The material to use for the mesh.
+            \return The pre-processed mesh.
+        */
+        ProcessedMesh processTriangleMesh(const TriangleMesh::SharedPtr& pTriangleMesh, const Material::SharedPtr& pMaterial) const;
+
         /** Generate tangents for a mesh.
             \param mesh The mesh to generate tangents for. If successful, the tangent attribute on the mesh will be set to the output vector.
             \param tangents Output for generated tangents.
@@ -454,6 +493,7 @@ namespace Falcor
         // SDFs
 
         /** Add an SDF grid.
+            The file the grid was loaded from is added as a scene cache dependency.
             \param pSDFGrid The SDF grid.
             \param pMaterial The material to be used by this SDF grid.
             \return The ID of the SDG grid desc in the scene.
@@ -510,6 +550,7 @@ namespace Falcor
         GridVolume::SharedPtr getGridVolume(const std::string& name) const;
 
         /** Add a grid volume.
+            The grid files of the volume, including streamed sequences, are added as scene cache dependencies.
             \param pGridVolume The grid volume.
             \param nodeID The node to attach the volume to (optional).
             \return The ID of the volume in the scene.
@@ -546,9 +587,10 @@ namespace Falcor
         const EnvMap::SharedPtr& getEnvMap() const { return mSceneData.pEnvMap; }
 
         /** Set the environment map.
+            The environment map texture file is added as a scene cache dependency.
             \param[in] pEnvMap Environment map. Can be nullptr.
         */
-        void setEnvMap(EnvMap::SharedPtr pEnvMap) { mSceneData.pEnvMap = pEnvMap; }
+        void setEnvMap(EnvMap::SharedPtr pEnvMap);
 
         // Cameras
 
@@ -734,6 +776,12 @@ namespace Falcor
         Scene::SharedPtr mpScene;
         SceneCache::Key mSceneCacheKey;
         bool mWriteSceneCache = false;  ///< True if scene cache should be written after import.
+        SceneCache::DependencyList mCacheDependencies;      ///< List of input files recorded in the scene cache.
+        std::set<std::filesystem::path> mCacheDependencyPaths;
+        std::mutex mCacheDependencyMutex;
+
+        uint64_t mWeldInputVertexCount = 0;     ///< Total number of input vertices of meshes processed with vertex welding.
+        uint64_t mWeldOutputVertexCount = 0;    ///< Total number of output vertices of meshes processed with vertex welding.
 
         SceneGraph mSceneGraph;
 
@@ -30,9 +30,11 @@
 #include "Material/HairMaterial.h"
 #include "Material/ClothMaterial.h"
 #include "Material/MaterialTextureLoader.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 
-#include <lz4_stream/lz4_stream.h>
+#include <lz4frame.h>
 
 #include <sstream>
 #include <fstream>
@@ -44,7 +46,7 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 29;
 
         /** Scene cache directory (subdirectory in the application data directory).
         */
@@ -52,15 +54,141 @@ namespace Falcor
 
         const size_t kBlockSize = 1 * 1024 * 1024;
 
+        /** Maximum number of dependencies stored in a cache file (used for validating the header).
+        */
+        const uint32_t kMaxDependencyCount = 1u << 24;
+
+        /** Maximum number of sections stored in a mapped cache file (used for validating the section table).
+        */
+        const uint32_t kMaxSectionCount = 1u << 24;
+
+        /** Alignment of sections in a mapped cache file. Sections are page aligned so they can be mapped individually.
+        */
+        const uint64_t kSectionAlignment = 4096;
+
+        /** Minimum size of a blob to be stored in separate sections.
+            Smaller blobs are stored inline in the main section.
+        */
+        const uint64_t kMinSectionSize = 64 * 1024;
+
+        /** Maximum uncompressed size of a section in a compressed cache file.
+            Large blobs are split into multiple sections which are compressed and decompressed in parallel.
+        */
+        const uint64_t kMaxCompressedSectionSize = 4 * 1024 * 1024;
+
         const char* kMagic = "FalcorS$";
         struct Header
         {
             uint8_t magic[8]{};
             uint32_t version{};
+            SceneCache::Format format{};
+
+            bool isValid() const
+            {
+                return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion &&
+                    (format == SceneCache::Format::Compressed || format == SceneCache::Format::Mapped);
+            }
+        };
+
+        /** Light collection data is stored in a separate file next to the scene cache file.
+            The file consists of a header followed by the data compressed as a single LZ4 frame.
+        */
+        const char* kLightCollectionMagic = "FalcorL$";
+        const uint32_t kLightCollectionVersion = 1;
+        const char kLightCollectionExtension[] = ".lights";
+
+        struct LightCollectionHeader
+        {
+            uint8_t magic[8]{};
+            uint32_t version{};
+            uint32_t reserved{};
+            uint64_t rawSize{};     ///< Size of the uncompressed data in bytes.
 
             bool isValid() const
             {
-                return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion;
+                return std::memcmp(magic, kLightCollectionMagic, sizeof(LightCollectionHeader::magic)) == 0 && version == kLightCollectionVersion;
+            }
+        };
+
+        /** Section table entry.
+        */
+        struct SectionDesc
+        {
+            uint64_t offset = 0;    ///< Offset from the beginning of the file in bytes.
+            uint64_t size = 0;      ///< Size of the stored (possibly compressed) data in bytes.
+            uint64_t rawSize = 0;   ///< Size of the uncompressed data in bytes.
+        };
+
+        /** Reference to the data of a section in memory.
+        */
+        struct SectionData
+        {
+            const void* pData = nullptr;
+            uint64_t size = 0;      ///< Size of the stored data in bytes.
+            uint64_t rawSize = 0;   ///< Size of the uncompressed data in bytes.
+            bool compressed = false;
+        };
+
+        /** Compress a section into a single LZ4 frame.
+        */
+        std::vector<uint8_t> compressSection(const SectionData& section)
+        {
+            LZ4F_preferences_t prefs = {};
+            prefs.frameInfo.contentSize = section.rawSize;
+            prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+
+            std::vector<uint8_t> compressed(LZ4F_compressFrameBound(section.rawSize, &prefs));
+            size_t size = LZ4F_compressFrame(compressed.data(), compressed.size(), section.pData, section.rawSize, &prefs);
+            if (LZ4F_isError(size)) throw RuntimeError("Failed to compress scene cache section: {}", LZ4F_getErrorName(size));
+            compressed.resize(size);
+            return compressed;
+        }
+
+        /** Decompress a section. The destination needs to hold section.rawSize bytes.
+        */
+        void decompressSection(const SectionData& section, void* pDst)
+        {
+            if (!section.compressed)
+            {
+                FALCOR_ASSERT(section.size == section.rawSize);
+                std::memcpy(pDst, section.pData, section.size);
+                return;
+            }
+
+            LZ4F_dctx* pContext = nullptr;
+            if (LZ4F_isError(LZ4F_createDecompressionContext(&pContext, LZ4F_VERSION))) throw RuntimeError("Failed to create LZ4 decompression context.");
+
+            const uint8_t* pSrc = static_cast<const uint8_t*>(section.pData);
+            uint8_t* pOut = static_cast<uint8_t*>(pDst);
+            size_t srcLeft = section.size;
+            size_t dstLeft = section.rawSize;
+            size_t result = 1;
+            while (result != 0 && srcLeft > 0)
+            {
+                size_t srcSize = srcLeft;
+                size_t dstSize = dstLeft;
+                result = LZ4F_decompress(pContext, pOut, &dstSize, pSrc, &srcSize, nullptr);
+                if (LZ4F_isError(result)) break;
+                pSrc += srcSize;
+                srcLeft -= srcSize;
+                pOut += dstSize;
+                dstLeft -= dstSize;
+            }
+            LZ4F_freeDecompressionContext(pContext);
+
+            if (LZ4F_isError(result)) throw RuntimeError("Failed to decompress scene cache section: {}", LZ4F_getErrorName(result));
+            if (result != 0 || dstLeft != 0) throw RuntimeError("Truncated section in scene cache.");
+        }
+
+        /** Read-only stream buffer over a block of memory.
+        */
+        class MemoryStreamBuffer : public std::streambuf
+        {
+        public:
+            MemoryStreamBuffer(const void* pData, size_t size)
+            {
+                char* pBegin = const_cast<char*>(static_cast<const char*>(pData));
+                setg(pBegin, pBegin, pBegin + size);
             }
         };
     }
@@ -70,13 +198,44 @@ namespace Falcor
     class SceneCache::OutputStream
     {
     public:
-        OutputStream(std::ostream& stream) : mStream(stream) {}
+        /** Constructor.
+            \param[in] stream Output stream.
+            \param[in] pSections Optional list receiving large blobs to be stored in separate sections.
+            \param[in] maxSectionSize Maximum size of a section. Larger blobs are split into multiple consecutive sections.
+        */
+        OutputStream(std::ostream& stream, std::vector<SectionData>* pSections = nullptr, uint64_t maxSectionSize = std::numeric_limits<uint64_t>::max())
+            : mStream(stream)
+            , mpSections(pSections)
+            , mMaxSectionSize(maxSectionSize)
+        {}
 
         void write(const void* data, size_t len)
         {
             mStream.write(reinterpret_cast<const char*>(data), len);
         }
 
+        /** Write a blob of data. The size needs to be written separately.
+            Large blobs are stored in separate sections if supported, otherwise the data is written inline.
+            The data needs to stay alive until the sections are written.
+        */
+        void writeBlob(const void* data, uint64_t size)
+        {
+            // Section index 0 is the main section and denotes inline data.
+            // Otherwise the index refers to the first of the consecutive sections holding the blob.
+            uint32_t sectionIndex = 0;
+            if (mpSections && size >= kMinSectionSize)
+            {
+                sectionIndex = (uint32_t)mpSections->size();
+                for (uint64_t offset = 0; offset < size; offset += mMaxSectionSize)
+                {
+                    uint64_t sectionSize = std::min(size - offset, mMaxSectionSize);
+                    mpSections->push_back({ static_cast<const uint8_t*>(data) + offset, sectionSize, sectionSize });
+                }
+            }
+            write(sectionIndex);
+            if (sectionIndex == 0) write(data, size);
+        }
+
         template<typename T>
         void write(const T& value)
         {
@@ -104,7 +263,7 @@ namespace Falcor
             write(len);
             if constexpr (std::is_trivial<T>::value && !std::is_same<T, bool>::value)
             {
-                write(vec.data(), len * sizeof(T));
+                writeBlob(vec.data(), len * sizeof(T));
             }
             else
             {
@@ -122,6 +281,8 @@ namespace Falcor
 
     private:
         std::ostream& mStream;
+        std::vector<SectionData>* mpSections;
+        uint64_t mMaxSectionSize;
     };
 
     /** Wrapper around std::istream to ease serialization of basic types.
@@ -129,13 +290,48 @@ namespace Falcor
     class SceneCache::InputStream
     {
     public:
-        InputStream(std::istream& stream) : mStream(stream) {}
+        /** Constructor.
+            \param[in] stream Input stream.
+            \param[in] pSections Optional list of sections in memory referenced by blobs.
+        */
+        InputStream(std::istream& stream, const std::vector<SectionData>* pSections = nullptr) : mStream(stream), mpSections(pSections) {}
 
         void read(void* data, size_t len)
         {
             mStream.read(reinterpret_cast<char*>(data), len);
         }
 
+        /** Read a blob of data written with OutputStream::writeBlob().
+            Blobs stored in separate sections are copied or decompressed directly from memory, one section per task.
+        */
+        void readBlob(void* data, uint64_t size)
+        {
+            auto sectionIndex = read<uint32_t>();
+            if (sectionIndex == 0)
+            {
+                read(data, size);
+                return;
+            }
+            if (!mpSections) throw RuntimeError("Invalid section reference in scene cache.");
+
+            // Find the range of sections holding the blob.
+            const auto& sections = *mpSections;
+            std::vector<uint64_t> offsets;
+            uint64_t offset = 0;
+            uint32_t sectionEnd = sectionIndex;
+            while (offset < size && sectionEnd < sections.size())
+            {
+                offsets.push_back(offset);
+                offset += sections[sectionEnd++].rawSize;
+            }
+            if (offset != size) throw RuntimeError("Invalid section reference in scene cache.");
+
+            Threading::parallelFor(0, offsets.size(), [&](size_t i)
+            {
+                decompressSection(sections[sectionIndex + i], static_cast<uint8_t*>(data) + offsets[i]);
+            }, 1);
+        }
+
         template<typename T>
         void read(T& value)
         {
@@ -173,7 +369,7 @@ namespace Falcor
             vec.resize(len);
             if constexpr (std::is_trivial<T>::value && !std::is_same<T, bool>::value)
             {
-                read(vec.data(), len * sizeof(T));
+                readBlob(vec.data(), len * sizeof(T));
             }
             else
             {
@@ -190,8 +386,51 @@ namespace Falcor
 
     private:
         std::istream& mStream;
+        const std::vector<SectionData>* mpSections;
     };
 
+    std::optional<SceneCache::Dependency> SceneCache::Dependency::create(const std::filesystem::path& path, bool computeContentHash)
+    {
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(path, ec)) return {};
+
+        Dependency dependency;
+        dependency.path = path;
+        dependency.size = std::filesystem::file_size(path, ec);
+        if (ec) return {};
+        dependency.lastWriteTime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        if (ec) return {};
+
+        if (computeContentHash)
+        {
+            std::ifstream fs(path, std::ios_base::binary);
+            if (!fs.good()) return {};
+
+            SHA1 sha1;
+            std::vector<char> buffer(kBlockSize);
+            while (fs)
+            {
+                fs.read(buffer.data(), buffer.size());
+                sha1.update(buffer.data(), (size_t)fs.gcount());
+            }
+            dependency.contentHash = sha1.finalize();
+        }
+
+        return dependency;
+    }
+
+    bool SceneCache::Dependency::isUpToDate() const
+    {
+        auto current = create(path, false);
+        if (!current || current->size != size) return false;
+        if (current->lastWriteTime == lastWriteTime) return true;
+
+        // The file was touched. Compare the contents if we have a hash.
+        if (!contentHash) return false;
+        current = create(path, true);
+        return current && current->contentHash == contentHash;
+    }
+
     bool SceneCache::hasValidCache(const Key& key)
     {
         auto cachePath = getCachePath(key);
@@ -204,10 +443,33 @@ namespace Falcor
         // Verify header.
         Header header;
         fs.read(reinterpret_cast<char*>(&header), sizeof(header));
-        return !fs.eof() && header.isValid();
+        if (fs.eof() || !header.isValid()) return false;
+
+        // Verify dependencies.
+        try
+        {
+            InputStream stream(fs);
+            auto dependencies = readDependencies(stream);
+            if (!fs.good()) return false;
+
+            for (const auto& dependency : dependencies)
+            {
+                if (!dependency.isUpToDate())
+                {
+                    logInfo("Scene cache '{}' is out of date ('{}' has changed).", cachePath, dependency.path);
+                    return false;
+                }
+            }
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+
+        return true;
     }
 
-    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key)
+    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key, const DependencyList& dependencies, Format format)
     {
         auto cachePath = getCachePath(key);
 
@@ -224,13 +486,22 @@ namespace Falcor
         Header header;
         std::memcpy(header.magic, kMagic, sizeof(Header::magic));
         header.version = kVersion;
+        header.format = format;
         fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
 
-        // Write cache (compressed).
-        lz4_stream::basic_ostream<kBlockSize> zs(fs);
-        OutputStream stream(zs);
-        writeSceneData(stream, sceneData);
+        // Write dependencies (uncompressed).
+        {
+            OutputStream stream(fs);
+            writeDependencies(stream, dependencies);
+        }
+
+        // Write scene data.
+        writeSections(fs, sceneData, format);
         if (fs.bad()) throw RuntimeError("Failed to write scene cache file to '{}'.", cachePath);
+
+        // Remove light collection data computed for the previous scene cache.
+        std::error_code ec;
+        std::filesystem::remove(getLightCollectionPath(key), ec);
     }
 
     Scene::SceneData SceneCache::readCache(const Key& key)
@@ -239,21 +510,25 @@ namespace Falcor
 
         logInfo("Loading scene cache from '{}'.", cachePath);
 
-        // Open file.
-        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) throw RuntimeError("Failed to open scene cache file '{}'.", cachePath);
+        // Map file. Pages are loaded lazily while reading.
+        MemoryMappedFile file(cachePath, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!file.isOpen()) throw RuntimeError("Failed to open scene cache file '{}'.", cachePath);
+        MemoryStreamBuffer buffer(file.getData(), file.getSize());
+        std::istream fs(&buffer);
 
         // Read header (uncompressed).
         Header header;
         fs.read(reinterpret_cast<char*>(&header), sizeof(header));
-        if (!header.isValid()) throw RuntimeError("Invalid header in scene cache file '{}'.", cachePath);
+        if (fs.fail() || !header.isValid()) throw RuntimeError("Invalid header in scene cache file '{}'.", cachePath);
 
-        // Read cache (compressed).
-        lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
-        InputStream stream(zs);
-        auto sceneData = readSceneData(stream);
-        if (fs.bad()) throw RuntimeError("Failed to read scene cache file from '{}'.", cachePath);
-        return sceneData;
+        // Skip dependencies (uncompressed). These are validated in hasValidCache().
+        {
+            InputStream stream(fs);
+            readDependencies(stream);
+        }
+
+        // Read scene data.
+        return readSections(fs, file, header.format);
     }
 
     std::filesystem::path SceneCache::getCachePath(const Key& key)
@@ -261,6 +536,226 @@ namespace Falcor
         return getAppDataDirectory() / kDirectory / SHA1::toString(key);
     }
 
+    std::filesystem::path SceneCache::getLightCollectionPath(const Key& key)
+    {
+        auto path = getCachePath(key);
+        path += kLightCollectionExtension;
+        return path;
+    }
+
+    // Light collection
+
+    void SceneCache::writeLightCollection(const Key& key, const LightCollection::CachedData& data)
+    {
+        static_assert(std::is_trivially_copyable<LightCollection::MeshLightTriangle>::value);
+
+        auto path = getLightCollectionPath(key);
+
+        logInfo("Writing light collection cache to '{}'.", path);
+
+        // Serialize and compress the data.
+        std::ostringstream rawStream(std::ios_base::binary);
+        {
+            OutputStream stream(rawStream);
+            stream.write(data.signature);
+            stream.write((uint64_t)data.triangles.size());
+            stream.write(data.triangles.data(), data.triangles.size() * sizeof(LightCollection::MeshLightTriangle));
+            stream.write(data.activeTriangleList);
+        }
+        std::string rawData = rawStream.str();
+        auto compressedData = compressSection({ rawData.data(), rawData.size(), rawData.size() });
+
+        // Write file.
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream fs(path.c_str(), std::ios_base::binary);
+        if (fs.fail()) throw RuntimeError("Failed to create light collection cache file '{}'.", path);
+
+        LightCollectionHeader header;
+        std::memcpy(header.magic, kLightCollectionMagic, sizeof(LightCollectionHeader::magic));
+        header.version = kLightCollectionVersion;
+        header.rawSize = rawData.size();
+        fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        fs.write(reinterpret_cast<const char*>(compressedData.data()), compressedData.size());
+        if (fs.fail()) throw RuntimeError("Failed to write light collection cache file '{}'.", path);
+    }
+
+    std::optional<LightCollection::CachedData> SceneCache::readLightCollection(const Key& key)
+    {
+        auto path = getLightCollectionPath(key);
+        if (!std::filesystem::exists(path)) return {};
+
+        try
+        {
+            MemoryMappedFile file(path, MemoryMappedFile::AccessHint::SequentialScan);
+            if (!file.isOpen()) throw RuntimeError("Failed to open file.");
+
+            // Read header.
+            LightCollectionHeader header;
+            if (file.getSize() < sizeof(header)) throw RuntimeError("Invalid header.");
+            std::memcpy(&header, file.getData(), sizeof(header));
+            if (!header.isValid()) throw RuntimeError("Invalid header.");
+
+            // Decompress the data.
+            std::vector<uint8_t> rawData(header.rawSize);
+            const uint8_t* pCompressedData = static_cast<const uint8_t*>(file.getData()) + sizeof(header);
+            decompressSection({ pCompressedData, file.getSize() - sizeof(header), header.rawSize, true }, rawData.data());
+
+            // Deserialize.
+            MemoryStreamBuffer buffer(rawData.data(), rawData.size());
+            std::istream fs(&buffer);
+            InputStream stream(fs);
+
+            LightCollection::CachedData data;
+            stream.read(data.signature);
+            auto triangleCount = stream.read<uint64_t>();
+            if (triangleCount > header.rawSize / sizeof(LightCollection::MeshLightTriangle)) throw RuntimeError("Invalid triangle count.");
+            data.triangles.resize(triangleCount);
+            stream.read(data.triangles.data(), data.triangles.size() * sizeof(LightCollection::MeshLightTriangle));
+            stream.read(data.activeTriangleList);
+            if (fs.fail()) throw RuntimeError("Unexpected end of data.");
+
+            logInfo("Loaded light collection cache from '{}'.", path);
+            return data;
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to read light collection cache '{}': {}", path, e.what());
+            return {};
+        }
+    }
+
+    // Sections
+
+    void SceneCache::writeSections(std::ostream& fs, const Scene::SceneData& sceneData, Format format)
+    {
+        const bool compressed = format == Format::Compressed;
+
+        // Serialize the scene data into the main section. Large blobs are only referenced and written to separate sections below.
+        std::vector<SectionData> sections(1);
+        std::ostringstream mainStream(std::ios_base::binary);
+        {
+            OutputStream stream(mainStream, &sections, compressed ? kMaxCompressedSectionSize : std::numeric_limits<uint64_t>::max());
+            writeSceneData(stream, sceneData);
+        }
+        std::string mainData = mainStream.str();
+        sections[0] = { mainData.data(), mainData.size(), mainData.size() };
+
+        // Compress sections in parallel.
+        std::vector<std::vector<uint8_t>> compressedData;
+        if (compressed)
+        {
+            compressedData.resize(sections.size());
+            Threading::parallelFor(0, sections.size(), [&](size_t i)
+            {
+                compressedData[i] = compressSection(sections[i]);
+                sections[i].pData = compressedData[i].data();
+                sections[i].size = compressedData[i].size();
+                sections[i].compressed = true;
+            }, 1);
+        }
+
+        // Compute section offsets following the section table.
+        // Uncompressed sections are page aligned so they can be mapped individually.
+        const uint64_t alignment = compressed ? 1 : kSectionAlignment;
+        std::vector<SectionDesc> descs(sections.size());
+        uint64_t offset = (uint64_t)fs.tellp() + sizeof(uint32_t) + descs.size() * sizeof(SectionDesc);
+        for (size_t i = 0; i < sections.size(); ++i)
+        {
+            offset = align_to(alignment, offset);
+            descs[i] = { offset, sections[i].size, sections[i].rawSize };
+            offset += sections[i].size;
+        }
+
+        // Write section table.
+        OutputStream stream(fs);
+        stream.write((uint32_t)descs.size());
+        stream.write(descs.data(), descs.size() * sizeof(SectionDesc));
+
+        // Write sections.
+        const char padding[kSectionAlignment] = {};
+        for (size_t i = 0; i < sections.size(); ++i)
+        {
+            uint64_t pos = (uint64_t)fs.tellp();
+            FALCOR_ASSERT(pos <= descs[i].offset);
+            fs.write(padding, descs[i].offset - pos);
+            fs.write(static_cast<const char*>(sections[i].pData), sections[i].size);
+        }
+    }
+
+    Scene::SceneData SceneCache::readSections(std::istream& fs, const MemoryMappedFile& file, Format format)
+    {
+        const bool compressed = format == Format::Compressed;
+
+        // Read section table.
+        InputStream stream(fs);
+        auto count = stream.read<uint32_t>();
+        if (count == 0 || count > kMaxSectionCount) throw RuntimeError("Invalid section count in scene cache.");
+        std::vector<SectionDesc> descs(count);
+        stream.read(descs.data(), descs.size() * sizeof(SectionDesc));
+        if (fs.fail()) throw RuntimeError("Failed to read section table in scene cache.");
+
+        // Resolve sections to memory in the mapped file.
+        std::vector<SectionData> sections(count);
+        const uint8_t* pFileData = static_cast<const uint8_t*>(file.getData());
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const auto& desc = descs[i];
+            if (desc.offset > file.getSize() || desc.size > file.getSize() - desc.offset || (!compressed && desc.size != desc.rawSize))
+            {
+                throw RuntimeError("Invalid section in scene cache.");
+            }
+            sections[i] = { pFileData + desc.offset, desc.size, desc.rawSize, compressed };
+        }
+
+        // Decompress the main section if needed. Uncompressed data is read in place.
+        std::vector<uint8_t> mainData;
+        SectionData mainSection = sections[0];
+        if (compressed)
+        {
+            mainData.resize(mainSection.rawSize);
+            decompressSection(mainSection, mainData.data());
+            mainSection = { mainData.data(), mainData.size(), mainData.size() };
+        }
+
+        // Read the scene data from the main section.
+        MemoryStreamBuffer mainBuffer(mainSection.pData, mainSection.size);
+        std::istream mainStream(&mainBuffer);
+        InputStream sectionStream(mainStream, &sections);
+        auto sceneData = readSceneData(sectionStream);
+        if (mainStream.fail()) throw RuntimeError("Failed to read scene cache main section.");
+        return sceneData;
+    }
+
+    // Dependencies
+
+    void SceneCache::writeDependencies(OutputStream& stream, const DependencyList& dependencies)
+    {
+        stream.write((uint32_t)dependencies.size());
+        for (const auto& dependency : dependencies)
+        {
+            stream.write(dependency.path);
+            stream.write(dependency.size);
+            stream.write(dependency.lastWriteTime);
+            stream.write(dependency.contentHash);
+        }
+    }
+
+    SceneCache::DependencyList SceneCache::readDependencies(InputStream& stream)
+    {
+        auto count = stream.read<uint32_t>();
+        if (count > kMaxDependencyCount) throw RuntimeError("Invalid dependency count in scene cache.");
+
+        DependencyList dependencies(count);
+        for (auto& dependency : dependencies)
+        {
+            stream.read(dependency.path);
+            stream.read(dependency.size);
+            stream.read(dependency.lastWriteTime);
+            stream.read(dependency.contentHash);
+        }
+        return dependencies;
+    }
+
     // SceneData
 
     void SceneCache::writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData)
@@ -820,6 +1315,21 @@ namespace Falcor
                 stream.write(id);
             }
         }
+        for (const auto& pStreamer : pGridVolume->mStreamers)
+        {
+            stream.write(pStreamer != nullptr);
+            if (!pStreamer) continue;
+            const auto& paths = pStreamer->getPaths();
+            stream.write((uint32_t)paths.size());
+            for (const auto& path : paths) stream.write(path);
+            stream.write(pStreamer->getGridname());
+            stream.write((uint32_t)pStreamer->getRingSize());
+            for (const auto& pGrid : pStreamer->getRingGrids())
+            {
+                stream.write((uint32_t)std::distance(grids.begin(), std::find(grids.begin(), grids.end(), pGrid)));
+            }
+            for (uint32_t frame : pStreamer->getRingFrames()) stream.write(frame);
+        }
         stream.write(pGridVolume->mGridFrame);
         stream.write(pGridVolume->mGridFrameCount);
         stream.write(pGridVolume->mBounds);
@@ -844,6 +1354,19 @@ namespace Falcor
                 pGrid = id == uint32_t(-1) ? nullptr : grids[id];
             }
         }
+        for (auto& pStreamer : pGridVolume->mStreamers)
+        {
+            if (!stream.read<bool>()) continue;
+            std::vector<std::filesystem::path> paths(stream.read<uint32_t>());
+            for (auto& path : paths) stream.read(path);
+            auto gridname = stream.read<std::string>();
+            uint32_t ringSize = stream.read<uint32_t>();
+            std::vector<Grid::SharedPtr> ringGrids(ringSize);
+            for (auto& pGrid : ringGrids) pGrid = grids[stream.read<uint32_t>()];
+            std::vector<uint32_t> ringFrames(ringSize);
+            for (auto& frame : ringFrames) stream.read(frame);
+            pStreamer = GridSequenceStreamer::create(paths, gridname, std::move(ringGrids), std::move(ringFrames));
+        }
         stream.read(pGridVolume->mGridFrame);
         stream.read(pGridVolume->mGridFrameCount);
         stream.read(pGridVolume->mBounds);
@@ -858,14 +1381,14 @@ namespace Falcor
     {
         const nanovdb::HostBuffer& buffer = pGrid->mGridHandle.buffer();
         stream.write((uint64_t)buffer.size());
-        stream.write(buffer.data(), buffer.size());
+        stream.writeBlob(buffer.data(), buffer.size());
     }
 
     Grid::SharedPtr SceneCache::readGrid(InputStream& stream)
     {
         uint64_t size = stream.read<uint64_t>();
         auto buffer = nanovdb::HostBuffer::create(size);
-        stream.read(buffer.data(), buffer.size());
+        stream.readBlob(buffer.data(), buffer.size());
         return Grid::SharedPtr(new Grid(nanovdb::GridHandle<nanovdb::HostBuffer>(std::move(buffer))));
     }
 
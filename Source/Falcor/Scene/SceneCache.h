@@ -41,21 +41,72 @@
 #include "Utils/CryptoUtils.h"
 
 #include <filesystem>
+#include <optional>
 #include <string>
 #include <vector>
 
 namespace Falcor
 {
+    class MemoryMappedFile;
+
     /** Helper class for reading and writing scene cache files.
         The scene cache is used to heavily reduce load times of more complex assets.
         The cache stores a binary representation of `Scene::SceneData` which contains everything to re-create a `Scene`.
+        In addition, the cache stores the list of input files the scene was built from. A cache is only considered valid
+        if none of these files have changed since the cache was written.
+
+        The scene data is split into sections listed in a section table after the header. The main section holds the
+        serialized scene data, large arrays (index/vertex data, curve data, grid payloads) are stored in separate sections.
+        Two file formats are supported:
+        - Compressed: Each section is compressed as an independent LZ4 frame. Sections are compressed and decompressed in parallel.
+        - Mapped: Sections are stored uncompressed and page aligned. The file is memory mapped when reading and large
+          arrays are copied directly from the mapping. This trades disk space for load time, which is then mostly bound
+          by disk bandwidth.
+
+        The pre-integrated emissive triangles of the scene's light collection are computed lazily after loading. They are
+        stored in a separate file next to the cache file, so they can be added without rewriting the scene cache.
     */
     class FALCOR_API SceneCache
     {
     public:
         using Key = SHA1::MD;
 
+        /** Cache file format.
+        */
+        enum class Format : uint32_t
+        {
+            Compressed = 0,     ///< LZ4 compressed sections.
+            Mapped = 1,         ///< Uncompressed page aligned sections suitable for memory mapping.
+        };
+
+        /** Input file the cached scene depends on.
+        */
+        struct Dependency
+        {
+            std::filesystem::path path;             ///< Absolute path of the file.
+            uint64_t size = 0;                      ///< File size in bytes.
+            int64_t lastWriteTime = 0;              ///< Last write time of the file (in file clock ticks).
+            std::optional<SHA1::MD> contentHash;    ///< Optional SHA-1 hash of the file contents.
+
+            /** Create a dependency from the current state of a file.
+                \param[in] path Absolute path of the file.
+                \param[in] computeContentHash If true, a hash of the file contents is computed.
+                \return Returns the dependency, or an empty optional if the file does not exist.
+            */
+            static std::optional<Dependency> create(const std::filesystem::path& path, bool computeContentHash);
+
+            /** Check if the file is unchanged.
+                If the size matches but the last write time differs, the file is considered unchanged
+                if a content hash is available and matches the current file contents.
+                \return Returns true if the file is unchanged.
+            */
+            bool isUpToDate() const;
+        };
+
+        using DependencyList = std::vector<Dependency>;
+
         /** Check if there is a valid scene cache for a given cache key.
+            The cache is only valid if all the recorded dependencies are up to date.
             \param[in] key Cache key.
             \return Returns true if a valid cache exists.
         */
@@ -64,8 +115,10 @@ namespace Falcor
         /** Write a scene cache.
             \param[in] sceneData Scene data.
             \param[in] key Cache key.
+            \param[in] dependencies List of input files the scene depends on.
+            \param[in] format File format.
         */
-        static void writeCache(const Scene::SceneData& sceneData, const Key& key);
+        static void writeCache(const Scene::SceneData& sceneData, const Key& key, const DependencyList& dependencies = {}, Format format = Format::Compressed);
 
         /** Read a scene cache.
             \param[in] key Cache key.
@@ -73,11 +126,31 @@ namespace Falcor
         */
         static Scene::SceneData readCache(const Key& key);
 
+        /** Write pre-integrated emissive triangles for a scene cache.
+            The data is stored in a separate file next to the scene cache, which is removed when the scene cache is rewritten.
+            \param[in] key Cache key of the scene.
+            \param[in] data Light collection data.
+        */
+        static void writeLightCollection(const Key& key, const LightCollection::CachedData& data);
+
+        /** Read pre-integrated emissive triangles for a scene cache.
+            \param[in] key Cache key of the scene.
+            \return Returns the light collection data, or an empty optional if there is no valid data.
+        */
+        static std::optional<LightCollection::CachedData> readLightCollection(const Key& key);
+
     private:
         class OutputStream;
         class InputStream;
 
         static std::filesystem::path getCachePath(const Key& key);
+        static std::filesystem::path getLightCollectionPath(const Key& key);
+
+        static void writeSections(std::ostream& fs, const Scene::SceneData& sceneData, Format format);
+        static Scene::SceneData readSections(std::istream& fs, const MemoryMappedFile& file, Format format);
+
+        static void writeDependencies(OutputStream& stream, const DependencyList& dependencies);
+        static DependencyList readDependencies(InputStream& stream);
 
         static void writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData);
         static Scene::SceneData readSceneData(InputStream& stream);
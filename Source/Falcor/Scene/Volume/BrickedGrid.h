@@ -27,6 +27,10 @@
  **************************************************************************/
 #pragma once
 #include "Core/API/Texture.h"
+#include "Core/API/Formats.h"
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <vector>
 
 namespace Falcor
 {
@@ -36,4 +40,28 @@ namespace Falcor
         Texture::SharedPtr indirection;
         Texture::SharedPtr atlas;
     };
+
+    /** Host-side contents of the bricked grid textures.
+        This is produced on the CPU and can be built on any thread. The textures are created from it on the main thread.
+    */
+    struct BrickedGridData
+    {
+        uint3 leafDim = uint3(0);               ///< Dimensions of the range and indirection textures.
+        std::vector<uint32_t> rangeData;        ///< Range texture data (RG16Float, 4 mips).
+        std::vector<uint32_t> ptrData;          ///< Indirection texture data (RGBA8Uint).
+        uint3 atlasDim = uint3(0);              ///< Dimensions of the atlas texture in pixels.
+        ResourceFormat atlasFormat = ResourceFormat::Unknown;
+        std::vector<uint8_t> atlasData;         ///< Atlas texture data.
+
+        uint64_t getSizeInBytes() const { return rangeData.size() * sizeof(uint32_t) + ptrData.size() * sizeof(uint32_t) + atlasData.size(); }
+
+        BrickedGrid createTextures() const
+        {
+            BrickedGrid bricks;
+            bricks.range = Texture::create3D(leafDim.x, leafDim.y, leafDim.z, ResourceFormat::RG16Float, 4, rangeData.data(), ResourceBindFlags::ShaderResource, false);
+            bricks.indirection = Texture::create3D(leafDim.x, leafDim.y, leafDim.z, ResourceFormat::RGBA8Uint, 1, ptrData.data(), ResourceBindFlags::ShaderResource, false);
+            bricks.atlas = Texture::create3D(atlasDim.x, atlasDim.y, atlasDim.z, atlasFormat, 1, atlasData.data(), ResourceBindFlags::ShaderResource, false);
+            return bricks;
+        }
+    };
 }
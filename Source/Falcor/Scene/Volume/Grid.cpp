@@ -87,6 +87,12 @@ namespace Falcor
     }
 
     Grid::SharedPtr Grid::createFromFile(const std::filesystem::path& path, const std::string& gridname)
+    {
+        auto pData = loadHostData(path, gridname);
+        return pData ? createFromHostData(std::move(*pData)) : nullptr;
+    }
+
+    std::unique_ptr<Grid::HostData> Grid::loadHostData(const std::filesystem::path& path, const std::string& gridname)
     {
         std::filesystem::path fullPath;
         if (!findFileInDataDirectories(path, fullPath))
@@ -95,19 +101,49 @@ namespace Falcor
             return nullptr;
         }
 
+        nanovdb::GridHandle<nanovdb::HostBuffer> handle;
         if (hasExtension(fullPath, "nvdb"))
         {
-            return createFromNanoVDBFile(fullPath, gridname);
+            handle = loadNanoVDBFile(fullPath, gridname);
         }
         else if (hasExtension(fullPath, "vdb"))
         {
-            return createFromOpenVDBFile(fullPath, gridname);
+            handle = loadOpenVDBFile(fullPath, gridname);
         }
         else
         {
             logWarning("Error when loading grid. Unsupported grid file '{}'.", fullPath);
             return nullptr;
         }
+
+        if (!handle) return nullptr;
+        auto pData = std::make_unique<HostData>(prepareHostData(std::move(handle)));
+        pData->path = fullPath;
+        return pData;
+    }
+
+    Grid::SharedPtr Grid::createFromHostData(HostData&& data)
+    {
+        return SharedPtr(new Grid(std::move(data)));
+    }
+
+    void Grid::setHostData(HostData&& data)
+    {
+        mGridHandle = std::move(data.gridHandle);
+        mSourcePath = std::move(data.path);
+        mpFloatGrid = mGridHandle.grid<float>();
+        mAccessor.emplace(mpFloatGrid->getAccessor());
+
+        // Keep both NanoVDB and brick textures resident in GPU memory for simplicity for now (~15% increased footprint).
+        mpBuffer = Buffer::createStructured(
+            sizeof(uint32_t),
+            uint32_t(div_round_up(mGridHandle.size(), sizeof(uint32_t))),
+            ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource,
+            Buffer::CpuAccess::None,
+            mGridHandle.data()
+        );
+        mBrickedGrid = data.bricks.createTextures();
+        data.bricks = {};
     }
 
     void Grid::renderUI(Gui::Widgets& widget)
@@ -176,7 +212,7 @@ namespace Falcor
 
     float Grid::getValue(const int3& ijk) const
     {
-        return mAccessor.getValue(nanovdb::Coord(ijk.x, ijk.y, ijk.z));
+        return mAccessor->getValue(nanovdb::Coord(ijk.x, ijk.y, ijk.z));
     }
 
     const nanovdb::GridHandle<nanovdb::HostBuffer>& Grid::getGridHandle() const
@@ -201,59 +237,63 @@ namespace Falcor
     }
 
     Grid::Grid(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle)
-        : mGridHandle(std::move(gridHandle))
-        , mpFloatGrid(mGridHandle.grid<float>())
-        , mAccessor(mpFloatGrid->getAccessor())
+        : Grid(prepareHostData(std::move(gridHandle)))
+    {
+    }
+
+    Grid::Grid(HostData&& data)
     {
-        if (!mpFloatGrid->hasMinMax())
+        setHostData(std::move(data));
+    }
+
+    Grid::HostData Grid::prepareHostData(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle)
+    {
+        HostData data;
+        data.gridHandle = std::move(gridHandle);
+
+        auto pFloatGrid = data.gridHandle.grid<float>();
+        if (!pFloatGrid->hasMinMax())
         {
-            nanovdb::gridStats(*mpFloatGrid);
+            nanovdb::gridStats(*pFloatGrid);
         }
 
-        // Keep both NanoVDB and brick textures resident in GPU memory for simplicity for now (~15% increased footprint).
-        mpBuffer = Buffer::createStructured(
-            sizeof(uint32_t),
-            uint32_t(div_round_up(mGridHandle.size(), sizeof(uint32_t))),
-            ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource,
-            Buffer::CpuAccess::None,
-            mGridHandle.data()
-        );
         using NanoVDBGridConverter = NanoVDBConverterBC4;
-        mBrickedGrid = NanoVDBGridConverter(mpFloatGrid).convert();
+        data.bricks = NanoVDBGridConverter(pFloatGrid).convertToHost();
+        return data;
     }
 
-    Grid::SharedPtr Grid::createFromNanoVDBFile(const std::filesystem::path& path, const std::string& gridname)
+    nanovdb::GridHandle<nanovdb::HostBuffer> Grid::loadNanoVDBFile(const std::filesystem::path& path, const std::string& gridname)
     {
         if (!nanovdb::io::hasGrid(path.string(), gridname))
         {
             logWarning("Error when loading grid. Can't find grid '{}' in '{}'.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         auto handle = nanovdb::io::readGrid(path.string(), gridname);
         if (!handle)
         {
             logWarning("Error when loading grid.");
-            return nullptr;
+            return {};
         }
 
         auto floatGrid = handle.grid<float>();
         if (!floatGrid || floatGrid->gridType() != nanovdb::GridType::Float)
         {
             logWarning("Error when loading grid. Grid '{}' in '{}' is not of type float.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (floatGrid->isEmpty())
         {
             logWarning("Grid '{}' in '{}' is empty.", gridname, path);
-            return nullptr;
+            return {};
         }
 
-        return SharedPtr(new Grid(std::move(handle)));
+        return handle;
     }
 
-    Grid::SharedPtr Grid::createFromOpenVDBFile(const std::filesystem::path& path, const std::string& gridname)
+    nanovdb::GridHandle<nanovdb::HostBuffer> Grid::loadOpenVDBFile(const std::filesystem::path& path, const std::string& gridname)
     {
         openvdb::initialize();
 
@@ -275,25 +315,23 @@ namespace Falcor
         if (!baseGrid)
         {
             logWarning("Error when loading grid. Can't find grid '{}' in '{}'.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (!baseGrid->isType<openvdb::FloatGrid>())
         {
             logWarning("Error when loading grid. Grid '{}' in '{}' is not of type float.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         if (baseGrid->empty())
         {
             logWarning("Grid '{}' in '{}' is empty.", gridname, path);
-            return nullptr;
+            return {};
         }
 
         openvdb::FloatGrid::Ptr floatGrid = openvdb::gridPtrCast<openvdb::FloatGrid>(baseGrid);
-        auto handle = nanovdb::openToNanoVDB(floatGrid);
-
-        return SharedPtr(new Grid(std::move(handle)));
+        return nanovdb::openToNanoVDB(floatGrid);
     }
 
 
@@ -47,6 +47,7 @@
 
 #include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
 
 namespace Falcor
@@ -60,6 +61,18 @@ namespace Falcor
     public:
         using SharedPtr = std::shared_ptr<Grid>;
 
+        /** Grid data loaded and converted to bricks on the host, but not yet uploaded to the GPU.
+            Producing it doesn't access the GPU, so it can be done on a worker thread.
+        */
+        struct HostData
+        {
+            nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle;
+            BrickedGridData bricks;
+            std::filesystem::path path; ///< Path of the file the grid was loaded from. Empty if not loaded from a file.
+
+            uint64_t getSizeInBytes() const { return gridHandle.size() + bricks.getSizeInBytes(); }
+        };
+
         /** Create a sphere voxel grid.
             \param[in] radius Radius of the sphere in world units.
             \param[in] voxelSize Size of a voxel in world units.
@@ -86,6 +99,25 @@ namespace Falcor
         */
         static SharedPtr createFromFile(const std::filesystem::path& path, const std::string& gridname);
 
+        /** Load a grid from a file into host memory. This function is thread-safe.
+            \param[in] path File path of the grid. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \return Host data, or nullptr if the grid failed to load.
+        */
+        static std::unique_ptr<HostData> loadHostData(const std::filesystem::path& path, const std::string& gridname);
+
+        /** Create a grid from host data.
+            \param[in] data Host data, which is moved into the grid.
+            \return A new grid.
+        */
+        static SharedPtr createFromHostData(HostData&& data);
+
+        /** Replace the contents of the grid with new host data.
+            This is used to recycle grids of streamed grid sequences. The caller needs to rebind the grid.
+            \param[in] data Host data, which is moved into the grid.
+        */
+        void setHostData(HostData&& data);
+
         /** Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
@@ -141,16 +173,24 @@ namespace Falcor
         */
         rmcv::mat4 getInvTransform() const;
 
+        /** Get the path of the file the grid was loaded from.
+            \return The full path, or an empty path if the grid was not loaded from a file.
+        */
+        const std::filesystem::path& getSourcePath() const { return mSourcePath; }
+
     private:
         Grid(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
+        Grid(HostData&& data);
 
-        static SharedPtr createFromNanoVDBFile(const std::filesystem::path& path, const std::string& gridname);
-        static SharedPtr createFromOpenVDBFile(const std::filesystem::path& path, const std::string& gridname);
+        static HostData prepareHostData(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
+        static nanovdb::GridHandle<nanovdb::HostBuffer> loadNanoVDBFile(const std::filesystem::path& path, const std::string& gridname);
+        static nanovdb::GridHandle<nanovdb::HostBuffer> loadOpenVDBFile(const std::filesystem::path& path, const std::string& gridname);
 
         // Host data.
         nanovdb::GridHandle<nanovdb::HostBuffer> mGridHandle;
-        nanovdb::FloatGrid* mpFloatGrid;
-        nanovdb::FloatGrid::AccessorType mAccessor;
+        nanovdb::FloatGrid* mpFloatGrid = nullptr;
+        std::optional<nanovdb::FloatGrid::AccessorType> mAccessor;
+        std::filesystem::path mSourcePath;
         // Device data.
         Buffer::SharedPtr mpBuffer;
         BrickedGrid mBrickedGrid;
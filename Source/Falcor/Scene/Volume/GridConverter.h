@@ -31,7 +31,7 @@
 #include "Core/API/Formats.h"
 #include "Utils/Logger.h"
 #include "Utils/HostDeviceShared.slangh"
-#include "Utils/NumericRange.h"
+#include "Utils/Threading.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/Timing/CpuTimer.h"
 
@@ -46,7 +46,7 @@
 
 #include <algorithm>
 #include <atomic>
-#include <execution>
+#include <cstring>
 #include <vector>
 
 namespace Falcor
@@ -63,8 +63,15 @@ namespace Falcor
         NanoVDBToBricksConverter(const nanovdb::FloatGrid* grid);
         NanoVDBToBricksConverter(const NanoVDBToBricksConverter& rhs) = delete;
 
+        /** Convert the grid to bricks and create the textures.
+        */
         BrickedGrid convert();
 
+        /** Convert the grid to bricks on the host only. This doesn't access the GPU and can be called from any thread.
+            The converter is left empty.
+        */
+        BrickedGridData convertToHost();
+
     private:
         const static uint32_t kBrickSize = 8; // Must be 8, to match both NanoVDB leaf size.
         const static int32_t kBC4Compress = kBitsPerTexel == 4;
@@ -284,18 +291,28 @@ namespace Falcor
 
     template <typename TexelType, unsigned int kBitsPerTexel>
     BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convert()
+    {
+        return convertToHost().createTextures();
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    BrickedGridData NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertToHost()
     {
         auto t0 = CpuTimer::getCurrentTimePoint();
-        auto range = NumericRange<int>(0, mLeafDim[0].z);
-        std::for_each(std::execution::par, range.begin(), range.end(), [&](int z) { convertSlice(z); });
+        Threading::parallelFor(0, mLeafDim[0].z, [&](size_t z) { convertSlice((int)z); });
         for (int mip = 1; mip < 4; ++mip) computeMip(mip);
         double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
         logInfo("converted in {}ms: mNonEmptyCount {} vs max {}", dt, mNonEmptyCount, getAtlasMaxBrick());
 
-        BrickedGrid bricks;
-        bricks.range = Texture::create3D(mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RG16Float, 4, mRangeData.data(), ResourceBindFlags::ShaderResource, false);
-        bricks.indirection = Texture::create3D(mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RGBA8Uint, 1, mPtrData.data(), ResourceBindFlags::ShaderResource, false);
-        bricks.atlas = Texture::create3D(getAtlasSizePixels().x, getAtlasSizePixels().y, getAtlasSizePixels().z, getAtlasFormat(), 1, mAtlasData.data(), ResourceBindFlags::ShaderResource, false);
-        return bricks;
+        BrickedGridData data;
+        data.leafDim = uint3(mLeafDim[0]);
+        data.rangeData = std::move(mRangeData);
+        data.ptrData = std::move(mPtrData);
+        data.atlasDim = getAtlasSizePixels();
+        data.atlasFormat = getAtlasFormat();
+        data.atlasData.resize(mAtlasData.size() * sizeof(TexelType));
+        std::memcpy(data.atlasData.data(), mAtlasData.data(), data.atlasData.size());
+        mAtlasData = {};
+        return data;
     }
 }
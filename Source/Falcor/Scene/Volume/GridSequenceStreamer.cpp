@@ -0,0 +1,231 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "GridSequenceStreamer.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/Logger.h"
+#include <algorithm>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kInvalidRingIndex = 0xffffffff;
+
+        std::unique_ptr<Grid::HostData> loadFrame(const std::filesystem::path& path, const std::string& gridname)
+        {
+            try
+            {
+                return Grid::loadHostData(path, gridname);
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Error when loading grid '{}' from '{}': {}", gridname, path, e.what());
+                return nullptr;
+            }
+        }
+    }
+
+    GridSequenceStreamer::GridSequenceStreamer(const std::vector<std::filesystem::path>& paths, const std::string& gridname)
+        : mPaths(paths)
+        , mGridname(gridname)
+    {
+    }
+
+    GridSequenceStreamer::~GridSequenceStreamer()
+    {
+        for (auto& [frame, load] : mPending) load.task.finish();
+    }
+
+    GridSequenceStreamer::SharedPtr GridSequenceStreamer::create(const std::vector<std::filesystem::path>& paths, const std::string& gridname, uint32_t ringSize)
+    {
+        checkArgument(!paths.empty(), "'paths' must not be empty.");
+        checkArgument(ringSize > 0, "'ringSize' must be at least 1.");
+
+        SharedPtr pStreamer(new GridSequenceStreamer(paths, gridname));
+
+        // Load the first frames in parallel. Each one becomes a ring grid.
+        uint32_t ringCount = std::min(ringSize, pStreamer->getFrameCount());
+        std::vector<PendingLoad> loads;
+        for (uint32_t frame = 0; frame < ringCount; ++frame) loads.push_back(pStreamer->dispatchLoad(frame));
+
+        for (uint32_t frame = 0; frame < ringCount; ++frame)
+        {
+            loads[frame].task.finish();
+            auto& pData = *loads[frame].pData;
+            if (!pData)
+            {
+                pStreamer->mFailedFrames.insert(frame);
+                continue;
+            }
+            pStreamer->mRingGrids.push_back(Grid::createFromHostData(std::move(*pData)));
+            pStreamer->mRingFrames.push_back(frame);
+            pStreamer->mStats.framesLoaded++;
+        }
+
+        if (pStreamer->mRingGrids.empty())
+        {
+            logWarning("Failed to load any of the first {} frames of grid sequence '{}'.", ringCount, gridname);
+            return nullptr;
+        }
+
+        return pStreamer;
+    }
+
+    GridSequenceStreamer::SharedPtr GridSequenceStreamer::create(const std::vector<std::filesystem::path>& paths, const std::string& gridname, std::vector<Grid::SharedPtr> ringGrids, std::vector<uint32_t> ringFrames)
+    {
+        checkArgument(!paths.empty(), "'paths' must not be empty.");
+        checkArgument(!ringGrids.empty() && ringGrids.size() == ringFrames.size(), "'ringGrids' and 'ringFrames' must be non-empty and have the same size.");
+
+        SharedPtr pStreamer(new GridSequenceStreamer(paths, gridname));
+        pStreamer->mRingGrids = std::move(ringGrids);
+        pStreamer->mRingFrames = std::move(ringFrames);
+        return pStreamer;
+    }
+
+    bool GridSequenceStreamer::update(uint32_t frame, bool wrap)
+    {
+        const uint32_t frameCount = getFrameCount();
+        frame = std::min(frame, frameCount - 1);
+
+        // Frames that should be resident, starting with the current one.
+        std::vector<uint32_t> window;
+        for (uint32_t i = 0; i < getRingSize(); ++i)
+        {
+            uint32_t f = frame + i;
+            if (f >= frameCount)
+            {
+                if (!wrap) break;
+                f %= frameCount;
+            }
+            if (std::find(window.begin(), window.end(), f) != window.end()) break;
+            window.push_back(f);
+        }
+        auto inWindow = [&window](uint32_t f) { return std::find(window.begin(), window.end(), f) != window.end(); };
+
+        // Drop finished loads of frames that are no longer needed (e.g. after seeking).
+        for (auto it = mPending.begin(); it != mPending.end();)
+        {
+            if (!inWindow(it->first) && !it->second.task.isRunning()) it = mPending.erase(it);
+            else ++it;
+        }
+
+        bool changed = false;
+
+        // Make the current frame resident, waiting for its load or loading it on the calling thread.
+        if (findRingIndex(frame) == kInvalidRingIndex && mFailedFrames.count(frame) == 0)
+        {
+            mStats.stalls++;
+            std::unique_ptr<Grid::HostData> pData;
+            if (auto it = mPending.find(frame); it != mPending.end())
+            {
+                it->second.task.finish();
+                pData = std::move(*it->second.pData);
+                mPending.erase(it);
+            }
+            else
+            {
+                pData = loadFrame(mPaths[frame], mGridname);
+            }
+            changed |= upload(frame, std::move(pData), window);
+        }
+
+        // Upload frames that have finished loading in the background.
+        for (auto it = mPending.begin(); it != mPending.end();)
+        {
+            if (it->second.task.isRunning() || !inWindow(it->first))
+            {
+                ++it;
+                continue;
+            }
+            it->second.task.finish();
+            if (*it->second.pData) mStats.prefetchHits++;
+            changed |= upload(it->first, std::move(*it->second.pData), window);
+            it = mPending.erase(it);
+        }
+
+        // Prefetch the remaining frames of the window.
+        for (uint32_t f : window)
+        {
+            if (findRingIndex(f) != kInvalidRingIndex || mPending.count(f) > 0 || mFailedFrames.count(f) > 0) continue;
+            mPending.emplace(f, dispatchLoad(f));
+        }
+
+        return changed;
+    }
+
+    Grid::SharedPtr GridSequenceStreamer::getGrid(uint32_t frame) const
+    {
+        uint32_t ringIndex = findRingIndex(std::min(frame, getFrameCount() - 1));
+        return ringIndex != kInvalidRingIndex ? mRingGrids[ringIndex] : nullptr;
+    }
+
+    uint64_t GridSequenceStreamer::getStagingSizeInBytes()
+    {
+        uint64_t size = 0;
+        for (auto& [frame, load] : mPending)
+        {
+            if (!load.task.isRunning() && *load.pData) size += (*load.pData)->getSizeInBytes();
+        }
+        return size;
+    }
+
+    GridSequenceStreamer::PendingLoad GridSequenceStreamer::dispatchLoad(uint32_t frame) const
+    {
+        PendingLoad load;
+        load.pData = std::make_shared<std::unique_ptr<Grid::HostData>>();
+        load.task = Threading::dispatchTask([path = mPaths[frame], gridname = mGridname, pData = load.pData]() { *pData = loadFrame(path, gridname); });
+        return load;
+    }
+
+    bool GridSequenceStreamer::upload(uint32_t frame, std::unique_ptr<Grid::HostData> pData, const std::vector<uint32_t>& window)
+    {
+        if (!pData)
+        {
+            mFailedFrames.insert(frame);
+            return false;
+        }
+
+        // Replace a frame that is outside the window. There is always one as the window is no larger than the ring.
+        auto it = std::find_if(mRingFrames.begin(), mRingFrames.end(), [&window](uint32_t f) { return std::find(window.begin(), window.end(), f) == window.end(); });
+        FALCOR_ASSERT(it != mRingFrames.end());
+        if (it == mRingFrames.end()) return false;
+
+        size_t ringIndex = std::distance(mRingFrames.begin(), it);
+        mRingGrids[ringIndex]->setHostData(std::move(*pData));
+        mRingFrames[ringIndex] = frame;
+        mStats.framesLoaded++;
+        return true;
+    }
+
+    uint32_t GridSequenceStreamer::findRingIndex(uint32_t frame) const
+    {
+        auto it = std::find(mRingFrames.begin(), mRingFrames.end(), frame);
+        return it != mRingFrames.end() ? (uint32_t)std::distance(mRingFrames.begin(), it) : kInvalidRingIndex;
+    }
+}
@@ -0,0 +1,130 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Grid.h"
+#include "Core/Macros.h"
+#include "Utils/Threading.h"
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** Streams a sequence of grids from disk through a fixed ring of grids.
+
+        Only a window of frames starting at the current frame is kept resident. Frames following the
+        current one are loaded and converted to bricks on worker threads. The GPU resources are created
+        on the calling thread when the frame is uploaded to a ring grid, replacing a frame that has left
+        the window. The ring grids are never replaced, so they can be bound to the scene once.
+    */
+    class FALCOR_API GridSequenceStreamer
+    {
+    public:
+        using SharedPtr = std::shared_ptr<GridSequenceStreamer>;
+
+        static constexpr uint32_t kInvalidFrame = 0xffffffff;
+
+        struct Stats
+        {
+            uint64_t framesLoaded = 0;      ///< Number of frames uploaded to a ring grid.
+            uint64_t prefetchHits = 0;      ///< Number of uploaded frames that were loaded ahead of time on a worker thread.
+            uint64_t stalls = 0;            ///< Number of times the current frame was not ready and had to be loaded or waited for.
+        };
+
+        ~GridSequenceStreamer();
+
+        /** Create a streamer and load the first frames of the sequence.
+            \param[in] paths File paths of the grids. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \param[in] ringSize Number of frames kept resident. Must be at least 1.
+            \return A new object, or nullptr if none of the first frames could be loaded.
+        */
+        static SharedPtr create(const std::vector<std::filesystem::path>& paths, const std::string& gridname, uint32_t ringSize);
+
+        /** Create a streamer from existing ring grids.
+            \param[in] paths File paths of the grids.
+            \param[in] gridname Name of the grid to load.
+            \param[in] ringGrids Ring grids.
+            \param[in] ringFrames Frame held by each ring grid, or kInvalidFrame.
+            \return A new object.
+        */
+        static SharedPtr create(const std::vector<std::filesystem::path>& paths, const std::string& gridname, std::vector<Grid::SharedPtr> ringGrids, std::vector<uint32_t> ringFrames);
+
+        /** Make the given frame resident and prefetch the frames following it.
+            If the frame is not yet available, it is loaded on the calling thread.
+            \param[in] frame Current frame.
+            \param[in] wrap If true, prefetching continues at the first frame after the last one (looped playback).
+            \return True if the contents of any ring grid changed.
+        */
+        bool update(uint32_t frame, bool wrap);
+
+        /** Get the ring grid holding a frame.
+            \return The grid or nullptr if the frame is not resident.
+        */
+        Grid::SharedPtr getGrid(uint32_t frame) const;
+
+        const std::vector<Grid::SharedPtr>& getRingGrids() const { return mRingGrids; }
+        const std::vector<uint32_t>& getRingFrames() const { return mRingFrames; }
+        const std::vector<std::filesystem::path>& getPaths() const { return mPaths; }
+        const std::string& getGridname() const { return mGridname; }
+        uint32_t getFrameCount() const { return (uint32_t)mPaths.size(); }
+        uint32_t getRingSize() const { return (uint32_t)mRingGrids.size(); }
+
+        /** Get the amount of host memory used for frames that have been loaded ahead of time.
+        */
+        uint64_t getStagingSizeInBytes();
+
+        const Stats& getStats() const { return mStats; }
+
+    private:
+        struct PendingLoad
+        {
+            Threading::Task task;
+            std::shared_ptr<std::unique_ptr<Grid::HostData>> pData;
+        };
+
+        GridSequenceStreamer(const std::vector<std::filesystem::path>& paths, const std::string& gridname);
+
+        PendingLoad dispatchLoad(uint32_t frame) const;
+        bool upload(uint32_t frame, std::unique_ptr<Grid::HostData> pData, const std::vector<uint32_t>& window);
+        uint32_t findRingIndex(uint32_t frame) const;
+
+        std::vector<std::filesystem::path> mPaths;
+        std::string mGridname;
+
+        std::vector<Grid::SharedPtr> mRingGrids;
+        std::vector<uint32_t> mRingFrames;          ///< Frame held by each ring grid.
+        std::map<uint32_t, PendingLoad> mPending;   ///< Background loads keyed by frame.
+        std::set<uint32_t> mFailedFrames;           ///< Frames that failed to load.
+        Stats mStats;
+    };
+}
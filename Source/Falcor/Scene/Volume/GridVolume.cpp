@@ -28,6 +28,7 @@
 #include "GridVolume.h"
 #include "Grid.h"
 #include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include <set>
 #include <filesystem>
@@ -47,6 +48,41 @@ namespace Falcor
         const float kMaxAnisotropy = 0.99f;
         const double kMinFrameRate = 1.0;
         const double kMaxFrameRate = 1000.0;
+
+        const char* kSlotNames[] = { "Density", "Emission" };
+        static_assert(std::size(kSlotNames) == (size_t)GridVolume::GridSlot::Count);
+
+        bool findGridFiles(const std::filesystem::path& path, std::vector<std::filesystem::path>& paths)
+        {
+            std::filesystem::path fullPath;
+            if (!findFileInDataDirectories(path, fullPath))
+            {
+                logWarning("Cannot find directory '{}'.", path);
+                return false;
+            }
+            if (!std::filesystem::is_directory(fullPath))
+            {
+                logWarning("'{}' is not a directory.", path);
+                return false;
+            }
+
+            // Enumerate grid files.
+            paths.clear();
+            for (auto p : std::filesystem::directory_iterator(fullPath))
+            {
+                const auto& path = p.path();
+                if (hasExtension(path, "nvdb") || hasExtension(path, "vdb")) paths.push_back(path);
+            }
+
+            // Sort by length first, then alpha-numerically.
+            auto cmp = [](const std::filesystem::path& a, const std::filesystem::path& b) {
+                auto sa = a.string();
+                auto sb = b.string();
+                return sa.length() != sb.length() ? sa.length() < sb.length() : sa < sb;
+            };
+            std::sort(paths.begin(), paths.end(), cmp);
+            return true;
+        }
     }
 
     static_assert(sizeof(GridVolumeData) % 16 == 0, "GridVolumeData size should be a multiple of 16");
@@ -81,6 +117,21 @@ namespace Falcor
             if (widget.checkbox("Playback", playback)) setPlaybackEnabled(playback);
         }
 
+        for (uint32_t slotIndex = 0; slotIndex < (uint32_t)GridSlot::Count; ++slotIndex)
+        {
+            const auto& pStreamer = mStreamers[slotIndex];
+            if (!pStreamer) continue;
+
+            const auto& stats = pStreamer->getStats();
+            std::string text = fmt::format("{} grid streaming:\n", kSlotNames[slotIndex]);
+            text += fmt::format("  Ring size: {}\n", pStreamer->getRingSize());
+            text += fmt::format("  Frames loaded: {}\n", stats.framesLoaded);
+            text += fmt::format("  Prefetch hits: {}\n", stats.prefetchHits);
+            text += fmt::format("  Stalls: {}\n", stats.stalls);
+            text += fmt::format("  Staging memory: {}\n", formatByteSize(pStreamer->getStagingSizeInBytes()));
+            widget.text(text);
+        }
+
         if (const auto& densityGrid = getDensityGrid())
         {
             if (auto group = widget.group("Density Grid")) densityGrid->renderUI(group);
@@ -140,35 +191,41 @@ namespace Falcor
 
     uint32_t GridVolume::loadGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty)
     {
-        std::filesystem::path fullPath;
-        if (!findFileInDataDirectories(path, fullPath))
-        {
-            logWarning("Cannot find directory '{}'.", path);
-            return 0;
-        }
-        if (!std::filesystem::is_directory(fullPath))
-        {
-            logWarning("'{}' is not a directory.", path);
-            return 0;
-        }
+        std::vector<std::filesystem::path> paths;
+        if (!findGridFiles(path, paths)) return 0;
+        return loadGridSequence(slot, paths, gridname, keepEmpty);
+    }
+
+    uint32_t GridVolume::streamGridSequence(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, uint32_t ringSize)
+    {
+        uint32_t slotIndex = (uint32_t)slot;
+        FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
+
+        auto pStreamer = GridSequenceStreamer::create(paths, gridname, ringSize);
+        if (!pStreamer) return 0;
+
+        mGrids[slotIndex].clear();
+        mStreamers[slotIndex] = pStreamer;
+        updateSequence();
+        updateStreamers();
+        updateBounds();
+        markUpdates(UpdateFlags::GridsChanged);
+        return pStreamer->getFrameCount();
+    }
 
-        // Enumerate grid files.
+    uint32_t GridVolume::streamGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, uint32_t ringSize)
+    {
         std::vector<std::filesystem::path> paths;
-        for (auto p : std::filesystem::directory_iterator(fullPath))
-        {
-            const auto& path = p.path();
-            if (hasExtension(path, "nvdb") || hasExtension(path, "vdb")) paths.push_back(path);
-        }
+        if (!findGridFiles(path, paths)) return 0;
+        return streamGridSequence(slot, paths, gridname, ringSize);
+    }
 
-        // Sort by length first, then alpha-numerically.
-        auto cmp = [](const std::filesystem::path& a, const std::filesystem::path& b) {
-            auto sa = a.string();
-            auto sb = b.string();
-            return sa.length() != sb.length() ? sa.length() < sb.length() : sa < sb;
-        };
-        std::sort(paths.begin(), paths.end(), cmp);
+    const GridSequenceStreamer::SharedPtr& GridVolume::getGridSequenceStreamer(GridSlot slot) const
+    {
+        uint32_t slotIndex = (uint32_t)slot;
+        FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
 
-        return loadGridSequence(slot, paths, gridname, keepEmpty);
+        return mStreamers[slotIndex];
     }
 
     void GridVolume::setGridSequence(GridSlot slot, const GridSequence& grids)
@@ -176,9 +233,10 @@ namespace Falcor
         uint32_t slotIndex = (uint32_t)slot;
         FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
 
-        if (mGrids[slotIndex] != grids)
+        if (mGrids[slotIndex] != grids || mStreamers[slotIndex])
         {
             mGrids[slotIndex] = grids;
+            mStreamers[slotIndex] = nullptr;
             updateSequence();
             updateBounds();
             markUpdates(UpdateFlags::GridsChanged);
@@ -205,6 +263,16 @@ namespace Falcor
         uint32_t slotIndex = (uint32_t)slot;
         FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
 
+        if (const auto& pStreamer = mStreamers[slotIndex])
+        {
+            // Grids are returned by reference, so look up the ring grid rather than calling getGrid() on the streamer.
+            const auto& ringGrids = pStreamer->getRingGrids();
+            const auto& ringFrames = pStreamer->getRingFrames();
+            uint32_t frame = std::min(mGridFrame, pStreamer->getFrameCount() - 1);
+            auto it = std::find(ringFrames.begin(), ringFrames.end(), frame);
+            return it != ringFrames.end() ? ringGrids[std::distance(ringFrames.begin(), it)] : kNullGrid;
+        }
+
         const auto& gridSequence = mGrids[slotIndex];
         uint32_t gridIndex = std::min(mGridFrame, (uint32_t)gridSequence.size() - 1);
         return gridSequence.empty() ? kNullGrid : gridSequence[gridIndex];
@@ -217,6 +285,10 @@ namespace Falcor
         {
             std::copy_if(grids.begin(), grids.end(), std::inserter(uniqueGrids, uniqueGrids.begin()), [] (const auto& grid) { return grid != nullptr; });
         }
+        for (const auto& pStreamer : mStreamers)
+        {
+            if (pStreamer) uniqueGrids.insert(pStreamer->getRingGrids().begin(), pStreamer->getRingGrids().end());
+        }
         return std::vector<Grid::SharedPtr>(uniqueGrids.begin(), uniqueGrids.end());
     }
 
@@ -226,6 +298,7 @@ namespace Falcor
         {
             mGridFrame = gridFrame;
             markUpdates(UpdateFlags::GridsChanged);
+            updateStreamers();
             updateBounds();
         }
     }
@@ -326,6 +399,10 @@ namespace Falcor
     {
         mGridFrameCount = 1;
         for (const auto& grids : mGrids) mGridFrameCount = std::max(mGridFrameCount, (uint32_t)grids.size());
+        for (const auto& pStreamer : mStreamers)
+        {
+            if (pStreamer) mGridFrameCount = std::max(mGridFrameCount, pStreamer->getFrameCount());
+        }
         setGridFrame(std::min(mGridFrame, mGridFrameCount - 1));
     }
 
@@ -348,6 +425,14 @@ namespace Falcor
         }
     }
 
+    void GridVolume::updateStreamers()
+    {
+        for (const auto& pStreamer : mStreamers)
+        {
+            if (pStreamer && pStreamer->update(mGridFrame, mPlaybackEnabled)) markUpdates(UpdateFlags::GridsChanged | UpdateFlags::GridResourcesChanged);
+        }
+    }
+
     void GridVolume::markUpdates(UpdateFlags updates)
     {
         mUpdates |= updates;
@@ -391,6 +476,12 @@ namespace Falcor
         volume.def("loadGridSequence",
             pybind11::overload_cast<GridVolume::GridSlot, const std::filesystem::path&, const std::string&, bool>(&GridVolume::loadGridSequence),
             "slot"_a, "path"_a, "gridnames"_a, "keepEmpty"_a = true);
+        volume.def("streamGridSequence",
+            pybind11::overload_cast<GridVolume::GridSlot, const std::vector<std::filesystem::path>&, const std::string&, uint32_t>(&GridVolume::streamGridSequence),
+            "slot"_a, "paths"_a, "gridname"_a, "ringSize"_a = 4);
+        volume.def("streamGridSequence",
+            pybind11::overload_cast<GridVolume::GridSlot, const std::filesystem::path&, const std::string&, uint32_t>(&GridVolume::streamGridSequence),
+            "slot"_a, "path"_a, "gridname"_a, "ringSize"_a = 4);
 
         pybind11::enum_<GridVolume::GridSlot> gridSlot(volume, "GridSlot");
         gridSlot.value("Density", GridVolume::GridSlot::Density);
@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Grid.h"
+#include "GridSequenceStreamer.h"
 #include "GridVolumeData.slang"
 #include "Core/Macros.h"
 #include "Utils/Math/AABB.h"
@@ -58,11 +59,12 @@ namespace Falcor
         */
         enum class UpdateFlags
         {
-            None                = 0x0,  ///< Nothing updated.
-            PropertiesChanged   = 0x1,  ///< Volume properties changed.
-            GridsChanged        = 0x2,  ///< Volume grids changed.
-            TransformChanged    = 0x4,  ///< Volume transform changed.
-            BoundsChanged       = 0x8,  ///< Volume world-space bounds changed.
+            None                    = 0x0,   ///< Nothing updated.
+            PropertiesChanged       = 0x1,   ///< Volume properties changed.
+            GridsChanged            = 0x2,   ///< Volume grids changed.
+            TransformChanged        = 0x4,   ///< Volume transform changed.
+            BoundsChanged           = 0x8,   ///< Volume world-space bounds changed.
+            GridResourcesChanged    = 0x10,  ///< GPU resources of streamed grids were replaced by newly loaded frames.
         };
 
         /** Grid slots available in the volume.
@@ -138,6 +140,33 @@ namespace Falcor
         */
         uint32_t loadGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty = true);
 
+        /** Stream a sequence of grids from files to a grid slot.
+            Only a ring of frames starting at the current frame is kept resident. The following frames are
+            loaded on worker threads during playback.
+            Note: This will replace any existing grid sequence for that slot.
+            \param[in] slot Grid slot.
+            \param[in] paths File paths of the grids. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \param[in] ringSize Number of frames kept resident.
+            \return Returns the length of the streamed sequence, or 0 if it failed to load.
+        */
+        uint32_t streamGridSequence(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, uint32_t ringSize);
+
+        /** Stream a sequence of grids from a directory to a grid slot.
+            Note: This will replace any existing grid sequence for that slot.
+            \param[in] slot Grid slot.
+            \param[in] path Directory containing grid files. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \param[in] ringSize Number of frames kept resident.
+            \return Returns the length of the streamed sequence, or 0 if it failed to load.
+        */
+        uint32_t streamGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, uint32_t ringSize);
+
+        /** Get the streamer of the specified slot.
+            \return The streamer or nullptr if the slot is not streamed.
+        */
+        const GridSequenceStreamer::SharedPtr& getGridSequenceStreamer(GridSlot slot) const;
+
         /** Set the grid sequence for the specified slot.
         */
         void setGridSequence(GridSlot slot, const GridSequence& grids);
@@ -271,12 +300,14 @@ namespace Falcor
 
         void updateSequence();
         void updateBounds();
+        void updateStreamers();
 
         void markUpdates(UpdateFlags updates);
         void setFlags(uint32_t flags);
 
         std::string mName;
         std::array<GridSequence, (size_t)GridSlot::Count> mGrids;
+        std::array<GridSequenceStreamer::SharedPtr, (size_t)GridSlot::Count> mStreamers;
         uint32_t mGridFrame = 0;
         uint32_t mGridFrameCount = 1;
         double mFrameRate = 30.f;
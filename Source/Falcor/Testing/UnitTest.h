@@ -434,4 +434,22 @@ namespace Falcor
 #define EXPECT_LT(x, y) expectLtInternal((x), #x, (y), #y, ctx, __FILE__, __LINE__)
 #define EXPECT(x)       expectInternal((x), #x, ctx, __FILE__, __LINE__)
 
+    /** Check if a function throws an exception of a given type. Use as EXPECT(throws<RuntimeError>([&]() { ... })).
+        \param[in] func Function to call.
+        \return True if the function threw an exception of type E.
+    */
+    template<typename E, typename F>
+    bool throws(F func)
+    {
+        try
+        {
+            func();
+        }
+        catch (const E&)
+        {
+            return true;
+        }
+        return false;
+    }
+
 } // namespace Falcor
@@ -26,9 +26,41 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "BufferAllocator.h"
+#include "Core/Errors.h"
+#include "Utils/Math/Common.h"
+#include <algorithm>
+#include <cstring>
 
 namespace Falcor
 {
+    namespace
+    {
+        /** Ranges separated by at most this many bytes are uploaded in a single copy.
+            Each copy has a fixed cost, so uploading a small gap is cheaper than issuing another copy.
+        */
+        const size_t kMaxDirtyRangeGap = 16 * 1024;
+
+        /** Find the region in a map from offset to size that ends at the given offset.
+        */
+        std::map<size_t, size_t>::iterator findRegionEndingAt(std::map<size_t, size_t>& regions, size_t byteOffset)
+        {
+            auto it = regions.lower_bound(byteOffset);
+            if (it == regions.begin()) return regions.end();
+            --it;
+            return it->first + it->second == byteOffset ? it : regions.end();
+        }
+
+        /** Get size class of a free region, which is the index of the highest set bit of its size.
+        */
+        uint32_t getSizeClass(size_t byteSize)
+        {
+            FALCOR_ASSERT(byteSize > 0);
+            uint32_t sizeClass = 0;
+            while (byteSize >>= 1) sizeClass++;
+            return sizeClass;
+        }
+    }
+
     BufferAllocator::BufferAllocator(size_t alignment, size_t elementSize, size_t cacheLineSize, ResourceBindFlags bindFlags)
         : mAlignment(alignment)
         , mElementSize(elementSize)
@@ -53,10 +85,61 @@ namespace Falcor
 
     size_t BufferAllocator::allocate(size_t byteSize)
     {
+        if (auto byteOffset = allocFromFreeList(byteSize)) return *byteOffset;
         computeAndAllocatePadding(byteSize);
         return allocInternal(byteSize);
     }
 
+    void BufferAllocator::free(size_t byteOffset, size_t byteSize)
+    {
+        checkArgument(byteOffset + byteSize <= mBuffer.size(), "Memory region is out of range.");
+        if (byteSize == 0) return;
+
+        size_t start = byteOffset;
+        size_t end = byteOffset + byteSize;
+
+        // Check that the region isn't already free.
+        auto next = mFreeBlocks.lower_bound(start);
+        if (next != mFreeBlocks.end()) checkArgument(end <= next->first, "Memory region is already free.");
+        if (next != mFreeBlocks.begin()) checkArgument(std::prev(next)->first + std::prev(next)->second <= start, "Memory region is already free.");
+
+        // Coalesce with adjacent free regions and alignment padding.
+        while (true)
+        {
+            if (auto it = findRegionEndingAt(mPaddingBlocks, start); it != mPaddingBlocks.end())
+            {
+                start = it->first;
+                mPaddingBlocks.erase(it);
+            }
+            else if (auto it = findRegionEndingAt(mFreeBlocks, start); it != mFreeBlocks.end())
+            {
+                start = it->first;
+                removeFreeBlock(it);
+            }
+            else if (auto it = mPaddingBlocks.find(end); it != mPaddingBlocks.end())
+            {
+                end += it->second;
+                mPaddingBlocks.erase(it);
+            }
+            else if (auto it = mFreeBlocks.find(end); it != mFreeBlocks.end())
+            {
+                end += it->second;
+                removeFreeBlock(it);
+            }
+            else break;
+        }
+
+        if (end == mBuffer.size())
+        {
+            // The region is at the end of the buffer, shrink the buffer instead.
+            mBuffer.resize(start);
+        }
+        else
+        {
+            insertFreeBlock(start, end - start);
+        }
+    }
+
     void BufferAllocator::setBlob(const void* pData, size_t byteOffset, size_t byteSize)
     {
         checkArgument(pData != nullptr, "Invalid pointer.");
@@ -74,7 +157,11 @@ namespace Falcor
     void BufferAllocator::clear()
     {
         mBuffer.clear();
-        mDirty = {};
+        mDirtyRanges.clear();
+        mFreeBlocks.clear();
+        mFreeLists.clear();
+        mFreeSize = 0;
+        mPaddingBlocks.clear();
     }
 
     Buffer::SharedPtr BufferAllocator::getGPUBuffer()
@@ -103,19 +190,27 @@ namespace Falcor
                 mpGpuBuffer = Buffer::create(bufSize, mBindFlags, Buffer::CpuAccess::None, nullptr);
             }
 
-            mDirty = Range(0, mBuffer.size()); // Mark entire buffer as dirty so the data gets uploaded.
+            // Mark entire buffer as dirty so the data gets uploaded.
+            mDirtyRanges.clear();
+            mDirtyRanges[0] = mBuffer.size();
         }
 
-        // If any range is dirty, upload the data from the CPU to the GPU.
-        if (mDirty.start < mDirty.end)
+        // Merge dirty ranges separated by small gaps. Ranges may extend past the end if the buffer has shrunk.
+        std::vector<Range> uploads;
+        for (const auto& [start, end] : mDirtyRanges)
         {
-            size_t byteSize = mDirty.end - mDirty.start;
-            size_t byteOffset = mDirty.start;
-            FALCOR_ASSERT(byteOffset + byteSize <= mBuffer.size());
-            FALCOR_ASSERT(mBuffer.size() <= mpGpuBuffer->getSize());
-            mpGpuBuffer->setBlob(mBuffer.data() + byteOffset, byteOffset, byteSize);
+            size_t clampedEnd = std::min(end, mBuffer.size());
+            if (start >= clampedEnd) break;
+            if (!uploads.empty() && start - uploads.back().end <= kMaxDirtyRangeGap) uploads.back().end = clampedEnd;
+            else uploads.emplace_back(start, clampedEnd);
+        }
+        mDirtyRanges.clear();
 
-            mDirty = { mBuffer.size(), 0 }; // Reset dirty range to inverted range. Any min/max operation on it will work.
+        // Upload the dirty ranges from the CPU to the GPU.
+        FALCOR_ASSERT(mBuffer.size() <= mpGpuBuffer->getSize());
+        for (const auto& range : uploads)
+        {
+            mpGpuBuffer->setBlob(mBuffer.data() + range.start, range.start, range.end - range.start);
         }
 
         return mpGpuBuffer;
@@ -123,9 +218,9 @@ namespace Falcor
 
     // Private
 
-    void BufferAllocator::computeAndAllocatePadding(size_t byteSize)
+    size_t BufferAllocator::computeAlignedOffset(size_t byteOffset, size_t byteSize) const
     {
-        size_t currentOffset = mBuffer.size();
+        size_t currentOffset = byteOffset;
 
         if (mAlignment > 0 && currentOffset % mAlignment > 0)
         {
@@ -144,9 +239,17 @@ namespace Falcor
             }
         }
 
+        return currentOffset;
+    }
+
+    void BufferAllocator::computeAndAllocatePadding(size_t byteSize)
+    {
+        size_t currentOffset = computeAlignedOffset(mBuffer.size(), byteSize);
+
         size_t pad = currentOffset - mBuffer.size();
         if (pad > 0)
         {
+            mPaddingBlocks[mBuffer.size()] = pad;
             allocInternal(pad);
         }
         FALCOR_ASSERT(mAlignment == 0 || mBuffer.size() % mAlignment == 0);
@@ -159,10 +262,67 @@ namespace Falcor
         return byteOffset;
     }
 
+    std::optional<size_t> BufferAllocator::allocFromFreeList(size_t byteSize)
+    {
+        if (byteSize == 0 || mFreeBlocks.empty()) return {};
+
+        // Search the size classes from the one of the requested size upwards.
+        // Regions in the first class may be too small, and alignment may require padding within a region.
+        for (uint32_t sizeClass = getSizeClass(byteSize); sizeClass < (uint32_t)mFreeLists.size(); sizeClass++)
+        {
+            for (size_t blockOffset : mFreeLists[sizeClass])
+            {
+                auto it = mFreeBlocks.find(blockOffset);
+                FALCOR_ASSERT(it != mFreeBlocks.end());
+                size_t blockEnd = blockOffset + it->second;
+                size_t byteOffset = computeAlignedOffset(blockOffset, byteSize);
+                if (byteOffset + byteSize > blockEnd) continue;
+
+                // Split the region, returning the padding before and the remainder after the allocation to the free lists.
+                removeFreeBlock(it);
+                if (byteOffset > blockOffset) insertFreeBlock(blockOffset, byteOffset - blockOffset);
+                if (byteOffset + byteSize < blockEnd) insertFreeBlock(byteOffset + byteSize, blockEnd - byteOffset - byteSize);
+
+                std::memset(mBuffer.data() + byteOffset, 0, byteSize);
+                markAsDirty(byteOffset, byteSize);
+                return byteOffset;
+            }
+        }
+        return {};
+    }
+
+    void BufferAllocator::insertFreeBlock(size_t byteOffset, size_t byteSize)
+    {
+        FALCOR_ASSERT(byteSize > 0);
+        uint32_t sizeClass = getSizeClass(byteSize);
+        if (sizeClass >= mFreeLists.size()) mFreeLists.resize(sizeClass + 1);
+        mFreeLists[sizeClass].insert(byteOffset);
+        mFreeBlocks[byteOffset] = byteSize;
+        mFreeSize += byteSize;
+    }
+
+    void BufferAllocator::removeFreeBlock(std::map<size_t, size_t>::iterator it)
+    {
+        mFreeLists[getSizeClass(it->second)].erase(it->first);
+        mFreeSize -= it->second;
+        mFreeBlocks.erase(it);
+    }
+
     void BufferAllocator::markAsDirty(const Range& range)
     {
         FALCOR_ASSERT(range.start < range.end);
-        mDirty.start = std::min(mDirty.start, range.start);
-        mDirty.end = std::max(mDirty.end, range.end);
+        size_t start = range.start;
+        size_t end = range.end;
+
+        // Merge with all overlapping or adjacent ranges.
+        auto it = mDirtyRanges.upper_bound(start);
+        if (it != mDirtyRanges.begin() && std::prev(it)->second >= start) it = std::prev(it);
+        while (it != mDirtyRanges.end() && it->first <= end)
+        {
+            start = std::min(start, it->first);
+            end = std::max(end, it->second);
+            it = mDirtyRanges.erase(it);
+        }
+        mDirtyRanges[start] = end;
     }
 }
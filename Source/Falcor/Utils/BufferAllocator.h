@@ -26,6 +26,12 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #pragma once
+#include "Core/Macros.h"
+#include "Core/API/Buffer.h"
+#include <map>
+#include <optional>
+#include <set>
+#include <vector>
 
 namespace Falcor
 {
@@ -43,6 +49,14 @@ namespace Falcor
         It is assumed that the base pointer of the GPU buffer starts at a
         cache line. The implementation doesn't provide any alignment
         guarantees for the CPU side buffer (where it doesn't matter anyway).
+
+        Memory regions can be returned using free(). Free regions are kept in
+        power-of-two size classes and coalesced with adjacent free regions.
+        allocate() reuses free regions before growing the buffer.
+
+        Modified regions are tracked as a sorted set of dirty ranges. When the
+        GPU buffer is updated, ranges separated by small gaps are merged and
+        each remaining range is uploaded with a separate copy.
     */
     class FALCOR_API BufferAllocator
     {
@@ -56,6 +70,8 @@ namespace Falcor
         BufferAllocator(size_t alignment, size_t elementSize, size_t cacheLineSize = 128, ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
 
         /** Allocates a memory region.
+            Free regions are reused if possible, otherwise the memory is allocated at the end of the buffer.
+            The allocated memory is zero-initialized.
             \param[in] byteSize Amount of memory in bytes to allocate.
             \return Offset in bytes to the allocated memory.
         */
@@ -71,7 +87,7 @@ namespace Falcor
             return allocate(count * sizeof(T));
         }
 
-        /** Allocates an object of given type and copies the data.
+        /** Allocates an object of given type at the end of the buffer and copies the data.
             \param[in] obj The object to copy.
             \return Offset in bytes to the allocated object.
         */
@@ -86,7 +102,7 @@ namespace Falcor
             return byteOffset;
         }
 
-        /** Allocates an object of given type and executes its constructor.
+        /** Allocates an object of given type at the end of the buffer and executes its constructor.
             \param[in] args Arguments to pass to the constructor.
             \return Offset in bytes to the allocated object.
         */
@@ -101,6 +117,28 @@ namespace Falcor
             return byteOffset;
         }
 
+        /** Free a memory region so that it can be reused by later allocations.
+            The region is coalesced with adjacent free regions. If it ends at the end of the buffer, the buffer shrinks.
+            \param[in] byteOffset Offset in bytes to the memory region, as returned by an allocation.
+            \param[in] byteSize Size in bytes of the memory region.
+        */
+        void free(size_t byteOffset, size_t byteSize);
+
+        /** Free memory holding an array of the given type.
+            \param[in] byteOffset Offset in bytes to the memory region.
+            \param[in] count Number of array elements.
+        */
+        template<typename T>
+        void free(size_t byteOffset, size_t count = 1)
+        {
+            free(byteOffset, count * sizeof(T));
+        }
+
+        /** Get the total size of all free regions within the buffer.
+            \return Size in bytes.
+        */
+        size_t getFreeSize() const { return mFreeSize; }
+
         /** Set data into a memory region.
             \param[in] pData Pointer to the source data.
             \param[in] byteOffset Offset in bytes to the destination memory region.
@@ -161,8 +199,12 @@ namespace Falcor
         Buffer::SharedPtr getGPUBuffer();
 
     private:
+        size_t computeAlignedOffset(size_t byteOffset, size_t byteSize) const;
         void computeAndAllocatePadding(size_t byteSize);
         size_t allocInternal(size_t byteSize);
+        std::optional<size_t> allocFromFreeList(size_t byteSize);
+        void insertFreeBlock(size_t byteOffset, size_t byteSize);
+        void removeFreeBlock(std::map<size_t, size_t>::iterator it);
 
         struct Range
         {
@@ -180,7 +222,12 @@ namespace Falcor
         const size_t mCacheLineSize;        ///< Allocation are aligned to not span multiple cache lines (if possible). A value of zero means do not care about cache line alignment.
         const ResourceBindFlags mBindFlags; ///< Bind flags for the GPU buffer.
 
-        Range mDirty;                       ///< Range of buffer that is dirty and needs to be updatd on the GPU. We track a single dirty range for now to minimize the number of uploads, but this could be changed.
+        std::map<size_t, size_t> mDirtyRanges;          ///< Sorted, non-overlapping ranges of the buffer that need to be updated on the GPU. Maps start to end offset.
+
+        std::map<size_t, size_t> mFreeBlocks;           ///< Free memory regions within the buffer. Maps offset to size.
+        std::vector<std::set<size_t>> mFreeLists;       ///< Offsets of free regions per size class. Size class i holds regions of size [2^i, 2^(i+1)).
+        size_t mFreeSize = 0;                           ///< Total size of free regions in bytes.
+        std::map<size_t, size_t> mPaddingBlocks;        ///< Padding inserted at the end of the buffer for alignment. Maps offset to size. Padding is coalesced with freed regions.
 
         std::vector<uint8_t> mBuffer;       ///< CPU buffer holding a copy of the data.
         Buffer::SharedPtr mpGpuBuffer;      ///< GPU buffer holding the data.
@@ -26,14 +26,55 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "AsyncTextureLoader.h"
+#include "Core/Errors.h"
 #include "Core/API/Device.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
 #include "Utils/Threading.h"
+#include <optional>
 
 namespace Falcor
 {
     namespace
     {
         constexpr size_t kUploadsPerFlush = 16; ///< Number of texture uploads before issuing a flush (to keep upload heap from growing).
+
+        /** Load a texture. Textures loaded from a bitmap are analyzed on the CPU before the texture is created.
+            A texture where all texels are the same is created with a single texel, which samples to the same value without uploading the full image.
+        */
+        Texture::SharedPtr loadTexture(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSrgb, Resource::BindFlags bindFlags, std::optional<TextureAnalyzer::Result>& analysis)
+        {
+            std::filesystem::path fullPath;
+            if (hasExtension(path, "dds") || !findFileInDataDirectories(path, fullPath))
+            {
+                return Texture::createFromFile(path, generateMipLevels, loadAsSrgb, bindFlags);
+            }
+
+            Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(fullPath, true);
+            if (!pBitmap) return nullptr;
+
+            try
+            {
+                analysis = TextureAnalyzer::analyze(*pBitmap, loadAsSrgb);
+            }
+            catch (const RuntimeError& e)
+            {
+                // Leave the analysis to the GPU.
+                logDebug("Texture '{}' is not analyzed on the CPU: {}", fullPath, e.what());
+            }
+
+            if (analysis && analysis->isConstant(TextureChannelFlags::RGBA) && (pBitmap->getWidth() > 1 || pBitmap->getHeight() > 1))
+            {
+                // The analysis only succeeds for uncompressed formats, the first texel holds the value of the whole image.
+                logDebug("Texture '{}' is constant, creating it with a single texel.", fullPath);
+                pBitmap = Bitmap::create(1, 1, pBitmap->getFormat(), pBitmap->getData());
+            }
+
+            Texture::SharedPtr pTexture = Texture::createFromBitmap(*pBitmap, generateMipLevels, loadAsSrgb, bindFlags);
+            pTexture->setSourcePath(fullPath);
+
+            return pTexture;
+        }
     }
 
     AsyncTextureLoader::AsyncTextureLoader(size_t threadCount)
@@ -106,12 +147,13 @@ namespace Falcor
             lock.unlock();
 
             // Load the textures (this part is running in parallel).
-            Texture::SharedPtr pTexture = Texture::createFromFile(request.path, request.generateMipLevels, request.loadAsSRGB, request.bindFlags);
+            std::optional<TextureAnalyzer::Result> analysis;
+            Texture::SharedPtr pTexture = loadTexture(request.path, request.generateMipLevels, request.loadAsSRGB, request.bindFlags, analysis);
             request.promise.set_value(pTexture);
 
             if (request.callback)
             {
-                request.callback(pTexture);
+                request.callback(pTexture, analysis ? &analysis.value() : nullptr);
             }
 
             lock.lock();
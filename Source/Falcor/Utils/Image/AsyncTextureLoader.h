@@ -29,6 +29,7 @@
 #include "Core/Macros.h"
 #include "Core/API/Resource.h"
 #include "Core/API/Texture.h"
+#include "TextureAnalyzer.h"
 #include <condition_variable>
 #include <filesystem>
 #include <functional>
@@ -47,7 +48,11 @@ namespace Falcor
     class FALCOR_API AsyncTextureLoader
     {
     public:
-        using LoadCallback = std::function<void(Texture::SharedPtr pTexture)>;
+        /** Function called after a texture load has finished.
+            Textures loaded from bitmaps are analyzed on the CPU before the texture is created. Constant textures are created with a single texel.
+            pAnalysis points to the analysis of the image, or is nullptr if the texture wasn't analyzed.
+        */
+        using LoadCallback = std::function<void(Texture::SharedPtr pTexture, const TextureAnalyzer::Result* pAnalysis)>;
 
         /** Constructor.
             \param[in] threadCount Number of worker threads.
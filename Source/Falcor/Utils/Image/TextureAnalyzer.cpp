@@ -27,6 +27,12 @@
  **************************************************************************/
 #include "TextureAnalyzer.h"
 #include "Core/API/RenderContext.h"
+#include "Utils/Threading.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <mutex>
 
 namespace Falcor
 {
@@ -39,6 +45,210 @@ namespace Falcor
         static_assert((uint32_t)TextureChannelFlags::Alpha == 0x8);
 
         const char kShaderFilename[] = "Utils/Image/TextureAnalyzer.cs.slang";
+
+        // Target number of texels processed per task by the CPU analysis.
+        const size_t kTexelsPerTask = 1 << 16;
+
+        /** Per-channel statistics gathered over a range of rows by the CPU analysis.
+            Channels are in storage order. For integer formats min/max hold the raw values.
+        */
+        template<typename T>
+        struct ChannelStats
+        {
+            T minValue[4];
+            T maxValue[4];
+            bool varying[4] = {};
+            bool pos[4] = {};
+            bool neg[4] = {};
+            bool inf[4] = {};
+            bool nan[4] = {};
+
+            ChannelStats()
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    minValue[c] = std::numeric_limits<T>::max();
+                    maxValue[c] = std::numeric_limits<T>::lowest();
+                }
+            }
+
+            void merge(const ChannelStats& other)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    minValue[c] = std::min(minValue[c], other.minValue[c]);
+                    maxValue[c] = std::max(maxValue[c], other.maxValue[c]);
+                    varying[c] |= other.varying[c];
+                    pos[c] |= other.pos[c];
+                    neg[c] |= other.neg[c];
+                    inf[c] |= other.inf[c];
+                    nan[c] |= other.nan[c];
+                }
+            }
+        };
+
+        /** Run a row kernel over all rows of an image in parallel and merge the per-task statistics.
+        */
+        template<typename T, typename Kernel>
+        ChannelStats<T> reduceRows(uint32_t width, uint32_t height, Kernel&& kernel)
+        {
+            ChannelStats<T> stats;
+            std::mutex mutex;
+            size_t grainSize = std::max<size_t>(1, kTexelsPerTask / width);
+
+            Threading::parallelForChunks(0, height, [&](size_t rowBegin, size_t rowEnd)
+            {
+                ChannelStats<T> local;
+                for (size_t y = rowBegin; y < rowEnd; y++) kernel((uint32_t)y, local);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                stats.merge(local);
+            }, grainSize);
+
+            return stats;
+        }
+
+        /** Gather min/max of the raw values of integer formats.
+            The unorm conversion is monotonic and injective, so the raw values are sufficient to derive the full result.
+            The inner loop is written without branches so that it vectorizes.
+        */
+        template<typename T, uint32_t N>
+        ChannelStats<T> analyzeUnorm(const uint8_t* pData, uint32_t width, uint32_t height, uint32_t rowPitch)
+        {
+            return reduceRows<T>(width, height, [=](uint32_t y, ChannelStats<T>& stats)
+            {
+                const T* pRow = reinterpret_cast<const T*>(pData + (size_t)y * rowPitch);
+                T minValue[N], maxValue[N];
+                for (uint32_t c = 0; c < N; c++) minValue[c] = maxValue[c] = pRow[c];
+
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    for (uint32_t c = 0; c < N; c++)
+                    {
+                        T v = pRow[x * N + c];
+                        minValue[c] = v < minValue[c] ? v : minValue[c];
+                        maxValue[c] = v > maxValue[c] ? v : maxValue[c];
+                    }
+                }
+
+                for (uint32_t c = 0; c < N; c++)
+                {
+                    stats.minValue[c] = std::min(stats.minValue[c], minValue[c]);
+                    stats.maxValue[c] = std::max(stats.maxValue[c], maxValue[c]);
+                }
+            });
+        }
+
+        /** Gather the full statistics of floating-point formats.
+            The comparisons mirror the shader so that NaNs and infinities are classified identically.
+        */
+        template<typename T, uint32_t N, typename Convert>
+        ChannelStats<float> analyzeFloat(const uint8_t* pData, uint32_t width, uint32_t height, uint32_t rowPitch, Convert convert)
+        {
+            float ref[N];
+            for (uint32_t c = 0; c < N; c++) ref[c] = convert(reinterpret_cast<const T*>(pData)[c]);
+
+            return reduceRows<float>(width, height, [=](uint32_t y, ChannelStats<float>& stats)
+            {
+                const T* pRow = reinterpret_cast<const T*>(pData + (size_t)y * rowPitch);
+                float minValue[N], maxValue[N];
+                uint32_t varying[N] = {}, pos[N] = {}, neg[N] = {}, inf[N] = {}, nan[N] = {};
+                for (uint32_t c = 0; c < N; c++)
+                {
+                    minValue[c] = stats.minValue[c];
+                    maxValue[c] = stats.maxValue[c];
+                }
+
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    for (uint32_t c = 0; c < N; c++)
+                    {
+                        float v = convert(pRow[x * N + c]);
+                        varying[c] |= v != ref[c];
+                        pos[c] |= v > 0.f;
+                        neg[c] |= v < 0.f;
+                        inf[c] |= std::isinf(v);
+                        nan[c] |= std::isnan(v);
+                        minValue[c] = v < minValue[c] ? v : minValue[c];
+                        maxValue[c] = v > maxValue[c] ? v : maxValue[c];
+                    }
+                }
+
+                for (uint32_t c = 0; c < N; c++)
+                {
+                    stats.minValue[c] = minValue[c];
+                    stats.maxValue[c] = maxValue[c];
+                    stats.varying[c] |= varying[c] != 0;
+                    stats.pos[c] |= pos[c] != 0;
+                    stats.neg[c] |= neg[c] != 0;
+                    stats.inf[c] |= inf[c] != 0;
+                    stats.nan[c] |= nan[c] != 0;
+                }
+            });
+        }
+
+        /** Assemble the final result from per-channel statistics.
+            \param[in] stats Statistics in storage order.
+            \param[in] channelMap Storage channel for each of the RGBA channels, or -1 if missing (read as 0 for RGB and 1 for alpha).
+            \param[in] convert Function converting a statistic value to float.
+        */
+        template<typename T, typename Convert>
+        TextureAnalyzer::Result makeResult(const ChannelStats<T>& stats, const T* ref, const int channelMap[4], Convert convert)
+        {
+            TextureAnalyzer::Result result = {};
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                const int c = channelMap[i];
+                if (c < 0)
+                {
+                    float v = i == 3 ? 1.f : 0.f;
+                    result.value[i] = result.minValue[i] = result.maxValue[i] = v;
+                    if (v > 0.f) result.mask |= (uint32_t)TextureAnalyzer::Result::RangeFlags::Pos << (4 + 4 * i);
+                    continue;
+                }
+
+                // The GPU clears min to FLT_MAX and max to 0 and clamps the reduced values to zero.
+                result.value[i] = convert(ref[c], i);
+                result.minValue[i] = std::min(std::max(convert(stats.minValue[c], i), 0.f), FLT_MAX);
+                result.maxValue[i] = std::max(convert(stats.maxValue[c], i), 0.f);
+
+                uint32_t range = 0;
+                if (stats.pos[c]) range |= (uint32_t)TextureAnalyzer::Result::RangeFlags::Pos;
+                if (stats.neg[c]) range |= (uint32_t)TextureAnalyzer::Result::RangeFlags::Neg;
+                if (stats.inf[c]) range |= (uint32_t)TextureAnalyzer::Result::RangeFlags::Inf;
+                if (stats.nan[c]) range |= (uint32_t)TextureAnalyzer::Result::RangeFlags::NaN;
+                result.mask |= range << (4 + 4 * i);
+                if (stats.varying[c]) result.mask |= 1u << i;
+            }
+            return result;
+        }
+
+        template<typename T, uint32_t N>
+        TextureAnalyzer::Result analyzeUnormResult(const uint8_t* pData, uint32_t width, uint32_t height, uint32_t rowPitch, const int channelMap[4], bool srgb)
+        {
+            ChannelStats<T> stats = analyzeUnorm<T, N>(pData, width, height, rowPitch);
+            for (uint32_t c = 0; c < N; c++)
+            {
+                stats.varying[c] = stats.minValue[c] != stats.maxValue[c];
+                stats.pos[c] = stats.maxValue[c] > 0;
+            }
+
+            auto convert = [srgb](T v, uint32_t channel)
+            {
+                float f = (float)v / (float)std::numeric_limits<T>::max();
+                return srgb && channel < 3 ? sRGBToLinear(f) : f;
+            };
+            return makeResult(stats, reinterpret_cast<const T*>(pData), channelMap, convert);
+        }
+
+        template<typename T, uint32_t N, typename Convert>
+        TextureAnalyzer::Result analyzeFloatResult(const uint8_t* pData, uint32_t width, uint32_t height, uint32_t rowPitch, const int channelMap[4], Convert convert)
+        {
+            ChannelStats<float> stats = analyzeFloat<T, N>(pData, width, height, rowPitch, convert);
+            float ref[N];
+            for (uint32_t c = 0; c < N; c++) ref[c] = convert(reinterpret_cast<const T*>(pData)[c]);
+            return makeResult(stats, ref, channelMap, [](float v, uint32_t) { return v; });
+        }
     }
 
     // Verify that the result struct matches the size expected by the shader.
@@ -105,6 +315,81 @@ namespace Falcor
         }
     }
 
+    TextureAnalyzer::Result TextureAnalyzer::analyze(const void* pData, uint32_t width, uint32_t height, uint32_t rowPitch, ResourceFormat format)
+    {
+        FALCOR_ASSERT(pData);
+        checkArgument(width > 0 && height > 0, "Image dimensions must be non-zero");
+
+        const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+        const FormatType type = getFormatType(format);
+        const uint32_t channelCount = getFormatChannelCount(format);
+        const uint32_t channelBits = getNumChannelBits(format, 0);
+        const bool srgb = type == FormatType::UnormSrgb;
+
+        // Map RGBA to storage channels. Missing channels are read as (0,0,0,1) by the GPU.
+        int channelMap[4] = { -1, -1, -1, -1 };
+        for (uint32_t i = 0; i < channelCount; i++) channelMap[i] = (int)i;
+
+        switch (format)
+        {
+        case ResourceFormat::BGRX8Unorm:
+        case ResourceFormat::BGRX8UnormSrgb:
+            channelMap[3] = -1;
+            [[fallthrough]];
+        case ResourceFormat::BGRA8Unorm:
+        case ResourceFormat::BGRA8UnormSrgb:
+            std::swap(channelMap[0], channelMap[2]);
+            break;
+        default:
+            break;
+        }
+
+        // Check that the format has uniform channel sizes and no padding.
+        if (getFormatBytesPerBlock(format) * 8 != channelCount * channelBits || getFormatWidthCompressionRatio(format) != 1)
+        {
+            throw RuntimeError("Format {} is not supported", to_string(format));
+        }
+        checkArgument((uint64_t)width * getFormatBytesPerBlock(format) <= rowPitch, "Row pitch is too small for the image width");
+
+        // Dispatch to a kernel specialized for the storage type and channel count.
+#define dispatch_channels(func, T, ...) \
+        switch (channelCount) \
+        { \
+        case 1: return func<T, 1>(pBytes, width, height, rowPitch, channelMap, __VA_ARGS__); \
+        case 2: return func<T, 2>(pBytes, width, height, rowPitch, channelMap, __VA_ARGS__); \
+        case 3: return func<T, 3>(pBytes, width, height, rowPitch, channelMap, __VA_ARGS__); \
+        case 4: return func<T, 4>(pBytes, width, height, rowPitch, channelMap, __VA_ARGS__); \
+        default: break; \
+        }
+
+        if ((type == FormatType::Unorm || type == FormatType::UnormSrgb) && channelBits == 8)
+        {
+            dispatch_channels(analyzeUnormResult, uint8_t, srgb);
+        }
+        else if (type == FormatType::Unorm && channelBits == 16)
+        {
+            dispatch_channels(analyzeUnormResult, uint16_t, false);
+        }
+        else if (type == FormatType::Float && channelBits == 16)
+        {
+            dispatch_channels(analyzeFloatResult, uint16_t, [](uint16_t v) { return f16tof32(v); });
+        }
+        else if (type == FormatType::Float && channelBits == 32)
+        {
+            dispatch_channels(analyzeFloatResult, float, [](float v) { return v; });
+        }
+#undef dispatch_channels
+
+        throw RuntimeError("Format {} is not supported", to_string(format));
+    }
+
+    TextureAnalyzer::Result TextureAnalyzer::analyze(const Bitmap& bitmap, bool loadAsSrgb)
+    {
+        ResourceFormat format = bitmap.getFormat();
+        if (loadAsSrgb) format = linearToSrgbFormat(format);
+        return analyze(bitmap.getData(), bitmap.getWidth(), bitmap.getHeight(), bitmap.getRowPitch(), format);
+    }
+
     void TextureAnalyzer::clear(RenderContext* pRenderContext, Buffer::SharedPtr pResult, uint64_t resultOffset, size_t resultCount) const
     {
         FALCOR_ASSERT(pRenderContext);
@@ -30,6 +30,7 @@
 #include "Core/API/Formats.h"
 #include "Core/API/Buffer.h"
 #include "Core/API/Texture.h"
+#include "Utils/Image/Bitmap.h"
 #include "RenderGraph/BasePasses/ComputePass.h"
 #include "Utils/Math/Vector.h"
 #include <memory>
@@ -121,6 +122,27 @@ namespace Falcor
         */
         void analyze(RenderContext* pRenderContext, const std::vector<Texture::SharedPtr>& inputs, Buffer::SharedPtr pResult, bool clearResult = true);
 
+        /** Analyze 2D image data on the CPU.
+            This produces the same result as the GPU analysis of a texture created from the same data,
+            without requiring the data to be uploaded. The rows are processed in parallel.
+            Throws an exception if the format is not supported. Supported are 8/16-bit unorm (incl. sRGB)
+            and 16/32-bit float formats with 1-4 channels, including the BGRA/BGRX layouts produced by Bitmap.
+            \param[in] pData Pointer to the image data. The first texel in memory is used as reference value.
+            \param[in] width Width in texels.
+            \param[in] height Height in texels.
+            \param[in] rowPitch Size of one row in bytes.
+            \param[in] format Format of the data. For sRGB formats the linearized values are analyzed.
+            \return The analysis result.
+        */
+        static Result analyze(const void* pData, uint32_t width, uint32_t height, uint32_t rowPitch, ResourceFormat format);
+
+        /** Analyze a bitmap on the CPU. See analyze() above.
+            \param[in] bitmap The bitmap. This is expected to be stored top-down to match the GPU texture reference texel.
+            \param[in] loadAsSrgb Interpret the bitmap data as sRGB, as done when creating a texture with 'loadAsSrgb' set.
+            \return The analysis result.
+        */
+        static Result analyze(const Bitmap& bitmap, bool loadAsSrgb = false);
+
         /** Helper function to clear the results buffer.
             \param[in] pRenderContext The context.
             \param[in] pResult GPU buffer to clear. This is expected to have UAV bind flag.
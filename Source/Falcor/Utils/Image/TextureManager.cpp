@@ -149,7 +149,7 @@ namespace Falcor
 
             // Function called by the async texture loader when loading finishes.
             // It's called by a worker thread so needs to acquire the mutex before changing any state.
-            auto callback = [=](Texture::SharedPtr pTexture)
+            auto callback = [=](Texture::SharedPtr pTexture, const TextureAnalyzer::Result* pAnalysis)
             {
                 std::unique_lock<std::mutex> lock(mMutex);
 
@@ -157,6 +157,7 @@ namespace Falcor
                 auto& desc = getDesc(handle);
                 desc.state = TextureState::Loaded;
                 desc.pTexture = pTexture;
+                if (pTexture && pAnalysis) desc.analysis = *pAnalysis;
 
                 // Add to texture-to-handle map.
                 if (pTexture) mTextureToHandle[pTexture.get()] = handle;
@@ -254,6 +255,14 @@ namespace Falcor
         return mTextureDescs[handle.id];
     }
 
+    std::optional<TextureAnalyzer::Result> TextureManager::getTextureAnalysis(const Texture::SharedPtr& pTexture) const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mTextureToHandle.find(pTexture.get());
+        if (it == mTextureToHandle.end()) return {};
+        return mTextureDescs[it->second.id].analysis;
+    }
+
     size_t TextureManager::getTextureDescCount() const
     {
         std::lock_guard<std::mutex> lock(mMutex);
@@ -36,6 +36,7 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
 
 namespace Falcor
@@ -82,8 +83,9 @@ namespace Falcor
         */
         struct TextureDesc
         {
-            TextureState state = TextureState::Invalid;     ///< Current state of the texture.
-            Texture::SharedPtr pTexture;                    ///< Valid texture object when state is 'Loaded', or nullptr if loading failed.
+            TextureState state = TextureState::Invalid;      ///< Current state of the texture.
+            Texture::SharedPtr pTexture;                     ///< Valid texture object when state is 'Loaded', or nullptr if loading failed.
+            std::optional<TextureAnalyzer::Result> analysis; ///< CPU analysis of the texture contents, if the texture was loaded from a bitmap.
 
             bool isValid() const { return state != TextureState::Invalid; }
         };
@@ -142,6 +144,13 @@ namespace Falcor
         */
         TextureDesc getTextureDesc(const TextureHandle& handle) const;
 
+        /** Get the analysis of a managed texture's contents.
+            Textures loaded from bitmaps are analyzed on the CPU when they are loaded. Other textures need to be analyzed on the GPU.
+            \param[in] pTexture The texture.
+            \return The analysis result, or an empty optional if the texture isn't managed or wasn't analyzed.
+        */
+        std::optional<TextureAnalyzer::Result> getTextureAnalysis(const Texture::SharedPtr& pTexture) const;
+
         /** Get texture desc count.
             \return Number of texture descs.
         */
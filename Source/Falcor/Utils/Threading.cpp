@@ -27,68 +27,358 @@
  **************************************************************************/
 #include "Threading.h"
 #include "Core/Assert.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <vector>
 
 namespace Falcor
 {
+    struct Threading::Task::State
+    {
+        std::atomic<bool> done = false;
+        std::exception_ptr exception;
+    };
+
+    struct Threading::TaskGroup::State
+    {
+        std::atomic<size_t> pendingCount = 0;
+        std::mutex mutex;
+        std::exception_ptr exception;
+    };
+
     namespace
     {
+        /** Time a waiting thread sleeps when there is no pending work to help with.
+        */
+        constexpr auto kWaitInterval = std::chrono::microseconds(100);
+
+        /** Number of chunks per worker used when automatically choosing a grain size in parallelFor.
+        */
+        constexpr size_t kChunksPerWorker = 4;
+
+        using Job = std::function<void(void)>;
+
+        struct Worker
+        {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
         struct ThreadingData
         {
             bool initialized = false;
             std::vector<std::thread> threads;
-            uint32_t current;
+            std::vector<std::unique_ptr<Worker>> workers;
+
+            std::atomic<uint32_t> nextWorker = 0;   ///< Round-robin index for jobs submitted from outside the pool.
+            std::atomic<size_t> queuedCount = 0;    ///< Number of jobs sitting in the deques.
+            std::atomic<size_t> inFlightCount = 0;  ///< Number of jobs dispatched but not yet completed.
+
+            std::mutex sleepMutex;
+            std::condition_variable sleepCondition; ///< Signaled when jobs are queued or the pool terminates.
+            std::condition_variable idleCondition;  ///< Signaled when a job completes.
+            bool terminate = false;
         } gData; // TODO: REMOVEGLOBAL
+
+        thread_local int32_t tWorkerIndex = -1;
+
+        void pushJob(Job job)
+        {
+            FALCOR_ASSERT(gData.initialized);
+
+            gData.inFlightCount++;
+
+            // Workers push onto their own deque, other threads distribute jobs round-robin.
+            const uint32_t workerCount = (uint32_t)gData.workers.size();
+            const uint32_t index = tWorkerIndex >= 0 ? (uint32_t)tWorkerIndex : gData.nextWorker++ % workerCount;
+            {
+                Worker& worker = *gData.workers[index];
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                worker.jobs.push_back(std::move(job));
+            }
+            gData.queuedCount++;
+
+            // Lock the sleep mutex before notifying to avoid a lost wakeup.
+            {
+                std::lock_guard<std::mutex> lock(gData.sleepMutex);
+            }
+            gData.sleepCondition.notify_one();
+        }
+
+        bool popJob(int32_t workerIndex, Job& job)
+        {
+            if (gData.queuedCount == 0) return false;
+
+            const uint32_t workerCount = (uint32_t)gData.workers.size();
+
+            // Take the most recently pushed job from our own deque.
+            if (workerIndex >= 0)
+            {
+                Worker& worker = *gData.workers[workerIndex];
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                if (!worker.jobs.empty())
+                {
+                    job = std::move(worker.jobs.back());
+                    worker.jobs.pop_back();
+                    gData.queuedCount--;
+                    return true;
+                }
+            }
+
+            // Steal the oldest job from another worker.
+            const uint32_t startIndex = workerIndex >= 0 ? (uint32_t)workerIndex + 1 : 0;
+            for (uint32_t i = 0; i < workerCount; ++i)
+            {
+                const uint32_t victimIndex = (startIndex + i) % workerCount;
+                if ((int32_t)victimIndex == workerIndex) continue;
+                Worker& victim = *gData.workers[victimIndex];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.jobs.empty())
+                {
+                    job = std::move(victim.jobs.front());
+                    victim.jobs.pop_front();
+                    gData.queuedCount--;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void runJob(Job& job)
+        {
+            job();
+            job = nullptr;
+
+            if (--gData.inFlightCount == 0)
+            {
+                std::lock_guard<std::mutex> lock(gData.sleepMutex);
+                gData.idleCondition.notify_all();
+            }
+        }
+
+        /** Execute a single pending job on the calling thread.
+            \return True if a job was executed.
+        */
+        bool helpOnce()
+        {
+            if (!gData.initialized) return false;
+
+            Job job;
+            if (!popJob(tWorkerIndex, job)) return false;
+            runJob(job);
+            return true;
+        }
+
+        /** Help executing pending jobs until the predicate is satisfied.
+        */
+        template<typename Pred>
+        void helpUntil(Pred pred)
+        {
+            while (!pred())
+            {
+                if (!helpOnce()) std::this_thread::sleep_for(kWaitInterval);
+            }
+        }
+
+        void workerMain(int32_t workerIndex)
+        {
+            tWorkerIndex = workerIndex;
+
+            while (true)
+            {
+                Job job;
+                if (popJob(workerIndex, job))
+                {
+                    runJob(job);
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(gData.sleepMutex);
+                gData.sleepCondition.wait(lock, []() { return gData.terminate || gData.queuedCount > 0; });
+                if (gData.terminate && gData.queuedCount == 0) break;
+            }
+
+            tWorkerIndex = -1;
+        }
     }
 
     void Threading::start(uint32_t threadCount)
     {
         if (gData.initialized) return;
 
-        gData.threads.resize(threadCount);
+        if (threadCount == 0) threadCount = getLogicalThreadCount();
+
+        gData.terminate = false;
+        gData.workers.resize(threadCount);
+        for (auto& pWorker : gData.workers) pWorker = std::make_unique<Worker>();
+
+        // Mark as initialized before launching threads as the workers access the global state.
         gData.initialized = true;
+
+        gData.threads.reserve(threadCount);
+        for (uint32_t i = 0; i < threadCount; ++i)
+        {
+            gData.threads.emplace_back(workerMain, (int32_t)i);
+        }
     }
 
     void Threading::shutdown()
     {
+        if (!gData.initialized) return;
+
+        finish();
+
+        {
+            std::lock_guard<std::mutex> lock(gData.sleepMutex);
+            gData.terminate = true;
+        }
+        gData.sleepCondition.notify_all();
+
         for (auto& t : gData.threads)
         {
             if (t.joinable()) t.join();
         }
 
+        gData.threads.clear();
+        gData.workers.clear();
         gData.initialized = false;
     }
 
+    bool Threading::isRunning()
+    {
+        return gData.initialized;
+    }
+
+    uint32_t Threading::getWorkerCount()
+    {
+        return gData.initialized ? (uint32_t)gData.workers.size() : 0;
+    }
+
     Threading::Task Threading::dispatchTask(const std::function<void(void)>& func)
     {
-        FALCOR_ASSERT(gData.initialized);
+        auto pState = std::make_shared<Task::State>();
+
+        auto job = [pState, func]()
+        {
+            try
+            {
+                func();
+            }
+            catch (...)
+            {
+                pState->exception = std::current_exception();
+            }
+            pState->done = true;
+        };
 
-        std::thread& t = gData.threads[gData.current];
-        if (t.joinable()) t.join();
-        t = std::thread(func);
-        gData.current = (gData.current + 1) % gData.threads.size();
+        if (gData.initialized) pushJob(std::move(job));
+        else job();
 
-        return Task();
+        return Task(pState);
     }
 
-    void Threading::finish()
+    void Threading::parallelForChunks(size_t begin, size_t end, const std::function<void(size_t, size_t)>& func, size_t grainSize)
     {
-        for (auto& t : gData.threads)
+        if (begin >= end) return;
+
+        const size_t count = end - begin;
+        const size_t workerCount = getWorkerCount();
+        if (grainSize == 0) grainSize = std::max<size_t>(1, count / (std::max<size_t>(1, workerCount) * kChunksPerWorker));
+
+        // Run serially if there is not enough work to split.
+        if (workerCount == 0 || count <= grainSize)
         {
-            if (t.joinable()) t.join();
+            func(begin, end);
+            return;
         }
+
+        TaskGroup group;
+        for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += grainSize)
+        {
+            const size_t chunkEnd = std::min(end, chunkBegin + grainSize);
+            group.run([&func, chunkBegin, chunkEnd]() { func(chunkBegin, chunkEnd); });
+        }
+        group.wait();
     }
 
-    Threading::Task::Task()
+    void Threading::finish()
     {
+        if (!gData.initialized) return;
+        FALCOR_ASSERT_MSG(tWorkerIndex < 0, "Threading::finish() must not be called from a worker thread");
+
+        // Help executing jobs while waiting.
+        while (gData.inFlightCount > 0)
+        {
+            if (helpOnce()) continue;
+
+            std::unique_lock<std::mutex> lock(gData.sleepMutex);
+            gData.idleCondition.wait_for(lock, kWaitInterval, []() { return gData.inFlightCount == 0; });
+        }
     }
 
     bool Threading::Task::isRunning()
     {
-        FALCOR_UNIMPLEMENTED();
+        return mpState && !mpState->done;
     }
 
     void Threading::Task::finish()
     {
-        FALCOR_UNIMPLEMENTED();
+        if (!mpState) return;
+
+        helpUntil([this]() { return mpState->done.load(); });
+
+        if (mpState->exception)
+        {
+            std::exception_ptr exception = mpState->exception;
+            mpState->exception = nullptr;
+            std::rethrow_exception(exception);
+        }
+    }
+
+    Threading::TaskGroup::TaskGroup()
+        : mpState(std::make_shared<State>())
+    {
+    }
+
+    Threading::TaskGroup::~TaskGroup()
+    {
+        // Make sure no task outlives the group. Exceptions are dropped at this point.
+        helpUntil([this]() { return mpState->pendingCount == 0; });
+    }
+
+    void Threading::TaskGroup::run(std::function<void(void)> func)
+    {
+        auto job = [pState = mpState, func = std::move(func)]()
+        {
+            try
+            {
+                func();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(pState->mutex);
+                if (!pState->exception) pState->exception = std::current_exception();
+            }
+            pState->pendingCount--;
+        };
+
+        mpState->pendingCount++;
+        if (gData.initialized) pushJob(std::move(job));
+        else job();
+    }
+
+    void Threading::TaskGroup::wait()
+    {
+        helpUntil([this]() { return mpState->pendingCount == 0; });
+
+        std::exception_ptr exception;
+        {
+            std::lock_guard<std::mutex> lock(mpState->mutex);
+            std::swap(exception, mpState->exception);
+        }
+        if (exception) std::rethrow_exception(exception);
     }
 }
@@ -27,60 +27,137 @@
  **************************************************************************/
 #pragma once
 #include "Core/Macros.h"
+#include <algorithm>
 #include <condition_variable>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <cstdint>
 
 namespace Falcor
 {
+    /** Global work-stealing task scheduler.
+
+        The scheduler owns a fixed set of worker threads, each with its own task deque.
+        Workers execute tasks from the back of their own deque (LIFO) and steal from the
+        front of other workers' deques (FIFO) when they run out of work.
+        Threads waiting on a task or task group help executing pending tasks instead of
+        blocking, so it is safe to dispatch and wait on tasks from within other tasks.
+
+        If the scheduler has not been started, tasks are executed immediately on the calling thread.
+    */
     class FALCOR_API Threading
     {
     public:
-        const static uint32_t kDefaultThreadCount = 16;
-
-        /** Handle to a dispatched task
-
-            TODO: Implementation
+        /** Handle to a dispatched task.
         */
-        class Task
+        class FALCOR_API Task
         {
         public:
+            /** Create an empty task handle. An empty task is never running.
+            */
+            Task() = default;
+
             /** Check if task is still executing
             */
             bool isRunning();
 
-            /** Wait for task to finish executing
+            /** Wait for task to finish executing.
+                The calling thread helps executing other pending tasks while waiting.
+                If the task threw an exception, it is rethrown here.
             */
             void finish();
 
         private:
-            Task();
+            struct State;
+            Task(std::shared_ptr<State> pState) : mpState(std::move(pState)) {}
+            std::shared_ptr<State> mpState;
             friend class Threading;
         };
 
+        /** Group of tasks that can be waited on collectively.
+            The destructor waits for all tasks in the group to finish.
+        */
+        class FALCOR_API TaskGroup
+        {
+        public:
+            TaskGroup();
+            ~TaskGroup();
+
+            TaskGroup(const TaskGroup&) = delete;
+            TaskGroup& operator=(const TaskGroup&) = delete;
+
+            /** Dispatch a task as part of this group.
+                \param[in] func Function to execute.
+            */
+            void run(std::function<void(void)> func);
+
+            /** Wait for all tasks in the group to finish.
+                The calling thread helps executing pending tasks while waiting.
+                If any of the tasks threw an exception, the first one is rethrown here.
+            */
+            void wait();
+
+        private:
+            struct State;
+            std::shared_ptr<State> mpState;
+        };
+
         /** Initializes the global thread pool
-            \param[in] threadCount Number of threads in the pool
+            \param[in] threadCount Number of worker threads in the pool. If zero, the logical thread count is used.
         */
-        static void start(uint32_t threadCount = kDefaultThreadCount);
+        static void start(uint32_t threadCount = 0);
 
-        /** Waits for all currently executing threads to finish
+        /** Waits for all currently dispatched tasks to finish
         */
         static void finish();
 
-        /** Waits for all currently executing threads to finish and shuts down the thread pool
+        /** Waits for all currently dispatched tasks to finish and shuts down the thread pool
         */
         static void shutdown();
 
+        /** Returns true if the thread pool is running.
+        */
+        static bool isRunning();
+
+        /** Returns the number of worker threads in the pool, or zero if the pool is not running.
+        */
+        static uint32_t getWorkerCount();
+
         /** Returns the maximum number of concurrent threads supported by the hardware
         */
-        static uint32_t getLogicalThreadCount() { return std::thread::hardware_concurrency(); }
+        static uint32_t getLogicalThreadCount() { return std::max(1u, std::thread::hardware_concurrency()); }
 
         /** Starts a task on an available thread.
             \return Handle to the task
         */
         static Task dispatchTask(const std::function<void(void)>& func);
+
+        /** Execute a function for each index in [begin, end) in parallel.
+            The range is split into chunks that are distributed over the thread pool.
+            The calling thread participates in the work and the call returns once all indices have been processed.
+            \param[in] begin First index.
+            \param[in] end One past the last index.
+            \param[in] func Function called as func(i) for each index i.
+            \param[in] grainSize Minimum number of indices per chunk. If zero, a grain size is chosen automatically.
+        */
+        template<typename Func>
+        static void parallelFor(size_t begin, size_t end, Func&& func, size_t grainSize = 0)
+        {
+            parallelForChunks(begin, end, [&func](size_t chunkBegin, size_t chunkEnd)
+            {
+                for (size_t i = chunkBegin; i < chunkEnd; ++i) func(i);
+            }, grainSize);
+        }
+
+        /** Execute a function for chunks of the index range [begin, end) in parallel.
+            \param[in] begin First index.
+            \param[in] end One past the last index.
+            \param[in] func Function called as func(chunkBegin, chunkEnd) for each chunk.
+            \param[in] grainSize Minimum number of indices per chunk. If zero, a grain size is chosen automatically.
+        */
+        static void parallelForChunks(size_t begin, size_t end, const std::function<void(size_t, size_t)>& func, size_t grainSize = 0);
     };
 
     /** Simple thread barrier class.
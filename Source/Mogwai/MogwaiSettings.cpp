@@ -230,9 +230,24 @@ namespace Mogwai
                 << "Program kernels time (total): " << s.programKernelsTotalTime << " s" << std::endl
                 << "Program version time (max): " << s.programVersionMaxTime << " s" << std::endl
                 << "Program kernels time (max): " << s.programKernelsMaxTime << " s" << std::endl;
+            if (auto pCache = Program::getShaderCache())
+            {
+                const auto cs = pCache->getStats();
+                oss << "Shader cache hits/misses: " << cs.hitCount << " / " << cs.missCount << std::endl
+                    << "Shader cache time saved: " << cs.timeSaved << " s" << std::endl
+                    << "Shader cache size: " << pCache->getSize() / (1024 * 1024) << " MB (" << pCache->getEntryCount() << " kernels)" << std::endl;
+            }
+            else
+            {
+                oss << "Shader cache: disabled (requires the D3D12 backend)" << std::endl;
+            }
             g.text(oss.str());
 
-            if (g.button("Reset")) Program::resetGlobalCompilationStats();
+            if (g.button("Reset"))
+            {
+                Program::resetGlobalCompilationStats();
+                if (auto pCache = Program::getShaderCache()) pCache->resetStats();
+            }
         }
 
         // Scene UI
@@ -0,0 +1,114 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "FalcorBenchmark.h"
+#include "Rendering/Lights/LightBVHBuilder.h"
+#include <random>
+
+namespace
+{
+    const uint64_t kTriangleCounts[] = { 10000, 100000, 1000000, 10000000 };
+
+    // Number of triangles per synthetic emissive mesh.
+    const uint32_t kTrianglesPerMesh = 2 * 64 * 64;
+
+    /** Generates synthetic emissive meshes. Each mesh is a tessellated quad with random placement,
+        orientation, size and flux, so the triangles form spatially coherent clusters like in real scenes.
+    */
+    std::vector<LightCollection::MeshLightTriangle> generateTriangles(uint64_t triangleCount)
+    {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> u(0.f, 1.f);
+        auto randomDirection = [&]()
+        {
+            float z = 1.f - 2.f * u(rng);
+            float r = std::sqrt(std::max(0.f, 1.f - z * z));
+            float phi = glm::two_pi<float>() * u(rng);
+            return float3(r * std::cos(phi), r * std::sin(phi), z);
+        };
+
+        std::vector<LightCollection::MeshLightTriangle> triangles(triangleCount);
+        for (uint64_t meshStart = 0; meshStart < triangleCount; meshStart += kTrianglesPerMesh)
+        {
+            const float3 origin = float3(u(rng), u(rng), u(rng)) * 100.f;
+            const float3 normal = randomDirection();
+            const float3 tangent = glm::normalize(glm::cross(normal, std::abs(normal.x) < 0.9f ? float3(1.f, 0.f, 0.f) : float3(0.f, 1.f, 0.f)));
+            const float3 bitangent = glm::cross(normal, tangent);
+            const float cellSize = 0.01f + 0.1f * u(rng);
+            const float radiance = u(rng) < 0.1f ? 0.f : 10.f * u(rng);
+
+            const uint64_t meshEnd = std::min(meshStart + kTrianglesPerMesh, triangleCount);
+            for (uint64_t i = meshStart; i < meshEnd; ++i)
+            {
+                const uint32_t cell = (uint32_t)(i - meshStart) / 2;
+                const float3 corner = origin + (float)(cell % 64) * cellSize * tangent + (float)(cell / 64) * cellSize * bitangent;
+                auto& tri = triangles[i];
+                tri.vtx[0].pos = corner;
+                tri.vtx[1].pos = corner + cellSize * ((i & 1) ? bitangent : tangent);
+                tri.vtx[2].pos = corner + cellSize * (tangent + bitangent);
+                tri.normal = (i & 1) ? -normal : normal;
+                tri.area = 0.5f * cellSize * cellSize;
+                tri.averageRadiance = float3(radiance);
+                tri.flux = radiance * tri.area * glm::pi<float>();
+                tri.lightIdx = (uint32_t)(meshStart / kTrianglesPerMesh);
+            }
+        }
+        return triangles;
+    }
+}
+
+BENCHMARK(LightBVHBuilder)
+{
+    const std::pair<LightBVHBuilder::SplitHeuristic, const char*> heuristics[] =
+    {
+        { LightBVHBuilder::SplitHeuristic::Equal, "Equal" },
+        { LightBVHBuilder::SplitHeuristic::BinnedSAH, "BinnedSAH" },
+        { LightBVHBuilder::SplitHeuristic::BinnedSAOH, "BinnedSAOH" },
+    };
+
+    for (uint64_t triangleCount : kTriangleCounts)
+    {
+        if (triangleCount > ctx.getMaxProblemSize()) break;
+
+        const auto triangles = generateTriangles(triangleCount);
+        for (const auto& [heuristic, heuristicName] : heuristics)
+        {
+            LightBVHBuilder::Options options;
+            options.splitHeuristicSelection = heuristic;
+            auto pBuilder = LightBVHBuilder::create(options);
+
+            std::vector<PackedNode> nodes;
+            std::vector<uint32_t> triangleIndices;
+            std::vector<uint64_t> triangleBitmasks;
+            ctx.measure(std::to_string(triangleCount) + " triangles, " + heuristicName, [&]()
+            {
+                pBuilder->buildCPU(triangles, nodes, triangleIndices, triangleBitmasks);
+            }, triangleCount);
+            ctx.report("  node count", std::to_string(nodes.size()));
+        }
+    }
+}
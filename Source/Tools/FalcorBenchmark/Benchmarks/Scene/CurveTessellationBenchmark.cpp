@@ -0,0 +1,101 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "FalcorBenchmark.h"
+#include "Scene/Curves/CurveTessellation.h"
+#include <cmath>
+#include <random>
+
+namespace
+{
+    const uint32_t kStrandCounts[] = { 100000, 1000000, 5000000 };
+    const uint32_t kVertexCountPerStrand = 8;
+    const uint32_t kSubdivPerSegment = 2;
+
+    // Polytubes have 4 vertices per tessellated point, which exceeds the memory of typical machines for the largest strand counts.
+    const uint32_t kMaxPolytubeStrandCount = 1000000;
+
+    struct Hair
+    {
+        std::vector<uint32_t> vertexCounts;
+        std::vector<float3> controlPoints;
+        std::vector<float> widths;
+        std::vector<float2> UVs;
+    };
+
+    /** Generates wavy strands rooted on a unit square.
+    */
+    Hair generateHair(uint32_t strandCount)
+    {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> u(0.f, 1.f);
+
+        Hair hair;
+        hair.vertexCounts.assign(strandCount, kVertexCountPerStrand);
+        hair.controlPoints.reserve((size_t)strandCount * kVertexCountPerStrand);
+        hair.widths.reserve((size_t)strandCount * kVertexCountPerStrand);
+        hair.UVs.reserve((size_t)strandCount * kVertexCountPerStrand);
+        for (uint32_t i = 0; i < strandCount; ++i)
+        {
+            const float2 root(u(rng), u(rng));
+            const float phase = 6.f * u(rng);
+            for (uint32_t j = 0; j < kVertexCountPerStrand; ++j)
+            {
+                const float h = 0.02f * j;
+                hair.controlPoints.push_back(float3(root.x + 0.005f * std::sin(phase + j), h, root.y + 0.005f * std::cos(phase + j)));
+                hair.widths.push_back(0.001f * (1.f - 0.5f * j / kVertexCountPerStrand));
+                hair.UVs.push_back(root);
+            }
+        }
+        return hair;
+    }
+}
+
+BENCHMARK(CurveTessellation)
+{
+    for (uint32_t strandCount : kStrandCounts)
+    {
+        if ((uint64_t)strandCount * kVertexCountPerStrand > ctx.getMaxProblemSize()) break;
+
+        const Hair hair = generateHair(strandCount);
+        const std::string suffix = fmt::format("({} strands)", strandCount);
+
+        ctx.measure("convertToLinearSweptSphere " + suffix, [&]()
+        {
+            CurveTessellation::convertToLinearSweptSphere(strandCount, hair.vertexCounts.data(), hair.controlPoints.data(), hair.widths.data(), hair.UVs.data(),
+                1, kSubdivPerSegment, 1, 1, 1.f, rmcv::identity<rmcv::mat4>());
+        }, strandCount);
+
+        if (strandCount > kMaxPolytubeStrandCount) continue;
+
+        ctx.measure("convertToPolytube " + suffix, [&]()
+        {
+            CurveTessellation::convertToPolytube(strandCount, hair.vertexCounts.data(), hair.controlPoints.data(), hair.widths.data(), hair.UVs.data(),
+                kSubdivPerSegment, 1, 1, 1.f, 4);
+        }, strandCount);
+    }
+}
@@ -0,0 +1,106 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "FalcorBenchmark.h"
+#include "Scene/Importers/PBRTImporter/LoopSubdivide.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+    const uint32_t kMaxLevels = 4;
+    const uint32_t kMaxGridSize = 256;
+
+    struct Mesh
+    {
+        std::vector<float3> positions;
+        std::vector<uint32_t> indices;
+    };
+
+    /** Generates a wavy grid with jittered vertices, random diagonals and holes, so that it has both
+        irregular interior vertices and boundaries like typical loopsubdiv control meshes.
+    */
+    Mesh generateMesh(uint32_t gridSize)
+    {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> u(-0.2f, 0.2f);
+
+        Mesh mesh;
+        for (uint32_t y = 0; y <= gridSize; ++y)
+        {
+            for (uint32_t x = 0; x <= gridSize; ++x) mesh.positions.push_back(float3(x + u(rng), y + u(rng), std::sin(0.3f * x) + u(rng)));
+        }
+
+        std::vector<uint32_t> indices;
+        for (uint32_t y = 0; y < gridSize; ++y)
+        {
+            for (uint32_t x = 0; x < gridSize; ++x)
+            {
+                if (rng() % 8 == 0) continue;
+                const uint32_t i = y * (gridSize + 1) + x;
+                if (rng() % 2 == 0) indices.insert(indices.end(), { i, i + 1, i + gridSize + 2, i, i + gridSize + 2, i + gridSize + 1 });
+                else indices.insert(indices.end(), { i, i + 1, i + gridSize + 1, i + 1, i + gridSize + 2, i + gridSize + 1 });
+            }
+        }
+
+        // Remove vertices not referenced by any face.
+        std::vector<uint32_t> remap(mesh.positions.size(), uint32_t(-1));
+        std::vector<float3> positions;
+        for (uint32_t& index : indices)
+        {
+            if (remap[index] == uint32_t(-1))
+            {
+                remap[index] = (uint32_t)positions.size();
+                positions.push_back(mesh.positions[index]);
+            }
+            index = remap[index];
+        }
+        mesh.positions = std::move(positions);
+        mesh.indices = std::move(indices);
+        return mesh;
+    }
+}
+
+BENCHMARK(LoopSubdivide)
+{
+    // Size the control mesh so that the finest level fits in the problem size.
+    const uint64_t maxTriangles = std::max<uint64_t>(ctx.getMaxProblemSize() >> (2 * kMaxLevels), 32);
+    const uint32_t gridSize = std::min(kMaxGridSize, (uint32_t)std::sqrt(maxTriangles / 2.0));
+    const Mesh mesh = generateMesh(gridSize);
+    ctx.report("control vertices", std::to_string(mesh.positions.size()));
+    ctx.report("control triangles", std::to_string(mesh.indices.size() / 3));
+
+    for (uint32_t levels = 1; levels <= kMaxLevels; ++levels)
+    {
+        const uint64_t triangleCount = (mesh.indices.size() / 3) << (2 * levels);
+        ctx.measure(fmt::format("level {}", levels), [&]()
+        {
+            pbrt::loopSubdivide(levels, mesh.positions, mesh.indices);
+        }, triangleCount);
+    }
+}
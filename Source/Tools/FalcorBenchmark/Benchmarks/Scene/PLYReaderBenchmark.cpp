@@ -0,0 +1,141 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "FalcorBenchmark.h"
+#include "Scene/Importers/PBRTImporter/PLYReader.h"
+#include "Scene/TriangleMesh.h"
+#include "Utils/Threading.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace
+{
+    // Synthetic data set used if no data directory is given.
+    const uint32_t kFileCount = 64;
+    const uint32_t kGridSize = 256;
+
+    /** Write a binary little endian PLY file containing a grid of quads with normals and texture coordinates.
+    */
+    void writeGridPLY(const std::filesystem::path& path, uint32_t gridSize, float offset)
+    {
+        const uint32_t vertexCount = (gridSize + 1) * (gridSize + 1);
+        const uint32_t faceCount = gridSize * gridSize;
+
+        std::ofstream file(path, std::ios::binary);
+        file << "ply\n"
+            << "format binary_little_endian 1.0\n"
+            << "element vertex " << vertexCount << "\n"
+            << "property float x\nproperty float y\nproperty float z\n"
+            << "property float nx\nproperty float ny\nproperty float nz\n"
+            << "property float u\nproperty float v\n"
+            << "element face " << faceCount << "\n"
+            << "property list uchar int vertex_indices\n"
+            << "end_header\n";
+
+        for (uint32_t y = 0; y <= gridSize; ++y)
+        {
+            for (uint32_t x = 0; x <= gridSize; ++x)
+            {
+                const float u = (float)x / gridSize, v = (float)y / gridSize;
+                const float vertex[8] = { u, v, offset + 0.1f * std::sin(10.f * u), 0.f, 0.f, 1.f, u, v };
+                file.write(reinterpret_cast<const char*>(vertex), sizeof(vertex));
+            }
+        }
+
+        for (uint32_t y = 0; y < gridSize; ++y)
+        {
+            for (uint32_t x = 0; x < gridSize; ++x)
+            {
+                const uint8_t count = 4;
+                const int32_t i = y * (gridSize + 1) + x;
+                const int32_t quad[4] = { i, i + 1, i + (int32_t)gridSize + 2, i + (int32_t)gridSize + 1 };
+                file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+                file.write(reinterpret_cast<const char*>(quad), sizeof(quad));
+            }
+        }
+    }
+
+    std::vector<std::filesystem::path> findPLYFiles(const std::filesystem::path& directory)
+    {
+        std::vector<std::filesystem::path> paths;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+        {
+            if (!entry.is_regular_file()) continue;
+            const auto& path = entry.path();
+            if (hasExtension(path, "ply") || (hasExtension(path, "gz") && hasExtension(path.stem(), "ply"))) paths.push_back(path);
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+}
+
+BENCHMARK(PLYReader)
+{
+    // Use the PLY files from the data directory or generate a synthetic data set.
+    std::filesystem::path directory = ctx.getDataDirectory();
+    bool isSynthetic = directory.empty();
+    if (isSynthetic)
+    {
+        directory = std::filesystem::temp_directory_path() / "FalcorBenchmarkPLY";
+        std::filesystem::create_directories(directory);
+        const uint64_t triangleCount = 2ull * kGridSize * kGridSize;
+        const uint32_t fileCount = (uint32_t)std::clamp<uint64_t>(ctx.getMaxProblemSize() / triangleCount, 1, kFileCount);
+        for (uint32_t i = 0; i < fileCount; ++i) writeGridPLY(directory / fmt::format("grid{}.ply", i), kGridSize, (float)i);
+    }
+
+    const auto paths = findPLYFiles(directory);
+    if (paths.empty()) throw RuntimeError("No PLY files found in '{}'.", directory);
+
+    uint64_t triangleCount = 0;
+    uint64_t fileSize = 0;
+    for (const auto& path : paths)
+    {
+        triangleCount += pbrt::loadPLY(path).indices.size() / 3;
+        fileSize += std::filesystem::file_size(path);
+    }
+    ctx.report("files", std::to_string(paths.size()));
+    ctx.report("triangles", std::to_string(triangleCount));
+    ctx.report("file size (MB)", fmt::format("{:.1f}", fileSize / (1024.0 * 1024.0)));
+
+    ctx.measure("Assimp (TriangleMesh::createFromFile)", [&]()
+    {
+        for (const auto& path : paths) TriangleMesh::createFromFile(path);
+    }, triangleCount);
+
+    ctx.measure("loadPLY (single thread)", [&]()
+    {
+        for (const auto& path : paths) pbrt::loadPLY(path);
+    }, triangleCount);
+
+    ctx.measure("loadPLY (parallel)", [&]()
+    {
+        Threading::parallelFor(0, paths.size(), [&](size_t i) { pbrt::loadPLY(paths[i]); }, 1);
+    }, triangleCount);
+
+    if (isSynthetic) std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,126 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "FalcorBenchmark.h"
+#include "Scene/SDFs/SDFBrickFile.h"
+#include "Scene/SDFs/SDFValueProcessor.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Threading.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+
+namespace
+{
+    const uint32_t kMaxGridWidth = 512;
+    const uint32_t kBrickWidth = 8;
+
+    /** Corner values of a box with spherical holes in the [-0.5, 0.5]^3 grid.
+    */
+    std::vector<float> createSyntheticValues(uint32_t gridWidth)
+    {
+        const uint32_t w = gridWidth + 1;
+        std::vector<float> values((size_t)w * w * w);
+        Threading::parallelFor(0, w, [&](size_t z)
+        {
+            for (uint32_t y = 0; y < w; ++y)
+            {
+                for (uint32_t x = 0; x < w; ++x)
+                {
+                    const float px = (float)x / gridWidth - 0.5f, py = (float)y / gridWidth - 0.5f, pz = (float)z / gridWidth - 0.5f;
+                    const float box = std::max(std::max(std::abs(px), std::abs(py)), std::abs(pz)) - 0.4f;
+                    const float hole = 0.15f - std::sqrt((px - 0.2f) * (px - 0.2f) + py * py + (pz + 0.1f) * (pz + 0.1f));
+                    values[x + w * (y + w * z)] = std::max(box, hole);
+                }
+            }
+        });
+        return values;
+    }
+
+    /** Scalar reference matching the per-value loops previously used by the SDF grid implementations.
+    */
+    void quantizeScalar(const std::vector<float>& values, float scale, std::vector<int16_t>& dst)
+    {
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            float normalizedValue = std::clamp(values[i] * scale, -1.f, 1.f);
+            float integerScale = normalizedValue * float(INT16_MAX);
+            dst[i] = integerScale >= 0.f ? int16_t(integerScale + 0.5f) : int16_t(integerScale - 0.5f);
+        }
+    }
+}
+
+BENCHMARK(SDFValueProcessor)
+{
+    // Pick the largest power-of-two grid that fits in the problem size.
+    uint32_t gridWidth = 32;
+    while (gridWidth < kMaxGridWidth && std::pow(2.0 * gridWidth + 1.0, 3.0) <= (double)ctx.getMaxProblemSize()) gridWidth *= 2;
+
+    const auto values = createSyntheticValues(gridWidth);
+    const uint32_t brickGridWidth = SDFValueProcessor::getBrickGridWidth(gridWidth, kBrickWidth);
+    ctx.report("grid width", std::to_string(gridWidth));
+    ctx.report("values", std::to_string(values.size()));
+
+    std::vector<int16_t> quantized(values.size());
+    std::vector<SDFValueProcessor::BrickRange> ranges((size_t)brickGridWidth * brickGridWidth * brickGridWidth);
+
+    ctx.measure("quantize (scalar reference)", [&]()
+    {
+        quantizeScalar(values, 1.f, quantized);
+    }, values.size());
+
+    ctx.measure("quantize (SDFValueProcessor)", [&]()
+    {
+        SDFValueProcessor::quantize(values.data(), values.size(), 1.f, quantized.data());
+    }, values.size());
+
+    ctx.measure("brick ranges", [&]()
+    {
+        SDFValueProcessor::processBricks(values.data(), gridWidth, kBrickWidth, 0, brickGridWidth, ranges.data());
+    }, values.size());
+
+    ctx.measure("brick ranges + quantize", [&]()
+    {
+        SDFValueProcessor::processBricks(values.data(), gridWidth, kBrickWidth, 0, brickGridWidth, ranges.data(), 1.f, quantized.data());
+    }, values.size());
+
+    SDFBrickFile::Desc desc;
+    desc.gridWidth = gridWidth;
+    desc.brickWidth = kBrickWidth;
+
+    const float narrowBandDistance = SDFBrickFile::getNarrowBandDistance(desc);
+    const size_t narrowBandBricks = std::count_if(ranges.begin(), ranges.end(), [&](const auto& range) { return range.isNarrowBand(narrowBandDistance); });
+    ctx.report("narrow band bricks", fmt::format("{} / {}", narrowBandBricks, ranges.size()));
+
+    const std::filesystem::path path = getTempFilePath();
+    ctx.measure("SDFBrickFile::write", [&]()
+    {
+        SDFBrickFile::write(path, values, desc);
+    }, values.size());
+    ctx.report("file size (MB)", fmt::format("{:.1f}", std::filesystem::file_size(path) / (1024.0 * 1024.0)));
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,170 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "FalcorBenchmark.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <args.hxx>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <vector>
+
+namespace
+{
+    struct Benchmark
+    {
+        std::filesystem::path path;
+        std::string name;
+        BenchmarkFunc func;
+    };
+
+    std::vector<Benchmark>& getBenchmarks()
+    {
+        static std::vector<Benchmark> benchmarks;
+        return benchmarks;
+    }
+}
+
+void BenchmarkContext::measure(const std::string& label, const std::function<void()>& func, uint64_t itemCount)
+{
+    double minTime = std::numeric_limits<double>::max();
+    double totalTime = 0.0;
+    for (uint32_t i = 0; i < mRepeatCount; ++i)
+    {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        func();
+        double time = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        minTime = std::min(minTime, time);
+        totalTime += time;
+    }
+    double meanTime = totalTime / mRepeatCount;
+
+    mStream << "  " << std::left << std::setw(48) << label << std::right << std::fixed << std::setprecision(3)
+        << " min " << std::setw(12) << minTime << " ms"
+        << "  mean " << std::setw(12) << meanTime << " ms";
+    if (itemCount > 0 && minTime > 0.0)
+    {
+        mStream << "  " << std::setw(10) << std::setprecision(2) << (itemCount / (minTime * 1e3)) << " M items/s";
+    }
+    mStream << std::endl;
+}
+
+void BenchmarkContext::report(const std::string& label, const std::string& value)
+{
+    mStream << "  " << std::left << std::setw(48) << label << std::right << " " << value << std::endl;
+}
+
+void registerBenchmark(const std::filesystem::path& path, const std::string& name, BenchmarkFunc func)
+{
+    getBenchmarks().push_back({ path, name, std::move(func) });
+}
+
+int main(int argc, char** argv)
+{
+    args::ArgumentParser parser("Falcor CPU benchmarks.");
+    parser.helpParams.programName = "FalcorBenchmark";
+    args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
+    args::ValueFlag<std::string> filterFlag(parser, "filter", "Regular expression for filtering benchmarks to run.", {'f', "filter"});
+    args::ValueFlag<uint32_t> repeatFlag(parser, "N", "Number of times to repeat each measurement.", {'r', "repeat"});
+    args::ValueFlag<uint64_t> maxSizeFlag(parser, "N", "Maximum problem size (e.g. triangle count) to benchmark.", {'s', "max-size"});
+    args::ValueFlag<std::string> dataDirFlag(parser, "path", "Directory with input data for benchmarks working on files.", {'d', "data-dir"});
+    args::Flag listFlag(parser, "", "List available benchmarks.", {'l', "list"});
+    args::CompletionFlag completionFlag(parser, {"complete"});
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+    }
+    catch (const args::Completion& e)
+    {
+        std::cout << e.what();
+        return 0;
+    }
+    catch (const args::Help&)
+    {
+        std::cout << parser;
+        return 0;
+    }
+    catch (const args::ParseError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+    catch (const args::RequiredError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    auto benchmarks = getBenchmarks();
+    std::sort(benchmarks.begin(), benchmarks.end(), [](const Benchmark& a, const Benchmark& b) { return a.name < b.name; });
+
+    if (filterFlag)
+    {
+        std::regex filterRegex(args::get(filterFlag));
+        benchmarks.erase(std::remove_if(benchmarks.begin(), benchmarks.end(), [&](const Benchmark& b) { return !std::regex_search(b.name, filterRegex); }), benchmarks.end());
+    }
+
+    if (listFlag)
+    {
+        for (const auto& b : benchmarks) std::cout << b.name << " (" << b.path.filename().string() << ")" << std::endl;
+        return 0;
+    }
+
+    // Disable logging to console, we don't want to clutter the benchmark output with log messages.
+    Logger::setOutputs(Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow);
+
+    Threading::start();
+
+    BenchmarkContext ctx(std::cout, repeatFlag ? std::max(args::get(repeatFlag), 1u) : 3, maxSizeFlag ? args::get(maxSizeFlag) : std::numeric_limits<uint64_t>::max(),
+        dataDirFlag ? std::filesystem::path(args::get(dataDirFlag)) : std::filesystem::path());
+
+    int returnCode = 0;
+    for (const auto& b : benchmarks)
+    {
+        std::cout << b.name << " (" << b.path.filename().string() << ")" << std::endl;
+        try
+        {
+            b.func(ctx);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "  Benchmark failed: " << e.what() << std::endl;
+            returnCode = 1;
+        }
+    }
+
+    Threading::shutdown();
+
+    return returnCode;
+}
@@ -0,0 +1,93 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Falcor.h"
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <ostream>
+#include <string>
+
+using namespace Falcor;
+
+/** Context passed to each benchmark for timing code and reporting the results.
+*/
+class BenchmarkContext
+{
+public:
+    BenchmarkContext(std::ostream& stream, uint32_t repeatCount, uint64_t maxProblemSize, const std::filesystem::path& dataDirectory)
+        : mStream(stream)
+        , mRepeatCount(repeatCount)
+        , mMaxProblemSize(maxProblemSize)
+        , mDataDirectory(dataDirectory)
+    {}
+
+    /** Returns the maximum problem size (e.g. number of triangles) benchmarks should use.
+    */
+    uint64_t getMaxProblemSize() const { return mMaxProblemSize; }
+
+    /** Returns the directory with input data for benchmarks working on files, or an empty path if not specified.
+        Benchmarks should fall back to generating synthetic input data if no directory is given.
+    */
+    const std::filesystem::path& getDataDirectory() const { return mDataDirectory; }
+
+    /** Time a function and report the result.
+        The function is run repeatCount times and the min and mean time is reported.
+        \param[in] label Label of the measurement.
+        \param[in] func Function to time.
+        \param[in] itemCount Number of items processed per call, used for reporting the throughput. Zero disables reporting the throughput.
+    */
+    void measure(const std::string& label, const std::function<void()>& func, uint64_t itemCount = 0);
+
+    /** Report an additional value along with the measurements.
+    */
+    void report(const std::string& label, const std::string& value);
+
+private:
+    std::ostream& mStream;
+    uint32_t mRepeatCount;
+    uint64_t mMaxProblemSize;
+    std::filesystem::path mDataDirectory;
+};
+
+using BenchmarkFunc = std::function<void(BenchmarkContext& ctx)>;
+
+void registerBenchmark(const std::filesystem::path& path, const std::string& name, BenchmarkFunc func);
+
+/** Macro to define a CPU benchmark. The macro works in the same way as CPU_TEST().
+*/
+#define BENCHMARK(name)                                                         \
+    static void Benchmark##name(BenchmarkContext& ctx);                         \
+    struct BenchmarkRegisterer##name {                                          \
+        BenchmarkRegisterer##name()                                             \
+        {                                                                       \
+            std::filesystem::path path = __FILE__;                              \
+            registerBenchmark(path, #name, Benchmark##name);                    \
+        }                                                                       \
+    } RegisterBenchmark##name;                                                  \
+    static void Benchmark##name(BenchmarkContext& ctx) /* over to the user for the braces */
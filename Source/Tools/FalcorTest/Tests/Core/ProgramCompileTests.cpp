@@ -0,0 +1,129 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include <chrono>
+
+namespace Falcor
+{
+    namespace
+    {
+        const std::filesystem::path kShaderFile = "Tests/Core/ProgramCompileTests.cs.slang";
+        const uint32_t kNumElems = 256;
+        const uint32_t kVersionCount = 4;
+
+        Program::DefineList getValueDefines(uint32_t value)
+        {
+            Program::DefineList defines;
+            defines.add("VALUE", std::to_string(value));
+            return defines;
+        }
+    }
+
+    GPU_TEST(ProgramCompileVersionAsync)
+    {
+        ctx.createProgram(kShaderFile, "main", Program::DefineList(), Shader::CompilerFlags::None, "", false);
+        ComputeProgram* pProgram = ctx.getProgram();
+
+        std::vector<std::shared_future<ProgramVersion::SharedConstPtr>> futures;
+        for (uint32_t i = 0; i < kVersionCount; i++) futures.push_back(pProgram->compileVersionAsync(getValueDefines(i + 1)));
+
+        // Requesting a version again returns the pending or compiled version.
+        EXPECT(pProgram->compileVersionAsync(getValueDefines(1)).get() == futures[0].get());
+
+        for (uint32_t i = 0; i < kVersionCount; i++)
+        {
+            ProgramVersion::SharedConstPtr pVersion = futures[i].get();
+            EXPECT(pVersion != nullptr);
+            if (!pVersion) continue;
+            EXPECT(pVersion->getDefines() == getValueDefines(i + 1));
+
+            // Selecting the defines switches to the compiled version.
+            pProgram->setDefines(getValueDefines(i + 1));
+            EXPECT(pProgram->getActiveVersion() == pVersion);
+
+            ctx.createVars();
+            ctx.allocateStructuredBuffer("result", kNumElems);
+            ctx.runProgram(kNumElems, 1, 1);
+
+            const uint32_t* result = ctx.mapBuffer<const uint32_t>("result");
+            for (uint32_t j = 0; j < kNumElems; j++)
+            {
+                EXPECT_EQ(result[j], (i + 1) * j) << "version " << i << ", element " << j;
+            }
+            ctx.unmapBuffer("result");
+        }
+    }
+
+    GPU_TEST(ProgramCompileVersionsAsync)
+    {
+        std::vector<Program::SharedPtr> programs;
+        for (uint32_t i = 0; i < kVersionCount; i++)
+        {
+            programs.push_back(ComputeProgram::createFromFile(kShaderFile, "main", getValueDefines(i + 1)));
+        }
+
+        auto futures = Program::compileVersionsAsync(programs);
+        EXPECT_EQ(futures.size(), programs.size());
+
+        // Without background compilation the versions are compiled before returning.
+        if (!Program::isBackgroundCompilationSupported())
+        {
+            for (const auto& future : futures) EXPECT(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+        }
+
+        for (size_t i = 0; i < futures.size(); i++)
+        {
+            ProgramVersion::SharedConstPtr pVersion = futures[i].get();
+            EXPECT(pVersion != nullptr);
+            EXPECT(programs[i]->getActiveVersion() == pVersion);
+        }
+    }
+
+    GPU_TEST(ProgramCompileVersionAsyncError)
+    {
+        auto pProgram = ComputeProgram::createFromFile(kShaderFile, "main");
+
+        Program::DefineList defines;
+        defines.add("COMPILE_ERROR", "1");
+        auto future = pProgram->compileVersionAsync(defines);
+
+        bool caught = false;
+        try
+        {
+            future.get();
+        }
+        catch (const RuntimeError&)
+        {
+            caught = true;
+        }
+        EXPECT(caught);
+
+        // The program is still usable with other defines.
+        EXPECT(pProgram->compileVersionAsync(getValueDefines(2)).get() != nullptr);
+    }
+}
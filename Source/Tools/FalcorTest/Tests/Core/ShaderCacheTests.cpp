@@ -0,0 +1,157 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Program/ShaderCache.h"
+#include <filesystem>
+#include <numeric>
+
+namespace Falcor
+{
+    namespace
+    {
+        ShaderCache::Key makeKey(uint32_t i)
+        {
+            return SHA1::compute(&i, sizeof(i));
+        }
+
+        std::vector<uint8_t> makeData(size_t size, uint8_t seed)
+        {
+            std::vector<uint8_t> data(size);
+            std::iota(data.begin(), data.end(), seed);
+            return data;
+        }
+
+        std::filesystem::path getTestDirectory()
+        {
+            auto path = std::filesystem::temp_directory_path() / "FalcorShaderCacheTest";
+            std::filesystem::remove_all(path);
+            return path;
+        }
+    }
+
+    CPU_TEST(ShaderCache_PutGet)
+    {
+        auto directory = getTestDirectory();
+        {
+            auto pCache = ShaderCache::create(directory);
+            EXPECT_EQ(pCache->getEntryCount(), 0);
+
+            EXPECT(!pCache->get(makeKey(0)));
+            auto data = makeData(1000, 3);
+            pCache->put(makeKey(0), data.data(), data.size(), 2.0);
+            EXPECT_EQ(pCache->getEntryCount(), 1);
+
+            auto result = pCache->get(makeKey(0));
+            EXPECT(result && *result == data);
+            EXPECT(!pCache->get(makeKey(1)));
+
+            auto stats = pCache->getStats();
+            EXPECT_EQ(stats.hitCount, 1);
+            EXPECT_EQ(stats.missCount, 2);
+            EXPECT_EQ(stats.timeSaved, 2.0);
+        }
+
+        // Entries persist across instances.
+        {
+            auto pCache = ShaderCache::create(directory);
+            EXPECT_EQ(pCache->getEntryCount(), 1);
+            auto result = pCache->get(makeKey(0));
+            EXPECT(result && *result == makeData(1000, 3));
+
+            pCache->clear();
+            EXPECT_EQ(pCache->getEntryCount(), 0);
+            EXPECT_EQ(pCache->getSize(), 0);
+            EXPECT(!pCache->get(makeKey(0)));
+        }
+
+        std::filesystem::remove_all(directory);
+    }
+
+    CPU_TEST(ShaderCache_SharedDirectory)
+    {
+        auto directory = getTestDirectory();
+        auto pCacheA = ShaderCache::create(directory);
+        auto pCacheB = ShaderCache::create(directory);
+
+        // Entries written by another instance after creation are found on disk.
+        auto data = makeData(1000, 7);
+        pCacheB->put(makeKey(0), data.data(), data.size(), 1.0);
+        EXPECT_EQ(pCacheA->getEntryCount(), 0);
+
+        auto result = pCacheA->get(makeKey(0));
+        EXPECT(result && *result == data);
+        EXPECT_EQ(pCacheA->getEntryCount(), 1);
+        EXPECT_EQ(pCacheA->getSize(), pCacheB->getSize());
+        EXPECT_EQ(pCacheA->getStats().hitCount, 1);
+
+        // Entries removed by another instance are dropped from the index.
+        pCacheB->clear();
+        EXPECT(!pCacheA->get(makeKey(0)));
+        EXPECT_EQ(pCacheA->getEntryCount(), 0);
+        EXPECT_EQ(pCacheA->getSize(), 0);
+
+        pCacheA.reset();
+        pCacheB.reset();
+        std::filesystem::remove_all(directory);
+    }
+
+    CPU_TEST(ShaderCache_Eviction)
+    {
+        auto directory = getTestDirectory();
+        auto pCache = ShaderCache::create(directory);
+
+        // Fill the cache and then shrink it to fit about half of the entries.
+        const size_t kEntrySize = 4096;
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            auto data = makeData(kEntrySize, (uint8_t)i);
+            pCache->put(makeKey(i), data.data(), data.size(), 1.0);
+        }
+        EXPECT_EQ(pCache->getEntryCount(), 8);
+        uint64_t entrySize = pCache->getSize() / 8;
+
+        // Use the first entry so that it becomes the most recently used one.
+        EXPECT(pCache->get(makeKey(0)));
+
+        pCache->setMaxSize(4 * entrySize);
+        EXPECT_EQ(pCache->getEntryCount(), 4);
+        EXPECT_LE(pCache->getSize(), 4 * entrySize);
+        EXPECT_EQ(pCache->getStats().evictionCount, 4);
+
+        // The least recently used entries 1-4 are evicted.
+        EXPECT(pCache->get(makeKey(0)));
+        for (uint32_t i = 1; i < 5; i++) EXPECT(!pCache->get(makeKey(i))) << "i = " << i;
+        for (uint32_t i = 5; i < 8; i++) EXPECT(pCache->get(makeKey(i))) << "i = " << i;
+
+        // Reopening with a smaller limit evicts on creation.
+        pCache = ShaderCache::create(directory, 2 * entrySize);
+        EXPECT_EQ(pCache->getEntryCount(), 2);
+
+        std::filesystem::remove_all(directory);
+    }
+}
@@ -0,0 +1,193 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "RenderGraph/TransientResourcePlanner.h"
+#include <algorithm>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        using Request = TransientResourcePlanner::Request;
+        using Plan = TransientResourcePlanner::Plan;
+
+        Request makeRequest(uint64_t key, uint64_t size, uint32_t firstUse, uint32_t lastUse, bool transient = true)
+        {
+            Request r;
+            r.key = key;
+            r.size = size;
+            r.firstUse = firstUse;
+            r.lastUse = lastUse;
+            r.transient = transient;
+            return r;
+        }
+
+        /** Check that requests sharing an allocation are compatible, don't overlap in time and fit the allocation.
+        */
+        void validatePlan(CPUUnitTestContext& ctx, const std::vector<Request>& requests, const Plan& plan)
+        {
+            EXPECT_EQ(plan.allocationIndex.size(), requests.size());
+
+            uint64_t naiveSize = 0;
+            for (const auto& r : requests) naiveSize += r.size;
+            EXPECT_EQ(plan.naiveSize, naiveSize);
+
+            uint64_t allocatedSize = 0;
+            for (auto size : plan.allocationSize) allocatedSize += size;
+            EXPECT_EQ(plan.allocatedSize, allocatedSize);
+            EXPECT_LE(plan.allocatedSize, plan.naiveSize);
+
+            for (size_t i = 0; i < requests.size(); i++)
+            {
+                uint32_t a = plan.allocationIndex[i];
+                EXPECT_LT(a, plan.getAllocationCount());
+                if (a >= plan.getAllocationCount()) continue;
+                EXPECT_GE(plan.allocationSize[a], requests[i].size);
+
+                for (size_t j = i + 1; j < requests.size(); j++)
+                {
+                    if (plan.allocationIndex[j] != a) continue;
+                    const auto& ri = requests[i];
+                    const auto& rj = requests[j];
+                    EXPECT(ri.transient && rj.transient) << "requests " << i << " and " << j;
+                    EXPECT_EQ(ri.key, rj.key) << "requests " << i << " and " << j;
+                    EXPECT(ri.lastUse < rj.firstUse || rj.lastUse < ri.firstUse) << "requests " << i << " and " << j;
+                }
+            }
+        }
+    }
+
+    CPU_TEST(TransientResourcePlanner_Chain)
+    {
+        // A pass chain where each intermediate is consumed by the next pass.
+        // Intermediates 0 and 2 don't overlap and can share memory, 1 and 3 likewise.
+        std::vector<Request> requests =
+        {
+            makeRequest(0, 100, 0, 1),
+            makeRequest(0, 100, 1, 2),
+            makeRequest(0, 100, 2, 3),
+            makeRequest(0, 100, 3, 4),
+        };
+
+        Plan plan = TransientResourcePlanner::plan(requests);
+        validatePlan(ctx, requests, plan);
+        EXPECT_EQ(plan.getAllocationCount(), 2u);
+        EXPECT_EQ(plan.allocationIndex[0], plan.allocationIndex[2]);
+        EXPECT_EQ(plan.allocationIndex[1], plan.allocationIndex[3]);
+        EXPECT_EQ(plan.getBytesSaved(), 200ull);
+    }
+
+    CPU_TEST(TransientResourcePlanner_Constraints)
+    {
+        std::vector<Request> requests =
+        {
+            makeRequest(0, 100, 0, 0),
+            makeRequest(1, 100, 1, 1),          // Different key.
+            makeRequest(0, 100, 2, 2, false),   // Not transient.
+            makeRequest(0, 100, 3, 3),          // Can share with the first request.
+        };
+
+        Plan plan = TransientResourcePlanner::plan(requests);
+        validatePlan(ctx, requests, plan);
+        EXPECT_EQ(plan.getAllocationCount(), 3u);
+        EXPECT_EQ(plan.allocationIndex[0], plan.allocationIndex[3]);
+
+        // Requests with invalid lifetime are rejected.
+        bool caught = false;
+        try
+        {
+            TransientResourcePlanner::plan({ makeRequest(0, 100, 2, 1) });
+        }
+        catch (const ArgumentError&)
+        {
+            caught = true;
+        }
+        EXPECT(caught);
+    }
+
+    CPU_TEST(TransientResourcePlanner_BestFit)
+    {
+        // Two free allocations of different sizes, the request should reuse the smaller one that fits.
+        std::vector<Request> requests =
+        {
+            makeRequest(0, 400, 0, 0),
+            makeRequest(0, 200, 0, 0),
+            makeRequest(0, 150, 1, 1),
+        };
+
+        Plan plan = TransientResourcePlanner::plan(requests);
+        validatePlan(ctx, requests, plan);
+        EXPECT_EQ(plan.getAllocationCount(), 2u);
+        EXPECT_EQ(plan.allocationIndex[2], plan.allocationIndex[1]);
+        EXPECT_EQ(plan.allocatedSize, 600ull);
+    }
+
+    CPU_TEST(TransientResourcePlanner_Random)
+    {
+        std::mt19937 rng(1234);
+        for (uint32_t iter = 0; iter < 100; iter++)
+        {
+            const uint32_t passCount = 32;
+            std::vector<Request> requests(1 + rng() % 64);
+            for (auto& r : requests)
+            {
+                uint32_t a = rng() % passCount;
+                uint32_t b = rng() % passCount;
+                r = makeRequest(rng() % 3, 1024, std::min(a, b), std::max(a, b), rng() % 8 != 0);
+            }
+
+            Plan plan = TransientResourcePlanner::plan(requests);
+            validatePlan(ctx, requests, plan);
+
+            // With equal sizes, the number of allocations per key equals the maximum number of overlapping requests.
+            for (uint64_t key = 0; key < 3; key++)
+            {
+                uint32_t maxOverlap = 0;
+                for (uint32_t t = 0; t < passCount; t++)
+                {
+                    uint32_t overlap = 0;
+                    for (const auto& r : requests)
+                    {
+                        if (r.key == key && r.transient && r.firstUse <= t && t <= r.lastUse) overlap++;
+                    }
+                    maxOverlap = std::max(maxOverlap, overlap);
+                }
+
+                std::vector<uint32_t> allocations;
+                for (size_t i = 0; i < requests.size(); i++)
+                {
+                    if (requests[i].key == key && requests[i].transient) allocations.push_back(plan.allocationIndex[i]);
+                }
+                std::sort(allocations.begin(), allocations.end());
+                uint32_t allocationCount = (uint32_t)(std::unique(allocations.begin(), allocations.end()) - allocations.begin());
+                EXPECT_EQ(allocationCount, maxOverlap) << "iteration " << iter << ", key " << key;
+            }
+        }
+    }
+}
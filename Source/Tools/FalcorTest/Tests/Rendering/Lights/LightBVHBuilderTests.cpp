@@ -0,0 +1,395 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Rendering/Lights/LightBVHBuilder.h"
+#include "Utils/Threading.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Each synthetic emissive mesh is a grid of kGridSize x kGridSize quads.
+        const uint32_t kGridSize = 16;
+        const uint32_t kTrianglesPerMesh = 2 * kGridSize * kGridSize;
+
+        /** Generates synthetic emissive meshes with random placement, orientation, size and flux.
+            Some meshes have zero flux so that they are culled when pre-integration is enabled.
+        */
+        std::vector<LightCollection::MeshLightTriangle> generateTriangles(uint32_t meshCount)
+        {
+            std::mt19937 rng(1234);
+            std::uniform_real_distribution<float> u(0.f, 1.f);
+            auto randomDirection = [&]()
+            {
+                float z = 1.f - 2.f * u(rng);
+                float r = std::sqrt(std::max(0.f, 1.f - z * z));
+                float phi = glm::two_pi<float>() * u(rng);
+                return float3(r * std::cos(phi), r * std::sin(phi), z);
+            };
+
+            std::vector<LightCollection::MeshLightTriangle> triangles(meshCount * kTrianglesPerMesh);
+            for (uint32_t meshIndex = 0; meshIndex < meshCount; ++meshIndex)
+            {
+                const float3 origin = float3(u(rng), u(rng), u(rng)) * 100.f;
+                const float3 normal = randomDirection();
+                const float3 tangent = glm::normalize(glm::cross(normal, std::abs(normal.x) < 0.9f ? float3(1.f, 0.f, 0.f) : float3(0.f, 1.f, 0.f)));
+                const float3 bitangent = glm::cross(normal, tangent);
+                const float cellSize = 0.01f + 0.1f * u(rng);
+                const float radiance = u(rng) < 0.1f ? 0.f : 10.f * u(rng);
+
+                for (uint32_t i = 0; i < kTrianglesPerMesh; ++i)
+                {
+                    const uint32_t cell = i / 2;
+                    const float3 corner = origin + (float)(cell % kGridSize) * cellSize * tangent + (float)(cell / kGridSize) * cellSize * bitangent;
+                    auto& tri = triangles[meshIndex * kTrianglesPerMesh + i];
+                    tri.vtx[0].pos = corner;
+                    tri.vtx[1].pos = corner + cellSize * ((i & 1) ? bitangent : tangent);
+                    tri.vtx[2].pos = corner + cellSize * (tangent + bitangent);
+                    tri.normal = (i & 1) ? -normal : normal;
+                    tri.area = 0.5f * cellSize * cellSize;
+                    tri.averageRadiance = float3(radiance);
+                    tri.flux = radiance * tri.area * glm::pi<float>();
+                    tri.lightIdx = meshIndex;
+                }
+            }
+            return triangles;
+        }
+
+        struct BVHData
+        {
+            std::vector<PackedNode> nodes;
+            std::vector<uint32_t> triangleIndices;
+            std::vector<uint64_t> triangleBitmasks;
+            std::vector<float> nodeSplitQuality;
+        };
+
+        BVHData build(LightBVHBuilder& builder, const std::vector<LightCollection::MeshLightTriangle>& triangles)
+        {
+            BVHData bvh;
+            builder.buildCPU(triangles, bvh.nodes, bvh.triangleIndices, bvh.triangleBitmasks, &bvh.nodeSplitQuality);
+            return bvh;
+        }
+
+        BVHData build(const LightBVHBuilder::Options& options, const std::vector<LightCollection::MeshLightTriangle>& triangles)
+        {
+            return build(*LightBVHBuilder::create(options), triangles);
+        }
+
+        bool update(LightBVHBuilder& builder, const std::vector<LightCollection::MeshLightTriangle>& triangles, BVHData& bvh)
+        {
+            return builder.updateCPU(triangles, bvh.nodes, bvh.triangleIndices, bvh.triangleBitmasks, bvh.nodeSplitQuality);
+        }
+
+        void setMeshFlux(std::vector<LightCollection::MeshLightTriangle>& triangles, uint32_t meshIndex, float flux)
+        {
+            for (uint32_t i = 0; i < kTrianglesPerMesh; ++i) triangles[meshIndex * kTrianglesPerMesh + i].flux = flux;
+        }
+
+        bool isClose(float a, float b, float eps = 1e-4f)
+        {
+            return std::abs(a - b) <= eps * std::max(std::abs(a), std::abs(b)) + 1e-4f;
+        }
+
+        /** Checks that packed node attributes match the given bounds and flux.
+            The node extent is stored at half precision.
+        */
+        void expectNodeAttributes(CPUUnitTestContext& ctx, const SharedNodeAttributes& attribs, const AABB& bounds, float flux, uint32_t nodeIndex)
+        {
+            const float3 origin = bounds.center();
+            const float3 extent = bounds.extent() * 0.5f;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                EXPECT(isClose(attribs.origin[axis], origin[axis])) << "node " << nodeIndex << ", axis " << axis;
+                EXPECT(isClose(attribs.extent[axis], extent[axis], 1e-3f)) << "node " << nodeIndex << ", axis " << axis;
+            }
+            EXPECT(isClose(attribs.flux, flux)) << "node " << nodeIndex;
+        }
+
+        struct SubtreeData
+        {
+            AABB bounds;
+            float flux = 0.f;
+        };
+
+        /** Validates a subtree against the triangles it references and returns its bounds and flux.
+        */
+        SubtreeData validateSubtree(CPUUnitTestContext& ctx, const std::vector<LightCollection::MeshLightTriangle>& triangles, const BVHData& bvh, uint32_t nodeIndex, uint64_t bitmask, uint32_t depth, std::vector<uint32_t>& referenceCount)
+        {
+            SubtreeData subtree;
+            const PackedNode& node = bvh.nodes[nodeIndex];
+            if (node.isLeaf())
+            {
+                const LeafNode leafNode = node.getLeafNode();
+                EXPECT_LE(leafNode.triangleOffset + leafNode.triangleCount, bvh.triangleIndices.size()) << "node " << nodeIndex;
+                for (uint32_t i = leafNode.triangleOffset; i < std::min<size_t>(leafNode.triangleOffset + leafNode.triangleCount, bvh.triangleIndices.size()); ++i)
+                {
+                    const uint32_t triangleIndex = bvh.triangleIndices[i];
+                    referenceCount[triangleIndex]++;
+                    EXPECT_EQ(bvh.triangleBitmasks[triangleIndex], bitmask) << "triangle " << triangleIndex;
+                    for (const auto& vtx : triangles[triangleIndex].vtx) subtree.bounds.include(vtx.pos);
+                    subtree.flux += triangles[triangleIndex].flux;
+                }
+            }
+            else
+            {
+                const InternalNode internalNode = node.getInternalNode();
+                const SubtreeData left = validateSubtree(ctx, triangles, bvh, nodeIndex + 1, bitmask, depth + 1, referenceCount);
+                const SubtreeData right = validateSubtree(ctx, triangles, bvh, internalNode.rightChildIdx, bitmask | (1ull << depth), depth + 1, referenceCount);
+                subtree.bounds = left.bounds | right.bounds;
+                subtree.flux = left.flux + right.flux;
+            }
+            expectNodeAttributes(ctx, node.getNodeAttributes(), subtree.bounds, subtree.flux, nodeIndex);
+            return subtree;
+        }
+
+        /** Validates that the BVH references each triangle with non-zero flux exactly once,
+            and that the bitmasks, node bounds and node flux match the referenced triangles.
+        */
+        void validateBVH(CPUUnitTestContext& ctx, const std::vector<LightCollection::MeshLightTriangle>& triangles, const BVHData& bvh)
+        {
+            EXPECT(!bvh.nodes.empty());
+            EXPECT_EQ(bvh.nodeSplitQuality.size(), bvh.nodes.size());
+            EXPECT_EQ(bvh.triangleBitmasks.size(), triangles.size());
+            if (bvh.nodes.empty() || bvh.triangleBitmasks.size() != triangles.size()) return;
+
+            std::vector<uint32_t> referenceCount(triangles.size(), 0);
+            validateSubtree(ctx, triangles, bvh, 0, 0ull, 0, referenceCount);
+            for (size_t i = 0; i < triangles.size(); ++i)
+            {
+                const bool included = triangles[i].flux > 0.f;
+                EXPECT_EQ(referenceCount[i], included ? 1u : 0u) << "triangle " << i;
+                if (!included) EXPECT_EQ(bvh.triangleBitmasks[i], std::numeric_limits<uint64_t>::max()) << "triangle " << i;
+            }
+        }
+    }
+
+    CPU_TEST(LightBVHBuilder_ParallelBuild)
+    {
+        // Use enough triangles for the root to be above the thresholds for building subtrees and evaluating splits in parallel.
+        const auto triangles = generateTriangles(64);
+        EXPECT_GE(triangles.size(), 32768);
+
+        const LightBVHBuilder::SplitHeuristic heuristics[] =
+        {
+            LightBVHBuilder::SplitHeuristic::Equal,
+            LightBVHBuilder::SplitHeuristic::BinnedSAH,
+            LightBVHBuilder::SplitHeuristic::BinnedSAOH,
+        };
+
+        LightBVHBuilder::Options options[std::size(heuristics)];
+        for (size_t i = 0; i < std::size(heuristics); ++i) options[i].splitHeuristicSelection = heuristics[i];
+
+        // Build on the thread pool, which the test framework keeps running.
+        EXPECT(Threading::isRunning());
+        std::vector<BVHData> parallelBVHs;
+        for (const auto& o : options) parallelBVHs.push_back(build(o, triangles));
+
+        // Build serially on the calling thread.
+        std::vector<BVHData> serialBVHs;
+        for (auto o : options)
+        {
+            o.parallelBuild = false;
+            serialBVHs.push_back(build(o, triangles));
+        }
+
+        // The parallel build must produce the same nodes, triangle order and bitmasks as the serial build.
+        for (size_t i = 0; i < std::size(heuristics); ++i)
+        {
+            const auto& parallel = parallelBVHs[i];
+            const auto& serial = serialBVHs[i];
+            EXPECT_GT(serial.nodes.size(), 1) << "heuristic " << i;
+            EXPECT_EQ(parallel.nodes.size(), serial.nodes.size()) << "heuristic " << i;
+            if (parallel.nodes.size() != serial.nodes.size()) continue;
+            for (size_t j = 0; j < serial.nodes.size(); ++j)
+            {
+                EXPECT(std::memcmp(&parallel.nodes[j], &serial.nodes[j], sizeof(PackedNode)) == 0) << "heuristic " << i << ", node " << j;
+            }
+            EXPECT(parallel.triangleIndices == serial.triangleIndices) << "heuristic " << i;
+            EXPECT(parallel.triangleBitmasks == serial.triangleBitmasks) << "heuristic " << i;
+        }
+    }
+
+    CPU_TEST(LightBVHBuilder_IncrementalRefit)
+    {
+        auto triangles = generateTriangles(16);
+
+        LightBVHBuilder::Options options;
+        options.allowIncrementalUpdates = true;
+        auto pBuilder = LightBVHBuilder::create(options);
+        BVHData bvh = build(*pBuilder, triangles);
+        validateBVH(ctx, triangles, bvh);
+
+        // Scale the positions and flux by powers of two. All node attributes change, but the split costs scale exactly,
+        // so the split quality is unchanged and the update only refits. A full build produces the same hierarchy.
+        for (auto& tri : triangles)
+        {
+            for (auto& vtx : tri.vtx) vtx.pos *= 2.f;
+            tri.area *= 4.f;
+            tri.flux *= 2.f;
+        }
+
+        EXPECT(update(*pBuilder, triangles, bvh));
+        const auto stats = pBuilder->getUpdateStats();
+        EXPECT(!stats.fullRebuild);
+        EXPECT_EQ(stats.nodeCount, bvh.nodes.size());
+        EXPECT_EQ(stats.refitNodeCount, stats.nodeCount);
+        EXPECT_EQ(stats.rebuiltSubtreeCount, 0);
+        EXPECT_EQ(stats.insertedTriangleCount, 0);
+        EXPECT_EQ(stats.removedTriangleCount, 0);
+        validateBVH(ctx, triangles, bvh);
+
+        const BVHData reference = build(*pBuilder, triangles);
+        EXPECT_EQ(bvh.nodes.size(), reference.nodes.size());
+        if (bvh.nodes.size() != reference.nodes.size()) return;
+        for (uint32_t nodeIndex = 0; nodeIndex < reference.nodes.size(); ++nodeIndex)
+        {
+            const PackedNode& node = bvh.nodes[nodeIndex];
+            const PackedNode& referenceNode = reference.nodes[nodeIndex];
+            EXPECT_EQ(node.isLeaf(), referenceNode.isLeaf()) << "node " << nodeIndex;
+            if (node.isLeaf() != referenceNode.isLeaf()) continue;
+            if (node.isLeaf())
+            {
+                EXPECT_EQ(node.getLeafNode().triangleOffset, referenceNode.getLeafNode().triangleOffset) << "node " << nodeIndex;
+                EXPECT_EQ(node.getLeafNode().triangleCount, referenceNode.getLeafNode().triangleCount) << "node " << nodeIndex;
+            }
+            else
+            {
+                EXPECT_EQ(node.getInternalNode().rightChildIdx, referenceNode.getInternalNode().rightChildIdx) << "node " << nodeIndex;
+            }
+
+            SharedNodeAttributes referenceAttribs = referenceNode.getNodeAttributes();
+            AABB referenceBounds;
+            referenceAttribs.getAABB(referenceBounds.minPoint, referenceBounds.maxPoint);
+            expectNodeAttributes(ctx, node.getNodeAttributes(), referenceBounds, referenceAttribs.flux, nodeIndex);
+        }
+        EXPECT(bvh.triangleIndices == reference.triangleIndices);
+        EXPECT(bvh.triangleBitmasks == reference.triangleBitmasks);
+    }
+
+    CPU_TEST(LightBVHBuilder_IncrementalRebuild)
+    {
+        auto triangles = generateTriangles(16);
+
+        // Move every other quad of an emissive mesh far away. The subtrees of the mesh then span both locations,
+        // which degrades their split quality.
+        auto movedTriangles = triangles;
+        for (uint32_t i = 0; i < kTrianglesPerMesh; ++i)
+        {
+            if ((i / 2) % 2 == 0) continue;
+            for (auto& vtx : movedTriangles[i].vtx) vtx.pos += float3(1000.f, 0.f, 0.f);
+        }
+        setMeshFlux(triangles, 0, 1.f);
+        setMeshFlux(movedTriangles, 0, 1.f);
+
+        // With an infinite rebuild threshold, the hierarchy is kept and all nodes are refitted.
+        {
+            LightBVHBuilder::Options options;
+            options.allowIncrementalUpdates = true;
+            options.incrementalRebuildThreshold = std::numeric_limits<float>::infinity();
+            auto pBuilder = LightBVHBuilder::create(options);
+            BVHData bvh = build(*pBuilder, triangles);
+            const size_t nodeCount = bvh.nodes.size();
+
+            EXPECT(update(*pBuilder, movedTriangles, bvh));
+            const auto stats = pBuilder->getUpdateStats();
+            EXPECT(!stats.fullRebuild);
+            EXPECT_EQ(stats.rebuiltSubtreeCount, 0);
+            EXPECT_EQ(stats.refitNodeCount, nodeCount);
+            EXPECT_EQ(bvh.nodes.size(), nodeCount);
+            validateBVH(ctx, movedTriangles, bvh);
+        }
+
+        // With the default threshold, the subtrees whose split quality degraded are rebuilt.
+        {
+            LightBVHBuilder::Options options;
+            options.allowIncrementalUpdates = true;
+            auto pBuilder = LightBVHBuilder::create(options);
+            BVHData bvh = build(*pBuilder, triangles);
+
+            EXPECT(update(*pBuilder, movedTriangles, bvh));
+            const auto stats = pBuilder->getUpdateStats();
+            EXPECT(!stats.fullRebuild);
+            EXPECT_GT(stats.rebuiltSubtreeCount, 0);
+            EXPECT_GT(stats.rebuiltNodeCount, 0);
+            EXPECT_EQ(stats.nodeCount, bvh.nodes.size());
+            EXPECT_EQ(stats.refitNodeCount + stats.rebuiltNodeCount, stats.nodeCount);
+            validateBVH(ctx, movedTriangles, bvh);
+
+            // The root covers the same triangles as a full build.
+            const BVHData reference = build(*pBuilder, movedTriangles);
+            AABB referenceBounds;
+            SharedNodeAttributes referenceAttribs = reference.nodes[0].getNodeAttributes();
+            referenceAttribs.getAABB(referenceBounds.minPoint, referenceBounds.maxPoint);
+            expectNodeAttributes(ctx, bvh.nodes[0].getNodeAttributes(), referenceBounds, referenceAttribs.flux, 0);
+
+            // A subsequent update without changes doesn't rebuild anything.
+            EXPECT(update(*pBuilder, movedTriangles, bvh));
+            EXPECT_EQ(pBuilder->getUpdateStats().rebuiltSubtreeCount, 0);
+            validateBVH(ctx, movedTriangles, bvh);
+        }
+    }
+
+    CPU_TEST(LightBVHBuilder_IncrementalInsertRemove)
+    {
+        auto triangles = generateTriangles(16);
+        setMeshFlux(triangles, 0, 0.f);
+        setMeshFlux(triangles, 1, 1.f);
+
+        LightBVHBuilder::Options options;
+        options.allowIncrementalUpdates = true;
+        auto pBuilder = LightBVHBuilder::create(options);
+        BVHData bvh = build(*pBuilder, triangles);
+        validateBVH(ctx, triangles, bvh);
+
+        // Turn on the first mesh and turn off some triangles of the second mesh. With pre-integration enabled,
+        // triangles with zero flux are not included in the BVH, so this inserts and removes triangles.
+        const uint32_t removedCount = 100;
+        setMeshFlux(triangles, 0, 2.f);
+        for (uint32_t i = 0; i < removedCount; ++i) triangles[kTrianglesPerMesh + i].flux = 0.f;
+
+        EXPECT(update(*pBuilder, triangles, bvh));
+        const auto stats = pBuilder->getUpdateStats();
+        EXPECT(!stats.fullRebuild);
+        EXPECT_EQ(stats.insertedTriangleCount, kTrianglesPerMesh);
+        EXPECT_EQ(stats.removedTriangleCount, removedCount);
+        EXPECT_GT(stats.rebuiltSubtreeCount, 0);
+        validateBVH(ctx, triangles, bvh);
+
+        // Without any triangles left, the BVH cannot be updated incrementally and is left unchanged.
+        const BVHData previous = bvh;
+        for (auto& tri : triangles) tri.flux = 0.f;
+        EXPECT(!update(*pBuilder, triangles, bvh));
+        EXPECT_EQ(bvh.nodes.size(), previous.nodes.size());
+        EXPECT(bvh.triangleIndices == previous.triangleIndices);
+        EXPECT(bvh.triangleBitmasks == previous.triangleBitmasks);
+    }
+}
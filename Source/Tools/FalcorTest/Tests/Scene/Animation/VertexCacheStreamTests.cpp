@@ -0,0 +1,175 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/VertexCacheStream.h"
+#include "Core/Platform/OS.h"
+#include <filesystem>
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        using TrackDesc = VertexCacheStream::TrackDesc;
+
+        /** Keyframe content: every word holds the track and keyframe index.
+        */
+        uint32_t keyframeValue(uint32_t trackIndex, uint32_t keyframeIndex)
+        {
+            return (trackIndex << 16) | keyframeIndex;
+        }
+
+        std::filesystem::path writeTestStream(const std::vector<TrackDesc>& tracks)
+        {
+            std::filesystem::path path = getTempFilePath();
+            VertexCacheStream::write(path, tracks, [&](uint32_t trackIndex, uint32_t keyframeIndex, void* pData)
+            {
+                const auto& desc = tracks[trackIndex];
+                uint32_t* pWords = reinterpret_cast<uint32_t*>(pData);
+                for (size_t i = 0; i < desc.keyframeSize / sizeof(uint32_t); i++) pWords[i] = keyframeValue(trackIndex, keyframeIndex);
+            });
+            return path;
+        }
+
+        /** Emulates the GPU side: records which keyframe each slot holds.
+        */
+        struct SlotContents
+        {
+            std::vector<std::vector<uint32_t>> keyframes;
+            uint32_t uploadCount = 0;
+
+            VertexCacheStream::UploadCallback getCallback()
+            {
+                return [this](uint32_t trackIndex, uint32_t slot, const void* pData, uint64_t size)
+                {
+                    const uint32_t* pWords = reinterpret_cast<const uint32_t*>(pData);
+                    keyframes[trackIndex][slot] = pWords[size / sizeof(uint32_t) - 1] & 0xffff;
+                    uploadCount++;
+                };
+            }
+        };
+    }
+
+    CPU_TEST(VertexCacheStreamWindow)
+    {
+        const std::vector<TrackDesc> tracks = { { 10, 64 }, { 3, 16 } };
+        std::filesystem::path path = writeTestStream(tracks);
+
+        {
+            const uint32_t windowSize = 4;
+            auto pStream = VertexCacheStream::open(path, windowSize, true);
+            EXPECT_EQ(pStream->getTrackCount(), 2u);
+            EXPECT_EQ(pStream->getTrack(0).keyframeCount, 10u);
+            EXPECT_EQ(pStream->getTrack(0).keyframeSize, 64u);
+            EXPECT_EQ(pStream->getSlotCount(0), windowSize);
+            EXPECT_EQ(pStream->getSlotCount(1), 3u);
+
+            SlotContents contents;
+            contents.keyframes = { std::vector<uint32_t>(4, ~0u), std::vector<uint32_t>(3, ~0u) };
+
+            // Step through the animation twice, looped. The returned slots must always hold the requested keyframes.
+            for (uint32_t frame = 0; frame < 20; frame++)
+            {
+                uint2 keyframes = uint2(frame % 10, (frame + 1) % 10);
+                uint2 slots = pStream->update(0, keyframes, true, contents.getCallback());
+                EXPECT_EQ(contents.keyframes[0][slots.x], keyframes.x) << "frame " << frame;
+                EXPECT_EQ(contents.keyframes[0][slots.y], keyframes.y) << "frame " << frame;
+
+                // The slot table matches what was uploaded.
+                for (uint32_t slot = 0; slot < windowSize; slot++)
+                {
+                    uint32_t k = contents.keyframes[0][slot];
+                    if (k != ~0u) EXPECT_EQ(pStream->getSlot(0, k), slot) << "frame " << frame;
+                }
+
+                keyframes = uint2(frame % 3, (frame + 1) % 3);
+                slots = pStream->update(1, keyframes, true, contents.getCallback());
+                EXPECT_EQ(contents.keyframes[1][slots.x], keyframes.x) << "frame " << frame;
+                EXPECT_EQ(contents.keyframes[1][slots.y], keyframes.y) << "frame " << frame;
+            }
+
+            // The short track fits entirely, so it's loaded exactly once.
+            // The long track loads each keyframe once per visit (21 visits), plus whatever prefetches completed at the end.
+            const auto& stats = pStream->getStats();
+            EXPECT_GE(stats.keyframesLoaded, 3u + 21u);
+            EXPECT_LE(stats.keyframesLoaded, 3u + 21u + windowSize - 2);
+            EXPECT_EQ(contents.uploadCount, stats.keyframesLoaded);
+            EXPECT_EQ(stats.keyframesLoaded, stats.keyframesPrefetched + stats.stalls);
+            EXPECT_LE(pStream->getStagingSizeInBytes(), uint64_t(windowSize) * 64);
+        }
+
+        // The stream was opened with deleteOnClose.
+        EXPECT(!std::filesystem::exists(path));
+    }
+
+    CPU_TEST(VertexCacheStreamSeek)
+    {
+        const std::vector<TrackDesc> tracks = { { 16, 32 } };
+        std::filesystem::path path = writeTestStream(tracks);
+
+        auto pStream = VertexCacheStream::open(path, 3, true);
+        SlotContents contents;
+        contents.keyframes = { std::vector<uint32_t>(3, ~0u) };
+
+        // Random access and non-looped playback at the end of the animation.
+        const uint2 requests[] = { { 0, 1 }, { 7, 8 }, { 8, 9 }, { 2, 3 }, { 14, 15 }, { 15, 15 }, { 15, 0 }, { 15, 0 } };
+        for (const auto& keyframes : requests)
+        {
+            uint2 slots = pStream->update(0, keyframes, false, contents.getCallback());
+            EXPECT_EQ(contents.keyframes[0][slots.x], keyframes.x);
+            EXPECT_EQ(contents.keyframes[0][slots.y], keyframes.y);
+        }
+
+        // Requesting resident keyframes doesn't upload anything.
+        uint32_t uploadCount = contents.uploadCount;
+        pStream->update(0, uint2(15, 0), false, contents.getCallback());
+        EXPECT_EQ(contents.uploadCount, uploadCount);
+
+        EXPECT(throws<ArgumentError>([&]() { pStream->update(0, uint2(16, 0), false, contents.getCallback()); }));
+        EXPECT(throws<ArgumentError>([&]() { pStream->update(1, uint2(0, 1), false, contents.getCallback()); }));
+    }
+
+    CPU_TEST(VertexCacheStreamInvalidFile)
+    {
+        std::filesystem::path path = getTempFilePath();
+        {
+            std::ofstream fs(path, std::ios::binary);
+            fs << "not a vertex cache stream";
+        }
+        EXPECT(throws<RuntimeError>([&]() { VertexCacheStream::open(path, 2); }));
+        std::filesystem::remove(path);
+
+        // Truncated data.
+        const std::vector<TrackDesc> tracks = { { 4, 256 } };
+        path = writeTestStream(tracks);
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+        EXPECT(throws<RuntimeError>([&]() { VertexCacheStream::open(path, 2); }));
+        EXPECT(throws<ArgumentError>([&]() { VertexCacheStream::open(path, 1); }));
+        std::filesystem::remove(path);
+    }
+}
@@ -0,0 +1,135 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Curves/CurveTessellation.h"
+#include <cmath>
+
+namespace Falcor
+{
+    namespace
+    {
+        const float kWidth = 0.1f;
+
+        struct Strands
+        {
+            std::vector<uint32_t> vertexCounts;
+            std::vector<float3> controlPoints;
+            std::vector<float> widths;
+            std::vector<float2> UVs;
+        };
+
+        /** Straight strands along y. Strand i is at x = i. The third strand repeats one of its control points.
+        */
+        Strands createStrands()
+        {
+            Strands strands;
+            strands.vertexCounts = { 4, 6, 5, 3, 7 };
+            for (uint32_t i = 0; i < strands.vertexCounts.size(); ++i)
+            {
+                for (uint32_t j = 0; j < strands.vertexCounts[i]; ++j)
+                {
+                    float y = (i == 2 && j > 2) ? float(j - 1) : float(j);
+                    strands.controlPoints.push_back(float3(float(i), y, 0.f));
+                    strands.widths.push_back(kWidth);
+                    strands.UVs.push_back(float2(float(i), 0.f));
+                }
+            }
+            return strands;
+        }
+    }
+
+    CPU_TEST(CurveTessellationSweptSphere)
+    {
+        const Strands strands = createStrands();
+        const uint32_t strandCount = (uint32_t)strands.vertexCounts.size();
+        const uint32_t subdivPerSegment = 2;
+
+        for (uint32_t keepOneEveryXStrands : { 1u, 2u })
+        {
+            auto result = CurveTessellation::convertToLinearSweptSphere(strandCount, strands.vertexCounts.data(), strands.controlPoints.data(), strands.widths.data(), strands.UVs.data(),
+                1, subdivPerSegment, keepOneEveryXStrands, 1, 2.f, rmcv::identity<rmcv::mat4>());
+
+            // Count the points of the kept strands. The repeated control point is removed before tessellation.
+            uint32_t pointCount = 0;
+            uint32_t keptStrandCount = 0;
+            for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+            {
+                uint32_t uniqueCount = strands.vertexCounts[i] - (i == 2 ? 1 : 0);
+                pointCount += subdivPerSegment * (uniqueCount - 1) + 1;
+                keptStrandCount++;
+            }
+            EXPECT_EQ(result.points.size(), pointCount);
+            EXPECT_EQ(result.radius.size(), pointCount);
+            EXPECT_EQ(result.texCrds.size(), pointCount);
+            EXPECT_EQ(result.indices.size(), pointCount - keptStrandCount);
+
+            // Points of each strand are contiguous and segments connect consecutive points of the same strand.
+            for (size_t k = 0; k < result.points.size(); ++k)
+            {
+                EXPECT_EQ(result.points[k].z, 0.f);
+                EXPECT_EQ(result.radius[k], kWidth);
+                EXPECT_EQ(result.texCrds[k].x, result.points[k].x);
+            }
+            for (uint32_t index : result.indices)
+            {
+                EXPECT_LT(index + 1, result.points.size());
+                EXPECT_EQ(result.points[index].x, result.points[index + 1].x);
+                EXPECT_LT(result.points[index].y, result.points[index + 1].y);
+            }
+        }
+    }
+
+    CPU_TEST(CurveTessellationPolytube)
+    {
+        const Strands strands = createStrands();
+        const uint32_t strandCount = (uint32_t)strands.vertexCounts.size();
+        const uint32_t pointCountPerCrossSection = 4;
+
+        auto result = CurveTessellation::convertToPolytube(strandCount, strands.vertexCounts.data(), strands.controlPoints.data(), strands.widths.data(), nullptr,
+            3, 1, 2, 1.f, pointCountPerCrossSection);
+
+        // Cross-sections per strand: ceil(3 * (uniqueCount - 1) / 2) + 1.
+        const uint32_t crossSectionCount = 6 + 9 + 6 + 4 + 10;
+        EXPECT_EQ(result.vertices.size(), pointCountPerCrossSection * crossSectionCount);
+        EXPECT_EQ(result.normals.size(), result.vertices.size());
+        EXPECT_EQ(result.tangents.size(), result.vertices.size());
+        EXPECT_EQ(result.radii.size(), result.vertices.size());
+        EXPECT(result.texCrds.empty());
+        EXPECT_EQ(result.faceVertexCounts.size(), 2 * pointCountPerCrossSection * (crossSectionCount - strandCount));
+        EXPECT_EQ(result.faceVertexIndices.size(), 3 * result.faceVertexCounts.size());
+
+        // Faces only connect vertices of the same strand.
+        for (size_t f = 0; f < result.faceVertexCounts.size(); ++f)
+        {
+            EXPECT_EQ(result.faceVertexCounts[f], 3);
+            const uint32_t* indices = &result.faceVertexIndices[3 * f];
+            EXPECT(indices[0] < result.vertices.size() && indices[1] < result.vertices.size() && indices[2] < result.vertices.size());
+            EXPECT_LT(std::abs(result.vertices[indices[0]].x - result.vertices[indices[2]].x), 0.5f);
+        }
+    }
+}
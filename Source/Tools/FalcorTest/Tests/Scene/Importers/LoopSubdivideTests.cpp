@@ -0,0 +1,353 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Importers/PBRTImporter/LoopSubdivide.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Falcor
+{
+    namespace
+    {
+        struct Mesh
+        {
+            std::vector<float3> positions;
+            std::vector<uint32_t> indices;
+        };
+
+        Mesh createIcosahedron()
+        {
+            const float t = (1.f + std::sqrt(5.f)) / 2.f;
+            Mesh mesh;
+            mesh.positions = {
+                { -1, t, 0 }, { 1, t, 0 }, { -1, -t, 0 }, { 1, -t, 0 },
+                { 0, -1, t }, { 0, 1, t }, { 0, -1, -t }, { 0, 1, -t },
+                { t, 0, -1 }, { t, 0, 1 }, { -t, 0, -1 }, { -t, 0, 1 },
+            };
+            mesh.indices = {
+                0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+                1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+                3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+                4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1,
+            };
+            return mesh;
+        }
+
+        /** Flat grid in the xy-plane with alternating diagonals.
+        */
+        Mesh createGrid(uint32_t size)
+        {
+            Mesh mesh;
+            for (uint32_t y = 0; y <= size; ++y)
+            {
+                for (uint32_t x = 0; x <= size; ++x) mesh.positions.push_back(float3(x, y, 0.f));
+            }
+            for (uint32_t y = 0; y < size; ++y)
+            {
+                for (uint32_t x = 0; x < size; ++x)
+                {
+                    const uint32_t i = y * (size + 1) + x;
+                    if ((x + y) % 2 == 0) mesh.indices.insert(mesh.indices.end(), { i, i + 1, i + size + 2, i, i + size + 2, i + size + 1 });
+                    else mesh.indices.insert(mesh.indices.end(), { i, i + 1, i + size + 1, i + 1, i + size + 2, i + size + 1 });
+                }
+            }
+            return mesh;
+        }
+
+        /** Non-planar quad made of two triangles, all vertices on the boundary.
+        */
+        Mesh createQuad()
+        {
+            Mesh mesh;
+            mesh.positions = { { 0.f, 0.f, 0.f }, { 1.f, 0.f, 0.f }, { 1.f, 1.f, 0.5f }, { 0.f, 1.f, 0.f } };
+            mesh.indices = { 0, 1, 2, 0, 2, 3 };
+            return mesh;
+        }
+
+        Mesh createTetrahedron()
+        {
+            Mesh mesh;
+            mesh.positions = { { 0.f, 0.f, 0.f }, { 1.f, 0.f, 0.f }, { 0.f, 1.f, 0.f }, { 0.f, 0.f, 1.f } };
+            mesh.indices = { 0, 2, 1, 0, 1, 3, 0, 3, 2, 1, 2, 3 };
+            return mesh;
+        }
+
+        // Results of the original pbrt implementation (half-edge structures with per-vertex and per-face objects).
+        // The flat array implementation must produce the same vertex order, positions, normals and indices.
+
+        const float3 kQuadLevel1Positions[] =
+        {
+            { 0.175000012f, 0.175000012f, 0.f }, { 0.825000048f, 0.175000012f, 0.087500006f },
+            { 0.825000048f, 0.825000048f, 0.325000018f }, { 0.175000012f, 0.825000048f, 0.087500006f },
+            { 0.5f, 0.0500000007f, 0.0125000002f }, { 0.950000048f, 0.5f, 0.237500012f },
+            { 0.49999997f, 0.49999997f, 0.166666672f }, { 0.5f, 0.950000048f, 0.237500012f },
+            { 0.0500000007f, 0.5f, 0.0125000002f },
+        };
+
+        const float3 kQuadLevel1Normals[] =
+        {
+            { 0.075000003f, 0.075000003f, -0.292499959f }, { 0.0112500042f, 0.0787500143f, -0.180000022f },
+            { 0.071250014f, 0.071250014f, -0.292500108f }, { 0.0787500143f, 0.0112500042f, -0.180000022f },
+            { 0.13562499f, 0.373541713f, -1.00749993f }, { 0.130208343f, 0.368125051f, -1.00750017f },
+            { 0.428682595f, 0.428682625f, -1.71473026f }, { 0.368125051f, 0.130208343f, -1.00750017f },
+            { 0.373541772f, 0.13562499f, -1.00749993f },
+        };
+
+        const uint32_t kQuadLevel1Indices[] =
+        {
+            0, 4, 6, 4, 1, 5, 6, 5, 2, 4, 5, 6, 0, 6, 8, 6, 2, 7, 8, 7, 3, 6, 7, 8,
+        };
+
+        const float3 kQuadLevel2Positions[] =
+        {
+            { 0.168750003f, 0.168750003f, 0.f }, { 0.831250012f, 0.168750003f, 0.0843750015f },
+            { 0.831250012f, 0.831250012f, 0.331250012f }, { 0.168750003f, 0.831250012f, 0.0843750015f },
+            { 0.5f, 0.0437499993f, 0.0109375007f }, { 0.956250012f, 0.5f, 0.239062503f },
+            { 0.5f, 0.5f, 0.166666657f }, { 0.5f, 0.956250012f, 0.239062503f },
+            { 0.0437499993f, 0.5f, 0.0109375007f }, { 0.318749994f, 0.075000003f, 0.00156250002f },
+            { 0.514322877f, 0.26953125f, 0.0996093675f }, { 0.299479157f, 0.299479157f, 0.06640625f },
+            { 0.681250036f, 0.075000003f, 0.0359374993f }, { 0.925000012f, 0.318749994f, 0.157812506f },
+            { 0.729166687f, 0.270833343f, 0.124999993f }, { 0.73046881f, 0.485677034f, 0.207682312f },
+            { 0.925000012f, 0.681250036f, 0.3046875f }, { 0.700520813f, 0.700520813f, 0.266927093f },
+            { 0.26953125f, 0.514322877f, 0.099609375f }, { 0.075000003f, 0.318749994f, 0.00156250002f },
+            { 0.681250036f, 0.925000012f, 0.3046875f }, { 0.485677034f, 0.73046875f, 0.207682312f },
+            { 0.270833343f, 0.729166746f, 0.124999993f }, { 0.318749994f, 0.925000012f, 0.157812506f },
+            { 0.075000003f, 0.681250036f, 0.035937503f },
+        };
+
+        const float3 kQuadLevel2Normals[] =
+        {
+            { 0.0161865223f, 0.0161865223f, -0.0637304634f }, { 0.000761718489f, 0.0129492171f, -0.0274218693f },
+            { 0.0156787094f, 0.0156787094f, -0.0637304783f }, { 0.0129492171f, 0.000761718489f, -0.0274218693f },
+            { 0.0289860051f, 0.124578446f, -0.305670619f }, { 0.0282568261f, 0.123849243f, -0.30567053f },
+            { 0.130841166f, 0.130841196f, -0.523364663f }, { 0.123849243f, 0.0282568336f, -0.30567053f },
+            { 0.124578461f, 0.0289860088f, -0.305670619f }, { 0.0482283495f, 0.101812333f, -0.297060549f },
+            { 0.0790245906f, 0.169285789f, -0.495495021f }, { 0.11199747f, 0.111997515f, -0.44534564f },
+            { 0.0101692751f, 0.0868489742f, -0.193697974f }, { 0.0100000277f, 0.0866796523f, -0.19369787f },
+            { 0.0399271473f, 0.174874872f, -0.429603934f }, { 0.0784617215f, 0.168723077f, -0.495495439f },
+            { 0.0467178933f, 0.100301906f, -0.297060519f }, { 0.110675327f, 0.110675387f, -0.44534573f },
+            { 0.169285819f, 0.0790245682f, -0.495494992f }, { 0.101812333f, 0.0482283495f, -0.297060549f },
+            { 0.100301929f, 0.0467179045f, -0.297060609f }, { 0.168722942f, 0.078461729f, -0.495495141f },
+            { 0.174874961f, 0.0399271697f, -0.429604232f }, { 0.0866796523f, 0.0100000277f, -0.19369787f },
+            { 0.0868489668f, 0.0101692714f, -0.193697944f },
+        };
+
+        const uint32_t kQuadLevel2Indices[] =
+        {
+            0, 9, 11, 9, 4, 10, 11, 10, 6, 9, 10, 11, 4, 12, 14, 12, 1, 13, 14, 13, 5, 12, 13, 14,
+            6, 15, 17, 15, 5, 16, 17, 16, 2, 15, 16, 17, 4, 14, 10, 14, 5, 15, 10, 15, 6, 14, 15, 10,
+            0, 11, 19, 11, 6, 18, 19, 18, 8, 11, 18, 19, 6, 17, 21, 17, 2, 20, 21, 20, 7, 17, 20, 21,
+            8, 22, 24, 22, 7, 23, 24, 23, 3, 22, 23, 24, 6, 21, 18, 21, 7, 22, 18, 22, 8, 21, 22, 18,
+        };
+
+        const float3 kTetrahedronLevel1Positions[] =
+        {
+            { 0.200000003f, 0.199999988f, 0.200000018f }, { 0.399999976f, 0.200000018f, 0.199999988f },
+            { 0.199999988f, 0.399999976f, 0.200000018f }, { 0.200000018f, 0.199999988f, 0.399999976f },
+            { 0.177083328f, 0.322916657f, 0.177083328f }, { 0.322916657f, 0.322916687f, 0.177083328f },
+            { 0.322916687f, 0.177083328f, 0.177083328f }, { 0.322916687f, 0.177083328f, 0.322916657f },
+            { 0.177083328f, 0.177083328f, 0.322916687f }, { 0.177083328f, 0.322916657f, 0.322916687f },
+        };
+
+        const float3 kTetrahedronLevel1Normals[] =
+        {
+            { 0.0184180867f, 0.0184180811f, 0.0184180774f }, { -0.0184180867f, -1.88194815e-09f, 2.22044605e-16f },
+            { 4.3461732e-09f, -0.0184180867f, 2.17308527e-09f }, { -1.88194815e-09f, 2.22044605e-16f, -0.0184180867f },
+            { 0.0873543099f, -1.86264515e-08f, 0.0873543546f }, { -0.0873542577f, -0.0873543024f, -4.47034836e-08f },
+            { 2.42143869e-08f, 0.0873542652f, 0.0873543024f }, { -0.0873543024f, -5.21540642e-08f, -0.0873542577f },
+            { 0.0873542503f, 0.0873543173f, 2.04890966e-08f }, { -3.35276127e-08f, -0.0873542577f, -0.087354295f },
+        };
+
+        const uint32_t kTetrahedronLevel1Indices[] =
+        {
+            0, 4, 6, 4, 2, 5, 6, 5, 1, 4, 5, 6, 0, 6, 8, 6, 1, 7, 8, 7, 3, 6, 7, 8,
+            0, 8, 4, 8, 3, 9, 4, 9, 2, 8, 9, 4, 1, 5, 7, 5, 2, 9, 7, 9, 3, 5, 9, 7,
+        };
+
+        const float3 kTetrahedronLevel2Positions[] =
+        {
+            { 0.200000003f, 0.200000003f, 0.200000003f }, { 0.400000006f, 0.200000003f, 0.200000003f },
+            { 0.200000003f, 0.400000006f, 0.200000003f }, { 0.200000003f, 0.200000003f, 0.400000006f },
+            { 0.177083328f, 0.322916657f, 0.177083328f }, { 0.322916657f, 0.322916687f, 0.177083328f },
+            { 0.322916687f, 0.177083328f, 0.177083328f }, { 0.322916687f, 0.177083328f, 0.322916657f },
+            { 0.177083328f, 0.177083328f, 0.322916687f }, { 0.177083328f, 0.322916657f, 0.322916687f },
+            { 0.187825516f, 0.238606766f, 0.187825531f }, { 0.256510437f, 0.256510407f, 0.145833328f },
+            { 0.238606766f, 0.187825516f, 0.187825516f }, { 0.187825516f, 0.385742188f, 0.187825516f },
+            { 0.238606766f, 0.385742188f, 0.187825531f }, { 0.256510407f, 0.341145843f, 0.145833328f },
+            { 0.341145843f, 0.256510437f, 0.145833328f }, { 0.385742188f, 0.238606766f, 0.187825516f },
+            { 0.385742188f, 0.187825516f, 0.187825531f }, { 0.256510407f, 0.145833328f, 0.256510437f },
+            { 0.187825516f, 0.187825516f, 0.238606766f }, { 0.385742188f, 0.187825531f, 0.238606766f },
+            { 0.341145843f, 0.145833328f, 0.256510407f }, { 0.256510437f, 0.145833328f, 0.341145843f },
+            { 0.238606766f, 0.187825516f, 0.385742188f }, { 0.187825516f, 0.187825531f, 0.385742188f },
+            { 0.145833328f, 0.256510437f, 0.256510407f }, { 0.187825531f, 0.238606766f, 0.385742188f },
+            { 0.145833328f, 0.256510407f, 0.341145843f }, { 0.145833328f, 0.341145843f, 0.256510437f },
+            { 0.187825516f, 0.385742188f, 0.238606766f }, { 0.341145843f, 0.256510407f, 0.256510437f },
+            { 0.256510437f, 0.341145843f, 0.256510407f }, { 0.256510407f, 0.256510437f, 0.341145843f },
+        };
+
+        const float3 kTetrahedronLevel2Normals[] =
+        {
+            { 0.002233251f, 0.00223324937f, 0.00223324983f }, { -0.002233251f, 7.56699592e-10f, 1.51339918e-09f },
+            { 1.51339918e-09f, -0.002233251f, 7.5669937e-10f }, { 7.56699592e-10f, 1.51339918e-09f, -0.002233251f },
+            { 0.0444300845f, -1.3038516e-08f, 0.0444301106f }, { -0.0444300584f, -0.0444300845f, -3.16649675e-08f },
+            { 1.3038516e-08f, 0.0444300584f, 0.0444300808f }, { -0.0444300845f, -3.16649675e-08f, -0.0444300584f },
+            { 0.0444300584f, 0.0444300808f, 1.3038516e-08f }, { -3.16649675e-08f, -0.0444300584f, -0.0444300845f },
+            { 0.0267910827f, 0.0097769592f, 0.0267911106f }, { 0.0155314431f, 0.0155314719f, 0.0633297488f },
+            { 0.00977698062f, 0.0267910622f, 0.0267910827f }, { 0.017014116f, -0.00977698062f, 0.0170141179f },
+            { -0.0170140881f, -0.0267910827f, -1.67638063e-08f }, { 6.05359674e-09f, -0.0155314431f, 0.0477982983f },
+            { -0.0155314719f, -6.05359674e-09f, 0.0477983654f }, { -0.0267910622f, -0.017014116f, -2.98023224e-08f },
+            { -0.0097769592f, 0.0170140881f, 0.0170140974f }, { 0.0155314701f, 0.0633297488f, 0.0155314384f },
+            { 0.0267910622f, 0.0267910827f, 0.00977698062f }, { -0.026791079f, -1.86264515e-08f, -0.0170140881f },
+            { -0.0155314431f, 0.0477982983f, 6.05359674e-09f }, { -6.05359674e-09f, 0.0477983654f, -0.0155314719f },
+            { -0.017014116f, -2.98023224e-08f, -0.0267910622f }, { 0.0170140881f, 0.0170140974f, -0.0097769592f },
+            { 0.0633297488f, 0.0155314384f, 0.0155314691f }, { -1.86264515e-08f, -0.0170140881f, -0.026791079f },
+            { 0.0477982983f, 6.05359674e-09f, -0.0155314431f }, { 0.0477983654f, -0.0155314701f, -7.4505806e-09f },
+            { -2.98023224e-08f, -0.0267910622f, -0.017014116f }, { -0.0633297488f, -0.0477983654f, -0.0477982983f },
+            { -0.0477982983f, -0.0633297488f, -0.0477983654f }, { -0.0477983654f, -0.0477982983f, -0.0633297488f },
+        };
+
+        const uint32_t kTetrahedronLevel2Indices[] =
+        {
+            0, 10, 12, 10, 4, 11, 12, 11, 6, 10, 11, 12, 4, 13, 15, 13, 2, 14, 15, 14, 5, 13, 14, 15,
+            6, 16, 18, 16, 5, 17, 18, 17, 1, 16, 17, 18, 4, 15, 11, 15, 5, 16, 11, 16, 6, 15, 16, 11,
+            0, 12, 20, 12, 6, 19, 20, 19, 8, 12, 19, 20, 6, 18, 22, 18, 1, 21, 22, 21, 7, 18, 21, 22,
+            8, 23, 25, 23, 7, 24, 25, 24, 3, 23, 24, 25, 6, 22, 19, 22, 7, 23, 19, 23, 8, 22, 23, 19,
+            0, 20, 10, 20, 8, 26, 10, 26, 4, 20, 26, 10, 8, 25, 28, 25, 3, 27, 28, 27, 9, 25, 27, 28,
+            4, 29, 13, 29, 9, 30, 13, 30, 2, 29, 30, 13, 8, 28, 26, 28, 9, 29, 26, 29, 4, 28, 29, 26,
+            1, 17, 21, 17, 5, 31, 21, 31, 7, 17, 31, 21, 5, 14, 32, 14, 2, 30, 32, 30, 9, 14, 30, 32,
+            7, 33, 24, 33, 9, 27, 24, 27, 3, 33, 27, 24, 5, 32, 31, 32, 9, 33, 31, 33, 7, 32, 33, 31,
+        };
+
+        template<size_t PositionCount, size_t IndexCount>
+        void expectGolden(CPUUnitTestContext& ctx, const pbrt::LoopSubdivideResult& result, const float3 (&positions)[PositionCount], const float3 (&normals)[PositionCount], const uint32_t (&indices)[IndexCount])
+        {
+            auto expectNear = [&ctx](const float3& a, const float3& b, const char* what, size_t i)
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    EXPECT_LE(std::abs(a[c] - b[c]), 1e-5f * std::max(1.f, std::abs(b[c]))) << what << " " << i << " component " << c;
+                }
+            };
+
+            EXPECT_EQ(result.positions.size(), PositionCount);
+            EXPECT_EQ(result.normals.size(), PositionCount);
+            EXPECT_EQ(result.indices.size(), IndexCount);
+            if (result.positions.size() != PositionCount || result.normals.size() != PositionCount || result.indices.size() != IndexCount) return;
+
+            for (size_t i = 0; i < PositionCount; ++i)
+            {
+                expectNear(result.positions[i], positions[i], "position", i);
+                expectNear(result.normals[i], normals[i], "normal", i);
+            }
+            for (size_t i = 0; i < IndexCount; ++i) EXPECT_EQ(result.indices[i], indices[i]) << "index " << i;
+        }
+    }
+
+    CPU_TEST(LoopSubdivideClosedMesh)
+    {
+        const Mesh mesh = createIcosahedron();
+
+        for (uint32_t levels = 0; levels <= 3; ++levels)
+        {
+            const auto result = pbrt::loopSubdivide(levels, mesh.positions, mesh.indices);
+
+            // Each level splits every face into four and adds one vertex per edge.
+            const uint32_t scale = 1 << (2 * levels);
+            EXPECT_EQ(result.positions.size(), 10 * scale + 2);
+            EXPECT_EQ(result.normals.size(), result.positions.size());
+            EXPECT_EQ(result.indices.size(), 3 * 20 * scale);
+
+            size_t invalidIndices = 0;
+            for (uint32_t i : result.indices) invalidIndices += i >= result.positions.size() ? 1 : 0;
+            EXPECT_EQ(invalidIndices, 0);
+
+            // The original vertices keep their indices and are symmetric, so their limit positions are at the same distance from the center.
+            const float radius = length(result.positions[0]);
+            for (uint32_t i = 1; i < 12; ++i) EXPECT_LE(std::abs(length(result.positions[i]) - radius), 1e-4f * radius);
+
+            // Normals are consistently oriented and perpendicular to the sphere-like limit surface.
+            size_t outwardNormals = 0;
+            for (size_t i = 0; i < result.positions.size(); ++i)
+            {
+                const float cosTheta = dot(normalize(result.normals[i]), normalize(result.positions[i]));
+                EXPECT_GE(std::abs(cosTheta), 0.9f);
+                outwardNormals += cosTheta > 0.f ? 1 : 0;
+            }
+            EXPECT(outwardNormals == 0 || outwardNormals == result.positions.size());
+        }
+    }
+
+    CPU_TEST(LoopSubdivideBoundary)
+    {
+        const Mesh mesh = createGrid(6);
+        const auto result = pbrt::loopSubdivide(2, mesh.positions, mesh.indices);
+        EXPECT_EQ(result.indices.size(), 16 * mesh.indices.size());
+
+        // A flat mesh stays flat, and the boundary rules keep the limit surface within the grid.
+        for (size_t i = 0; i < result.positions.size(); ++i)
+        {
+            const float3 p = result.positions[i];
+            const float3 n = result.normals[i];
+            EXPECT_EQ(p.z, 0.f);
+            EXPECT(p.x >= 0.f && p.x <= 6.f && p.y >= 0.f && p.y <= 6.f);
+            EXPECT(n.x == 0.f && n.y == 0.f && n.z != 0.f);
+        }
+    }
+
+    CPU_TEST(LoopSubdivideGoldenOpenMesh)
+    {
+        const Mesh mesh = createQuad();
+        expectGolden(ctx, pbrt::loopSubdivide(1, mesh.positions, mesh.indices), kQuadLevel1Positions, kQuadLevel1Normals, kQuadLevel1Indices);
+        expectGolden(ctx, pbrt::loopSubdivide(2, mesh.positions, mesh.indices), kQuadLevel2Positions, kQuadLevel2Normals, kQuadLevel2Indices);
+    }
+
+    CPU_TEST(LoopSubdivideGoldenClosedMesh)
+    {
+        const Mesh mesh = createTetrahedron();
+        expectGolden(ctx, pbrt::loopSubdivide(1, mesh.positions, mesh.indices), kTetrahedronLevel1Positions, kTetrahedronLevel1Normals, kTetrahedronLevel1Indices);
+        expectGolden(ctx, pbrt::loopSubdivide(2, mesh.positions, mesh.indices), kTetrahedronLevel2Positions, kTetrahedronLevel2Normals, kTetrahedronLevel2Indices);
+    }
+
+    CPU_TEST(LoopSubdivideInvalidIndices)
+    {
+        const Mesh mesh = createIcosahedron();
+        std::vector<uint32_t> indices = mesh.indices;
+        indices[4] = 12;
+
+        bool threw = false;
+        try
+        {
+            pbrt::loopSubdivide(1, mesh.positions, indices);
+        }
+        catch (const RuntimeError&)
+        {
+            threw = true;
+        }
+        EXPECT(threw);
+    }
+}
@@ -0,0 +1,409 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Importers/PBRTImporter/Parser.h"
+#include "Scene/Importers/PBRTImporter/Builder.h"
+#include "Core/Platform/OS.h"
+#include <filesystem>
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        std::string nextToken(pbrt::Tokenizer& tokenizer)
+        {
+            auto token = tokenizer.next();
+            return token ? std::string(token->token) : std::string();
+        }
+
+        /** Check that the fast path stops at a value it cannot parse and leaves it for the regular path.
+        */
+        template<typename T>
+        void testNumberArrayFallback(CPUUnitTestContext& ctx, const std::string& str, const std::vector<T>& expectedValues, const std::string& expectedToken)
+        {
+            auto pTokenizer = pbrt::Tokenizer::createFromString(str);
+            EXPECT_EQ(nextToken(*pTokenizer), "[") << str;
+
+            std::vector<T> values;
+            EXPECT(!pTokenizer->readNumberArray(values)) << str;
+            EXPECT(values == expectedValues) << str;
+            EXPECT_EQ(nextToken(*pTokenizer), expectedToken) << str;
+        }
+
+        void writeFile(const std::filesystem::path& path, const std::string& contents)
+        {
+            std::ofstream file(path, std::ios::binary);
+            file.write(contents.data(), contents.size());
+        }
+
+        std::unique_ptr<pbrt::BasicScene> parseScene(const std::string& str)
+        {
+            auto pScene = std::make_unique<pbrt::BasicScene>("");
+            pbrt::BasicSceneBuilder builder(*pScene);
+            pbrt::parseString(builder, str);
+            return pScene;
+        }
+
+        std::unique_ptr<pbrt::BasicScene> parseSceneFile(const std::filesystem::path& path)
+        {
+            auto pScene = std::make_unique<pbrt::BasicScene>(path.parent_path());
+            pbrt::BasicSceneBuilder builder(*pScene);
+            pbrt::parseFile(builder, path);
+            return pScene;
+        }
+
+        /** Parse a scene file and return the error message, or an empty string if parsing succeeded.
+        */
+        std::string getParseError(const std::filesystem::path& path)
+        {
+            try
+            {
+                parseSceneFile(path);
+            }
+            catch (const RuntimeError& e)
+            {
+                return e.what();
+            }
+            return {};
+        }
+
+        const pbrt::ParsedParameter* findParameter(const pbrt::ShapeSceneEntity& shape, const std::string& name)
+        {
+            for (const auto& param : shape.params.getParameters())
+            {
+                if (param.name == name) return &param;
+            }
+            return nullptr;
+        }
+
+        /** Create a scene with a triangle mesh whose position array spans several pages.
+            The file size is a multiple of the page size, so the last value ends at the end of the memory mapping.
+            \param[in] closed Close the array. Otherwise the file ends with a number.
+            \param[out] positions Values of the position array.
+        */
+        std::string createLargeMeshScene(bool closed, std::vector<pbrt::Float>& positions)
+        {
+            const size_t kPageSize = 4096;
+
+            std::string str = "WorldBegin\nShape \"trianglemesh\" \"integer indices\" [ 0 1 2 ] \"point3 P\" [\n";
+            positions.clear();
+            for (uint32_t i = 0; str.size() < 3 * kPageSize; ++i)
+            {
+                positions.push_back(i * 0.25f - 100.f);
+                str += std::to_string(positions.back()) + (i % 8 == 7 ? "\n" : " ");
+            }
+
+            std::string last = closed ? "]" : "7";
+            str.append(kPageSize - (str.size() + last.size()) % kPageSize, ' ');
+            str += last;
+            if (!closed) positions.push_back(7.f);
+            return str;
+        }
+    }
+
+    CPU_TEST(PBRTTokenizerNumberArray)
+    {
+        const std::string str = "[ 1 -2 +3.5 1e3 -2.5E-2 .5 -.25 6. 1E+2 ] Shape";
+        auto pTokenizer = pbrt::Tokenizer::createFromString(str);
+        EXPECT_EQ(nextToken(*pTokenizer), "[");
+
+        std::vector<pbrt::Float> floats;
+        EXPECT(pTokenizer->readNumberArray(floats));
+        const std::vector<pbrt::Float> expectedFloats = { 1.f, -2.f, 3.5f, 1000.f, -0.025f, 0.5f, -0.25f, 6.f, 100.f };
+        EXPECT(floats == expectedFloats);
+
+        // The location of the following token accounts for the skipped values.
+        auto token = pTokenizer->next();
+        EXPECT(token && token->token == "Shape");
+        if (token)
+        {
+            EXPECT_EQ(token->loc.line, 1u);
+            EXPECT_EQ(token->loc.column, (uint32_t)str.find("Shape"));
+        }
+        EXPECT(!pTokenizer->next());
+
+        pTokenizer = pbrt::Tokenizer::createFromString("[0 -2147483648 2147483647 +7]");
+        EXPECT_EQ(nextToken(*pTokenizer), "[");
+        std::vector<int> ints;
+        EXPECT(pTokenizer->readNumberArray(ints));
+        const std::vector<int> expectedInts = { 0, std::numeric_limits<int32_t>::lowest(), std::numeric_limits<int32_t>::max(), 7 };
+        EXPECT(ints == expectedInts);
+        EXPECT(!pTokenizer->next());
+
+        // Comments and line breaks inside of arrays.
+        pTokenizer = pbrt::Tokenizer::createFromString("[ 1 # one ] 2\n 2\r\n\t3 ]\n  Shape");
+        EXPECT_EQ(nextToken(*pTokenizer), "[");
+        floats.clear();
+        EXPECT(pTokenizer->readNumberArray(floats));
+        EXPECT(floats == std::vector<pbrt::Float>({ 1.f, 2.f, 3.f }));
+        token = pTokenizer->next();
+        EXPECT(token && token->token == "Shape");
+        if (token)
+        {
+            EXPECT_EQ(token->loc.line, 4u);
+            EXPECT_EQ(token->loc.column, 2u);
+        }
+    }
+
+    CPU_TEST(PBRTTokenizerNumberArrayFallback)
+    {
+        // Values that are not valid numbers of the array type are left for the regular path, which reports errors.
+        testNumberArrayFallback<int>(ctx, "[ 1 2 2147483648 ]", { 1, 2 }, "2147483648");
+        testNumberArrayFallback<int>(ctx, "[ 1 -2147483649 ]", { 1 }, "-2147483649");
+        testNumberArrayFallback<int>(ctx, "[ 1 2.5 ]", { 1 }, "2.5");
+        testNumberArrayFallback<int>(ctx, "[ 1 1e3 ]", { 1 }, "1e3");
+        testNumberArrayFallback<pbrt::Float>(ctx, "[ 1 \"x\" ]", { 1.f }, "\"x\"");
+        testNumberArrayFallback<pbrt::Float>(ctx, "[ 1 true ]", { 1.f }, "true");
+        testNumberArrayFallback<pbrt::Float>(ctx, "[ 1 - 2 ]", { 1.f }, "-");
+        testNumberArrayFallback<pbrt::Float>(ctx, "[ 1 1.2.3 ]", { 1.f }, "1.2.3");
+        testNumberArrayFallback<pbrt::Float>(ctx, "[ 1 2x ]", { 1.f }, "2x");
+
+        // The end of the file is left to the regular path, as the array may continue in the including file.
+        testNumberArrayFallback<pbrt::Float>(ctx, "[ 1 2", { 1.f, 2.f }, "");
+        testNumberArrayFallback<pbrt::Float>(ctx, "[ 1 2 # comment", { 1.f, 2.f }, "");
+    }
+
+    CPU_TEST(PBRTParserNumberArray)
+    {
+        auto pScene = parseScene(
+            "WorldBegin\n"
+            "Shape \"trianglemesh\" \"point3 P\" [ 0 0 0  1 0 0  0 1 0 ] \"integer indices\" [ 0 1 2 ]\n"
+            "    \"float alpha\" [ 0.5 ] \"float beta\" 2 \"string name\" [ \"tri\" ] \"bool flag\" [ true ]\n"
+            "    \"spectrum s\" [ 300 .5 800 1 ] \"float empty\" [ ]\n");
+
+        EXPECT_EQ(pScene->getShapes().size(), 1);
+        if (pScene->getShapes().size() != 1) return;
+        const auto& shape = pScene->getShapes()[0];
+
+        auto expectFloats = [&](const std::string& name, const std::vector<pbrt::Float>& expected)
+        {
+            auto pParam = findParameter(shape, name);
+            EXPECT(pParam && pParam->floats == expected) << name;
+        };
+        expectFloats("P", { 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 0.f });
+        expectFloats("alpha", { 0.5f });
+        expectFloats("beta", { 2.f });
+        expectFloats("s", { 300.f, 0.5f, 800.f, 1.f });
+        expectFloats("empty", {});
+
+        auto pIndices = findParameter(shape, "indices");
+        EXPECT(pIndices && pIndices->ints == std::vector<int>({ 0, 1, 2 }));
+        auto pName = findParameter(shape, "name");
+        EXPECT(pName && pName->strings == std::vector<std::string>({ "tri" }));
+        auto pFlag = findParameter(shape, "flag");
+        EXPECT(pFlag && pFlag->bools == std::vector<uint8_t>({ 1 }));
+
+        // Malformed arrays are reported by the regular path.
+        auto parseShape = [](const std::string& param)
+        {
+            parseScene("WorldBegin\nShape \"trianglemesh\" " + param + "\n");
+        };
+        EXPECT(throws<RuntimeError>([&]() { parseShape("\"integer indices\" [ 0 1 2.5 ]"); }));
+        EXPECT(throws<RuntimeError>([&]() { parseShape("\"integer indices\" [ 0 1 2147483648 ]"); }));
+        EXPECT(throws<RuntimeError>([&]() { parseShape("\"integer indices\" [ 0 1 \"2\" ]"); }));
+        EXPECT(throws<RuntimeError>([&]() { parseShape("\"point3 P\" [ 0 0 x ]"); }));
+        EXPECT(throws<RuntimeError>([&]() { parseShape("\"point3 P\" [ 0 0 - ]"); }));
+        EXPECT(throws<RuntimeError>([&]() { parseShape("\"float alpha\" [ 1 true ]"); }));
+        EXPECT(throws<RuntimeError>([&]() { parseShape("\"float alpha\" [ 1 \"a\" ]"); }));
+        EXPECT(throws<RuntimeError>([&]() { parseShape("\"float alpha\" [ 1 2"); }));
+    }
+
+    CPU_TEST(PBRTParserNumberArrayFile)
+    {
+        std::filesystem::path directory = getTempFilePath();
+        std::filesystem::create_directories(directory);
+
+        // Arrays ending at the end of the memory mapped file.
+        for (bool closed : { true, false })
+        {
+            std::vector<pbrt::Float> positions;
+            writeFile(directory / "large.pbrt", createLargeMeshScene(closed, positions));
+            EXPECT_EQ(std::filesystem::file_size(directory / "large.pbrt") % 4096, 0);
+
+            if (closed)
+            {
+                auto pScene = parseSceneFile(directory / "large.pbrt");
+                EXPECT_EQ(pScene->getShapes().size(), 1);
+                auto pP = pScene->getShapes().empty() ? nullptr : findParameter(pScene->getShapes()[0], "P");
+                EXPECT(pP && pP->floats == positions);
+            }
+            else
+            {
+                EXPECT(throws<RuntimeError>([&]() { parseSceneFile(directory / "large.pbrt"); }));
+            }
+        }
+
+        // Arrays continuing after the end of an included file.
+        writeFile(directory / "include.pbrt", "Shape \"trianglemesh\" \"point3 P\" [ 0 0 0  1 0");
+        writeFile(directory / "main.pbrt", "WorldBegin\nInclude \"include.pbrt\" 0  0 1 0 ] \"integer indices\" [ 0 1 2 ]\n");
+        {
+            auto pScene = parseSceneFile(directory / "main.pbrt");
+            EXPECT_EQ(pScene->getShapes().size(), 1);
+            auto pP = pScene->getShapes().empty() ? nullptr : findParameter(pScene->getShapes()[0], "P");
+            EXPECT(pP && pP->floats == std::vector<pbrt::Float>({ 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 0.f }));
+        }
+
+        std::filesystem::remove_all(directory);
+    }
+
+    CPU_TEST(PBRTParserImport)
+    {
+        std::filesystem::path directory = getTempFilePath();
+        std::filesystem::create_directories(directory);
+
+        writeFile(directory / "main.pbrt",
+            "WorldBegin\n"
+            "Material \"diffuse\"\n"
+            "AttributeBegin\n"
+            "  AreaLightSource \"diffuse\"\n"
+            "  Shape \"sphere\"\n"
+            "AttributeEnd\n"
+            "Import \"import.pbrt\"\n"
+            "Material \"coateddiffuse\"\n"
+            "AttributeBegin\n"
+            "  AreaLightSource \"diffuse\"\n"
+            "  Shape \"disk\"\n"
+            "AttributeEnd\n");
+
+        // Material and area light indices of the imported file are local to it until merged.
+        writeFile(directory / "import.pbrt",
+            "Shape \"cylinder\"\n"
+            "Material \"conductor\"\n"
+            "AttributeBegin\n"
+            "  AreaLightSource \"diffuse\"\n"
+            "  Shape \"trianglemesh\" \"point3 P\" [ 0 0 0  1 0 0  0 1 0 ] \"integer indices\" [ 0 1 2 ]\n"
+            "AttributeEnd\n"
+            "MakeNamedMaterial \"gold\" \"string type\" \"conductor\"\n"
+            "AttributeBegin\n"
+            "  NamedMaterial \"gold\"\n"
+            "  Shape \"bilinearmesh\"\n"
+            "AttributeEnd\n"
+            "ObjectBegin \"object\"\n"
+            "  Material \"dielectric\"\n"
+            "  Shape \"sphere\"\n"
+            "ObjectEnd\n"
+            "ObjectInstance \"object\"\n");
+
+        auto pScene = parseSceneFile(directory / "main.pbrt");
+
+        const auto& materials = pScene->getMaterials();
+        EXPECT_EQ(materials.size(), 4);
+        if (materials.size() == 4)
+        {
+            const std::vector<std::string> expectedTypes = { "diffuse", "coateddiffuse", "conductor", "dielectric" };
+            for (size_t i = 0; i < materials.size(); ++i)
+            {
+                EXPECT_EQ(materials[i].type, expectedTypes[i]) << "material " << i;
+                EXPECT_EQ(materials[i].name, "Unnamed" + std::to_string(i)) << "material " << i;
+            }
+        }
+        EXPECT_EQ(pScene->getNamedMaterials().count("gold"), 1);
+        EXPECT_EQ(pScene->getAreaLightCount(), 3u);
+
+        // Shapes of the imported file follow the shapes of the importing file.
+        struct ExpectedShape
+        {
+            std::string name;
+            pbrt::MaterialRef materialRef;
+            int lightIndex;
+        };
+        const std::vector<ExpectedShape> expectedShapes =
+        {
+            { "sphere", 0u, 0 },
+            { "disk", 1u, 1 },
+            { "cylinder", 0u, -1 },
+            { "trianglemesh", 2u, 2 },
+            { "bilinearmesh", std::string("gold"), -1 },
+        };
+        const auto& shapes = pScene->getShapes();
+        EXPECT_EQ(shapes.size(), expectedShapes.size());
+        for (size_t i = 0; i < std::min(shapes.size(), expectedShapes.size()); ++i)
+        {
+            EXPECT_EQ(shapes[i].name, expectedShapes[i].name) << "shape " << i;
+            EXPECT(shapes[i].materialRef == expectedShapes[i].materialRef) << "shape " << i;
+            EXPECT_EQ(shapes[i].lightIndex, expectedShapes[i].lightIndex) << "shape " << i;
+        }
+
+        const auto& instanceDefinitions = pScene->getInstanceDefinitions();
+        auto it = instanceDefinitions.find("object");
+        EXPECT(it != instanceDefinitions.end());
+        if (it != instanceDefinitions.end())
+        {
+            EXPECT_EQ(it->second.shapes.size(), 1);
+            EXPECT(!it->second.shapes.empty() && it->second.shapes[0].materialRef == pbrt::MaterialRef(3u));
+        }
+        EXPECT_EQ(pScene->getInstances().size(), 1);
+
+        std::filesystem::remove_all(directory);
+    }
+
+    CPU_TEST(PBRTParserImportErrors)
+    {
+        std::filesystem::path directory = getTempFilePath();
+        std::filesystem::create_directories(directory);
+
+        auto getImportError = [&](const std::string& main, const std::string& import)
+        {
+            writeFile(directory / "main.pbrt", "WorldBegin\n" + main);
+            writeFile(directory / "import.pbrt", import);
+            return getParseError(directory / "main.pbrt");
+        };
+
+        EXPECT_EQ(getImportError("Import \"import.pbrt\"\n", "Shape \"sphere\"\n"), "");
+
+        // Names defined by both files, before or after the Import directive.
+        const std::vector<std::string> definitions =
+        {
+            "MakeNamedMaterial \"a\" \"string type\" \"diffuse\"\n",
+            "MakeNamedMedium \"a\" \"string type\" \"homogeneous\"\n",
+            "Texture \"a\" \"float\" \"constant\"\n",
+            "Texture \"a\" \"spectrum\" \"constant\"\n",
+            "ObjectBegin \"a\"\nObjectEnd\n",
+        };
+        for (const auto& definition : definitions)
+        {
+            std::string error = getImportError(definition + "Import \"import.pbrt\"\n", definition);
+            EXPECT(error.find("Imported file redefines") != std::string::npos) << definition << error;
+            error = getImportError("Import \"import.pbrt\"\n" + definition, definition);
+            EXPECT(error.find("Imported file redefines") != std::string::npos) << definition << error;
+        }
+
+        // Unterminated blocks in the imported file.
+        std::string error = getImportError("Import \"import.pbrt\"\n", "AttributeBegin\nShape \"sphere\"\n");
+        EXPECT(error.find("Missing end to AttributeBegin") != std::string::npos) << error;
+        error = getImportError("Import \"import.pbrt\"\n", "ObjectBegin \"a\"\nShape \"sphere\"\n");
+        EXPECT(error.find("Missing end to ObjectBegin") != std::string::npos) << error;
+
+        // Import is not allowed inside of instance definitions.
+        error = getImportError("ObjectBegin \"a\"\nImport \"import.pbrt\"\nObjectEnd\n", "Shape \"sphere\"\n");
+        EXPECT(error.find("Import can't be called inside instance definition") != std::string::npos) << error;
+
+        std::filesystem::remove_all(directory);
+    }
+}
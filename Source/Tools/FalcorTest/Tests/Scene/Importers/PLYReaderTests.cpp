@@ -0,0 +1,204 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Importers/PBRTImporter/PLYReader.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        template<typename T>
+        void append(std::string& data, T value, bool bigEndian)
+        {
+            const char* bytes = reinterpret_cast<const char*>(&value);
+            for (size_t i = 0; i < sizeof(T); ++i) data.push_back(bytes[bigEndian ? sizeof(T) - 1 - i : i]);
+        }
+
+        bool throws(const std::string& data)
+        {
+            try
+            {
+                pbrt::loadPLY(data.data(), data.size(), "test");
+            }
+            catch (const RuntimeError&)
+            {
+                return true;
+            }
+            return false;
+        }
+    }
+
+    CPU_TEST(PLYReaderAscii)
+    {
+        const std::string data =
+            "ply\r\n"
+            "format ascii 1.0\n"
+            "comment quad with texture coordinates\n"
+            "element vertex 4\n"
+            "property float x\nproperty float y\nproperty float z\n"
+            "property float u\nproperty float v\n"
+            "element face 1\n"
+            "property list uchar int vertex_indices\n"
+            "property int face_indices\n"
+            "end_header\n"
+            "0 0 0 0 0\n"
+            "1 0 0 1 0\n"
+            "1 1 0 1 1\n"
+            "0 1 0 0 +1\n"
+            "4 0 1 2 3 7\n";
+
+        auto mesh = pbrt::loadPLY(data.data(), data.size(), "test");
+        EXPECT_EQ(mesh.positions.size(), 4);
+        EXPECT_EQ(mesh.texCoords.size(), 4);
+        EXPECT_EQ(mesh.texCoords[3].y, 1.f);
+
+        // The quad is split into two triangles, the face index property is skipped.
+        const std::vector<uint32_t> expectedIndices = { 0, 1, 2, 0, 2, 3 };
+        EXPECT(mesh.indices == expectedIndices);
+
+        // Normals are computed if not stored in the file.
+        EXPECT_EQ(mesh.normals.size(), 4);
+        for (const auto& n : mesh.normals) EXPECT_EQ(n, float3(0.f, 0.f, 1.f));
+    }
+
+    CPU_TEST(PLYReaderBinary)
+    {
+        for (bool bigEndian : { false, true })
+        {
+            std::string data = std::string("ply\nformat ") + (bigEndian ? "binary_big_endian" : "binary_little_endian") + " 1.0\n"
+                "element vertex 3\n"
+                "property float x\nproperty float y\nproperty float z\n"
+                "property double nx\nproperty float ny\nproperty float nz\n"
+                "property uchar red\n"
+                "element material 1\n"
+                "property list uchar float values\n"
+                "element face 1\n"
+                "property list uchar uint vertex_indices\n"
+                "end_header\n";
+
+            const float3 positions[] = { float3(0.f, 0.f, 0.f), float3(2.f, 0.f, 0.f), float3(0.f, 3.f, 0.f) };
+            for (const auto& p : positions)
+            {
+                append(data, p.x, bigEndian);
+                append(data, p.y, bigEndian);
+                append(data, p.z, bigEndian);
+                append(data, 1.0, bigEndian);
+                append(data, 0.f, bigEndian);
+                append(data, 0.f, bigEndian);
+                append(data, (uint8_t)255, bigEndian);
+            }
+
+            // Unknown elements are skipped.
+            append(data, (uint8_t)2, bigEndian);
+            append(data, 1.f, bigEndian);
+            append(data, 2.f, bigEndian);
+
+            append(data, (uint8_t)3, bigEndian);
+            for (uint32_t i : { 2u, 1u, 0u }) append(data, i, bigEndian);
+
+            auto mesh = pbrt::loadPLY(data.data(), data.size(), "test");
+            EXPECT_EQ(mesh.positions.size(), 3);
+            for (size_t i = 0; i < 3; ++i) EXPECT_EQ(mesh.positions[i], positions[i]);
+            for (const auto& n : mesh.normals) EXPECT_EQ(n, float3(1.f, 0.f, 0.f));
+            EXPECT(mesh.texCoords.empty());
+            const std::vector<uint32_t> expectedIndices = { 2, 1, 0 };
+            EXPECT(mesh.indices == expectedIndices);
+
+            // Truncated data.
+            EXPECT(throws(data.substr(0, data.size() - 1)));
+        }
+    }
+
+    CPU_TEST(PLYReaderErrors)
+    {
+        const std::string header =
+            "ply\n"
+            "format ascii 1.0\n"
+            "element vertex 3\n"
+            "property float x\nproperty float y\nproperty float z\n"
+            "element face 1\n"
+            "property list uchar int vertex_indices\n"
+            "end_header\n"
+            "0 0 0\n1 0 0\n0 1 0\n";
+
+        EXPECT(!throws(header + "3 0 1 2\n"));
+        EXPECT(throws(header + "3 0 1 3\n"));
+        EXPECT(throws(header + "3 0 1 -1\n"));
+        EXPECT(throws(header + "3 0 1\n"));
+        EXPECT(throws(header + "3 0 1 x\n"));
+        EXPECT(throws("ply\nformat foo 1.0\nend_header\n"));
+        EXPECT(throws("obj\n"));
+    }
+
+    CPU_TEST(PLYReaderCorruptCounts)
+    {
+        // Binary triangle, followed by the elements in the given header lines and data.
+        auto createBinary = [](const std::string& vertexCount, const std::string& extraHeader, const std::string& extraData)
+        {
+            std::string data = "ply\nformat binary_little_endian 1.0\n"
+                "element vertex " + vertexCount + "\n"
+                "property float x\nproperty float y\nproperty float z\n"
+                "element face 1\n"
+                "property list uchar int vertex_indices\n" +
+                extraHeader +
+                "end_header\n";
+            for (float v : { 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 0.f }) append(data, v, false);
+            append(data, (uint8_t)3, false);
+            for (int32_t i : { 0, 1, 2 }) append(data, i, false);
+            return data + extraData;
+        };
+
+        std::string extraData;
+        append(extraData, 1.f, false);
+        EXPECT(!throws(createBinary("3", "element material 1\nproperty float v\n", extraData)));
+
+        // Element sizes that overflow when multiplied with the count.
+        EXPECT(throws(createBinary("3", "element material 4611686018427387905\nproperty float v\n", extraData)));
+        EXPECT(throws(createBinary("4611686018427387905", "", "")));
+        EXPECT(throws(createBinary("18446744073709551615", "", "")));
+
+        // Negative list counts.
+        std::string listData;
+        append(listData, (int32_t)-1, false);
+        append(listData, 1.f, false);
+        EXPECT(throws(createBinary("3", "element material 1\nproperty list int float values\n", listData)));
+
+        // Counts exceeding the size of the file.
+        const std::string ascii =
+            "ply\n"
+            "format ascii 1.0\n"
+            "element vertex 3\n"
+            "property float x\nproperty float y\nproperty float z\n"
+            "element face 1000000000000\n"
+            "property list uchar int vertex_indices\n"
+            "end_header\n"
+            "0 0 0\n1 0 0\n0 1 0\n"
+            "3 0 1 2\n";
+        EXPECT(throws(ascii));
+    }
+}
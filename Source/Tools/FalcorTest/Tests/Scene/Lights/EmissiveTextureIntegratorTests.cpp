@@ -0,0 +1,183 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Lights/EmissiveTextureIntegrator.h"
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        EmissiveTextureIntegrator::TextureData createRandomTexture(uint32_t width, uint32_t height, uint32_t seed)
+        {
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<float> dist(0.f, 4.f);
+            EmissiveTextureIntegrator::TextureData texture;
+            texture.width = width;
+            texture.height = height;
+            texture.texels.resize((size_t)width * height);
+            for (auto& t : texture.texels) t = float3(dist(rng), dist(rng), dist(rng));
+            return texture;
+        }
+
+        /** Reference integration by point sampling the triangle on a fine regular grid in texel space.
+        */
+        float3 integrateReference(const EmissiveTextureIntegrator::TextureData& texture, const float2 texCoords[3], uint32_t samplesPerTexel)
+        {
+            const float2 dim((float)texture.width, (float)texture.height);
+            float2 pos[3];
+            for (uint32_t i = 0; i < 3; i++) pos[i] = texCoords[i] * dim;
+            auto edge = [](float2 a, float2 b, float2 p) { return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x); };
+            const float sign = edge(pos[0], pos[1], pos[2]) < 0.f ? -1.f : 1.f;
+
+            const float2 posMin = min(min(pos[0], pos[1]), pos[2]);
+            const float2 posMax = max(max(pos[0], pos[1]), pos[2]);
+            double sum[3] = {};
+            uint64_t count = 0;
+            for (int64_t y = (int64_t)std::floor(posMin.y); y < (int64_t)std::ceil(posMax.y); y++)
+            {
+                for (int64_t x = (int64_t)std::floor(posMin.x); x < (int64_t)std::ceil(posMax.x); x++)
+                {
+                    for (uint32_t s = 0; s < samplesPerTexel * samplesPerTexel; s++)
+                    {
+                        float2 p((float)x + ((s % samplesPerTexel) + 0.5f) / samplesPerTexel, (float)y + ((s / samplesPerTexel) + 0.5f) / samplesPerTexel);
+                        if (sign * edge(pos[0], pos[1], p) < 0.f || sign * edge(pos[1], pos[2], p) < 0.f || sign * edge(pos[2], pos[0], p) < 0.f) continue;
+                        float3 c = texture.fetch(x, y);
+                        for (uint32_t i = 0; i < 3; i++) sum[i] += c[i];
+                        count++;
+                    }
+                }
+            }
+            return count > 0 ? float3((float)(sum[0] / count), (float)(sum[1] / count), (float)(sum[2] / count)) : float3(0.f);
+        }
+    }
+
+    CPU_TEST(EmissiveTextureIntegratorClippedArea)
+    {
+        const float2 tri[3] = { float2(0.f, 0.f), float2(2.f, 0.f), float2(0.f, 2.f) };
+        EXPECT_EQ(EmissiveTextureIntegrator::computeClippedTriangleArea(tri, float2(0.f, 0.f), float2(1.f, 1.f)), 1.f);
+        EXPECT_EQ(EmissiveTextureIntegrator::computeClippedTriangleArea(tri, float2(1.f, 0.f), float2(2.f, 1.f)), 0.5f);
+        EXPECT_EQ(EmissiveTextureIntegrator::computeClippedTriangleArea(tri, float2(1.f, 1.f), float2(2.f, 2.f)), 0.f);
+        EXPECT_EQ(EmissiveTextureIntegrator::computeClippedTriangleArea(tri, float2(-1.f, -1.f), float2(3.f, 3.f)), 2.f);
+
+        // Same configuration far from the origin with opposite winding.
+        const float2 offset(8192.f, 4096.f);
+        const float2 farTri[3] = { tri[0] + offset, tri[2] + offset, tri[1] + offset };
+        EXPECT_EQ(EmissiveTextureIntegrator::computeClippedTriangleArea(farTri, float2(1.f, 0.f) + offset, float2(2.f, 1.f) + offset), 0.5f);
+    }
+
+    CPU_TEST(EmissiveTextureIntegratorTriangles)
+    {
+        auto texture = createRandomTexture(16, 8, 3);
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> dist(0.f, 1.f);
+
+        for (uint32_t i = 0; i < 20; i++)
+        {
+            float2 texCoords[3];
+            for (auto& uv : texCoords) uv = float2(dist(rng), dist(rng));
+
+            float weight = 0.f;
+            float3 result = EmissiveTextureIntegrator::integrateTriangle(texture, texCoords, &weight);
+
+            // The total weight is the triangle's area in texels.
+            float2 e1 = (texCoords[1] - texCoords[0]) * float2(16.f, 8.f);
+            float2 e2 = (texCoords[2] - texCoords[0]) * float2(16.f, 8.f);
+            float area = 0.5f * std::abs(e1.x * e2.y - e1.y * e2.x);
+            EXPECT_LE(std::abs(weight - area), 1e-3f * std::max(area, 1.f));
+            if (area < 0.5f) continue;
+
+            float3 reference = integrateReference(texture, texCoords, 64);
+            for (uint32_t c = 0; c < 3; c++) EXPECT_LE(std::abs(result[c] - reference[c]), 2e-2f) << "triangle " << i << " channel " << c;
+
+            // With wrap addressing, shifting the texture coordinates by whole periods gives the same result.
+            const float2 shift(-3.f, 2.f);
+            float2 shifted[3] = { texCoords[0] + shift, texCoords[1] + shift, texCoords[2] + shift };
+            float3 shiftedResult = EmissiveTextureIntegrator::integrateTriangle(texture, shifted);
+            for (uint32_t c = 0; c < 3; c++) EXPECT_LE(std::abs(shiftedResult[c] - result[c]), 1e-3f);
+        }
+
+        // Triangles that are degenerate in texture space use the average over the vertices.
+        const float2 line[3] = { float2(0.1f, 0.1f), float2(0.5f, 0.5f), float2(0.9f, 0.9f) };
+        float weight = -1.f;
+        float3 result = EmissiveTextureIntegrator::integrateTriangle(texture, line, &weight);
+        float3 expected = (texture.sample(line[0]) + texture.sample(line[1]) + texture.sample(line[2])) / 3.f;
+        EXPECT_EQ(weight, 0.f);
+        for (uint32_t c = 0; c < 3; c++) EXPECT_EQ(result[c], expected[c]);
+    }
+
+    CPU_TEST(EmissiveTextureIntegratorAddressModes)
+    {
+        auto texture = createRandomTexture(4, 4, 11);
+
+        texture.addressModeU = texture.addressModeV = Sampler::AddressMode::Wrap;
+        EXPECT(texture.fetch(-1, 5) == texture.fetch(3, 1));
+        texture.addressModeU = texture.addressModeV = Sampler::AddressMode::Clamp;
+        EXPECT(texture.fetch(-1, 5) == texture.fetch(0, 3));
+        texture.addressModeU = texture.addressModeV = Sampler::AddressMode::Mirror;
+        EXPECT(texture.fetch(-1, 5) == texture.fetch(0, 2));
+        EXPECT(texture.fetch(9, -6) == texture.fetch(1, 2));
+        texture.addressModeU = texture.addressModeV = Sampler::AddressMode::MirrorOnce;
+        EXPECT(texture.fetch(-2, 9) == texture.fetch(1, 3));
+        texture.addressModeU = texture.addressModeV = Sampler::AddressMode::Border;
+        EXPECT(texture.fetch(-1, 0) == float3(0.f));
+        EXPECT(texture.fetch(2, 3) == texture.texels[14]);
+    }
+
+    CPU_TEST(EmissiveTextureIntegratorFormats)
+    {
+        EXPECT(EmissiveTextureIntegrator::isFormatSupported(ResourceFormat::RGBA8UnormSrgb));
+        EXPECT(EmissiveTextureIntegrator::isFormatSupported(ResourceFormat::RGBA32Float));
+        EXPECT(!EmissiveTextureIntegrator::isFormatSupported(ResourceFormat::BC1Unorm));
+        EXPECT(!EmissiveTextureIntegrator::isFormatSupported(ResourceFormat::R11G11B10Float));
+
+        // 2x1 texture with row padding. Channels missing from the format are read as zero.
+        {
+            const uint8_t data[12] = { 255, 0, 51, 7, 0, 255, 0, 9, 0xcd, 0xcd, 0xcd, 0xcd };
+            auto texture = EmissiveTextureIntegrator::createTextureData(data, 2, 1, 12, ResourceFormat::BGRA8Unorm);
+            EXPECT(texture.texels[0] == float3(0.2f, 0.f, 1.f));
+            EXPECT(texture.texels[1] == float3(0.f, 1.f, 0.f));
+
+            auto srgb = EmissiveTextureIntegrator::createTextureData(data, 2, 1, 12, ResourceFormat::RGBA8UnormSrgb);
+            EXPECT_LE(std::abs(srgb.texels[0].z - 0.0331f), 1e-4f);
+            EXPECT_EQ(srgb.texels[0].x, 1.f);
+
+            auto r8 = EmissiveTextureIntegrator::createTextureData(data, 2, 1, 12, ResourceFormat::R8Unorm);
+            EXPECT(r8.texels[0] == float3(1.f, 0.f, 0.f));
+            EXPECT(r8.texels[1] == float3(0.f, 0.f, 0.f));
+        }
+        {
+            const uint16_t data[4] = { 0x3c00, 0x4000, 0xbc00, 0x3800 }; // 1, 2, -1, 0.5
+            auto texture = EmissiveTextureIntegrator::createTextureData(data, 1, 2, 4, ResourceFormat::RG16Float);
+            EXPECT(texture.texels[0] == float3(1.f, 2.f, 0.f));
+            EXPECT(texture.texels[1] == float3(-1.f, 0.5f, 0.f));
+        }
+    }
+}
@@ -0,0 +1,104 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MaterialSystem.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Scene/Material/ClothMaterial.h"
+
+namespace Falcor
+{
+    GPU_TEST(MaterialSystemAddMaterial)
+    {
+        auto pMaterials = MaterialSystem::create();
+        auto pMaterialA = StandardMaterial::create("A");
+        auto pMaterialB = StandardMaterial::create("B");
+
+        MaterialID idA = pMaterials->addMaterial(pMaterialA);
+        MaterialID idB = pMaterials->addMaterial(pMaterialB);
+        EXPECT_NE(idA.get(), idB.get());
+        EXPECT_EQ(pMaterials->addMaterial(pMaterialA).get(), idA.get());
+        EXPECT_EQ(pMaterials->addMaterial(pMaterialB).get(), idB.get());
+        EXPECT_EQ(pMaterials->getMaterialCount(), 2);
+
+        // Replaced materials are looked up by the replacement.
+        auto pMaterialC = StandardMaterial::create("C");
+        pMaterials->replaceMaterial(pMaterialA, pMaterialC);
+        EXPECT_EQ(pMaterials->addMaterial(pMaterialC).get(), idA.get());
+        EXPECT_EQ(pMaterials->getMaterialCount(), 2);
+        EXPECT_EQ(pMaterials->addMaterial(pMaterialA).get(), 2);
+    }
+
+    GPU_TEST(MaterialSystemRemoveDuplicates)
+    {
+        auto createMaterial = [](const std::string& name, float4 baseColor, float3 emissive)
+        {
+            auto pMaterial = StandardMaterial::create(name);
+            pMaterial->setBaseColor(baseColor);
+            pMaterial->setEmissiveColor(emissive);
+            return pMaterial;
+        };
+
+        std::vector<Material::SharedPtr> materials =
+        {
+            createMaterial("red", float4(1.f, 0.f, 0.f, 1.f), float3(0.f)),
+            createMaterial("green", float4(0.f, 1.f, 0.f, 1.f), float3(0.f)),
+            createMaterial("red2", float4(1.f, 0.f, 0.f, 1.f), float3(0.f)),
+            createMaterial("green2", float4(0.f, 1.f, 0.f, 1.f), float3(0.f)),
+            createMaterial("emissive", float4(1.f, 0.f, 0.f, 1.f), float3(1.f)),
+            ClothMaterial::create("cloth"), // Different type with default parameters.
+        };
+
+        // Equal materials must have equal hashes.
+        for (size_t i = 0; i < materials.size(); i++)
+        {
+            for (size_t j = 0; j < materials.size(); j++)
+            {
+                if (materials[i]->isEqual(materials[j])) EXPECT_EQ(materials[i]->hash(), materials[j]->hash()) << "i = " << i << " j = " << j;
+            }
+        }
+
+        auto pMaterials = MaterialSystem::create();
+        for (const auto& pMaterial : materials) pMaterials->addMaterial(pMaterial);
+
+        std::vector<MaterialID> idMap;
+        size_t removed = pMaterials->removeDuplicateMaterials(idMap);
+        EXPECT_EQ(removed, 2);
+        EXPECT_EQ(pMaterials->getMaterialCount(), 4);
+
+        const uint32_t expectedIDs[] = { 0, 1, 0, 1, 2, 3 };
+        EXPECT_EQ(idMap.size(), materials.size());
+        for (size_t i = 0; i < idMap.size(); i++)
+        {
+            EXPECT_EQ(idMap[i].get(), expectedIDs[i]) << "i = " << i;
+        }
+
+        // Lookup of remaining materials uses the new IDs.
+        EXPECT_EQ(pMaterials->addMaterial(materials[4]).get(), 2);
+        EXPECT_EQ(pMaterials->getMaterialCount(), 4);
+    }
+}
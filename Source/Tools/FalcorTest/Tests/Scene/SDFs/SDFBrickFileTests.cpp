@@ -0,0 +1,209 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SDFs/SDFBrickFile.h"
+#include "Scene/SDFs/SparseBrickSet/SDFSBS.h"
+#include "Utils/Math/AABB.h"
+#include "Core/Platform/OS.h"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Corner values of a sphere with radius 0.3 in the [-0.5, 0.5]^3 grid.
+        */
+        std::vector<float> createSphereValues(uint32_t gridWidth)
+        {
+            const uint32_t w = gridWidth + 1;
+            std::vector<float> values((size_t)w * w * w);
+            for (uint32_t z = 0; z < w; ++z)
+            {
+                for (uint32_t y = 0; y < w; ++y)
+                {
+                    for (uint32_t x = 0; x < w; ++x)
+                    {
+                        float px = float(x) / gridWidth - 0.5f;
+                        float py = float(y) / gridWidth - 0.5f;
+                        float pz = float(z) / gridWidth - 0.5f;
+                        values[x + w * (y + w * z)] = std::sqrt(px * px + py * py + pz * pz) - 0.3f;
+                    }
+                }
+            }
+            return values;
+        }
+    }
+
+    CPU_TEST(SDFBrickFileRoundTrip)
+    {
+        // Use a grid width that is not a multiple of the brick width.
+        SDFBrickFile::Desc desc;
+        desc.gridWidth = 37;
+        desc.brickWidth = 4;
+        desc.narrowBandThickness = 2.f;
+
+        auto values = createSphereValues(desc.gridWidth);
+        std::filesystem::path path = getTempFilePath();
+        SDFBrickFile::write(path, values, desc);
+        EXPECT(SDFBrickFile::isBrickFile(path));
+        EXPECT_LT(std::filesystem::file_size(path), values.size() * sizeof(float));
+
+        auto pFile = SDFBrickFile::open(path);
+        EXPECT_EQ(pFile->getDesc().gridWidth, desc.gridWidth);
+        EXPECT_EQ(pFile->getDesc().brickWidth, desc.brickWidth);
+        EXPECT_EQ(pFile->getBrickGridWidth(), 10u);
+        EXPECT_GT(pFile->getBrickCount(), 0u);
+        EXPECT_LT(pFile->getBrickCount(), 1000u);
+
+        uint32_t brickCount = 0;
+        pFile->readBricks([&](const uint3& brickCoord, const float* pValues)
+        {
+            EXPECT(brickCoord.x < 10 && brickCoord.y < 10 && brickCoord.z < 10);
+            brickCount++;
+        });
+        EXPECT_EQ(brickCount, pFile->getBrickCount());
+
+        // Values close to the surface are preserved, values further away are never overestimated and keep their sign.
+        auto readValues = pFile->readDenseValues();
+        EXPECT_EQ(readValues.size(), values.size());
+        if (readValues.size() != values.size()) return;
+        const float narrowBandDistance = desc.narrowBandThickness * std::sqrt(3.f) / desc.gridWidth;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            if (std::abs(values[i]) <= narrowBandDistance)
+            {
+                EXPECT_LE(std::abs(readValues[i] - values[i]), 1e-4f) << "index " << i;
+            }
+            else
+            {
+                EXPECT_LE(std::abs(readValues[i]), std::abs(values[i]) + 1e-4f) << "index " << i;
+                EXPECT_GE(readValues[i] * values[i], 0.f) << "index " << i;
+            }
+        }
+
+        pFile.reset();
+        std::filesystem::remove(path);
+    }
+
+    CPU_TEST(SDFBrickFileConvertDense)
+    {
+        const uint32_t gridWidth = 20;
+        auto values = createSphereValues(gridWidth);
+
+        std::filesystem::path densePath = getTempFilePath();
+        {
+            std::ofstream file(densePath, std::ios::binary);
+            file.write(reinterpret_cast<const char*>(&gridWidth), sizeof(uint32_t));
+            file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+        }
+
+        // Converting the legacy file gives the same result as writing the values directly.
+        std::filesystem::path convertedPath = getTempFilePath();
+        std::filesystem::path writtenPath = getTempFilePath();
+        SDFBrickFile::convertDenseFile(densePath, convertedPath, 8);
+        SDFBrickFile::Desc desc;
+        desc.gridWidth = gridWidth;
+        desc.brickWidth = 8;
+        SDFBrickFile::write(writtenPath, values, desc);
+
+        EXPECT(!SDFBrickFile::isBrickFile(densePath));
+        auto converted = SDFBrickFile::open(convertedPath)->readDenseValues();
+        auto written = SDFBrickFile::open(writtenPath)->readDenseValues();
+        EXPECT(converted == written);
+
+        std::filesystem::remove(densePath);
+        std::filesystem::remove(convertedPath);
+        std::filesystem::remove(writtenPath);
+    }
+
+    CPU_TEST(SDFBrickFileInvalidFile)
+    {
+        std::filesystem::path path = getTempFilePath();
+        {
+            std::ofstream file(path, std::ios::binary);
+            file << "not an SDF brick file";
+        }
+        EXPECT(throws<RuntimeError>([&]() { SDFBrickFile::open(path); }));
+        std::filesystem::path dstPath = getTempFilePath();
+        EXPECT(throws<RuntimeError>([&]() { SDFBrickFile::convertDenseFile(path, dstPath); }));
+        std::filesystem::remove(path);
+        std::filesystem::remove(dstPath);
+
+        // Truncated file.
+        SDFBrickFile::Desc desc;
+        desc.gridWidth = 16;
+        SDFBrickFile::write(path, createSphereValues(desc.gridWidth), desc);
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+        EXPECT(throws<RuntimeError>([&]() { SDFBrickFile::open(path); }));
+        std::filesystem::remove(path);
+
+        EXPECT(throws<ArgumentError>([&]() { SDFBrickFile::write(path, std::vector<float>(10), desc); }));
+    }
+
+    GPU_TEST(SDFBrickFileSBSBricks)
+    {
+        // An SBS creates its bricks straight from the narrow band bricks of the file. It must find the same bricks as from the dense values.
+        SDFBrickFile::Desc desc;
+        desc.gridWidth = 37;
+        desc.brickWidth = 4;
+        desc.narrowBandThickness = 2.f;
+
+        std::filesystem::path path = getTempFilePath();
+        SDFBrickFile::write(path, createSphereValues(desc.gridWidth), desc);
+        auto denseValues = SDFBrickFile::open(path)->readDenseValues();
+
+        for (bool compressed : { false, true })
+        {
+            SDFSBS::SharedPtr pFromFile = SDFSBS::create(7, compressed);
+            EXPECT(pFromFile->loadValuesFromFile(path));
+            pFromFile->createResources(ctx.getRenderContext());
+
+            SDFSBS::SharedPtr pFromValues = SDFSBS::create(7, compressed);
+            pFromValues->setValues(denseValues, desc.gridWidth);
+            pFromValues->createResources(ctx.getRenderContext());
+
+            EXPECT_GT(pFromValues->getAABBCount(), 0u);
+            EXPECT_EQ(pFromFile->getAABBCount(), pFromValues->getAABBCount()) << "compressed " << compressed;
+            EXPECT_EQ(pFromFile->getSize(), pFromValues->getSize()) << "compressed " << compressed;
+            if (pFromFile->getAABBCount() != pFromValues->getAABBCount()) continue;
+
+            const float* pFileAABBs = reinterpret_cast<const float*>(pFromFile->getAABBBuffer()->map(Buffer::MapType::Read));
+            const float* pValuesAABBs = reinterpret_cast<const float*>(pFromValues->getAABBBuffer()->map(Buffer::MapType::Read));
+            for (size_t i = 0; i < pFromValues->getAABBCount() * sizeof(AABB) / sizeof(float); ++i)
+            {
+                EXPECT_EQ(pFileAABBs[i], pValuesAABBs[i]) << "i=" << i << " compressed " << compressed;
+            }
+            pFromFile->getAABBBuffer()->unmap();
+            pFromValues->getAABBBuffer()->unmap();
+        }
+
+        std::filesystem::remove(path);
+    }
+}
@@ -0,0 +1,171 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SDFs/SDFValueProcessor.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        std::vector<float> createRandomValues(size_t count, uint32_t seed)
+        {
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<float> dist(-1.5f, 1.5f);
+            std::vector<float> values(count);
+            for (auto& v : values) v = dist(rng);
+            return values;
+        }
+
+        /** Scalar reference matching the per-value loops previously used by the SDF grid implementations.
+        */
+        template<typename T>
+        T quantizeReference(float value, float scale)
+        {
+            float normalizedValue = std::clamp(value * scale, -1.f, 1.f);
+            float integerScale = normalizedValue * float(std::numeric_limits<T>::max());
+            return integerScale >= 0.f ? T(integerScale + 0.5f) : T(integerScale - 0.5f);
+        }
+
+        template<typename T>
+        void testQuantize(CPUUnitTestContext& ctx, float scale)
+        {
+            // Use a count that is not a multiple of any vector width.
+            const auto values = createRandomValues(100003, 17);
+            std::vector<T> quantized(values.size());
+            SDFValueProcessor::quantize(values.data(), values.size(), scale, quantized.data());
+
+            size_t mismatches = 0;
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                if (quantized[i] != quantizeReference<T>(values[i], scale)) mismatches++;
+            }
+            EXPECT_EQ(mismatches, 0);
+        }
+    }
+
+    CPU_TEST(SDFValueProcessorQuantize)
+    {
+        testQuantize<int8_t>(ctx, 1.f);
+        testQuantize<int8_t>(ctx, 0.5f);
+        testQuantize<int16_t>(ctx, 1.f);
+        testQuantize<int16_t>(ctx, 2.f);
+
+        // Values outside [-1, 1] are clamped.
+        const float values[] = { -1.f, 1.f, 0.f, 2.f, -2.f };
+        int8_t quantized[5];
+        SDFValueProcessor::quantize(values, 5, 1.f, quantized);
+        EXPECT_EQ(quantized[0], -127);
+        EXPECT_EQ(quantized[1], 127);
+        EXPECT_EQ(quantized[2], 0);
+        EXPECT_EQ(quantized[3], 127);
+        EXPECT_EQ(quantized[4], -127);
+    }
+
+    CPU_TEST(SDFValueProcessorBricks)
+    {
+        // Use a grid width that is not a multiple of the brick width to exercise clamped bricks.
+        const uint32_t gridWidth = 37;
+        const uint32_t brickWidth = 8;
+        const uint32_t w = gridWidth + 1;
+        const uint32_t n = SDFValueProcessor::getBrickGridWidth(gridWidth, brickWidth);
+        EXPECT_EQ(n, 5);
+
+        const auto values = createRandomValues((size_t)w * w * w, 3);
+        const float scale = 0.75f;
+
+        // Process all layers at once.
+        std::vector<SDFValueProcessor::BrickRange> ranges((size_t)n * n * n);
+        std::vector<int16_t> quantized(values.size(), 0x7fff);
+        SDFValueProcessor::processBricks(values.data(), gridWidth, brickWidth, 0, n, ranges.data(), scale, quantized.data());
+
+        size_t rangeMismatches = 0;
+        for (uint32_t bz = 0; bz < n; ++bz)
+        {
+            for (uint32_t by = 0; by < n; ++by)
+            {
+                for (uint32_t bx = 0; bx < n; ++bx)
+                {
+                    float minValue = std::numeric_limits<float>::max();
+                    float maxValue = std::numeric_limits<float>::lowest();
+                    for (uint32_t z = bz * brickWidth; z <= std::min((bz + 1) * brickWidth, gridWidth); ++z)
+                    {
+                        for (uint32_t y = by * brickWidth; y <= std::min((by + 1) * brickWidth, gridWidth); ++y)
+                        {
+                            for (uint32_t x = bx * brickWidth; x <= std::min((bx + 1) * brickWidth, gridWidth); ++x)
+                            {
+                                const float v = values[x + w * (y + w * z)];
+                                minValue = std::min(minValue, v);
+                                maxValue = std::max(maxValue, v);
+                            }
+                        }
+                    }
+                    const auto& range = ranges[bx + n * (by + n * bz)];
+                    if (range.minValue != minValue || range.maxValue != maxValue) rangeMismatches++;
+                }
+            }
+        }
+        EXPECT_EQ(rangeMismatches, 0);
+
+        size_t valueMismatches = 0;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            if (quantized[i] != quantizeReference<int16_t>(values[i], scale)) valueMismatches++;
+        }
+        EXPECT_EQ(valueMismatches, 0);
+
+        // Processing one layer at a time gives the same ranges.
+        const size_t valuesPerSlice = (size_t)w * w;
+        size_t layerMismatches = 0;
+        for (uint32_t bz = 0; bz < n; ++bz)
+        {
+            std::vector<SDFValueProcessor::BrickRange> layerRanges((size_t)n * n);
+            SDFValueProcessor::processBricks(values.data() + bz * brickWidth * valuesPerSlice, gridWidth, brickWidth, bz, bz + 1, layerRanges.data());
+            for (size_t i = 0; i < layerRanges.size(); ++i)
+            {
+                const auto& range = ranges[bz * n * n + i];
+                if (layerRanges[i].minValue != range.minValue || layerRanges[i].maxValue != range.maxValue) layerMismatches++;
+            }
+        }
+        EXPECT_EQ(layerMismatches, 0);
+
+        // Classification.
+        SDFValueProcessor::BrickRange outside = { 0.5f, 0.9f };
+        SDFValueProcessor::BrickRange inside = { -0.9f, -0.2f };
+        SDFValueProcessor::BrickRange crossing = { -0.1f, 0.3f };
+        EXPECT(!outside.isNarrowBand(0.25f));
+        EXPECT(inside.isNarrowBand(0.25f));
+        EXPECT(crossing.isNarrowBand(0.f));
+        EXPECT_EQ(outside.getClosestValue(), 0.5f);
+        EXPECT_EQ(inside.getClosestValue(), -0.2f);
+        EXPECT_EQ(crossing.getClosestValue(), 0.f);
+    }
+}
@@ -0,0 +1,97 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Two triangles with a vertex each at the same position, as used by a mesh with vertex animation keyframes.
+            At rest vertices 0 and 3 coincide, in the second keyframe vertex 3 has moved.
+        */
+        const float3 kRestPositions[] = { float3(0.f, 0.f, 0.f), float3(1.f, 0.f, 0.f), float3(0.f, 1.f, 0.f), float3(0.f, 0.f, 0.f), float3(-1.f, 0.f, 0.f), float3(0.f, -1.f, 0.f) };
+        const float3 kMovedPositions[] = { float3(0.f, 0.f, 0.f), float3(1.f, 0.f, 0.f), float3(0.f, 1.f, 0.f), float3(0.f, 0.f, 1.f), float3(-1.f, 0.f, 0.f), float3(0.f, -1.f, 0.f) };
+        const float3 kNormals[] = { float3(0.f, 0.f, 1.f), float3(0.f, 0.f, 1.f), float3(0.f, 0.f, 1.f), float3(0.f, 0.f, 1.f), float3(0.f, 0.f, 1.f), float3(0.f, 0.f, 1.f) };
+        const uint32_t kIndices[] = { 0, 1, 2, 3, 4, 5 };
+
+        SceneBuilder::Mesh createCoincidentVertexMesh()
+        {
+            SceneBuilder::Mesh mesh;
+            mesh.name = "coincident";
+            mesh.faceCount = 2;
+            mesh.vertexCount = 6;
+            mesh.indexCount = 6;
+            mesh.pIndices = kIndices;
+            mesh.topology = Vao::Topology::TriangleList;
+            mesh.pMaterial = StandardMaterial::create("coincident");
+            mesh.positions = { kRestPositions, SceneBuilder::Mesh::AttributeFrequency::Vertex };
+            mesh.normals = { kNormals, SceneBuilder::Mesh::AttributeFrequency::Vertex };
+            return mesh;
+        }
+    }
+
+    GPU_TEST(SceneBuilderWeldVertices)
+    {
+        auto pBuilder = SceneBuilder::create(Settings(), SceneBuilder::Flags::WeldVertices | SceneBuilder::Flags::Force32BitIndices);
+        auto processedMesh = pBuilder->processMesh(createCoincidentVertexMesh());
+
+        // Without attribute indices, the coincident vertices are welded.
+        EXPECT_EQ(processedMesh.staticData.size(), 5u);
+        EXPECT_EQ(processedMesh.indexData.size(), 6u);
+        if (processedMesh.indexData.size() != 6) return;
+        EXPECT_EQ(processedMesh.indexData[0], processedMesh.indexData[3]);
+    }
+
+    GPU_TEST(SceneBuilderWeldVerticesKeyframes)
+    {
+        auto pBuilder = SceneBuilder::create(Settings(), SceneBuilder::Flags::WeldVertices | SceneBuilder::Flags::Force32BitIndices);
+        SceneBuilder::MeshAttributeIndices attributeIndices;
+        auto processedMesh = pBuilder->processMesh(createCoincidentVertexMesh(), &attributeIndices);
+
+        EXPECT_EQ(attributeIndices.size(), processedMesh.staticData.size());
+        EXPECT_EQ(processedMesh.indexData.size(), 6u);
+        if (attributeIndices.size() != processedMesh.staticData.size() || processedMesh.indexData.size() != 6) return;
+
+        // Remap both keyframes through the attribute indices the way the USD importer does,
+        // and check that each corner follows its original vertex.
+        for (const float3* pKeyframe : { kRestPositions, kMovedPositions })
+        {
+            for (uint32_t i = 0; i < 6; i++)
+            {
+                uint32_t vertex = processedMesh.indexData[i];
+                EXPECT_LT(vertex, attributeIndices.size());
+                if (vertex >= attributeIndices.size()) return;
+                float3 position = pKeyframe[attributeIndices[vertex].positionIdx];
+                float3 expected = pKeyframe[kIndices[i]];
+                EXPECT(position == expected) << "corner " << i;
+            }
+        }
+    }
+}
@@ -0,0 +1,209 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Volume/GridSequenceStreamer.h"
+#include "Core/Platform/OS.h"
+#include <nanovdb/util/IO.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kFrameCount = 6;
+        const uint32_t kRingSize = 3;
+
+        /** Synthesized grid sequence. Each frame is a sphere with a different radius, identified by its index bounds.
+        */
+        struct TestSequence
+        {
+            std::vector<std::filesystem::path> paths;
+            std::vector<int3> maxIndices;
+            std::string gridname;
+
+            TestSequence()
+            {
+                for (uint32_t frame = 0; frame < kFrameCount; ++frame)
+                {
+                    auto pGrid = Grid::createSphere(4.f + 2.f * frame, 1.f);
+                    std::filesystem::path path = getTempFilePath();
+                    path.replace_extension("nvdb");
+                    nanovdb::io::writeGrid(path.string(), pGrid->getGridHandle());
+                    paths.push_back(path);
+                    maxIndices.push_back(pGrid->getMaxIndex());
+                    gridname = pGrid->getGridHandle().grid<float>()->gridName();
+                }
+            }
+
+            ~TestSequence()
+            {
+                for (const auto& path : paths) std::filesystem::remove(path);
+            }
+        };
+
+        /** Check that a frame is resident and holds the contents of the frame's file.
+        */
+        void expectFrame(GPUUnitTestContext& ctx, const TestSequence& sequence, const GridSequenceStreamer& streamer, uint32_t frame)
+        {
+            auto pGrid = streamer.getGrid(frame);
+            EXPECT(pGrid != nullptr) << "frame " << frame;
+            if (pGrid) EXPECT(pGrid->getMaxIndex() == sequence.maxIndices[frame]) << "frame " << frame;
+        }
+
+        /** Check that the ring grids are the objects the streamer was created with, so the scene can bind them once.
+        */
+        void expectSameRingGrids(GPUUnitTestContext& ctx, const GridSequenceStreamer& streamer, const std::vector<Grid::SharedPtr>& ringGrids)
+        {
+            EXPECT(streamer.getRingGrids() == ringGrids);
+        }
+    }
+
+    GPU_TEST(GridSequenceStreamerPlayback)
+    {
+        TestSequence sequence;
+        auto pStreamer = GridSequenceStreamer::create(sequence.paths, sequence.gridname, kRingSize);
+        EXPECT(pStreamer != nullptr);
+        if (!pStreamer) return;
+
+        EXPECT_EQ(pStreamer->getFrameCount(), kFrameCount);
+        EXPECT_EQ(pStreamer->getRingSize(), kRingSize);
+        const auto ringGrids = pStreamer->getRingGrids();
+
+        // The first frames are resident after creation.
+        for (uint32_t frame = 0; frame < kRingSize; ++frame) expectFrame(ctx, sequence, *pStreamer, frame);
+        EXPECT(pStreamer->getGrid(kRingSize) == nullptr);
+
+        // Sequential playback.
+        for (uint32_t frame = 0; frame < kFrameCount; ++frame)
+        {
+            pStreamer->update(frame, false);
+            expectFrame(ctx, sequence, *pStreamer, frame);
+        }
+        expectSameRingGrids(ctx, *pStreamer, ringGrids);
+
+        // Frames past the end are clamped to the last frame.
+        pStreamer->update(kFrameCount + 10, false);
+        expectFrame(ctx, sequence, *pStreamer, kFrameCount - 1);
+
+        const auto& stats = pStreamer->getStats();
+        EXPECT_GE(stats.framesLoaded, (uint64_t)kFrameCount);
+        EXPECT_EQ(stats.framesLoaded, kRingSize + stats.prefetchHits + stats.stalls);
+    }
+
+    GPU_TEST(GridSequenceStreamerSeek)
+    {
+        TestSequence sequence;
+        auto pStreamer = GridSequenceStreamer::create(sequence.paths, sequence.gridname, kRingSize);
+        EXPECT(pStreamer != nullptr);
+        if (!pStreamer) return;
+        const auto ringGrids = pStreamer->getRingGrids();
+
+        // Seek forward past the window, backward, and to the same frame twice.
+        for (uint32_t frame : { 4u, 1u, 5u, 5u, 0u, 3u })
+        {
+            pStreamer->update(frame, false);
+            expectFrame(ctx, sequence, *pStreamer, frame);
+        }
+        expectSameRingGrids(ctx, *pStreamer, ringGrids);
+
+        // Updating the resident frame again doesn't stall.
+        uint64_t stalls = pStreamer->getStats().stalls;
+        pStreamer->update(3, false);
+        EXPECT_EQ(pStreamer->getStats().stalls, stalls);
+    }
+
+    GPU_TEST(GridSequenceStreamerWrap)
+    {
+        TestSequence sequence;
+        auto pStreamer = GridSequenceStreamer::create(sequence.paths, sequence.gridname, kRingSize);
+        EXPECT(pStreamer != nullptr);
+        if (!pStreamer) return;
+        const auto ringGrids = pStreamer->getRingGrids();
+
+        // Play the sequence twice with looping. Each frame is resident when it is current.
+        for (uint32_t i = 0; i < 2 * kFrameCount; ++i)
+        {
+            uint32_t frame = i % kFrameCount;
+            pStreamer->update(frame, true);
+            expectFrame(ctx, sequence, *pStreamer, frame);
+        }
+        expectSameRingGrids(ctx, *pStreamer, ringGrids);
+
+        // The ring never holds the same frame twice, also when the window wraps around.
+        const auto& ringFrames = pStreamer->getRingFrames();
+        for (size_t i = 0; i < ringFrames.size(); ++i)
+        {
+            for (size_t j = i + 1; j < ringFrames.size(); ++j)
+            {
+                EXPECT(ringFrames[i] == GridSequenceStreamer::kInvalidFrame || ringFrames[i] != ringFrames[j]);
+            }
+        }
+
+        // Without looping, the window stops at the last frame.
+        pStreamer->update(kFrameCount - 1, false);
+        expectFrame(ctx, sequence, *pStreamer, kFrameCount - 1);
+    }
+
+    GPU_TEST(GridSequenceStreamerMissingFrame)
+    {
+        TestSequence sequence;
+        const uint32_t missingFrame = 2;
+        auto paths = sequence.paths;
+        paths[missingFrame] = getTempFilePath().replace_extension("nvdb");
+
+        auto pStreamer = GridSequenceStreamer::create(paths, sequence.gridname, kRingSize);
+        EXPECT(pStreamer != nullptr);
+        if (!pStreamer) return;
+
+        // The missing frame is skipped, the ring holds the frames that loaded.
+        EXPECT_EQ(pStreamer->getRingSize(), kRingSize - 1);
+        expectFrame(ctx, sequence, *pStreamer, 0);
+        expectFrame(ctx, sequence, *pStreamer, 1);
+        const auto ringGrids = pStreamer->getRingGrids();
+
+        for (uint32_t frame = 0; frame < kFrameCount; ++frame)
+        {
+            pStreamer->update(frame, false);
+            if (frame == missingFrame) EXPECT(pStreamer->getGrid(frame) == nullptr);
+            else expectFrame(ctx, sequence, *pStreamer, frame);
+        }
+        expectSameRingGrids(ctx, *pStreamer, ringGrids);
+
+        // Seeking back to the missing frame doesn't retry loading it.
+        uint64_t stalls = pStreamer->getStats().stalls;
+        pStreamer->update(missingFrame, false);
+        EXPECT(pStreamer->getGrid(missingFrame) == nullptr);
+        EXPECT_EQ(pStreamer->getStats().stalls, stalls);
+
+        // All frames missing.
+        std::vector<std::filesystem::path> missingPaths(kFrameCount, paths[missingFrame]);
+        EXPECT(GridSequenceStreamer::create(missingPaths, sequence.gridname, kRingSize) == nullptr);
+    }
+}
@@ -317,4 +317,105 @@ GPU_TEST(BufferAllocatorStructAlign)
     }
 }
 
+GPU_TEST(BufferAllocatorFree)
+{
+    // Raw buffer with alignment and cacheline alignment.
+    BufferAllocator buf(16, 0, 128);
+
+    size_t a = buf.allocate(32);
+    size_t b = buf.allocate(48);
+    size_t c = buf.allocate(16);
+    size_t d = buf.allocate(64);
+    EXPECT_EQ(a, 0);
+    EXPECT_EQ(b, 32);
+    EXPECT_EQ(c, 80);
+    EXPECT_EQ(d, 128);
+    EXPECT_EQ(buf.getSize(), 192);
+
+    // Freed regions are reused by smaller allocations, the remainder stays free.
+    buf.free(b, 48);
+    EXPECT_EQ(buf.getFreeSize(), 48);
+    size_t e = buf.allocate(16);
+    EXPECT_EQ(e, 32);
+    EXPECT_EQ(buf.getFreeSize(), 32);
+
+    // Adjacent free regions are coalesced, so a larger allocation fits in the combined region.
+    buf.free(a, 32);
+    buf.free(e, 16);
+    EXPECT_EQ(buf.getFreeSize(), 80);
+    size_t f = buf.allocate(64);
+    EXPECT_EQ(f, 0);
+    EXPECT_EQ(buf.getFreeSize(), 16);
+    EXPECT_EQ(buf.getSize(), 192);
+
+    // Allocations too large for any free region are placed at the end.
+    size_t g = buf.allocate(100);
+    EXPECT_EQ(g, 256);
+    EXPECT_EQ(buf.getSize(), 356);
+
+    // Freeing the last regions shrinks the buffer, including the alignment padding before them.
+    buf.free(g, 100);
+    EXPECT_EQ(buf.getSize(), 192);
+    buf.free(d, 64);
+    EXPECT_EQ(buf.getSize(), 96);
+
+    // Freeing a region twice is an error.
+    bool caught = false;
+    try
+    {
+        buf.free(f, 64);
+        buf.free(f, 64);
+    }
+    catch (const ArgumentError&)
+    {
+        caught = true;
+    }
+    EXPECT(caught);
+}
+
+GPU_TEST(BufferAllocatorDirtyRanges)
+{
+    // Large raw buffer where only a few scattered elements are modified between uploads.
+    const size_t kCount = 64 * 1024;
+    BufferAllocator buf(0, 0, 0);
+    size_t offset = buf.allocate<uint32_t>(kCount);
+    EXPECT_EQ(offset, 0);
+
+    uint32_t* data = reinterpret_cast<uint32_t*>(buf.getStartPointer());
+    for (uint32_t i = 0; i < kCount; i++) data[i] = i;
+    buf.modified(0, kCount * sizeof(uint32_t));
+
+    auto validateGpuBuffer = [&]()
+    {
+        Buffer::SharedPtr pBuffer = buf.getGPUBuffer();
+        const uint32_t* ref = reinterpret_cast<const uint32_t*>(buf.getStartPointer());
+        const uint32_t* ptr = reinterpret_cast<const uint32_t*>(pBuffer->map(Buffer::MapType::Read));
+        for (size_t i = 0; i < buf.getSize() / sizeof(uint32_t); i++)
+        {
+            EXPECT_EQ(ptr[i], ref[i]) << "i=" << i;
+        }
+        pBuffer->unmap();
+    };
+
+    validateGpuBuffer();
+
+    // Modify the first and last elements and a few in between, including overlapping and adjacent ranges.
+    const size_t indices[] = { 0, kCount - 1, 100, 101, 5000, 5000, 30000, 12 };
+    for (size_t i : indices)
+    {
+        buf.set<uint32_t>(i * sizeof(uint32_t), 0xdeadbeef);
+    }
+    buf.modified(50 * sizeof(uint32_t), 100 * sizeof(uint32_t));
+
+    validateGpuBuffer();
+
+    // Free and reallocate a region in the middle. The reallocated memory is zero-initialized.
+    buf.free(1000 * sizeof(uint32_t), 10 * sizeof(uint32_t));
+    offset = buf.allocate<uint32_t>(10);
+    EXPECT_EQ(offset, 1000 * sizeof(uint32_t));
+    EXPECT_EQ(reinterpret_cast<const uint32_t*>(buf.getStartPointer())[1000], 0);
+
+    validateGpuBuffer();
+}
+
 } // namespace Falcor
@@ -27,6 +27,10 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/Image/AsyncTextureLoader.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include <limits>
+#include <optional>
 
 namespace Falcor
 {
@@ -103,36 +107,14 @@ namespace Falcor
                 float4(0.f, 0.f, 0.f, 1 / 256.f),
             },
         };
-    }
-
-    GPU_TEST(TextureAnalyzer)
-    {
-        TextureAnalyzer::SharedPtr pTextureAnalyzer = TextureAnalyzer::create();
-        EXPECT(pTextureAnalyzer != nullptr);
-
-        // Load test textures.
-        std::vector<Texture::SharedPtr> textures(kNumTests);
-        for (size_t i = 0; i < kNumTests; i++)
-        {
-            std::string fn = "tests/texture" + std::to_string(i + 1) + (i < kNumPNGs ? ".png" : ".exr");
-            textures[i] = Texture::createFromFile(fn, false, false);
-            if (!textures[i]) throw RuntimeError("Failed to load {}", fn);
-        }
 
-        // Analyze textures.
-        auto pResult = Buffer::create(kNumTests * kResultSize, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
-        EXPECT(pResult);
-        ctx.getRenderContext()->clearUAV(pResult->getUAV().get(), uint4(0));
-
-        for (size_t i = 0; i < kNumTests; i++)
+        std::filesystem::path getTestTexturePath(size_t i)
         {
-            pTextureAnalyzer->analyze(ctx.getRenderContext(), textures[i], 0, 0, pResult, i * kResultSize);
+            return "tests/texture" + std::to_string(i + 1) + (i < kNumPNGs ? ".png" : ".exr");
         }
 
-        auto verify = [&ctx](Buffer::SharedPtr pResult)
+        void verifyResults(UnitTestContext& ctx, const TextureAnalyzer::Result* result)
         {
-            // Verify results.
-            const TextureAnalyzer::Result* result = static_cast<const TextureAnalyzer::Result*>(pResult->map(Buffer::MapType::Read));
             for (size_t i = 0; i < kNumTests; i++)
             {
                 EXPECT_EQ(result[i].mask, kExpectedResult[i].mask) << "i = " << i;
@@ -158,15 +140,150 @@ namespace Falcor
                 EXPECT_EQ(result[i].isInf(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Inf) != 0) << "i = " << i;
                 EXPECT_EQ(result[i].isNaN(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::NaN) != 0) << "i = " << i;
             }
-            pResult->unmap();
-        };
+        }
+    }
+
+    GPU_TEST(TextureAnalyzer)
+    {
+        TextureAnalyzer::SharedPtr pTextureAnalyzer = TextureAnalyzer::create();
+        EXPECT(pTextureAnalyzer != nullptr);
+
+        // Load test textures.
+        std::vector<Texture::SharedPtr> textures(kNumTests);
+        for (size_t i = 0; i < kNumTests; i++)
+        {
+            auto fn = getTestTexturePath(i);
+            textures[i] = Texture::createFromFile(fn, false, false);
+            if (!textures[i]) throw RuntimeError("Failed to load {}", fn);
+        }
+
+        // Analyze textures.
+        auto pResult = Buffer::create(kNumTests * kResultSize, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
+        EXPECT(pResult);
+        ctx.getRenderContext()->clearUAV(pResult->getUAV().get(), uint4(0));
+
+        for (size_t i = 0; i < kNumTests; i++)
+        {
+            pTextureAnalyzer->analyze(ctx.getRenderContext(), textures[i], 0, 0, pResult, i * kResultSize);
+        }
 
-        verify(pResult);
+        const TextureAnalyzer::Result* result = static_cast<const TextureAnalyzer::Result*>(pResult->map(Buffer::MapType::Read));
+        verifyResults(ctx, result);
+        pResult->unmap();
 
         // Test the array version of the interface.
         ctx.getRenderContext()->clearUAV(pResult->getUAV().get(), uint4(0xbabababa));
         pTextureAnalyzer->analyze(ctx.getRenderContext(), textures, pResult);
 
-        verify(pResult);
+        result = static_cast<const TextureAnalyzer::Result*>(pResult->map(Buffer::MapType::Read));
+        verifyResults(ctx, result);
+        pResult->unmap();
+    }
+
+    CPU_TEST(TextureAnalyzerCPU)
+    {
+        std::vector<TextureAnalyzer::Result> results(kNumTests);
+        for (size_t i = 0; i < kNumTests; i++)
+        {
+            auto fn = getTestTexturePath(i);
+            std::filesystem::path fullPath;
+            if (!findFileInDataDirectories(fn, fullPath)) throw RuntimeError("Failed to find {}", fn);
+            auto pBitmap = Bitmap::createFromFile(fullPath, true);
+            if (!pBitmap) throw RuntimeError("Failed to load {}", fn);
+            results[i] = TextureAnalyzer::analyze(*pBitmap);
+        }
+
+        verifyResults(ctx, results.data());
+    }
+
+    CPU_TEST(TextureAnalyzerCPUFormats)
+    {
+        // 3x2 BGRA8 image where green and alpha vary. Analyzed as sRGB, only RGB are linearized.
+        const uint8_t bgra[] =
+        {
+            64, 255, 128, 255,   64,   0, 128, 255,   64, 255, 128, 255,
+            64, 255, 128, 255,   64, 255, 128,   0,   64, 255, 128, 255,
+        };
+        auto result = TextureAnalyzer::analyze(bgra, 3, 2, 12, ResourceFormat::BGRA8UnormSrgb);
+        EXPECT_EQ(result.mask, 0x0001111a);
+        EXPECT_EQ(result.value[0], sRGBToLinear(128 / 255.f));
+        EXPECT_EQ(result.value[2], sRGBToLinear(64 / 255.f));
+        EXPECT_EQ(result.minValue[1], 0.f);
+        EXPECT_EQ(result.maxValue[1], 1.f);
+        EXPECT_EQ(result.minValue[3], 0.f);
+
+        // Single channel float image. Missing channels read as (0,0,0,1).
+        const float values[] = { -1.f, 2.f, std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN() };
+        result = TextureAnalyzer::analyze(values, 2, 2, 8, ResourceFormat::R32Float);
+        EXPECT_EQ(result.mask, 0x000100f1);
+        EXPECT_EQ(result.value[0], -1.f);
+        EXPECT_EQ(result.minValue[0], 0.f);
+        EXPECT_EQ(result.maxValue[0], std::numeric_limits<float>::infinity());
+        EXPECT(result.isConstant(TextureChannelFlags::Green | TextureChannelFlags::Blue | TextureChannelFlags::Alpha));
+        EXPECT_EQ(result.value[3], 1.f);
+
+        // Row pitch padding must be skipped.
+        const uint8_t padded[] = { 7, 7, 0xff, 0xff, 7, 7, 0xff, 0xff };
+        result = TextureAnalyzer::analyze(padded, 2, 2, 4, ResourceFormat::R8Unorm);
+        EXPECT(result.isConstant(TextureChannelFlags::RGBA));
+        EXPECT_EQ(result.value[0], 7 / 255.f);
+
+        // Unsupported formats throw.
+        bool caught = false;
+        try
+        {
+            TextureAnalyzer::analyze(padded, 1, 1, 4, ResourceFormat::BC1Unorm);
+        }
+        catch (const RuntimeError&)
+        {
+            caught = true;
+        }
+        EXPECT(caught);
+    }
+
+    GPU_TEST(TextureAnalyzerAsyncTextureLoader)
+    {
+        // The loader analyzes the images before creating the textures, constant textures are created with a single texel.
+        std::vector<std::optional<TextureAnalyzer::Result>> results(kNumTests);
+        std::vector<Texture::SharedPtr> textures(kNumTests);
+        {
+            AsyncTextureLoader loader(2);
+            std::vector<std::future<Texture::SharedPtr>> futures;
+            for (size_t i = 0; i < kNumTests; i++)
+            {
+                futures.push_back(loader.loadFromFile(getTestTexturePath(i), true, false, Resource::BindFlags::ShaderResource,
+                    [&results, i](Texture::SharedPtr pTexture, const TextureAnalyzer::Result* pAnalysis) { if (pAnalysis) results[i] = *pAnalysis; }));
+            }
+            for (size_t i = 0; i < kNumTests; i++) textures[i] = futures[i].get();
+        }
+
+        for (size_t i = 0; i < kNumTests; i++)
+        {
+            EXPECT(textures[i] != nullptr) << "texture " << i;
+            EXPECT(results[i].has_value()) << "texture " << i;
+            if (!textures[i] || !results[i]) continue;
+
+            EXPECT_EQ(results[i]->mask, kExpectedResult[i].mask) << "texture " << i;
+            if (results[i]->isConstant(TextureChannelFlags::RGBA))
+            {
+                EXPECT_EQ(textures[i]->getWidth(), 1u) << "texture " << i;
+                EXPECT_EQ(textures[i]->getHeight(), 1u) << "texture " << i;
+            }
+            else
+            {
+                auto pReference = Texture::createFromFile(getTestTexturePath(i), true, false);
+                EXPECT_EQ(textures[i]->getWidth(), pReference->getWidth()) << "texture " << i;
+                EXPECT_EQ(textures[i]->getHeight(), pReference->getHeight()) << "texture " << i;
+            }
+        }
+
+        // The single texel holds the value of the constant texture.
+        TextureAnalyzer::SharedPtr pTextureAnalyzer = TextureAnalyzer::create();
+        auto pResult = Buffer::create(kResultSize, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
+        pTextureAnalyzer->analyze(ctx.getRenderContext(), textures[0], 0, 0, pResult, 0);
+        const TextureAnalyzer::Result* result = static_cast<const TextureAnalyzer::Result*>(pResult->map(Buffer::MapType::Read));
+        EXPECT(result->isConstant(TextureChannelFlags::RGBA));
+        for (uint32_t c = 0; c < 4; c++) EXPECT_EQ(result->value[c], kExpectedResult[0].value[c]) << "channel " << c;
+        pResult->unmap();
     }
 }
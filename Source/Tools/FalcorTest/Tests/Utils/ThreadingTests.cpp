@@ -0,0 +1,112 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Threading.h"
+#include <atomic>
+#include <stdexcept>
+
+namespace Falcor
+{
+    CPU_TEST(Threading_DispatchTask)
+    {
+        std::atomic<uint32_t> counter = 0;
+
+        std::vector<Threading::Task> tasks;
+        for (uint32_t i = 0; i < 100; ++i) tasks.push_back(Threading::dispatchTask([&]() { counter++; }));
+        for (auto& task : tasks)
+        {
+            task.finish();
+            EXPECT(!task.isRunning());
+        }
+        EXPECT_EQ(counter.load(), 100u);
+
+        for (uint32_t i = 0; i < 100; ++i) Threading::dispatchTask([&]() { counter++; });
+        Threading::finish();
+        EXPECT_EQ(counter.load(), 200u);
+    }
+
+    CPU_TEST(Threading_TaskException)
+    {
+        auto task = Threading::dispatchTask([]() { throw std::runtime_error("error"); });
+
+        bool caught = false;
+        try
+        {
+            task.finish();
+        }
+        catch (const std::runtime_error&)
+        {
+            caught = true;
+        }
+        EXPECT(caught);
+    }
+
+    CPU_TEST(Threading_TaskGroup)
+    {
+        std::atomic<uint32_t> counter = 0;
+
+        Threading::TaskGroup group;
+        for (uint32_t i = 0; i < 1000; ++i) group.run([&]() { counter++; });
+        group.wait();
+        EXPECT_EQ(counter.load(), 1000u);
+
+        // Tasks spawning nested groups must not deadlock.
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            group.run([&]()
+            {
+                Threading::TaskGroup nested;
+                for (uint32_t j = 0; j < 16; ++j) nested.run([&]() { counter++; });
+                nested.wait();
+            });
+        }
+        group.wait();
+        EXPECT_EQ(counter.load(), 1256u);
+    }
+
+    CPU_TEST(Threading_ParallelFor)
+    {
+        const size_t n = 100000;
+        std::vector<uint32_t> values(n, 0);
+
+        Threading::parallelFor(0, n, [&](size_t i) { values[i] += (uint32_t)i; });
+        for (size_t i = 0; i < n; ++i) EXPECT_EQ(values[i], (uint32_t)i) << "i = " << i;
+
+        // Explicit grain size and nested loops.
+        std::atomic<size_t> counter = 0;
+        Threading::parallelFor(0, 64, [&](size_t)
+        {
+            Threading::parallelFor(0, 100, [&](size_t) { counter++; }, 1);
+        }, 1);
+        EXPECT_EQ(counter.load(), (size_t)6400);
+
+        // Empty range.
+        Threading::parallelFor(10, 10, [&](size_t) { counter++; });
+        EXPECT_EQ(counter.load(), (size_t)6400);
+    }
+}